@@ -0,0 +1,164 @@
+/**
+ * @file Bench.h
+ * @brief Minimal microbenchmark harness for the esp32dev_bench build
+ *
+ * Google Benchmark-style registration and timing loop, small enough to run
+ * on the ESP32 itself (there is no host build of the firmware):
+ *
+ *     static void BM_Something(BenchState& state) {
+ *         while (state.keepRunning()) {
+ *             benchDoNotOptimize(something());
+ *         }
+ *     }
+ *     BENCHMARK(BM_Something);
+ *
+ * Each benchmark is calibrated until one run takes BENCH_MIN_TIME_US, then
+ * repeated BENCH_REPETITIONS times. The median time per iteration is
+ * reported. Serial is closed while a benchmark runs so log output from the
+ * code under test costs formatting time only, not UART time.
+ *
+ * Each benchmark runs in a task of its own (BENCH_TASK_STACK bytes), and the
+ * task's stack high-water mark is reported as "stack_bytes": the harness'
+ * own frames plus the deepest the benchmark body went. A body can attach a
+ * note to its result with BenchRegistry::setLabel().
+ *
+ * Results are printed as "BENCH {json}" lines between BENCH_BEGIN and
+ * BENCH_END; tools/bench_compare.py turns them into a results file and
+ * gates them against bench/baseline.json.
+ *
+ * The hot-path benchmarks (BENCH_FLASH_WRITE_FILTERS) then run again while
+ * another task erases and programs flash, as an OTA download does; those
+ * results carry an "@flash_write" suffix. The writes go to the
+ * BENCH_SCRATCH_PARTITION data partition, never an OTA slot, and the pass
+ * is skipped on a partition table without it.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+
+#ifndef BENCH_MIN_TIME_US
+#define BENCH_MIN_TIME_US         50000   // Target duration of one repetition
+#endif
+#ifndef BENCH_REPETITIONS
+#define BENCH_REPETITIONS         5       // Repetitions per benchmark (median reported)
+#endif
+#ifndef BENCH_MAX_ITERATIONS
+#define BENCH_MAX_ITERATIONS      1000000 // Calibration ceiling for very cheap bodies
+#endif
+#ifndef BENCH_TASK_STACK
+#define BENCH_TASK_STACK          16384   // Stack of the task each benchmark runs in
+#endif
+#ifndef BENCH_FLASH_LOAD_BYTES
+#define BENCH_FLASH_LOAD_BYTES    65536   // Bytes of the scratch partition rewritten by the flash load
+#endif
+#ifndef BENCH_SCRATCH_PARTITION
+#define BENCH_SCRATCH_PARTITION   "bench" // Data partition for the flash load (partitions_bench.csv)
+#endif
+
+/**
+ * @brief Iteration control handed to each benchmark body
+ */
+class BenchState {
+public:
+    explicit BenchState(uint32_t iterations) : remaining(iterations), iterations(iterations) {}
+
+    /**
+     * @brief Loop condition for the timed body
+     * @return true while iterations remain
+     */
+    inline bool keepRunning() {
+        if (remaining == 0) {
+            return false;
+        }
+        remaining--;
+        return true;
+    }
+
+    /**
+     * @brief Iterations requested for this run
+     */
+    uint32_t getIterations() const { return iterations; }
+
+private:
+    uint32_t remaining;
+    uint32_t iterations;
+};
+
+typedef void (*BenchFunction)(BenchState& state);
+
+/**
+ * @brief Keep a computed value alive so the optimizer cannot drop the work
+ */
+template <typename T>
+inline void benchDoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Registered benchmarks (static registration, run in registration order)
+ */
+class BenchRegistry {
+public:
+    /**
+     * @brief Register a benchmark (used by the BENCHMARK macro)
+     */
+    static void add(const char* name, BenchFunction function);
+
+    /**
+     * @brief Run every registered benchmark and print BENCH lines to Serial
+     * @param filter Only run benchmarks whose name contains this (nullptr = all)
+     * @param suffix Appended to each reported name (nullptr = none)
+     * @return Number of benchmarks run
+     */
+    static int runAll(const char* filter = nullptr, const char* suffix = nullptr);
+
+    /**
+     * @brief Attach a note to the running benchmark's result ("label", as in Google Benchmark)
+     * @param label Copied; up to 63 characters, no quotes
+     */
+    static void setLabel(const char* label);
+
+private:
+    struct Entry {
+        const char* name;
+        BenchFunction function;
+        Entry* next;
+    };
+
+    // One benchmark's measurements, filled in by measureTask()
+    struct Run {
+        BenchFunction function;
+        uint32_t iterations;
+        float ns_per_op[BENCH_REPETITIONS];
+        int32_t heap_delta;
+        uint32_t stack_bytes;
+        void* caller;
+    };
+
+    static Entry* head;
+    static Entry* tail;
+    static char label[64];
+
+    static uint32_t timeRun(BenchFunction function, uint32_t iterations);
+    static void measureTask(void* arg);
+};
+
+/**
+ * @brief Helper whose constructor registers a benchmark
+ */
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFunction function) {
+        BenchRegistry::add(name, function);
+    }
+};
+
+#define BENCHMARK(function) \
+    static BenchRegistrar function##_registrar(#function, function)
+
+#endif // BENCH_H
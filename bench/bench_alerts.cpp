@@ -0,0 +1,165 @@
+/**
+ * @file bench_alerts.cpp
+ * @brief Alert ingestion benchmarks: presets, option lookups, JSON parsing
+ *
+ * The JSON benchmarks use test/sample_alerts.json, embedded into the bench
+ * image by board_build.embed_txtfiles, so the payloads are the same ones the
+ * integration tests publish.
+ *
+ * BM_JsonIngest_SampleAlerts parses into the alert document as placed by
+ * MemoryPolicy (internal RAM by default); BM_JsonIngest_SampleAlertsPsram
+ * places it in PSRAM, so on a WROVER board the pair shows what moving the
+ * alert path there would cost. Without PSRAM both run from internal RAM.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "DisplayPreset.h"
+#include "MessageParser.h"
+#include <ArduinoJson.h>
+#include <MemoryPolicy.h>
+#include <vector>
+
+// embed_txtfiles appends a NUL, so the embedded file is a plain C string
+extern const char sample_alerts_json[] asm("_binary_test_sample_alerts_json_start");
+
+namespace {
+
+const char* const preset_levels[] = {"critical", "warning", "notice", "info", "unknown"};
+const char* const preset_categories[] = {
+    "security", "weather", "automation", "system", "network", "personal", "unknown"
+};
+
+/**
+ * @brief Each sample alert serialized on its own, as it would arrive over MQTT
+ */
+const std::vector<String>& sampleAlertPayloads() {
+    static std::vector<String> payloads;
+    if (!payloads.empty()) {
+        return payloads;
+    }
+
+    DynamicJsonDocument file(strlen(sample_alerts_json) * 2);
+    if (deserializeJson(file, sample_alerts_json)) {
+        Serial.println("Bench: sample_alerts.json failed to parse");
+        return payloads;
+    }
+
+    for (JsonPair alert : file["alerts"].as<JsonObject>()) {
+        String payload;
+        serializeJson(alert.value(), payload);
+        payloads.push_back(payload);
+    }
+    return payloads;
+}
+
+} // namespace
+
+/////////////////////////////////////////////
+// Display presets
+/////////////////////////////////////////////
+
+static void BM_DisplayPreset_AllCombinations(BenchState& state) {
+    while (state.keepRunning()) {
+        for (const char* level : preset_levels) {
+            for (const char* category : preset_categories) {
+                DisplayPreset preset = getDisplayPreset(level, category);
+                benchDoNotOptimize(preset);
+            }
+        }
+    }
+}
+BENCHMARK(BM_DisplayPreset_AllCombinations);
+
+static void BM_DisplayPreset_Critical(BenchState& state) {
+    while (state.keepRunning()) {
+        DisplayPreset preset = getDisplayPreset("critical", "security");
+        benchDoNotOptimize(preset);
+    }
+}
+BENCHMARK(BM_DisplayPreset_Critical);
+
+/////////////////////////////////////////////
+// MessageParser option lookups
+/////////////////////////////////////////////
+
+static void runParseMessage(BenchState& state, const char* msg) {
+    char color, position, mode, special;
+    String content;
+    while (state.keepRunning()) {
+        bool ok = MessageParser::parseMessage(msg, &color, &position, &mode, &special, &content);
+        benchDoNotOptimize(ok);
+        benchDoNotOptimize(special);
+    }
+}
+
+static void BM_MessageParser_NoOptions(BenchState& state) {
+    runParseMessage(state, "Front door open");
+}
+BENCHMARK(BM_MessageParser_NoOptions);
+
+static void BM_MessageParser_FirstEntries(BenchState& state) {
+    runParseMessage(state, "[red,rotate,trumpet]Front door open");
+}
+BENCHMARK(BM_MessageParser_FirstEntries);
+
+static void BM_MessageParser_LastEntries(BenchState& state) {
+    // Tail of every table: worst case for the linear option scan
+    runParseMessage(state, "[colormix,clock,bomb]Front door open");
+}
+BENCHMARK(BM_MessageParser_LastEntries);
+
+static void BM_MessageParser_UnknownOption(BenchState& state) {
+    runParseMessage(state, "[nosuchoption]Front door open");
+}
+BENCHMARK(BM_MessageParser_UnknownOption);
+
+/////////////////////////////////////////////
+// JSON ingestion
+/////////////////////////////////////////////
+
+template <typename Document>
+static void runJsonIngest(BenchState& state) {
+    const std::vector<String>& payloads = sampleAlertPayloads();
+
+    // Mirrors the messageCallback hot path: parse, pull fields, resolve preset
+    while (state.keepRunning()) {
+        for (const String& payload : payloads) {
+            Document doc(MQTT_MAX_PACKET_SIZE);
+            DeserializationError error = deserializeJson(doc, payload.c_str(), payload.length());
+            if (error) {
+                continue;
+            }
+
+            const char* title = doc["title"] | "";
+            const char* message = doc["message"] | "";
+            const char* level = doc["level"] | "info";
+            const char* category = doc["category"] | "system";
+            DisplayPreset preset = getDisplayPreset(level, category);
+
+            benchDoNotOptimize(title);
+            benchDoNotOptimize(message);
+            benchDoNotOptimize(preset);
+        }
+    }
+}
+
+static void BM_JsonIngest_SampleAlerts(BenchState& state) {
+    runJsonIngest<AlertJsonDocument>(state);
+}
+BENCHMARK(BM_JsonIngest_SampleAlerts);
+
+static void BM_JsonIngest_SampleAlertsPsram(BenchState& state) {
+    runJsonIngest<BulkJsonDocument>(state);
+}
+BENCHMARK(BM_JsonIngest_SampleAlertsPsram);
+
+static void BM_JsonParse_SampleFile(BenchState& state) {
+    size_t capacity = strlen(sample_alerts_json) * 2;
+    while (state.keepRunning()) {
+        DynamicJsonDocument doc(capacity);
+        DeserializationError error = deserializeJson(doc, sample_alerts_json);
+        benchDoNotOptimize(error);
+    }
+}
+BENCHMARK(BM_JsonParse_SampleFile);
@@ -0,0 +1,252 @@
+/**
+ * @file bench_decoder.cpp
+ * @brief Alert decoding: single-pass schema decoder against the ArduinoJson document
+ *
+ * Both benchmarks decode the same fuzzed corpus into AlertFields: alerts
+ * built from the sample_alerts.json vocabulary with members in random order,
+ * random whitespace, escaped and non-ASCII text, unknown members (nested
+ * objects and arrays included), wrong-typed and invalid display codes, and
+ * about one in six damaged (truncated or a structural character changed) so
+ * the error paths are timed too. The corpus comes from a fixed seed and is
+ * built without ArduinoJson, so it is the same on every run and adds nothing
+ * to the schema decoder's stack figure.
+ *
+ * Compare ns_per_op for throughput and stack_bytes for stack use. The
+ * ArduinoJson benchmark also checks that both decoders agree on every
+ * payload and reports the result as its label.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "AlertDecoder.h"
+#include <vector>
+
+namespace {
+
+const uint32_t CORPUS_SEED = 0xA1E27;
+const size_t CORPUS_SIZE = 96;
+
+const char* const TITLES[] = {
+    "Intruder Alert", "Storm Warning", "Garage Door", "Build Failed", "Laundry Done", "Server Down",
+    "Caf\\u00e9 Order Ready", "Wind \\\"Gusts\\\"", "\\ud83d\\udd25 Smoke", ""
+};
+const char* const MESSAGES[] = {
+    "Motion detected at front door",
+    "Severe thunderstorm expected at 3 PM",
+    "Garage door left open for 30 minutes",
+    "Pipeline main #1234 failed at stage: test",
+    "Washer cycle complete\\nDryer next",
+    "web-01 not responding (3 checks)",
+    "Temperature 23\\u00b0C, humidity 41%",
+    "Path C:\\\\logs\\\\today \\/ tab\\there",
+    "The quick brown fox jumps over the lazy dog while the sign scrolls this long line across the display "
+    "for as long as it takes to read it twice",
+    ""
+};
+const char* const LEVELS[] = {"critical", "warning", "notice", "info", "debug"};
+const char* const CATEGORIES[] = {"security", "weather", "automation", "system", "network", "personal", "other"};
+
+// Valid codes, then codes the sign does not know
+const char* const MODE_CODES[] = {"a", "b", "c", "n", "p", "t", "d", "z", ""};
+const char* const COLOR_CODES[] = {"1", "2", "3", "9", "A", "C", "0", "D", "red"};
+const char* const CHARSET_CODES[] = {"3", "6", "9", ":", "W", "Z", "0", "A"};
+const char* const POSITION_CODES[] = {" ", "0", "1", "2", "\\\"", "&", "3", "x"};
+const char* const SPEED_CODES[] = {"\\u0015", "\\u0017", "\\u0019", "\\\\031", "\\u001a", "\\\\032"};
+const char* const EFFECT_CODES[] = {"", "0", "9", "A", "S", "Z", "T", "z"};
+
+const char* const UNKNOWN_MEMBERS[] = {
+    "\"source\":\"security-system-01\"",
+    "\"tags\":[\"door\",\"front\",{\"zone\":\"kitchen\",\"ids\":[1,2,3]}]",
+    "\"meta\":{\"retries\":3,\"ratio\":0.75,\"ack\":true,\"owner\":null,\"nested\":{\"a\":[[],{}]}}",
+    "\"display_hint\":\"scroll\"",
+    "\"priority\":true"
+};
+
+class Prng {
+public:
+    explicit Prng(uint32_t seed) : state(seed) {}
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+    bool chance(uint32_t percent) { return below(100) < percent; }
+
+private:
+    uint32_t state;
+};
+
+template <size_t N>
+const char* pick(Prng& rng, const char* const (&pool)[N]) {
+    return pool[rng.below(N)];
+}
+
+String space(Prng& rng) {
+    static const char* const SPACES[] = {"", "", "", " ", "\n  ", "\t"};
+    return pick(rng, SPACES);
+}
+
+String member(Prng& rng, const char* key, const String& value) {
+    return "\"" + String(key) + "\"" + space(rng) + ":" + space(rng) + value;
+}
+
+String quoted(const char* text) {
+    return "\"" + String(text) + "\"";
+}
+
+/**
+ * @brief Members in random order, joined into an object
+ */
+String object(Prng& rng, std::vector<String>& members) {
+    for (size_t i = members.size(); i > 1; i--) {
+        std::swap(members[i - 1], members[rng.below(i)]);
+    }
+    String text = "{" + space(rng);
+    for (size_t i = 0; i < members.size(); i++) {
+        if (i) {
+            text += "," + space(rng);
+        }
+        text += members[i];
+    }
+    return text + space(rng) + "}";
+}
+
+String displayConfig(Prng& rng) {
+    std::vector<String> members;
+    if (rng.chance(90)) members.push_back(member(rng, "mode_code", quoted(pick(rng, MODE_CODES))));
+    if (rng.chance(90)) members.push_back(member(rng, "color_code", quoted(pick(rng, COLOR_CODES))));
+    if (rng.chance(70)) members.push_back(member(rng, "charset_code", quoted(pick(rng, CHARSET_CODES))));
+    if (rng.chance(70)) members.push_back(member(rng, "position_code", quoted(pick(rng, POSITION_CODES))));
+    if (rng.chance(70)) members.push_back(member(rng, "speed_code", quoted(pick(rng, SPEED_CODES))));
+    if (rng.chance(70)) members.push_back(member(rng, "effect_code", quoted(pick(rng, EFFECT_CODES))));
+    if (rng.chance(60)) members.push_back(member(rng, "priority", rng.chance(30) ? "true" : "false"));
+    if (rng.chance(60)) members.push_back(member(rng, "duration", String(5 + rng.below(120))));
+    if (rng.chance(20)) members.push_back(member(rng, "color_code", "1"));          // Wrong type
+    if (rng.chance(30)) members.push_back(member(rng, "mode", "\"flash\""));        // Descriptive, not read
+    return object(rng, members);
+}
+
+String fuzzedAlert(Prng& rng) {
+    std::vector<String> members;
+    if (rng.chance(95)) members.push_back(member(rng, "title", quoted(pick(rng, TITLES))));
+    if (rng.chance(95)) members.push_back(member(rng, "message", quoted(pick(rng, MESSAGES))));
+    if (rng.chance(85)) members.push_back(member(rng, "level", quoted(pick(rng, LEVELS))));
+    if (rng.chance(85)) members.push_back(member(rng, "category", quoted(pick(rng, CATEGORIES))));
+    if (rng.chance(60)) members.push_back(member(rng, "id", quoted(("alert-" + String(rng.below(100000))).c_str())));
+    if (rng.chance(80)) members.push_back(member(rng, "timestamp", String(1704045600UL + rng.below(86400))));
+    if (rng.chance(20)) members.push_back(member(rng, "expires", rng.chance(80) ? "1704132000" : "-1"));
+    if (rng.chance(30)) members.push_back(member(rng, "zone", quoted(rng.chance(50) ? "all" : "kitchen")));
+    if (rng.chance(10)) members.push_back(member(rng, "echo", "true"));
+    if (rng.chance(65)) members.push_back(member(rng, "display_config", displayConfig(rng)));
+    for (uint32_t n = rng.below(3); n > 0; n--) {
+        members.push_back(pick(rng, UNKNOWN_MEMBERS));
+    }
+    String text = object(rng, members);
+
+    // Damage some: cut short, or a structural character swapped
+    uint32_t damage = rng.below(12);
+    if (damage == 0) {
+        text.remove(rng.below(text.length()));
+    } else if (damage == 1) {
+        static const char STRUCTURAL[] = "{}[]:,\"";
+        text.setCharAt(rng.below(text.length()), STRUCTURAL[rng.below(sizeof(STRUCTURAL) - 1)]);
+    }
+    return text;
+}
+
+const std::vector<String>& corpus() {
+    static std::vector<String> payloads;
+    if (payloads.empty()) {
+        Prng rng(CORPUS_SEED);
+        for (size_t i = 0; i < CORPUS_SIZE; i++) {
+            payloads.push_back(fuzzedAlert(rng));
+        }
+    }
+    return payloads;
+}
+
+bool sameFields(const AlertFields& a, const AlertFields& b) {
+    if (a.text_length != b.text_length || memcmp(a.text, b.text, a.text_length) != 0 ||
+        a.title_length != b.title_length || a.has_title != b.has_title || strcmp(a.id, b.id) != 0 ||
+        strcmp(a.zone, b.zone) != 0 || strcmp(a.level, b.level) != 0 || strcmp(a.category, b.category) != 0 ||
+        a.timestamp != b.timestamp || a.expires != b.expires || a.echo != b.echo ||
+        a.has_display_config != b.has_display_config) {
+        return false;
+    }
+    return !a.has_display_config ||
+           (a.mode == b.mode && a.color == b.color && a.charset == b.charset && a.position == b.position &&
+            a.speed[0] == b.speed[0] && a.special == b.special && a.priority == b.priority &&
+            a.duration == b.duration && a.invalid_codes == b.invalid_codes);
+}
+
+// Both decoders get a fresh copy of the payload, as handleMQTTMessage() gets PubSubClient's buffer
+uint8_t scratch[MQTT_MAX_PACKET_SIZE];
+char text_a[ALERTDEC_BUFFER_SIZE(MQTT_MAX_PACKET_SIZE)];
+char text_b[ALERTDEC_BUFFER_SIZE(MQTT_MAX_PACKET_SIZE)];
+
+/**
+ * @brief Decode the corpus both ways once and label the result with the agreement
+ */
+void checkParity() {
+    static bool checked = false;
+    if (checked) {
+        return;
+    }
+    checked = true;
+
+    uint32_t valid = 0;
+    uint32_t mismatches = 0;
+    for (const String& payload : corpus()) {
+        AlertFields schema, document;
+        AlertDecodeResult a = AlertDecoder::decode((const uint8_t*)payload.c_str(), payload.length(), schema,
+                                                   text_a, sizeof(text_a));
+        memcpy(scratch, payload.c_str(), payload.length());
+        AlertDecodeResult b = AlertDecoder::decodeDocument(scratch, payload.length(), document, text_b,
+                                                           sizeof(text_b));
+        if (a == ALERTDEC_OK) {
+            valid++;
+        }
+        if ((a == ALERTDEC_OK) != (b == ALERTDEC_OK) || (a == ALERTDEC_OK && !sameFields(schema, document))) {
+            mismatches++;
+        }
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "corpus %u (%lu valid), %lu mismatches", (unsigned)CORPUS_SIZE,
+             (unsigned long)valid, (unsigned long)mismatches);
+    BenchRegistry::setLabel(label);
+}
+
+} // namespace
+
+static void BM_AlertDecode_Schema(BenchState& state) {
+    const std::vector<String>& payloads = corpus();
+    while (state.keepRunning()) {
+        for (const String& payload : payloads) {
+            memcpy(scratch, payload.c_str(), payload.length());
+            AlertFields fields;
+            AlertDecodeResult result = AlertDecoder::decode(scratch, payload.length(), fields, text_a, sizeof(text_a));
+            benchDoNotOptimize(result);
+            benchDoNotOptimize(fields);
+        }
+    }
+}
+BENCHMARK(BM_AlertDecode_Schema);
+
+static void BM_AlertDecode_ArduinoJson(BenchState& state) {
+    const std::vector<String>& payloads = corpus();
+    while (state.keepRunning()) {
+        for (const String& payload : payloads) {
+            memcpy(scratch, payload.c_str(), payload.length());
+            AlertFields fields;
+            AlertDecodeResult result = AlertDecoder::decodeDocument(scratch, payload.length(), fields, text_b,
+                                                                    sizeof(text_b));
+            benchDoNotOptimize(result);
+            benchDoNotOptimize(fields);
+        }
+    }
+    checkParity();
+}
+BENCHMARK(BM_AlertDecode_ArduinoJson);
@@ -0,0 +1,55 @@
+/**
+ * @file bench_eventbus.cpp
+ * @brief Event bus publish and dispatch benchmarks
+ *
+ * The benchmark subscriber only counts, so the numbers are the bus's own cost:
+ * one publish (claim + write + release) and one delivery through the
+ * subscriber table. Other subscribers registered by the build run too.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include <EventBus.h>
+
+namespace {
+
+uint32_t delivered_count = 0;
+
+void countEvent(const Event& event, void*) {
+    delivered_count += event.value;
+}
+
+void ensureSubscribed() {
+    static bool subscribed = false;
+    if (!subscribed) {
+        // OTA_FAILED has no other subscribers in the bench build
+        EventBus::subscribe(EVENT_MASK(EVT_OTA_FAILED), countEvent);
+        subscribed = true;
+    }
+    EventBus::dispatch(EVENTBUS_QUEUE_SIZE);
+}
+
+} // namespace
+
+static void BM_EventBus_PublishDispatch(BenchState& state) {
+    ensureSubscribed();
+    while (state.keepRunning()) {
+        EventBus::publish(EVT_OTA_FAILED, 1);
+        EventBus::dispatch(1);
+    }
+    benchDoNotOptimize(delivered_count);
+}
+BENCHMARK(BM_EventBus_PublishDispatch);
+
+static void BM_EventBus_PublishBurst(BenchState& state) {
+    // Fill the queue, then drain it in one dispatch: per-event cost of a busy loop pass
+    ensureSubscribed();
+    while (state.keepRunning()) {
+        for (uint16_t i = 0; i < EVENTBUS_QUEUE_SIZE; i++) {
+            EventBus::publish(EVT_OTA_FAILED, 1);
+        }
+        EventBus::dispatch(EVENTBUS_QUEUE_SIZE);
+    }
+    benchDoNotOptimize(delivered_count);
+}
+BENCHMARK(BM_EventBus_PublishBurst);
@@ -0,0 +1,71 @@
+/**
+ * @file bench_hotpath.cpp
+ * @brief Hot-path benchmarks: scheduler deadline scan and per-frame load estimate
+ *
+ * Together with the BETABRITE encode/write and JSON ingest benchmarks these
+ * are the paths include/HotPath.h places in IRAM/DRAM. bench_main.cpp runs
+ * them a second time with a concurrent flash writer ("@flash_write"), so a
+ * pair of results shows what an OTA download costs each path.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "Scheduler.h"
+#include "SignLoad.h"
+#include "BBDEFS.h"
+
+namespace {
+
+// Timer wheel as the firmware fills it: mostly idle components, a few polled every pass
+const uint8_t IDLE_COMPONENTS = 16;
+const uint8_t POLLED_COMPONENTS = 4;
+
+uint32_t polled_runs = 0;
+
+uint32_t idleComponent(uint32_t now) {
+    return now + 3600000;
+}
+
+uint32_t polledComponent(uint32_t now) {
+    polled_runs++;
+    return now;
+}
+
+Scheduler& benchScheduler() {
+    static Scheduler* scheduler = nullptr;
+    if (!scheduler) {
+        scheduler = new Scheduler();
+        for (uint8_t i = 0; i < IDLE_COMPONENTS; i++) {
+            scheduler->add("idle", idleComponent, 1000);
+        }
+        for (uint8_t i = 0; i < POLLED_COMPONENTS; i++) {
+            scheduler->add("polled", polledComponent, 1000);
+        }
+        scheduler->begin();
+        scheduler->loop();  // Idle components move to their far deadline
+    }
+    return *scheduler;
+}
+
+// Inline colour change to red (BB_FC_SELECTCHARCOLOR '1') part way through an amber frame
+const char* const load_text = "FRONT DOOR OPEN - \x1c" "1MOTION IN DRIVEWAY";
+
+} // namespace
+
+static void BM_Scheduler_LoopPolled(BenchState& state) {
+    Scheduler& scheduler = benchScheduler();
+    while (state.keepRunning()) {
+        benchDoNotOptimize(scheduler.loop());
+    }
+    benchDoNotOptimize(polled_runs);
+}
+BENCHMARK(BM_Scheduler_LoopPolled);
+
+static void BM_SignLoad_Estimate(BenchState& state) {
+    uint32_t milliamps = 0;
+    while (state.keepRunning()) {
+        milliamps = SignLoadGovernor::estimate(load_text, BB_COL_AMBER, BB_DM_FLASH);
+        benchDoNotOptimize(milliamps);
+    }
+}
+BENCHMARK(BM_SignLoad_Estimate);
@@ -0,0 +1,198 @@
+/**
+ * @file bench_main.cpp
+ * @brief Entry point and runner for the esp32dev_bench build
+ *
+ * Build and run:  pio run -e esp32dev_bench -t upload && pio device monitor -e esp32dev_bench | tee bench.log
+ * Compare:        python3 tools/bench_compare.py bench.log
+ *
+ * No WiFi, MQTT or sign traffic - the board only runs the registered
+ * benchmarks once after boot, then idles.
+ *
+ * The flash load pass erases and rewrites the BENCH_SCRATCH_PARTITION data
+ * partition (partitions_bench.csv), so the rollback image in the inactive
+ * OTA slot survives a bench run.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include <MemoryPolicy.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include <algorithm>
+
+namespace {
+
+// Hot paths re-run under a concurrent flash write (name substrings)
+const char* const FLASH_WRITE_FILTERS[] = {
+    "BM_BetaBrite_Encode", "BM_BetaBrite_WriteRaw", "BM_JsonIngest", "BM_DisplayPreset_Critical",
+    "BM_Scheduler", "BM_SignLoad", "BM_AlertDecode"
+};
+
+volatile bool flash_load_running = false;
+volatile bool flash_load_stopped = true;
+uint32_t flash_load_sectors = 0;
+
+/**
+ * @brief Erase and program sectors back to back, like Update.write() during an OTA download
+ */
+void flashLoadTask(void* arg) {
+    const esp_partition_t* scratch = (const esp_partition_t*)arg;
+    static uint8_t block[SPI_FLASH_SEC_SIZE];
+    memset(block, 0xA5, sizeof(block));
+
+    uint32_t offset = 0;
+    while (flash_load_running) {
+        esp_partition_erase_range(scratch, offset, SPI_FLASH_SEC_SIZE);
+        esp_partition_write(scratch, offset, block, sizeof(block));
+        flash_load_sectors++;
+        offset = (offset + SPI_FLASH_SEC_SIZE) % BENCH_FLASH_LOAD_BYTES;
+        vTaskDelay(1);  // Network reads between writes, and lets the idle task feed the watchdog
+    }
+    flash_load_stopped = true;
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Run the hot-path benchmarks again with the flash load on the other core
+ * @return Number of benchmarks run (0 if there is no scratch partition to write)
+ */
+int runUnderFlashLoad() {
+    const esp_partition_t* scratch = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           BENCH_SCRATCH_PARTITION);
+    if (!scratch || scratch->size < BENCH_FLASH_LOAD_BYTES) {
+        Serial.println("Bench: No \"" BENCH_SCRATCH_PARTITION "\" partition - skipping the flash write pass");
+        return 0;
+    }
+
+    flash_load_running = true;
+    flash_load_stopped = false;
+    xTaskCreatePinnedToCore(flashLoadTask, "bench_flash", 4096, (void*)scratch, 5, nullptr,
+                            xPortGetCoreID() == 0 ? 1 : 0);
+
+    int count = 0;
+    for (const char* filter : FLASH_WRITE_FILTERS) {
+        count += BenchRegistry::runAll(filter, "@flash_write");
+    }
+
+    flash_load_running = false;
+    while (!flash_load_stopped) {
+        delay(10);
+    }
+    Serial.printf("Bench: Flash load wrote %lu sectors\n", (unsigned long)flash_load_sectors);
+    return count;
+}
+
+} // namespace
+
+BenchRegistry::Entry* BenchRegistry::head = nullptr;
+BenchRegistry::Entry* BenchRegistry::tail = nullptr;
+char BenchRegistry::label[64] = "";
+
+void BenchRegistry::add(const char* name, BenchFunction function) {
+    Entry* entry = new Entry{name, function, nullptr};
+    if (tail) {
+        tail->next = entry;
+    } else {
+        head = entry;
+    }
+    tail = entry;
+}
+
+void BenchRegistry::setLabel(const char* text) {
+    strlcpy(label, text, sizeof(label));
+}
+
+uint32_t BenchRegistry::timeRun(BenchFunction function, uint32_t iterations) {
+    BenchState state(iterations);
+    int64_t start = esp_timer_get_time();
+    function(state);
+    return (uint32_t)(esp_timer_get_time() - start);
+}
+
+void BenchRegistry::measureTask(void* arg) {
+    Run& run = *(Run*)arg;
+
+    // Calibrate: grow until a run is long enough to scale from, then aim at the target
+    uint32_t iterations = 1;
+    uint32_t elapsed = timeRun(run.function, iterations);
+    while (elapsed < BENCH_MIN_TIME_US / 10 && iterations < BENCH_MAX_ITERATIONS) {
+        iterations *= 10;
+        elapsed = timeRun(run.function, iterations);
+    }
+    if (elapsed < BENCH_MIN_TIME_US) {
+        uint64_t scaled = (uint64_t)iterations * BENCH_MIN_TIME_US / (elapsed ? elapsed : 1);
+        iterations = (uint32_t)std::min<uint64_t>(std::max<uint64_t>(scaled, 1), BENCH_MAX_ITERATIONS);
+    }
+
+    uint32_t heap_before = ESP.getFreeHeap();
+    for (int rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        run.ns_per_op[rep] = timeRun(run.function, iterations) * 1000.0f / iterations;
+    }
+    run.heap_delta = (int32_t)ESP.getFreeHeap() - (int32_t)heap_before;
+    run.iterations = iterations;
+    run.stack_bytes = BENCH_TASK_STACK - uxTaskGetStackHighWaterMark(nullptr);  // Bytes on ESP-IDF
+
+    xTaskNotifyGive((TaskHandle_t)run.caller);
+    vTaskDelete(nullptr);
+}
+
+int BenchRegistry::runAll(const char* filter, const char* suffix) {
+    int count = 0;
+
+    for (Entry* entry = head; entry; entry = entry->next) {
+        if (filter && !strstr(entry->name, filter)) {
+            continue;
+        }
+
+        // Quiet UART while timing: logging in the code under test must not measure the baud rate
+        Serial.flush();
+        Serial.end();
+
+        // A fresh task per benchmark, so its stack high-water mark is this benchmark's alone
+        Run run = {};
+        run.function = entry->function;
+        run.caller = xTaskGetCurrentTaskHandle();
+        label[0] = '\0';
+        xTaskCreatePinnedToCore(measureTask, "bench_run", BENCH_TASK_STACK, &run, uxTaskPriorityGet(nullptr),
+                                nullptr, xPortGetCoreID());
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        std::sort(run.ns_per_op, run.ns_per_op + BENCH_REPETITIONS);
+
+        Serial.begin(115200);
+        Serial.printf("BENCH {\"name\":\"%s%s\",\"iterations\":%lu,\"repetitions\":%d,"
+                      "\"ns_per_op\":%.1f,\"min_ns\":%.1f,\"max_ns\":%.1f,\"heap_delta\":%ld,"
+                      "\"stack_bytes\":%lu",
+                      entry->name, suffix ? suffix : "", (unsigned long)run.iterations, BENCH_REPETITIONS,
+                      run.ns_per_op[BENCH_REPETITIONS / 2], run.ns_per_op[0],
+                      run.ns_per_op[BENCH_REPETITIONS - 1], (long)run.heap_delta, (unsigned long)run.stack_bytes);
+        if (label[0]) {
+            Serial.printf(",\"label\":\"%s\"", label);
+        }
+        Serial.println("}");
+        count++;
+    }
+
+    return count;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println();
+    bool psram = MemoryPolicy::begin();
+    Serial.printf("BENCH_BEGIN {\"version\":\"%s\",\"cpu_mhz\":%lu,\"psram_bytes\":%lu,\"min_time_us\":%d,"
+                  "\"repetitions\":%d,\"build\":\"%s %s\"}\n",
+                  FIRMWARE_VERSION, (unsigned long)getCpuFrequencyMhz(),
+                  (unsigned long)(psram ? ESP.getPsramSize() : 0), BENCH_MIN_TIME_US,
+                  BENCH_REPETITIONS, __DATE__, __TIME__);
+
+    int count = BenchRegistry::runAll();
+    count += runUnderFlashLoad();
+
+    Serial.printf("BENCH_END {\"benchmarks\":%d}\n", count);
+}
+
+void loop() {
+    delay(1000);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file bench_metrics.cpp
+ * @brief Metrics registry update and exposition benchmarks
+ *
+ * The update benchmarks are the cost every instrumented hot path pays; compare
+ * them with BM_Metrics_LoopOverhead (same loop, no update) - at 240 MHz each
+ * nanosecond is about a quarter of a cycle, so a few instructions show up as
+ * a few tens of ns.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "Metrics.h"
+
+namespace {
+
+const uint32_t BENCH_BOUNDS[] = {500, 1000, 2000, 5000, 10000, 20000, 50000, 100000};
+
+MetricCounter bench_counter("ledsign_bench_counter_total", "Benchmark counter");
+MetricGauge bench_gauge("ledsign_bench_gauge", "Benchmark gauge");
+MetricHistogram bench_histogram("ledsign_bench_histogram", "Benchmark histogram",
+                                BENCH_BOUNDS, sizeof(BENCH_BOUNDS) / sizeof(BENCH_BOUNDS[0]));
+
+/**
+ * Counts bytes without sending them anywhere
+ */
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+};
+
+} // namespace
+
+/////////////////////////////////////////////
+// Hot-path updates
+/////////////////////////////////////////////
+
+static void BM_Metrics_LoopOverhead(BenchState& state) {
+    uint32_t i = 0;
+    while (state.keepRunning()) {
+        benchDoNotOptimize(i++);
+    }
+}
+BENCHMARK(BM_Metrics_LoopOverhead);
+
+static void BM_Metrics_CounterInc(BenchState& state) {
+    while (state.keepRunning()) {
+        bench_counter.inc();
+    }
+    benchDoNotOptimize(bench_counter.get());
+}
+BENCHMARK(BM_Metrics_CounterInc);
+
+static void BM_Metrics_GaugeSet(BenchState& state) {
+    int32_t i = 0;
+    while (state.keepRunning()) {
+        bench_gauge.set(i++);
+    }
+    benchDoNotOptimize(bench_gauge.get());
+}
+BENCHMARK(BM_Metrics_GaugeSet);
+
+static void BM_Metrics_HistogramObserveLow(BenchState& state) {
+    // First bucket: one bound comparison
+    while (state.keepRunning()) {
+        bench_histogram.observe(100);
+    }
+    benchDoNotOptimize(bench_histogram.getSum());
+}
+BENCHMARK(BM_Metrics_HistogramObserveLow);
+
+static void BM_Metrics_HistogramObserveHigh(BenchState& state) {
+    // +Inf bucket: every bound compared
+    while (state.keepRunning()) {
+        bench_histogram.observe(1000000);
+    }
+    benchDoNotOptimize(bench_histogram.getSum());
+}
+BENCHMARK(BM_Metrics_HistogramObserveHigh);
+
+/////////////////////////////////////////////
+// Exposition (scrape / MQTT snapshot)
+/////////////////////////////////////////////
+
+static void BM_Metrics_WritePrometheus(BenchState& state) {
+    NullPrint out;
+    while (state.keepRunning()) {
+        size_t written = Metrics::writePrometheus(out);
+        benchDoNotOptimize(written);
+    }
+}
+BENCHMARK(BM_Metrics_WritePrometheus);
+
+static void BM_Metrics_SnapshotJson(BenchState& state) {
+    while (state.keepRunning()) {
+        String snapshot = Metrics::snapshotJson();
+        benchDoNotOptimize(snapshot.length());
+    }
+}
+BENCHMARK(BM_Metrics_SnapshotJson);
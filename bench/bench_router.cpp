@@ -0,0 +1,49 @@
+/**
+ * @file bench_router.cpp
+ * @brief Alert routing table match benchmarks
+ *
+ * A four-route table like a multi-zone sign's: site-wide, floor wildcard,
+ * own zone and a '#' catch-all. Matching runs per received message, so
+ * these are the per-message cost of routing before any JSON parsing.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "AlertRouter.h"
+
+namespace {
+
+AlertRouter& benchRouter() {
+    static AlertRouter router;
+    if (router.count() == 0) {
+        router.addRoute("ledSign/site/message", "warning", 0, 'E');
+        router.addRoute("ledSign/floor2/+", "", -1);
+        router.addRoute("ledSign/kitchen/message");
+        router.addRoute("ledSign/+/alerts/#");
+    }
+    return router;
+}
+
+} // namespace
+
+static void BM_AlertRouter_MatchOwnZone(BenchState& state) {
+    // Third route: the first two are rejected at their second level
+    AlertRouter& router = benchRouter();
+    const AlertRoute* route = nullptr;
+    while (state.keepRunning()) {
+        route = router.match("ledSign/kitchen/message");
+        benchDoNotOptimize(route);
+    }
+}
+BENCHMARK(BM_AlertRouter_MatchOwnZone);
+
+static void BM_AlertRouter_NoMatch(BenchState& state) {
+    // Worst case: every route is tried and fails
+    AlertRouter& router = benchRouter();
+    const AlertRoute* route = nullptr;
+    while (state.keepRunning()) {
+        route = router.match("ledSign/lobby/message");
+        benchDoNotOptimize(route);
+    }
+}
+BENCHMARK(BM_AlertRouter_NoMatch);
@@ -0,0 +1,73 @@
+/**
+ * @file bench_services.cpp
+ * @brief Home Assistant discovery and OTA version benchmarks
+ *
+ * HADiscovery runs against an unconnected PubSubClient: topic building and
+ * JSON payload generation are timed in full, publish() returns false at once.
+ */
+
+#include "defines.h"
+#include "Bench.h"
+#include "HADiscovery.h"
+#include <GitHubOTA.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+
+namespace {
+
+HADiscovery& benchDiscovery() {
+    static WiFiClient wifi_client;
+    static PubSubClient mqtt_client(wifi_client);
+    static HADiscovery discovery(&mqtt_client, "ledsign_bench", "LED Sign Bench", "kitchen");
+    return discovery;
+}
+
+} // namespace
+
+/////////////////////////////////////////////
+// Home Assistant discovery
+/////////////////////////////////////////////
+
+static void BM_HADiscovery_PublishDiscovery(BenchState& state) {
+    HADiscovery& discovery = benchDiscovery();
+    while (state.keepRunning()) {
+        bool ok = discovery.publishDiscovery();
+        benchDoNotOptimize(ok);
+    }
+}
+BENCHMARK(BM_HADiscovery_PublishDiscovery);
+
+static void BM_HADiscovery_HandleUnknownTopic(BenchState& state) {
+    // Falls through every command topic comparison before rejecting
+    HADiscovery& discovery = benchDiscovery();
+    const char topic[] = "ledSign/kitchen/unrelated/topic";
+    const uint8_t payload[] = "ON";
+    while (state.keepRunning()) {
+        bool handled = discovery.handleMessage(topic, payload, sizeof(payload) - 1);
+        benchDoNotOptimize(handled);
+    }
+}
+BENCHMARK(BM_HADiscovery_HandleUnknownTopic);
+
+static void BM_HADiscovery_LWTTopic(BenchState& state) {
+    HADiscovery& discovery = benchDiscovery();
+    while (state.keepRunning()) {
+        String topic = discovery.getLWTTopic();
+        benchDoNotOptimize(topic.length());
+    }
+}
+BENCHMARK(BM_HADiscovery_LWTTopic);
+
+/////////////////////////////////////////////
+// OTA version comparison
+/////////////////////////////////////////////
+
+static void BM_GitHubOTA_CompareVersions(BenchState& state) {
+    String newer = "v0.6.10";
+    String current = "0.6.9";
+    while (state.keepRunning()) {
+        int result = GitHubOTA::compareVersions(newer, current);
+        benchDoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_GitHubOTA_CompareVersions);
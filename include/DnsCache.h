@@ -0,0 +1,130 @@
+/****************************************************************************************************************************
+  DnsCache.h
+  Shared host name cache for the MQTT, Home Assistant and OTA clients
+
+  Each reconnect used to resolve the broker (and each OTA request api.github.com and the asset
+  CDN) from scratch, which adds seconds per attempt on sites with slow or flaky DNS. Clients
+  that connect by name go through this cache instead:
+
+      DnsCachedClientSecure client;        // drop-in for WiFiClientSecure
+      https.begin(client, url);            // HTTPClient / PubSubClient connect by name as before
+
+  - A fresh entry (younger than DNSCACHE_TTL_MS) answers without touching the network
+  - An expired entry is still returned for up to DNSCACHE_MAX_STALE_MS while a background task
+    re-resolves it (stale-while-revalidate); if DNS is down, the last good address is used
+  - The refresh task re-resolves every entry ahead of expiry, so connects normally hit
+  - prefetch() adds a host to be resolved in the background before its first connect
+  - Only a host that was never resolved (or is older than the stale limit) blocks the caller
+
+  lwIP does not report record TTLs to callers, so entries live DNSCACHE_TTL_MS; lwIP's own
+  table still honors the real TTL underneath. IPv4 only, like the rest of the firmware.
+
+  WiFi.hostByName() waits on one shared "DNS done" bit, so lookups must not overlap: they take
+  turns on a mutex, and the refresh task skips its pass while a caller is waiting for a lookup
+  rather than making it queue behind a slow background query.
+
+  Lives in include/ (like EventBus.h) so lib/GitHubOTA can use it; the implementation is
+  src/DnsCache.cpp. Hits, stale hits, misses, failures and lookup time are exported as
+  ledsign_dns* metrics (src/Metrics.h).
+ *****************************************************************************************************************************/
+
+#ifndef DnsCache_h
+#define DnsCache_h
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+// DNS cache configuration constants (from defines.h)
+#ifndef DNSCACHE_ENTRIES
+#define DNSCACHE_ENTRIES          8
+#endif
+#ifndef DNSCACHE_HOST_LEN
+#define DNSCACHE_HOST_LEN         64        // Longest cached host name + 1
+#endif
+#ifndef DNSCACHE_TTL_MS
+#define DNSCACHE_TTL_MS           300000
+#endif
+#ifndef DNSCACHE_MAX_STALE_MS
+#define DNSCACHE_MAX_STALE_MS     3600000
+#endif
+#ifndef DNSCACHE_RETRY_MS
+#define DNSCACHE_RETRY_MS         30000
+#endif
+
+namespace DnsCache {
+
+/**
+ * @brief Start the background refresh task (call once WiFi is up; later calls are no-ops)
+ * @return true if the task is running
+ */
+bool begin();
+
+/**
+ * @brief Resolve a host name through the cache
+ * @param host Host name or dotted IPv4 literal
+ * @param address Receives the address
+ * @param cached Set to true if answered without a lookup on this call (optional)
+ * @return false if the host has never resolved and the lookup failed
+ */
+bool resolve(const char* host, IPAddress& address, bool* cached = nullptr);
+
+/**
+ * @brief Queue a host for background resolution before its first connect
+ * @param host Host name (IP literals are ignored)
+ */
+void prefetch(const char* host);
+
+/**
+ * @brief Get human-readable status for logging
+ */
+String getStatus();
+
+} // namespace DnsCache
+
+/**
+ * @brief Where the last connect() by host name spent its time
+ */
+struct DnsConnectTiming {
+    uint32_t dns_us;            ///< Cache lookup (a real query only on a miss)
+    uint32_t connect_us;        ///< TCP connect (secure clients: plus loading the TLS credentials)
+    uint32_t tls_us;            ///< TLS handshake (0 for plain clients and PSK sessions)
+    bool dns_cached;            ///< Answered from the cache
+};
+
+/**
+ * @brief WiFiClient that resolves host names through DnsCache
+ */
+class DnsCachedClient : public WiFiClient {
+public:
+    using WiFiClient::connect;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeout_ms) override;
+
+    const DnsConnectTiming& connectTiming() const { return timing; }
+
+private:
+    DnsConnectTiming timing = {};
+};
+
+/**
+ * @brief WiFiClientSecure that resolves host names through DnsCache
+ *
+ * The host name is still passed to the TLS layer, so SNI and certificate
+ * name checks are unchanged. The connection opens in plain-start mode and
+ * startTLS() then runs the handshake, so the TCP connect and the handshake
+ * are timed apart.
+ */
+class DnsCachedClientSecure : public WiFiClientSecure {
+public:
+    using WiFiClientSecure::connect;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeout_ms) override;
+
+    const DnsConnectTiming& connectTiming() const { return timing; }
+
+private:
+    DnsConnectTiming timing = {};
+};
+
+#endif // DnsCache_h
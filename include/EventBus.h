@@ -0,0 +1,121 @@
+/****************************************************************************************************************************
+  EventBus.h
+  In-process publish/subscribe between modules
+
+  Modules announce what happened (WiFi up, alert shown, OTA started) without knowing who
+  reacts, and consumers subscribe themselves instead of being called from main.cpp:
+
+      EventBus::subscribe(EVENT_MASK(EVT_MQTT_CONNECTED) | EVENT_MASK(EVT_MQTT_DISCONNECTED),
+                          &StatusIndicator::handleEvent, this);
+      ...
+      EventBus::publish(EVT_MQTT_CONNECTED);
+
+  - Events are fixed-size structs; nothing is allocated on publish or dispatch
+  - publish() is lock-free (bounded multi-producer queue, one CAS per event) and safe from
+    any task or ISR; it never blocks and drops the event if the queue is full
+  - dispatch() runs on the main task from loop() and calls each matching handler in
+    subscription order; handlers may publish further events (delivered on a later dispatch).
+    Main-task code about to block for a long time (OTA download) may dispatch early; never
+    call it from a handler or another task
+  - Subscriber table is static (EVENTBUS_MAX_SUBSCRIBERS); subscribe from setup only
+
+  Lives in include/ (like SimClock.h) so libraries can publish too; the implementation is
+  src/EventBus.cpp. Queue depth, drops and post-to-handler latency are exported as
+  ledsign_event* metrics (src/Metrics.h).
+ *****************************************************************************************************************************/
+
+#ifndef EventBus_h
+#define EventBus_h
+
+#include <Arduino.h>
+
+// Event bus configuration constants (from defines.h)
+#ifndef EVENTBUS_QUEUE_SIZE
+#define EVENTBUS_QUEUE_SIZE       32        // Pending events (power of two)
+#endif
+#ifndef EVENTBUS_MAX_SUBSCRIBERS
+#define EVENTBUS_MAX_SUBSCRIBERS  16
+#endif
+#ifndef EVENTBUS_DISPATCH_BUDGET
+#define EVENTBUS_DISPATCH_BUDGET  16        // Events delivered per dispatch() call
+#endif
+
+/**
+ * @brief Event types (at most 32: subscriptions are bit masks)
+ */
+enum EventType : uint8_t {
+    EVT_WIFI_CONNECTED = 0,
+    EVT_WIFI_DISCONNECTED,
+    EVT_MQTT_CONNECTED,
+    EVT_MQTT_DISCONNECTED,
+    EVT_ALERT_RECEIVED,         ///< Alert handed to the sign; value: AlertSeverity
+    EVT_ERROR,                  ///< Something the user should notice (init failure, MQTT down too long)
+    EVT_OTA_STARTED,
+    EVT_OTA_COMPLETE,           ///< Published just before the reboot
+    EVT_OTA_FAILED,
+    EVT_TIME_SYNCED,            ///< SNTP (or a scenario ntp step) set the wall clock
+    EVT_CONFIG_CHANGED,         ///< ConfigStore committed a change set; value: CONFIG_GROUP_* mask
+    EVT_PORTAL_OPENED,          ///< WiFiManager config portal AP is up (non-blocking)
+    EVT_PORTAL_CLOSED,          ///< Config portal closed; value: 1 = WiFi connected, 0 = timed out
+    EVT_TYPE_COUNT
+};
+
+/**
+ * @brief Severity carried by EVT_ALERT_RECEIVED
+ */
+enum AlertSeverity : int32_t {
+    ALERT_SEVERITY_INFO = 0,
+    ALERT_SEVERITY_WARNING,
+    ALERT_SEVERITY_PRIORITY
+};
+
+#define EVENT_MASK(type)          (1UL << (type))
+
+/**
+ * @brief One event as queued and delivered
+ */
+struct Event {
+    EventType type;
+    int32_t value;              ///< Type-specific argument (0 if unused)
+    uint32_t posted_us;         ///< micros() at publish
+};
+
+typedef void (*EventHandler)(const Event& event, void* context);
+
+namespace EventBus {
+
+/**
+ * @brief Queue an event for the next dispatch()
+ * @return false if the queue was full and the event was dropped
+ */
+bool publish(EventType type, int32_t value = 0);
+
+/**
+ * @brief Register a handler for every type in mask
+ * @param mask EVENT_MASK(type) | ...
+ * @param handler Called on the main task from dispatch()
+ * @param context Passed back to the handler (usually the subscribing object)
+ * @return false if the subscriber table is full
+ */
+bool subscribe(uint32_t mask, EventHandler handler, void* context = nullptr);
+
+/**
+ * @brief Deliver queued events - call from the main loop
+ * @param budget Most events to deliver in this call
+ * @return Events delivered
+ */
+uint16_t dispatch(uint16_t budget = EVENTBUS_DISPATCH_BUDGET);
+
+/**
+ * @brief Events waiting for dispatch
+ */
+uint16_t depth();
+
+/**
+ * @brief Get human-readable status for logging
+ */
+String getStatus();
+
+} // namespace EventBus
+
+#endif // EventBus_h
@@ -0,0 +1,153 @@
+/****************************************************************************************************************************
+  HotPath.h
+  IRAM/DRAM placement for the latency-critical paths, and the SIGN_PROFILE cache-stall profiler
+
+  Code and constants normally run from flash through the 32 KB cache. A miss costs a flash read,
+  and every flash write or erase (OTA, LittleFS, NVS) disables the cache on both cores and
+  flushes it, so the next pass through flash-resident code starts cold. The paths that decide
+  alert-to-glass latency are placed in internal RAM instead:
+
+      size_t HOT_IRAM BETABRITE::EncodeTextFile(...)        // frame encoder
+      void HOT_IRAM PlaylistPlayer::loop()                  // UART TX pump (pre-encoded frames)
+      uint8_t HOT_IRAM Scheduler::loop()                    // deadline wheel of the main loop
+      HOT_DRAM const uint8_t GLYPH_PIXELS[95] = {...};      // per-frame lookup tables
+
+  Building with -D HOTPATH_IRAM=0 puts them back in flash (to compare, or if IRAM runs out in a
+  larger build). It is a build flag rather than a defines.h setting so lib/BETABRITE sees it.
+
+  The profile build (-D SIGN_PROFILE, env esp32dev_profile) samples the cycle counter and the
+  call-site PC at each instrumented site on the sign-writer, ingestion and indicator paths:
+
+      void SignController::displayMessage(...) {
+          HOTPATH_PROFILE(HOTPATH_SIGN_WRITE);
+          ...
+
+  Each site is classified once from its PC as flash-resident or IRAM, and keeps min/avg/max
+  cycles. Cycles above the site's fastest run are counted as stall (cache misses, flash-op
+  waits, preemption), split by whether a flash write window (FlashWrite, e.g. an OTA download)
+  was open, and attributed to the site's function. Sites are timed inclusively (a nested
+  site counts in its caller too) and only on the main loop task. Without SIGN_PROFILE the
+  macros compile to nothing.
+
+  Lives in include/ (like DnsCache.h) so the libraries can use it; the implementation is
+  src/HotPath.cpp.
+ *****************************************************************************************************************************/
+
+#ifndef HotPath_h
+#define HotPath_h
+
+#include <Arduino.h>
+
+// Hot path constants (from defines.h)
+#ifndef HOTPATH_IRAM
+#define HOTPATH_IRAM 1
+#endif
+#ifndef HOTPATH_MAX_SITES
+#define HOTPATH_MAX_SITES 16
+#endif
+
+#if HOTPATH_IRAM
+#define HOT_IRAM IRAM_ATTR
+#define HOT_DRAM DRAM_ATTR
+#else
+#define HOT_IRAM
+#define HOT_DRAM
+#endif
+
+/**
+ * @brief Paths the profiler attributes sites to
+ */
+enum HotPathId : uint8_t {
+    HOTPATH_SIGN_WRITE,                 ///< Alert or frame to sign UART
+    HOTPATH_INGEST,                     ///< MQTT payload to display request
+    HOTPATH_INDICATOR,                  ///< Status LED / buzzer
+    HOTPATH_COUNT
+};
+
+namespace HotPath {
+
+/**
+ * @brief Mark a flash write window (OTA download, bulk file write); nests
+ */
+void flashWriteBegin();
+void flashWriteEnd();
+
+/**
+ * @brief Holds a flash write window open for the life of a scope
+ */
+class FlashWrite {
+public:
+    FlashWrite() { flashWriteBegin(); }
+    ~FlashWrite() { flashWriteEnd(); }
+    FlashWrite(const FlashWrite&) = delete;
+    FlashWrite& operator=(const FlashWrite&) = delete;
+};
+
+/**
+ * @brief Whether the profiler is compiled in (SIGN_PROFILE)
+ */
+bool enabled();
+
+/**
+ * @brief Per-site and per-path profile as JSON
+ *
+ * {"cpu_mhz":N,"iram":true,"sites":[{"fn":"...","path":"ingest","pc":"0x400d1234","flash":true,
+ *   "n":N,"min":N,"avg":N,"max":N,"stall":N,"ota_n":N,"ota_stall":N}],
+ *  "paths":[{"path":"ingest","n":N,"cycles":N,"flash_stall":N,"iram_stall":N}]}
+ * (cycles; "stall" is the total above the site's fastest run, "ota_*" inside flash write windows)
+ */
+String report();
+
+/**
+ * @brief Get human-readable status for logging
+ */
+String getStatus();
+
+/**
+ * @brief One instrumented site (a function-local static, see HOTPATH_PROFILE)
+ */
+struct Site {
+    Site(HotPathId path, const char* function);
+
+    void record(uint32_t cycles, bool flash_busy);
+    void locate(uintptr_t pc);
+
+    HotPathId path;
+    const char* function;
+    uintptr_t pc;                       ///< Call-site PC (0 = not located yet)
+    bool in_flash;                      ///< PC is in flash-mapped IROM
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t busy_calls;                ///< Calls inside a flash write window
+    uint64_t busy_cycles;
+};
+
+/**
+ * @brief Times a site from construction to destruction
+ */
+class Scope {
+public:
+    explicit Scope(Site& site);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Site& site;
+    uint32_t start;
+    bool busy;
+};
+
+} // namespace HotPath
+
+#ifdef SIGN_PROFILE
+#define HOTPATH_PROFILE(path) \
+    static HotPath::Site hotpath_site_(path, __func__); \
+    HotPath::Scope hotpath_scope_(hotpath_site_)
+#else
+#define HOTPATH_PROFILE(path)
+#endif
+
+#endif // HotPath_h
@@ -0,0 +1,149 @@
+/****************************************************************************************************************************
+  MemoryPolicy.h
+  Where large buffers live: PSRAM for bulk data, internal RAM for everything that must be fast
+
+  WROVER-class boards have 4-8 MB of PSRAM next to ~300 KB of internal RAM, yet every large
+  buffer (JSON documents, the PubSubClient packet buffers, the OTA release document,
+  certificate copies) used to come out of the internal heap. Buffers now say what they are
+  and this layer places them:
+
+      BulkJsonDocument doc(8192);                       // PSRAM when the board has it
+      char* pem = MemoryPolicy::duplicate(text, MEM_BULK);
+      {
+          MemoryPolicy::BulkScope bulk;                 // mallocs inside a library call
+          mqtt_client = new PubSubClient(client);       // (its packet buffer) go to PSRAM
+      }
+
+  - MEM_INTERNAL: DMA, ISR-touched or hot-path data; always internal RAM
+  - MEM_BULK: large and not latency-critical; PSRAM if present, internal otherwise (or when
+    PSRAM is full), and internal for anything under MEMPOLICY_PSRAM_MIN_BYTES
+  - MEM_ALERT: the alert-path JSON document; internal unless MEMPOLICY_ALERT_DOC_PSRAM, so
+    alert latency can be compared with it in either place (ledsign_alert_doc_psram tells the
+    ledsign_alert_handle_microseconds histograms of the two builds apart; the bench build
+    times both placements in BM_JsonIngest_*)
+
+  Without PSRAM every class is an ordinary internal allocation, so callers never need to
+  check. Internal heap headroom (free, low-water mark, largest block) and PSRAM use are
+  exported as ledsign_heap_internal_* / ledsign_psram_* metrics.
+
+  Lives in include/ (like DnsCache.h) so lib/GitHubOTA can use it; the implementation is
+  src/MemoryPolicy.cpp.
+ *****************************************************************************************************************************/
+
+#ifndef MemoryPolicy_h
+#define MemoryPolicy_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Memory policy constants (from defines.h)
+#ifndef MEMPOLICY_PSRAM_MIN_BYTES
+#define MEMPOLICY_PSRAM_MIN_BYTES 256
+#endif
+#ifndef MEMPOLICY_ALERT_DOC_PSRAM
+#define MEMPOLICY_ALERT_DOC_PSRAM false
+#endif
+#ifndef MEMPOLICY_MALLOC_INTERNAL_LIMIT
+#ifdef CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL
+#define MEMPOLICY_MALLOC_INTERNAL_LIMIT CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL
+#else
+#define MEMPOLICY_MALLOC_INTERNAL_LIMIT 4096
+#endif
+#endif
+
+/**
+ * @brief What a buffer is used for, which decides where it goes
+ */
+enum MemoryClass : uint8_t {
+    MEM_INTERNAL,                       ///< DMA, ISR or hot path: internal RAM
+    MEM_BULK,                           ///< Large, not latency-critical: PSRAM when present
+    MEM_ALERT                           ///< Alert-path documents: MEMPOLICY_ALERT_DOC_PSRAM
+};
+
+namespace MemoryPolicy {
+
+/**
+ * @brief Detect PSRAM and report the split (call once, early in setup())
+ * @return true if PSRAM is available for MEM_BULK
+ */
+bool begin();
+
+/**
+ * @brief Whether bulk buffers go to PSRAM
+ */
+bool hasPsram();
+
+/**
+ * @brief Allocate for a memory class (falls back to internal RAM if PSRAM is full)
+ * @return nullptr if neither heap has room
+ */
+void* allocate(size_t size, MemoryClass type);
+
+/**
+ * @brief Resize a block from allocate(), keeping it in its class's heap
+ */
+void* reallocate(void* ptr, size_t size, MemoryClass type);
+
+/**
+ * @brief Free a block from allocate()/reallocate()/duplicate() (nullptr is ignored)
+ */
+void release(void* ptr);
+
+/**
+ * @brief NUL-terminated copy of a string in a memory class
+ * @return nullptr if out of memory
+ */
+char* duplicate(const String& text, MemoryClass type);
+
+/**
+ * @brief Refresh the internal heap / PSRAM gauges
+ */
+void updateMetrics();
+
+/**
+ * @brief Get human-readable status for logging
+ */
+String getStatus();
+
+/**
+ * @brief Sends plain malloc() calls of MEMPOLICY_PSRAM_MIN_BYTES or more to PSRAM for its lifetime
+ *
+ * For buffers allocated inside libraries (PubSubClient's packet buffer). Keep the scope
+ * short: allocations by other tasks while it is open are moved too. Has no effect without
+ * PSRAM, or if the SDK does not let malloc() use PSRAM.
+ */
+class BulkScope {
+public:
+    BulkScope();
+    ~BulkScope();
+    BulkScope(const BulkScope&) = delete;
+    BulkScope& operator=(const BulkScope&) = delete;
+
+private:
+    bool active;
+};
+
+} // namespace MemoryPolicy
+
+/**
+ * @brief ArduinoJson allocator for bulk documents
+ */
+struct BulkJsonAllocator {
+    void* allocate(size_t size) { return MemoryPolicy::allocate(size, MEM_BULK); }
+    void deallocate(void* ptr) { MemoryPolicy::release(ptr); }
+    void* reallocate(void* ptr, size_t size) { return MemoryPolicy::reallocate(ptr, size, MEM_BULK); }
+};
+
+/**
+ * @brief ArduinoJson allocator for the alert-path document
+ */
+struct AlertJsonAllocator {
+    void* allocate(size_t size) { return MemoryPolicy::allocate(size, MEM_ALERT); }
+    void deallocate(void* ptr) { MemoryPolicy::release(ptr); }
+    void* reallocate(void* ptr, size_t size) { return MemoryPolicy::reallocate(ptr, size, MEM_ALERT); }
+};
+
+typedef BasicJsonDocument<BulkJsonAllocator> BulkJsonDocument;
+typedef BasicJsonDocument<AlertJsonAllocator> AlertJsonDocument;
+
+#endif // MemoryPolicy_h
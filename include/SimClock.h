@@ -0,0 +1,51 @@
+/****************************************************************************************************************************
+  SimClock.h
+  Clock seam for the virtual-clock simulation build
+
+  Timing logic (priority stages, offline sequence, MQTT backoff, OTA checks, health checks,
+  clock display) reads time through SimClock instead of millis()/delay()/time() directly.
+
+  Normal builds: every call is an inline pass-through to the Arduino/libc function and
+  SIM_EVENT() compiles away, so there is no runtime cost.
+
+  SIM_CLOCK builds (pio run -e esp32dev_sim): time is virtual. delay() returns at once,
+  modules report their next deadline with wakeAt(), and the main loop jumps the clock to the
+  earliest one (see src/Simulation.h). SIM_EVENT() lines carry the virtual timestamp, so a
+  scenario produces the same event log on every run.
+ *****************************************************************************************************************************/
+
+#ifndef SimClock_h
+#define SimClock_h
+
+#include <Arduino.h>
+#include <time.h>
+
+namespace SimClock {
+
+#ifdef SIM_CLOCK
+
+uint32_t millis();                                  // Virtual milliseconds since boot
+void delay(uint32_t ms);                            // Advances virtual time, returns immediately
+time_t now();                                       // Virtual wall clock (0 until set)
+void wakeAt(uint32_t deadline_ms);                  // Earliest deadline wins for the next advance()
+void event(const char* source, const String& detail);
+
+void setEpoch(time_t epoch);                        // Wall clock at the current virtual instant
+uint32_t advance();                                 // Jump to the next deadline, returns step (ms)
+
+#define SIM_EVENT(source, detail)   SimClock::event(source, detail)
+
+#else
+
+inline uint32_t millis() { return ::millis(); }
+inline void delay(uint32_t ms) { ::delay(ms); }
+inline time_t now() { return ::time(nullptr); }
+inline void wakeAt(uint32_t) {}
+
+#define SIM_EVENT(source, detail)   do {} while (0)
+
+#endif
+
+} // namespace SimClock
+
+#endif // SimClock_h
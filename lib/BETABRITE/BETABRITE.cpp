@@ -15,6 +15,8 @@
 #include <time.h>
 #endif
 #include "BETABRITE.h"
+#include <driver/uart.h>
+#include <HotPath.h>  // HOT_IRAM: encoder and write path in IRAM (HOTPATH_IRAM)
 #define BB_BETWEEN_COMMAND_DELAY 110
 
 //BETABRITE::BETABRITE ( uint8_t receivePin, uint8_t transmitPin, const char Type, const char Address[2] ) : SoftwareSerial ( receivePin, transmitPin ) {
@@ -23,6 +25,14 @@ BETABRITE::BETABRITE ( uint8_t uart_num, uint8_t receivePin, uint8_t transmitPin
   //begin ( 9600 );
   this->begin(9600, SERIAL_7E1, receivePin, transmitPin);  // Set baud rate and pins
   this->_type = Type;
+  this->_uartNum = uart_num;
+  this->_bytesWritten = 0;
+  this->_commandDelay = BB_BETWEEN_COMMAND_DELAY;
+  this->_discard = false;
+  this->_tap = NULL;
+  this->_tapContext = NULL;
+  this->_owner = NULL;
+  this->_bytesRefused = 0;
   if ( Address )
   {
     this->_address[0] = Address[0];
@@ -142,7 +152,104 @@ void BETABRITE::EndNestedCommand ( void )
 
 void BETABRITE::DelayBetweenCommands ( void )
 {
-  delay ( BB_BETWEEN_COMMAND_DELAY );
+  if ( !_discard && !Refused ( ) )
+    delay ( _commandDelay );
+}
+
+size_t HOT_IRAM BETABRITE::EncodeTextFile ( char *Buffer, size_t BufferSize, const char Name, const char *Contents, const char initColor, const char Position, const char Mode, const char Special )
+{
+  size_t contentsLen = strlen ( Contents );
+  // sync(5) + SOH,type,addr(4) + STX(1) + cmd,name(2) + ESC,pos,mode,special(4) + color(2) + contents + EOT(1)
+  if ( BufferSize < 19 + contentsLen ) return 0;
+
+  size_t len = 0;
+  for ( char i = 0; i < 5; i++ ) Buffer[len++] = BB_NUL;
+  Buffer[len++] = BB_SOH; Buffer[len++] = _type; Buffer[len++] = _address[0]; Buffer[len++] = _address[1];
+  Buffer[len++] = BB_STX;
+  Buffer[len++] = BB_CC_WTEXT;
+  Buffer[len++] = Name;
+  Buffer[len++] = BB_ESC; Buffer[len++] = Position; Buffer[len++] = Mode;
+  if ( BB_DM_SPECIAL == Mode ) Buffer[len++] = Special;
+  if ( initColor != BB_COL_AUTOCOLOR )
+  {
+    Buffer[len++] = BB_FC_SELECTCHARCOLOR;
+    Buffer[len++] = initColor;
+  }
+  memcpy ( Buffer + len, Contents, contentsLen );
+  len += contentsLen;
+  Buffer[len++] = BB_EOT;
+  return len;
+}
+
+size_t HOT_IRAM BETABRITE::EncodeCancelPriorityTextFile ( char *Buffer, size_t BufferSize )
+{
+  if ( BufferSize < 13 ) return 0;
+
+  size_t len = 0;
+  for ( char i = 0; i < 5; i++ ) Buffer[len++] = BB_NUL;
+  Buffer[len++] = BB_SOH; Buffer[len++] = _type; Buffer[len++] = _address[0]; Buffer[len++] = _address[1];
+  Buffer[len++] = BB_STX;
+  Buffer[len++] = BB_CC_WTEXT;
+  Buffer[len++] = BB_PRIORITY_FILE_LABEL;
+  Buffer[len++] = BB_EOT;
+  return len;
+}
+
+void HOT_IRAM BETABRITE::WriteRaw ( const char *Buffer, size_t Length )
+{
+  write ( (const uint8_t *)Buffer, Length );
+}
+
+size_t HOT_IRAM BETABRITE::write ( uint8_t c )
+{
+  if ( Refused ( ) )
+  {
+    _bytesRefused++;
+    return 0;
+  }
+  _bytesWritten++;
+  if ( _tap )
+    _tap ( &c, 1, _tapContext );
+  if ( _discard )
+    return 1;
+  return HardwareSerial::write ( c );
+}
+
+size_t HOT_IRAM BETABRITE::write ( const uint8_t *Buffer, size_t Size )
+{
+  if ( Refused ( ) )
+  {
+    _bytesRefused += Size;
+    return 0;
+  }
+  _bytesWritten += Size;
+  if ( _tap )
+    _tap ( Buffer, Size, _tapContext );
+  if ( _discard )
+    return Size;
+  return HardwareSerial::write ( Buffer, Size );
+}
+
+bool BETABRITE::Claim ( TaskHandle_t Owner )
+{
+  if ( _owner != NULL && _owner != Owner )
+    return false;
+  _owner = Owner;
+  return true;
+}
+
+void BETABRITE::Release ( TaskHandle_t Owner )
+{
+  if ( _owner == Owner )
+    _owner = NULL;
+}
+
+bool BETABRITE::TxIdle ( void )
+{
+  if ( _discard )
+    return true;
+  // Zero timeout: reports the transmitter state without waiting for it
+  return uart_wait_tx_done ( (uart_port_t)_uartNum, 0 ) == ESP_OK;
 }
 
 #ifdef DATEFUNCTIONS
@@ -276,6 +383,9 @@ int BETABRITE::ReadResponse ( char *buffer, size_t bufferSize, unsigned long tim
 {
   unsigned long startTime = millis();
 
+  // Another task owns the sign: the request was never sent
+  if ( Refused ( ) ) return -1;
+
   // Wait for first byte (SOH) with timeout
   while ( !this->available() )
   {
@@ -18,6 +18,8 @@
 #include "BBDEFS.h"
 // #include <SoftwareSerial.h>
 #include <HardwareSerial.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 
 // following is based on Arduino forum user etracer's suggestion at
@@ -48,6 +50,46 @@ class BETABRITE : public HardwareSerial  {
     void EndNestedCommand ( void );
     void DelayBetweenCommands ( void );
 
+    // Pre-encoding - build a complete frame in memory for later transmission
+    // Returns frame length in bytes, or 0 if the buffer is too small
+    size_t EncodeTextFile ( char *Buffer, size_t BufferSize, const char Name, const char *Contents, const char initColor = BB_COL_AUTOCOLOR, const char Position = BB_DP_TOPLINE, const char Mode = BB_DM_COMPROTATE, const char Special = BB_SDM_TWINKLE );
+    size_t EncodeCancelPriorityTextFile ( char *Buffer, size_t BufferSize );
+    void WriteRaw ( const char *Buffer, size_t Length );
+
+    // Byte accounting - every byte sent to the sign passes through these
+    size_t write ( uint8_t c ) override;
+    size_t write ( const uint8_t *Buffer, size_t Size ) override;
+    using HardwareSerial::write;
+    unsigned long GetBytesWritten ( void ) const { return _bytesWritten; }
+
+    // Non-blocking flush() - true once the last byte written has left the UART
+    bool TxIdle ( void );
+
+    // Discard mode - frames are built and counted but never reach the UART, and
+    // commands skip the inter-command delay (encoding benchmarks)
+    void SetDiscardOutput ( bool Discard ) { _discard = Discard; }
+
+    // Sign type code sent in every command header - a sign answers only its own
+    // type or a wildcard (BB_ST_ALL, BB_ST_1LINE, ...), which is how models are probed
+    void SetType ( const char Type ) { _type = Type; }
+    char GetType ( void ) const { return _type; }
+
+    // Pause after each command for the sign to process it (ms, model dependent)
+    void SetCommandDelay ( unsigned int DelayMs ) { _commandDelay = DelayMs; }
+    unsigned int GetCommandDelay ( void ) const { return _commandDelay; }
+
+    // Exclusive owner - while a task holds the sign, bytes written from any other task
+    // are refused (not sent, tapped or counted), their command delays are skipped and
+    // reads fail at once, so nothing can interleave with the owner's frames
+    bool Claim ( TaskHandle_t Owner );
+    void Release ( TaskHandle_t Owner );
+    bool IsClaimed ( void ) const { return _owner != NULL; }
+    unsigned long GetBytesRefused ( void ) const { return _bytesRefused; }
+
+    // Output tap - sees every byte sent to the sign, in order (traffic capture)
+    typedef void ( *TapCallback ) ( const uint8_t *Buffer, size_t Size, void *Context );
+    void SetTap ( TapCallback Tap, void *Context ) { _tapContext = Context; _tap = Tap; }
+
     // Read commands - query the sign for stored data
     // Returns number of payload bytes read into buffer, or -1 on timeout
     int ReadTextFile ( const char Name, char *buffer, size_t bufferSize, unsigned long timeoutMs = 2000 );
@@ -64,6 +106,15 @@ class BETABRITE : public HardwareSerial  {
     int ReadResponse ( char *buffer, size_t bufferSize, unsigned long timeoutMs );
     char	_type;
     char	_address[2];
+    uint8_t	_uartNum;
+    unsigned long _bytesWritten;
+    unsigned int	_commandDelay;
+    bool	_discard;
+    TapCallback	_tap;
+    void	*_tapContext;
+    volatile TaskHandle_t	_owner;
+    unsigned long _bytesRefused;
+    bool Refused ( void ) const { return _owner != NULL && _owner != xTaskGetCurrentTaskHandle ( ); }
     void Sync ( void );
 };
 
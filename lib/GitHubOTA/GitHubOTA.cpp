@@ -5,6 +5,11 @@
  */
 
 #include "GitHubOTA.h"
+#include <SimClock.h>
+#include <EventBus.h>
+#include <DnsCache.h>
+#include <MemoryPolicy.h>
+#include <HotPath.h>
 #include <mbedtls/md.h>
 
 // Constructor
@@ -34,6 +39,9 @@ bool GitHubOTA::begin(const char* currentVersion) {
         _currentVersion = _currentVersion.substring(1);
     }
 
+    // Resolve the API host in the background so the first check doesn't wait on DNS
+    DnsCache::prefetch(GITHUB_API_HOST);
+
     Serial.printf("GitHubOTA: Initialized for %s/%s, current version: %s\n",
                   _repoOwner, _repoName, _currentVersion.c_str());
 
@@ -71,7 +79,7 @@ void GitHubOTA::loop() {
         return;
     }
 
-    unsigned long now = millis();
+    unsigned long now = SimClock::millis();
 
     // Handle rollover
     if (now < _lastCheckTime) {
@@ -82,6 +90,13 @@ void GitHubOTA::loop() {
     if (now - _lastCheckTime >= _checkInterval) {
         Serial.println("GitHubOTA: Periodic update check triggered");
 
+#ifdef SIM_CLOCK
+        // Virtual-clock build: record the check, never fetch or flash
+        SIM_EVENT("ota", "periodic check");
+        _lastCheckTime = now;
+        return;
+#endif
+
         if (checkForUpdate()) {
             if (_updateAvailable) {
                 Serial.printf("GitHubOTA: Update available: %s -> %s\n",
@@ -92,6 +107,8 @@ void GitHubOTA::loop() {
 
         _lastCheckTime = now;
     }
+
+    SimClock::wakeAt(_lastCheckTime + _checkInterval);
 }
 
 // Check for updates (manual trigger)
@@ -111,7 +128,7 @@ bool GitHubOTA::checkForUpdate() {
 
 // Fetch latest release from GitHub API
 bool GitHubOTA::fetchLatestRelease() {
-    WiFiClientSecure client;
+    DnsCachedClientSecure client;
     HTTPClient https;
 
     // Use Arduino's built-in CA bundle
@@ -154,7 +171,7 @@ bool GitHubOTA::fetchLatestRelease() {
     String payload = https.getString();
     https.end();
 
-    DynamicJsonDocument doc(8192);  // Large buffer for release info
+    BulkJsonDocument doc(8192);  // Large buffer for release info
     DeserializationError error = deserializeJson(doc, payload);
 
     if (error) {
@@ -201,6 +218,14 @@ bool GitHubOTA::fetchLatestRelease() {
             foundFirmware = true;
             Serial.printf("GitHubOTA: Found firmware.bin (%s)\n",
                           formatBytes(_firmwareSize).c_str());
+
+            // Asset host is resolved ahead of the download
+            int hostStart = _firmwareUrl.indexOf("://");
+            if (hostStart > 0) {
+                hostStart += 3;
+                int hostEnd = _firmwareUrl.indexOf('/', hostStart);
+                DnsCache::prefetch(_firmwareUrl.substring(hostStart, hostEnd < 0 ? _firmwareUrl.length() : hostEnd).c_str());
+            }
         } else if (name == "firmware.sha256") {
             // Store checksum URL for later
             String checksumUrl = asset["browser_download_url"].as<String>();
@@ -230,7 +255,7 @@ bool GitHubOTA::fetchLatestRelease() {
 
 // Download checksum file
 String GitHubOTA::downloadChecksum(const String& checksumUrl) {
-    WiFiClientSecure client;
+    DnsCachedClientSecure client;
     HTTPClient https;
 
     client.setInsecure();
@@ -273,11 +298,17 @@ bool GitHubOTA::performUpdate() {
 
     Serial.printf("GitHubOTA: Starting update to version %s\n", _latestVersion.c_str());
     displayMessage("UPDATING FIRMWARE " + _latestVersion);
+
+    // The download blocks the main loop: deliver now so the status LED shows it
+    EventBus::publish(EVT_OTA_STARTED);
+    EventBus::dispatch();
     delay(2000);
 
     bool success = downloadAndFlash(_firmwareUrl);
 
     if (success) {
+        EventBus::publish(EVT_OTA_COMPLETE);
+        EventBus::dispatch();
         displayMessage("UPDATE COMPLETE - REBOOTING");
         delay(3000);
         Serial.println("GitHubOTA: Update successful, rebooting...");
@@ -285,6 +316,7 @@ bool GitHubOTA::performUpdate() {
         return true;  // Won't reach here
     } else {
         setStatus("Update failed");
+        EventBus::publish(EVT_OTA_FAILED);
         displayMessage("UPDATE FAILED");
         delay(5000);
         return false;
@@ -293,7 +325,7 @@ bool GitHubOTA::performUpdate() {
 
 // Download and flash firmware
 bool GitHubOTA::downloadAndFlash(const String& url) {
-    WiFiClientSecure client;
+    DnsCachedClientSecure client;
     HTTPClient https;
 
     client.setInsecure();
@@ -355,6 +387,8 @@ bool GitHubOTA::downloadAndFlash(const String& url) {
 
     displayMessage("INSTALLING");
 
+    // Flash writes flush the cache: sign writes from here on are profiled as "ota"
+    HotPath::FlashWrite flash_write;
     while (https.connected() && written < contentLength) {
         size_t available = stream->available();
 
@@ -111,6 +111,24 @@ public:
      */
     void setAutoUpdate(bool enabled);
 
+    /**
+     * Compare two semantic version strings
+     * @param v1 First version (e.g., "0.2.0")
+     * @param v2 Second version (e.g., "0.1.9")
+     * @return -1 if v1 < v2, 0 if equal, 1 if v1 > v2
+     */
+    static int compareVersions(const String& v1, const String& v2);
+
+    /**
+     * Parse version string into major.minor.patch
+     * @param version Version string
+     * @param major Output: major version
+     * @param minor Output: minor version
+     * @param patch Output: patch version
+     * @return true if parsing successful
+     */
+    static bool parseVersion(const String& version, int& major, int& minor, int& patch);
+
 private:
     // Configuration
     const char* _repoOwner;
@@ -152,24 +170,6 @@ private:
      */
     String downloadChecksum(const String& checksumUrl);
 
-    /**
-     * Compare two semantic version strings
-     * @param v1 First version (e.g., "0.2.0")
-     * @param v2 Second version (e.g., "0.1.9")
-     * @return -1 if v1 < v2, 0 if equal, 1 if v1 > v2
-     */
-    int compareVersions(const String& v1, const String& v2);
-
-    /**
-     * Parse version string into major.minor.patch
-     * @param version Version string
-     * @param major Output: major version
-     * @param minor Output: minor version
-     * @param patch Output: patch version
-     * @return true if parsing successful
-     */
-    bool parseVersion(const String& version, int& major, int& minor, int& patch);
-
     /**
      * Display message on LED sign
      * @param message Message to display
@@ -0,0 +1,999 @@
+/**
+ * @file AlertDecoder.cpp
+ * @brief Single-pass alert decoder and its ArduinoJson counterpart
+ *
+ * The parser is a small recursive descent over the alert and display_config
+ * objects only; any other value is skipped iteratively with a bit stack of
+ * open containers, so stack use is fixed whatever the payload nests. The
+ * grammar edges (escapes, surrogate pairs, number forms, error kinds)
+ * follow ArduinoJson 6's JsonDeserializer so both paths agree on what is an
+ * alert.
+ */
+
+#include "defines.h"
+#include "AlertDecoder.h"
+#include "AlertSchema.h"
+#include "Metrics.h"
+#include <MemoryPolicy.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+
+#ifndef ALERTDEC_DOCUMENT_SIZE
+#ifdef MQTT_MAX_PACKET_SIZE
+#define ALERTDEC_DOCUMENT_SIZE    MQTT_MAX_PACKET_SIZE
+#else
+#define ALERTDEC_DOCUMENT_SIZE    2048
+#endif
+#endif
+
+static_assert(ALERTDEC_NESTING_LIMIT <= 32, "skipValue() tracks open containers in a 32-bit stack");
+
+namespace {
+
+MetricCounter metric_schema_decodes("ledsign_alert_schema_decodes_total", "Alerts decoded in one pass without a JSON document");
+MetricCounter metric_fallbacks("ledsign_alert_decode_fallbacks_total", "Alerts the schema decoder handed to ArduinoJson");
+MetricCounter metric_invalid_codes("ledsign_alert_invalid_codes_total", "display_config codes the sign does not know, replaced by the default");
+
+const char DEFAULT_TITLE[] = "Alert";
+const size_t DEFAULT_TITLE_LEN = sizeof(DEFAULT_TITLE) - 1;
+const size_t SEPARATOR_LEN = 2;             // ": "
+const size_t MAX_NUMBER_LEN = 63;           // ArduinoJson's number buffer
+
+// invalid_mask bits, one per display_config code
+enum CodeBit : uint8_t {
+    CODE_MODE = 1 << 0,
+    CODE_COLOR = 1 << 1,
+    CODE_CHARSET = 1 << 2,
+    CODE_POSITION = 1 << 3,
+    CODE_SPEED = 1 << 4,
+    CODE_EFFECT = 1 << 5
+};
+
+inline bool inCodeSet(const uint32_t set[4], char c) {
+    uint8_t u = (uint8_t)c;
+    return u < 128 && ((set[u >> 5] >> (u & 31)) & 1);
+}
+
+void setDefaults(AlertFields& fields) {
+    fields.text = "";
+    fields.text_length = 0;
+    fields.title_length = 0;
+    fields.has_title = false;
+    fields.id = "";
+    fields.zone = "";
+    fields.level = "info";
+    fields.category = "application";
+    fields.timestamp = 0;
+    fields.expires = 0;
+    fields.echo = false;
+    fields.invalid_codes = 0;
+}
+
+void setDisplayDefaults(AlertFields& fields) {
+    fields.mode = 'a';          // Rotate
+    fields.color = '2';         // Green
+    fields.charset = '3';       // 7high
+    fields.position = ' ';      // Midline
+    fields.speed[0] = '\027';   // Medium (3)
+    fields.speed[1] = '\0';
+    fields.special = 0;         // No effect
+    fields.priority = false;
+    fields.duration = 15;
+}
+
+/**
+ * @brief Apply one display_config code
+ * @param first Code from codeValue(), 0 for an empty string
+ * @param valid false if the value was not a string
+ * @return false if the code was replaced by its default
+ */
+bool applyCode(AlertFields& fields, AlertKey key, char first, bool valid) {
+    switch (key) {
+        case ALERTKEY_MODE_CODE:
+            valid = valid && inCodeSet(ALERT_CODES_MODE, first);
+            fields.mode = valid ? first : 'a';
+            break;
+        case ALERTKEY_COLOR_CODE:
+            valid = valid && inCodeSet(ALERT_CODES_COLOR, first);
+            fields.color = valid ? first : '2';
+            break;
+        case ALERTKEY_CHARSET_CODE:
+            valid = valid && inCodeSet(ALERT_CODES_CHARSET, first);
+            fields.charset = valid ? first : '3';
+            break;
+        case ALERTKEY_POSITION_CODE:
+            valid = valid && inCodeSet(ALERT_CODES_POSITION, first);
+            fields.position = valid ? first : ' ';
+            break;
+        case ALERTKEY_SPEED_CODE:
+            valid = valid && inCodeSet(ALERT_CODES_SPEED, first);
+            fields.speed[0] = valid ? first : '\027';
+            break;
+        case ALERTKEY_EFFECT_CODE:
+            // "" is a valid effect: none
+            valid = valid && (first == 0 || inCodeSet(ALERT_CODES_EFFECT, first));
+            fields.special = valid ? first : 0;
+            break;
+        default:
+            break;
+    }
+    return valid;
+}
+
+/**
+ * @brief The code a display_config string stands for
+ *
+ * Either its first character, or the octal escape the Alert Manager spec
+ * writes out as text ("\\031" in JSON, a backslash and three digits).
+ */
+char codeValue(const char* text, size_t length) {
+    if (length >= 4 && text[0] == '\\' && text[1] >= '0' && text[1] <= '3' && text[2] >= '0' && text[2] <= '7' &&
+        text[3] >= '0' && text[3] <= '7') {
+        return (char)(((text[1] - '0') << 6) | ((text[2] - '0') << 3) | (text[3] - '0'));
+    }
+    return length ? text[0] : 0;
+}
+
+uint8_t codeBit(AlertKey key) {
+    switch (key) {
+        case ALERTKEY_MODE_CODE: return CODE_MODE;
+        case ALERTKEY_COLOR_CODE: return CODE_COLOR;
+        case ALERTKEY_CHARSET_CODE: return CODE_CHARSET;
+        case ALERTKEY_POSITION_CODE: return CODE_POSITION;
+        case ALERTKEY_SPEED_CODE: return CODE_SPEED;
+        case ALERTKEY_EFFECT_CODE: return CODE_EFFECT;
+        default: return 0;
+    }
+}
+
+AlertKey lookupKey(const char* key, size_t length, uint8_t scope) {
+    if (length == 0 || length > ALERT_KEY_MAX_LEN) {
+        return ALERTKEY_NONE;
+    }
+    const AlertKeySlot& slot = ALERT_KEY_TABLE[ALERT_KEY_SLOT(key[0], key[length - 1], length)];
+    if (!slot.name || slot.length != length || slot.scope != scope || memcmp(slot.name, key, length) != 0) {
+        return ALERTKEY_NONE;
+    }
+    return slot.key;
+}
+
+/**
+ * @brief The caller's buffer: display text from the front, other strings from the back
+ *
+ * Title and message are unescaped in arrival order and joined into
+ * "Title: Message" by finish(), which moves at most one of them.
+ */
+class AlertText {
+public:
+    AlertText(char* buffer, size_t size)
+        : buf(buffer), front(0), back(size), title_start(0), title_length(0), message_length(0),
+          title_set(false), message_set(false), title_first(false), truncated(false), overflow(false) {}
+
+    // Display text (title or message)
+    void beginText(bool title) {
+        truncated = false;
+        if (title) {
+            title_set = true;
+            title_first = !message_set;
+            title_start = front;
+        } else {
+            message_set = true;
+            if (title_set) {
+                putRaw(':');
+                putRaw(' ');
+            }
+        }
+        text_title = title;
+        text_start = front;
+    }
+
+    inline bool putText(char c) {
+        if (c == '\0') {
+            truncated = true;   // A C string ends here (String(title) did too)
+        }
+        if (truncated) {
+            return true;
+        }
+        return putRaw(c);
+    }
+
+    void endText() {
+        (text_title ? title_length : message_length) = front - text_start;
+    }
+
+    // Strings other than the display text, NUL-terminated at the back
+    void beginString() {
+        if (back <= front) {
+            overflow = true;
+            return;
+        }
+        buf[--back] = '\0';
+        string_end = back;
+    }
+
+    inline bool putString(char c) {
+        if (back <= front) {
+            overflow = true;
+            return false;
+        }
+        buf[--back] = c;
+        return true;
+    }
+
+    const char* endString() {
+        if (overflow) {
+            return "";
+        }
+        std::reverse(buf + back, buf + string_end);   // Written back to front
+        return buf + back;
+    }
+
+    bool failed() const { return overflow; }
+
+    /**
+     * @brief Join title and message into the display text
+     * @return false if the buffer was too small
+     */
+    bool finish(AlertFields& fields) {
+        if (overflow) {
+            return false;
+        }
+        if (title_set && message_set) {
+            if (!title_first) {
+                // [message][title] -> [title]": "[message]
+                if (!reserve(SEPARATOR_LEN)) {
+                    return false;
+                }
+                std::rotate(buf, buf + title_start, buf + front);
+                memmove(buf + title_length + SEPARATOR_LEN, buf + title_length, message_length);
+                buf[title_length] = ':';
+                buf[title_length + 1] = ' ';
+                front += SEPARATOR_LEN;
+            }
+        } else if (title_set) {
+            if (!reserve(SEPARATOR_LEN)) {
+                return false;
+            }
+            putRaw(':');
+            putRaw(' ');
+        } else {
+            // "Alert: " in front of the message (if any)
+            if (!reserve(DEFAULT_TITLE_LEN + SEPARATOR_LEN)) {
+                return false;
+            }
+            memmove(buf + DEFAULT_TITLE_LEN + SEPARATOR_LEN, buf, message_set ? message_length : 0);
+            memcpy(buf, DEFAULT_TITLE, DEFAULT_TITLE_LEN);
+            buf[DEFAULT_TITLE_LEN] = ':';
+            buf[DEFAULT_TITLE_LEN + 1] = ' ';
+            front += DEFAULT_TITLE_LEN + SEPARATOR_LEN;
+            title_length = DEFAULT_TITLE_LEN;
+        }
+        if (front >= back) {
+            return false;
+        }
+        buf[front] = '\0';
+
+        fields.text = buf;
+        fields.text_length = front;
+        fields.title_length = title_length;
+        fields.has_title = title_set;
+        return true;
+    }
+
+private:
+    inline bool putRaw(char c) {
+        if (front >= back) {
+            overflow = true;
+            return false;
+        }
+        buf[front++] = c;
+        return true;
+    }
+
+    bool reserve(size_t bytes) {
+        return front + bytes < back;    // Plus the terminating NUL
+    }
+
+    char* buf;
+    size_t front;
+    size_t back;
+    size_t title_start;
+    size_t title_length;
+    size_t message_length;
+    size_t text_start = 0;
+    size_t string_end = 0;
+    bool title_set;
+    bool message_set;
+    bool title_first;
+    bool text_title = false;
+    bool truncated;
+    bool overflow;
+};
+
+/**
+ * @brief One pass over the payload, filling AlertFields as keys are recognised
+ */
+class Parser {
+public:
+    Parser(const uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size)
+        : p((const char*)payload), end((const char*)payload + length), out(buffer, size), fields(fields),
+          depth(0), invalid_mask(0), title_string(false), message_string(false), found_something(false),
+          error(ALERTDEC_OK) {
+        // ArduinoJson stops at a NUL byte as at the end of the input
+        const char* nul = (const char*)memchr(p, '\0', length);
+        if (nul) {
+            end = nul;
+        }
+    }
+
+    AlertDecodeResult run() {
+        setDefaults(fields);
+        setDisplayDefaults(fields);
+        fields.has_display_config = false;
+
+        if (!skipSpace()) {
+            return error;
+        }
+        // A root that is not an object is valid JSON with no alert fields
+        bool ok = *p == '{' ? parseObject(ALERT_KEY_SCOPE_ALERT) : skipValue();
+        if (!ok) {
+            return error;
+        }
+        if (!out.finish(fields)) {
+            return ALERTDEC_NO_MEMORY;
+        }
+        fields.invalid_codes = fields.has_display_config ? __builtin_popcount(invalid_mask) : 0;
+        return ALERTDEC_OK;
+    }
+
+private:
+    bool fail(AlertDecodeResult result) {
+        if (error == ALERTDEC_OK) {
+            error = result;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Skip whitespace; false (Incomplete/EmptyInput) at the end of the input
+     */
+    bool skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            p++;
+        }
+        if (p >= end) {
+            return fail(found_something ? ALERTDEC_INCOMPLETE_INPUT : ALERTDEC_EMPTY_INPUT);
+        }
+        found_something = true;
+        return true;
+    }
+
+    static bool isQuote(char c) {
+        return c == '"' || c == '\'';
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    template <typename Sink>
+    static bool putCodepoint(Sink& sink, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            return sink.put((char)codepoint);
+        }
+        if (codepoint < 0x800) {
+            return sink.put((char)(0xC0 | (codepoint >> 6))) && sink.put((char)(0x80 | (codepoint & 0x3F)));
+        }
+        if (codepoint < 0x10000) {
+            return sink.put((char)(0xE0 | (codepoint >> 12))) && sink.put((char)(0x80 | ((codepoint >> 6) & 0x3F))) &&
+                   sink.put((char)(0x80 | (codepoint & 0x3F)));
+        }
+        return sink.put((char)(0xF0 | (codepoint >> 18))) && sink.put((char)(0x80 | ((codepoint >> 12) & 0x3F))) &&
+               sink.put((char)(0x80 | ((codepoint >> 6) & 0x3F))) && sink.put((char)(0x80 | (codepoint & 0x3F)));
+    }
+
+    /**
+     * @brief Unescape a quoted string into a sink (p at the opening quote)
+     */
+    template <typename Sink>
+    bool parseString(Sink& sink) {
+        const char quote = *p++;
+        uint16_t high_surrogate = 0;
+        for (;;) {
+            if (p >= end) {
+                return fail(ALERTDEC_INCOMPLETE_INPUT);
+            }
+            char c = *p++;
+            if (c == quote) {
+                return true;
+            }
+            if (c == '\\') {
+                if (p >= end) {
+                    return fail(ALERTDEC_INCOMPLETE_INPUT);
+                }
+                c = *p++;
+                switch (c) {
+                    case '"': case '\\': case '/': break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u': {
+                        uint16_t unit = 0;
+                        for (int i = 0; i < 4; i++) {
+                            if (p >= end) {
+                                return fail(ALERTDEC_INCOMPLETE_INPUT);
+                            }
+                            int digit = hexValue(*p++);
+                            if (digit < 0) {
+                                return fail(ALERTDEC_INVALID_INPUT);
+                            }
+                            unit = (unit << 4) | digit;
+                        }
+                        if (unit >= 0xD800 && unit < 0xDC00) {
+                            high_surrogate = unit & 0x3FF;      // Waits for its low half
+                            continue;
+                        }
+                        uint32_t codepoint = unit;
+                        if (unit >= 0xDC00 && unit < 0xE000) {
+                            codepoint = 0x10000 + (((uint32_t)high_surrogate << 10) | (unit & 0x3FF));
+                        }
+                        if (!putCodepoint(sink, codepoint)) {
+                            return fail(ALERTDEC_NO_MEMORY);
+                        }
+                        continue;
+                    }
+                    default:
+                        return fail(ALERTDEC_INVALID_INPUT);
+                }
+            }
+            if (!sink.put(c)) {
+                return fail(ALERTDEC_NO_MEMORY);
+            }
+        }
+    }
+
+    struct DiscardSink {
+        inline bool put(char) { return true; }
+    };
+
+    struct KeySink {
+        char key[ALERT_KEY_MAX_LEN];
+        size_t length = 0;
+        inline bool put(char c) {
+            if (length < ALERT_KEY_MAX_LEN) {
+                key[length] = c;
+            }
+            length++;   // Past ALERT_KEY_MAX_LEN: not a schema key, keep scanning
+            return true;
+        }
+    };
+
+    struct TextSink {
+        AlertText& out;
+        inline bool put(char c) { return out.putText(c); }
+    };
+
+    struct StringSink {
+        AlertText& out;
+        inline bool put(char c) { return out.putString(c); }
+    };
+
+    struct CodeSink {
+        char text[4];
+        size_t length = 0;
+        bool ended = false;
+        inline bool put(char c) {
+            ended = ended || c == '\0';     // As a C string
+            if (!ended && length < sizeof(text)) {
+                text[length++] = c;
+            }
+            return true;
+        }
+    };
+
+    static bool isUnquotedKeyChar(char c) {
+        return c == '_' || c == '+' || c == '-' || c == '.' || (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+               (c >= 'a' && c <= 'z');
+    }
+
+    bool parseKey(KeySink& key) {
+        if (isQuote(*p)) {
+            return parseString(key);
+        }
+        if (!isUnquotedKeyChar(*p)) {
+            return fail(ALERTDEC_INVALID_INPUT);
+        }
+        while (p < end && isUnquotedKeyChar(*p)) {
+            key.put(*p++);
+        }
+        return true;
+    }
+
+    bool parseColon() {
+        if (!skipSpace()) {
+            return false;
+        }
+        if (*p != ':') {
+            return fail(ALERTDEC_INVALID_INPUT);
+        }
+        p++;
+        return skipSpace();
+    }
+
+    bool skipKeyword(const char* word) {
+        for (; *word; word++) {
+            if (p >= end) {
+                return fail(ALERTDEC_INCOMPLETE_INPUT);
+            }
+            if (*p != *word) {
+                return fail(ALERTDEC_INVALID_INPUT);
+            }
+            p++;
+        }
+        return true;
+    }
+
+    static bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    /**
+     * @brief Scan a number; integer set when it is one that fits in 64 bits
+     */
+    bool parseNumber(bool& integer, bool& negative, uint64_t& magnitude) {
+        const char* start = p;
+        while (p < end && isNumberChar(*p) && (size_t)(p - start) < MAX_NUMBER_LEN) {
+            p++;
+        }
+        const char* s = start;
+        negative = false;
+        if (s < p && (*s == '-' || *s == '+')) {
+            negative = *s == '-';
+            s++;
+        }
+        if (s >= p || !((*s >= '0' && *s <= '9') || *s == '.')) {
+            return fail(ALERTDEC_INVALID_INPUT);
+        }
+
+        integer = true;
+        magnitude = 0;
+        while (s < p && *s >= '0' && *s <= '9') {
+            uint8_t digit = *s - '0';
+            if (magnitude > (UINT64_MAX - digit) / 10) {
+                integer = false;    // Too big: ArduinoJson keeps it as a float
+            } else {
+                magnitude = magnitude * 10 + digit;
+            }
+            s++;
+        }
+        if (negative && magnitude > ((uint64_t)1 << 63)) {
+            integer = false;
+        }
+        if (s < p && *s == '.') {
+            integer = false;
+            for (s++; s < p && *s >= '0' && *s <= '9'; s++) {
+            }
+        }
+        if (s < p && (*s == 'e' || *s == 'E')) {
+            integer = false;
+            s++;
+            if (s < p && (*s == '-' || *s == '+')) {
+                s++;
+            }
+            for (; s < p && *s >= '0' && *s <= '9'; s++) {
+            }
+        }
+        if (s != p) {
+            return fail(ALERTDEC_INVALID_INPUT);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Skip a string, number or keyword
+     */
+    bool skipScalar() {
+        if (isQuote(*p)) {
+            DiscardSink sink;
+            return parseString(sink);
+        }
+        switch (*p) {
+            case 't': return skipKeyword("true");
+            case 'f': return skipKeyword("false");
+            case 'n': return skipKeyword("null");
+            default: {
+                bool integer, negative;
+                uint64_t magnitude;
+                return parseNumber(integer, negative, magnitude);
+            }
+        }
+    }
+
+    /**
+     * @brief Skip any value without recursion (p at its first character)
+     */
+    bool skipValue() {
+        uint32_t stack = 0;     // Bit per open container, 1 = object
+        uint8_t open = 0;
+        for (;;) {
+            // A value
+            if (*p == '{' || *p == '[') {
+                if (depth + open >= ALERTDEC_NESTING_LIMIT) {
+                    return fail(ALERTDEC_TOO_DEEP);
+                }
+                bool object = *p++ == '{';
+                stack = (stack << 1) | (object ? 1 : 0);
+                open++;
+                if (!skipSpace()) {
+                    return false;
+                }
+                if (*p == (object ? '}' : ']')) {
+                    p++;
+                    stack >>= 1;
+                    open--;
+                } else {
+                    if (object && !skipMemberKey()) {
+                        return false;
+                    }
+                    continue;
+                }
+            } else if (!skipScalar()) {
+                return false;
+            }
+
+            // Close finished containers until the next value starts
+            for (;;) {
+                if (open == 0) {
+                    return true;
+                }
+                if (!skipSpace()) {
+                    return false;
+                }
+                bool object = stack & 1;
+                if (*p == (object ? '}' : ']')) {
+                    p++;
+                    stack >>= 1;
+                    open--;
+                    continue;
+                }
+                if (*p != ',') {
+                    return fail(ALERTDEC_INVALID_INPUT);
+                }
+                p++;
+                if (!skipSpace()) {
+                    return false;
+                }
+                if (object && !skipMemberKey()) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+
+    bool skipMemberKey() {
+        KeySink key;
+        return parseKey(key) && parseColon();
+    }
+
+    bool parseText(bool title) {
+        bool& seen = title ? title_string : message_string;
+        if (seen) {
+            // The first one is already in the display text; ArduinoJson keeps the last
+            return fail(ALERTDEC_UNSUPPORTED);
+        }
+        if (!isQuote(*p)) {
+            return skipValue();
+        }
+        seen = true;
+        out.beginText(title);
+        TextSink sink{out};
+        if (!parseString(sink)) {
+            return false;
+        }
+        out.endText();
+        return true;
+    }
+
+    bool parseStringField(const char*& field, const char* fallback) {
+        if (!isQuote(*p)) {
+            field = fallback;
+            return skipValue();
+        }
+        out.beginString();
+        StringSink sink{out};
+        if (!parseString(sink)) {
+            return false;
+        }
+        field = out.endString();
+        return !out.failed() || fail(ALERTDEC_NO_MEMORY);
+    }
+
+    bool parseCode(AlertKey key) {
+        uint8_t bit = codeBit(key);
+        bool valid;
+        char first = 0;
+        if (*p == 'n') {
+            // null counts as absent, as it does for display_config["..."].isNull()
+            invalid_mask &= ~bit;
+            applyCode(fields, key, 0, false);
+            return skipKeyword("null");
+        }
+        if (isQuote(*p)) {
+            CodeSink sink;
+            if (!parseString(sink)) {
+                return false;
+            }
+            first = codeValue(sink.text, sink.length);
+            valid = true;
+        } else {
+            if (!skipValue()) {
+                return false;
+            }
+            valid = false;
+        }
+        if (applyCode(fields, key, first, valid)) {
+            invalid_mask &= ~bit;
+        } else {
+            invalid_mask |= bit;
+        }
+        return true;
+    }
+
+    bool parseBool(bool& field) {
+        field = false;
+        if (*p == 't' || *p == 'f') {
+            field = *p == 't';
+            return skipKeyword(field ? "true" : "false");
+        }
+        return skipValue();
+    }
+
+    /**
+     * @brief An integer field: unsigned 32-bit, or int for duration
+     */
+    bool parseInteger(AlertKey key) {
+        bool integer = false;
+        bool negative = false;
+        uint64_t magnitude = 0;
+        bool number = !isQuote(*p) && *p != '{' && *p != '[' && *p != 't' && *p != 'f' && *p != 'n';
+        if (number) {
+            if (!parseNumber(integer, negative, magnitude)) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+
+        if (key == ALERTKEY_DURATION) {
+            bool fits = integer && (negative ? magnitude <= (uint64_t)INT32_MAX + 1 : magnitude <= INT32_MAX);
+            fields.duration = fits ? (unsigned int)(int)(negative ? -(int64_t)magnitude : (int64_t)magnitude) : 15;
+            return true;
+        }
+        bool fits = integer && (!negative || magnitude == 0) && magnitude <= UINT32_MAX;
+        (key == ALERTKEY_TIMESTAMP ? fields.timestamp : fields.expires) = fits ? (uint32_t)magnitude : 0;
+        return true;
+    }
+
+    bool parseField(AlertKey key) {
+        switch (key) {
+            case ALERTKEY_TITLE: return parseText(true);
+            case ALERTKEY_MESSAGE: return parseText(false);
+            case ALERTKEY_LEVEL: return parseStringField(fields.level, "info");
+            case ALERTKEY_CATEGORY: return parseStringField(fields.category, "application");
+            case ALERTKEY_ID: return parseStringField(fields.id, "");
+            case ALERTKEY_ZONE: return parseStringField(fields.zone, "");
+            case ALERTKEY_TIMESTAMP:
+            case ALERTKEY_EXPIRES:
+            case ALERTKEY_DURATION: return parseInteger(key);
+            case ALERTKEY_ECHO: return parseBool(fields.echo);
+            case ALERTKEY_PRIORITY: return parseBool(fields.priority);
+            case ALERTKEY_DISPLAY_CONFIG:
+                // The last display_config replaces any earlier one entirely
+                setDisplayDefaults(fields);
+                invalid_mask = 0;
+                fields.has_display_config = *p == '{';
+                return fields.has_display_config ? parseObject(ALERT_KEY_SCOPE_DISPLAY) : skipValue();
+            case ALERTKEY_MODE_CODE:
+            case ALERTKEY_COLOR_CODE:
+            case ALERTKEY_CHARSET_CODE:
+            case ALERTKEY_POSITION_CODE:
+            case ALERTKEY_SPEED_CODE:
+            case ALERTKEY_EFFECT_CODE: return parseCode(key);
+            default: return skipValue();
+        }
+    }
+
+    /**
+     * @brief The alert or display_config object (p at '{')
+     */
+    bool parseObject(uint8_t scope) {
+        if (depth >= ALERTDEC_NESTING_LIMIT) {
+            return fail(ALERTDEC_TOO_DEEP);
+        }
+        p++;
+        depth++;
+        if (!skipSpace()) {
+            return false;
+        }
+        if (*p == '}') {
+            p++;
+            depth--;
+            return true;
+        }
+        for (;;) {
+            KeySink key;
+            if (!parseKey(key) || !parseColon()) {
+                return false;
+            }
+            if (!parseField(lookupKey(key.key, key.length, scope))) {
+                return false;
+            }
+            if (!skipSpace()) {
+                return false;
+            }
+            if (*p == '}') {
+                p++;
+                depth--;
+                return true;
+            }
+            if (*p != ',') {
+                return fail(ALERTDEC_INVALID_INPUT);
+            }
+            p++;
+            if (!skipSpace()) {
+                return false;
+            }
+        }
+    }
+
+    const char* p;
+    const char* end;
+    AlertText out;
+    AlertFields& fields;
+    uint8_t depth;
+    uint8_t invalid_mask;
+    bool title_string;
+    bool message_string;
+    bool found_something;
+    AlertDecodeResult error;
+};
+
+AlertDecodeResult fromDeserializationError(const DeserializationError& error) {
+    switch (error.code()) {
+        case DeserializationError::Ok: return ALERTDEC_OK;
+        case DeserializationError::EmptyInput: return ALERTDEC_EMPTY_INPUT;
+        case DeserializationError::IncompleteInput: return ALERTDEC_INCOMPLETE_INPUT;
+        case DeserializationError::TooDeep: return ALERTDEC_TOO_DEEP;
+        case DeserializationError::NoMemory: return ALERTDEC_NO_MEMORY;
+        default: return ALERTDEC_INVALID_INPUT;
+    }
+}
+
+const char* copyString(AlertText& out, const char* text) {
+    out.beginString();
+    for (; *text; text++) {
+        out.putString(*text);
+    }
+    return out.endString();
+}
+
+} // namespace
+
+namespace AlertDecoder {
+
+AlertDecodeResult decode(const uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size) {
+    Parser parser(payload, length, fields, buffer, size);
+    return parser.run();
+}
+
+AlertDecodeResult decodeDocument(uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size) {
+    // Internal RAM unless MEMPOLICY_ALERT_DOC_PSRAM - this is the alert latency path
+    AlertJsonDocument doc(ALERTDEC_DOCUMENT_SIZE);
+    DeserializationError error = deserializeJson(doc, payload, length);
+    if (error) {
+        return fromDeserializationError(error);
+    }
+
+    setDefaults(fields);
+    AlertText out(buffer, size);
+
+    if (doc["title"].is<const char*>()) {
+        out.beginText(true);
+        for (const char* c = doc["title"].as<const char*>(); *c; c++) {
+            out.putText(*c);
+        }
+        out.endText();
+    }
+    if (doc["message"].is<const char*>()) {
+        out.beginText(false);
+        for (const char* c = doc["message"].as<const char*>(); *c; c++) {
+            out.putText(*c);
+        }
+        out.endText();
+    }
+
+    fields.id = copyString(out, doc["id"] | "");
+    fields.zone = copyString(out, doc["zone"] | "");
+    fields.level = copyString(out, doc["level"] | "info");
+    fields.category = copyString(out, doc["category"] | "application");
+    fields.timestamp = doc["timestamp"] | 0UL;
+    fields.expires = doc["expires"] | 0UL;
+    fields.echo = doc["echo"] | false;
+
+    setDisplayDefaults(fields);
+    JsonObject display_config = doc["display_config"];
+    fields.has_display_config = !display_config.isNull();
+    if (fields.has_display_config) {
+        static const AlertKey CODE_KEYS[] = {ALERTKEY_MODE_CODE, ALERTKEY_COLOR_CODE, ALERTKEY_CHARSET_CODE,
+                                             ALERTKEY_POSITION_CODE, ALERTKEY_SPEED_CODE, ALERTKEY_EFFECT_CODE};
+        static const char* const CODE_NAMES[] = {"mode_code", "color_code", "charset_code",
+                                                 "position_code", "speed_code", "effect_code"};
+        for (size_t i = 0; i < sizeof(CODE_KEYS) / sizeof(CODE_KEYS[0]); i++) {
+            JsonVariant code = display_config[CODE_NAMES[i]];
+            if (code.isNull()) {
+                continue;   // Absent: default, not an invalid code
+            }
+            bool valid = code.is<const char*>();
+            const char* text = valid ? code.as<const char*>() : "";
+            if (!applyCode(fields, CODE_KEYS[i], codeValue(text, strnlen(text, 4)), valid)) {
+                fields.invalid_codes++;
+            }
+        }
+        fields.priority = display_config["priority"] | false;
+        fields.duration = display_config["duration"] | 15;
+    }
+
+    return out.finish(fields) ? ALERTDEC_OK : ALERTDEC_NO_MEMORY;
+}
+
+AlertDecodeResult decodeAlert(uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size) {
+    AlertDecodeResult result = ALERTDEC_UNSUPPORTED;
+    if (ALERTDEC_SCHEMA_DECODER) {
+        result = decode(payload, length, fields, buffer, size);
+        if (result == ALERTDEC_UNSUPPORTED) {
+            metric_fallbacks.inc();
+        } else if (result == ALERTDEC_OK) {
+            metric_schema_decodes.inc();
+        }
+    }
+    if (result == ALERTDEC_UNSUPPORTED) {
+        result = decodeDocument(payload, length, fields, buffer, size);
+    }
+    if (result == ALERTDEC_OK && fields.invalid_codes) {
+        metric_invalid_codes.inc(fields.invalid_codes);
+    }
+    return result;
+}
+
+const char* resultName(AlertDecodeResult result) {
+    switch (result) {
+        case ALERTDEC_OK: return "Ok";
+        case ALERTDEC_EMPTY_INPUT: return "EmptyInput";
+        case ALERTDEC_INCOMPLETE_INPUT: return "IncompleteInput";
+        case ALERTDEC_INVALID_INPUT: return "InvalidInput";
+        case ALERTDEC_TOO_DEEP: return "TooDeep";
+        case ALERTDEC_NO_MEMORY: return "NoMemory";
+        case ALERTDEC_UNSUPPORTED: return "Unsupported";
+    }
+    return "Unknown";
+}
+
+String getStatus() {
+    if (!ALERTDEC_SCHEMA_DECODER) {
+        return "ArduinoJson only (ALERTDEC_SCHEMA_DECODER false)";
+    }
+    String status = String(metric_schema_decodes.get()) + " schema decodes, " + String(metric_fallbacks.get()) +
+                    " via ArduinoJson";
+    if (metric_invalid_codes.get()) {
+        status += ", " + String(metric_invalid_codes.get()) + " invalid codes replaced";
+    }
+    return status;
+}
+
+} // namespace AlertDecoder
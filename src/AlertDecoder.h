@@ -0,0 +1,140 @@
+/**
+ * @file AlertDecoder.h
+ * @brief Single-pass alert decoder for the Alert Manager JSON schema
+ *
+ * handleMQTTMessage() only ever reads a fixed set of alert fields:
+ *
+ *     {"id": "...", "timestamp": N, "expires": N, "zone": "...", "echo": true,
+ *      "title": "...", "message": "...", "level": "...", "category": "...",
+ *      "display_config": {"mode_code": "a", "color_code": "2", "charset_code": "3",
+ *                         "position_code": " ", "speed_code": "\u0017",
+ *                         "effect_code": "", "priority": false, "duration": 15}}
+ *
+ * so decode() walks the payload once without building a JSON document. Keys
+ * go through the perfect hash in AlertSchema.h (generated by
+ * tools/gen_alert_schema.py) and everything else is skipped in place. The
+ * title and message are unescaped straight into the caller's text buffer as
+ * the display text "Title: Message". display_config codes are checked
+ * against the BBDEFS.h value sets as they arrive, and a code the sign does
+ * not know falls back to its default and is counted.
+ *
+ * Accepts what ArduinoJson accepts (single quotes, unquoted keys, anything
+ * after the root value ignored, nesting limit 10) and gives the fields the
+ * same values the ArduinoJson lookups with defaults did: a missing field or
+ * one of the wrong type gets the default, and the last of duplicate keys
+ * wins. A repeated title or message returns ALERTDEC_UNSUPPORTED and the
+ * caller uses decodeDocument(), the ArduinoJson path, for that message.
+ *
+ * Strings other than the display text are written to the end of the same
+ * buffer, so ALERTDEC_BUFFER_SIZE(length) bytes always hold a payload of
+ * that length. Fields point into the buffer and live as long as it does.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef ALERT_DECODER_H
+#define ALERT_DECODER_H
+
+#include <Arduino.h>
+
+// Alert decoder configuration constants (from defines.h)
+#ifndef ALERTDEC_SCHEMA_DECODER
+#define ALERTDEC_SCHEMA_DECODER   true      // false = always decode with ArduinoJson
+#endif
+#ifndef ALERTDEC_NESTING_LIMIT
+#define ALERTDEC_NESTING_LIMIT    10        // ArduinoJson's default
+#endif
+
+// Text buffer for a payload of `length` bytes ("Alert: " default title and separators)
+#define ALERTDEC_BUFFER_SLACK     16
+#define ALERTDEC_BUFFER_SIZE(length) ((length) + ALERTDEC_BUFFER_SLACK)
+
+/**
+ * @brief Decode outcome (names match ArduinoJson's DeserializationError)
+ */
+enum AlertDecodeResult : uint8_t {
+    ALERTDEC_OK,
+    ALERTDEC_EMPTY_INPUT,
+    ALERTDEC_INCOMPLETE_INPUT,
+    ALERTDEC_INVALID_INPUT,
+    ALERTDEC_TOO_DEEP,
+    ALERTDEC_NO_MEMORY,
+    ALERTDEC_UNSUPPORTED                ///< Valid, but needs decodeDocument()
+};
+
+/**
+ * @brief The alert fields handleMQTTMessage() uses, defaults applied
+ */
+struct AlertFields {
+    const char* text;                   ///< "Title: Message", NUL-terminated
+    size_t text_length;
+    size_t title_length;                ///< Title part of text
+    bool has_title;                     ///< "title" was a string (else text starts "Alert")
+    const char* id;                     ///< "" if absent
+    const char* zone;                   ///< "" if absent
+    const char* level;                  ///< "info" if absent
+    const char* category;               ///< "application" if absent
+    uint32_t timestamp;                 ///< 0 if absent
+    uint32_t expires;                   ///< 0 if absent
+    bool echo;
+
+    bool has_display_config;            ///< display_config was an object
+    char mode;                          ///< BB_DM_* ('a')
+    char color;                         ///< BB_COL_* ('2')
+    char charset;                       ///< BB_CS_* ('3')
+    char position;                      ///< BB_DP_* (' ')
+    char speed[2];                      ///< BB_FC_SPEED* as a string ("\027")
+    char special;                       ///< BB_SDM_* (0 = no effect)
+    bool priority;
+    unsigned int duration;              ///< Seconds (15)
+    uint8_t invalid_codes;              ///< display_config codes replaced by their default
+
+    /**
+     * @brief Message part of text ("" if absent)
+     */
+    const char* message() const { return text + title_length + 2; }
+};
+
+namespace AlertDecoder {
+
+/**
+ * @brief Decode an alert in one pass
+ *
+ * @param payload JSON payload (need not be NUL-terminated)
+ * @param length Payload length
+ * @param fields Filled on ALERTDEC_OK
+ * @param buffer Text buffer, at least ALERTDEC_BUFFER_SIZE(length) bytes
+ * @param size Buffer size
+ * @return ALERTDEC_OK, a syntax error, or ALERTDEC_UNSUPPORTED
+ */
+AlertDecodeResult decode(const uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size);
+
+/**
+ * @brief Decode through an ArduinoJson document (the general path)
+ *
+ * Same fields and buffer layout as decode(); used for what decode() does
+ * not handle, when ALERTDEC_SCHEMA_DECODER is false, and by the benchmarks.
+ * The payload is parsed in place (ArduinoJson zero-copy) and is modified.
+ */
+AlertDecodeResult decodeDocument(uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size);
+
+/**
+ * @brief Decode with the configured path, falling back to ArduinoJson when needed
+ */
+AlertDecodeResult decodeAlert(uint8_t* payload, size_t length, AlertFields& fields, char* buffer, size_t size);
+
+/**
+ * @brief Name of a result for logging ("InvalidInput", ...)
+ */
+const char* resultName(AlertDecodeResult result);
+
+/**
+ * @brief Get human-readable status for logging
+ */
+String getStatus();
+
+} // namespace AlertDecoder
+
+#endif // ALERT_DECODER_H
@@ -0,0 +1,237 @@
+/**
+ * @file AlertRouter.cpp
+ * @brief Implementation of the alert topic routing table
+ */
+
+#include "defines.h"
+#include "AlertRouter.h"
+#include <MemoryPolicy.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+namespace {
+// Severity ladder for style/offset (DisplayPreset levels, least urgent first)
+const char* const LEVELS[] = {"info", "notice", "warning", "critical"};
+const int LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+int levelIndex(const char* level) {
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        if (strcmp(level, LEVELS[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+}
+
+AlertRouter::AlertRouter()
+    : route_count(0), arena_used(0), overlap_hash(0), overlap_ms(0), overlap_copies(0) {
+}
+
+void AlertRouter::clear() {
+    route_count = 0;
+    arena_used = 0;
+}
+
+const char* AlertRouter::store(const char* text) {
+    size_t length = strlen(text) + 1;
+    if (arena_used + length > sizeof(arena)) {
+        return nullptr;
+    }
+    char* copy = arena + arena_used;
+    memcpy(copy, text, length);
+    arena_used += length;
+    return copy;
+}
+
+bool AlertRouter::addRoute(const char* filter, const char* style, int8_t priority_offset, char file) {
+    if (route_count >= ALERTROUTER_MAX_ROUTES) {
+        Serial.println("AlertRouter: Error - Route table full");
+        return false;
+    }
+    if (!filter || !filter[0]) {
+        Serial.println("AlertRouter: Error - Empty filter");
+        return false;
+    }
+    if (style && style[0] && levelIndex(style) < 0) {
+        Serial.print("AlertRouter: Error - Unknown style ");
+        Serial.println(style);
+        return false;
+    }
+    if (file && (file < 'A' || file > 'Z')) {
+        Serial.println("AlertRouter: Error - File must be a letter A-Z");
+        return false;
+    }
+
+    size_t arena_mark = arena_used;
+    AlertRoute& r = routes[route_count];
+    r.filter = store(filter);
+    r.style = store(style ? style : "");
+    if (!r.filter || !r.style) {
+        Serial.println("AlertRouter: Error - Route arena full");
+        arena_used = arena_mark;
+        return false;
+    }
+    r.priority_offset = priority_offset;
+    r.file = file;
+    r.hits = 0;
+
+    // Split into levels; wildcards must fill a whole level and '#' must be last
+    r.level_count = 0;
+    const char* level = r.filter;
+    for (;;) {
+        const char* end = strchr(level, '/');
+        size_t length = end ? (size_t)(end - level) : strlen(level);
+        bool plus = length == 1 && level[0] == '+';
+        bool hash = length == 1 && level[0] == '#';
+        bool stray = !plus && !hash && (memchr(level, '+', length) || memchr(level, '#', length));
+
+        if (stray || (hash && end) || r.level_count >= ALERTROUTER_MAX_LEVELS || length > 255) {
+            Serial.print("AlertRouter: Error - Invalid filter ");
+            Serial.println(filter);
+            arena_used = arena_mark;
+            return false;
+        }
+
+        r.level_text[r.level_count] = plus ? nullptr : level;
+        r.level_len[r.level_count] = (uint8_t)length;
+        r.level_count++;
+
+        if (!end) {
+            break;
+        }
+        level = end + 1;
+    }
+
+    route_count++;
+    return true;
+}
+
+bool AlertRouter::load(const char* path, const String& zone) {
+    clear();
+
+    File file = LittleFS.open(path, "r");
+    if (file) {
+        BulkJsonDocument doc(2048);
+        DeserializationError error = deserializeJson(doc, file);
+        file.close();
+
+        if (error) {
+            Serial.print("AlertRouter: Error - ");
+            Serial.print(path);
+            Serial.print(": ");
+            Serial.println(error.c_str());
+        } else {
+            for (JsonObject entry : doc["routes"].as<JsonArray>()) {
+                String filter = entry["filter"] | "";
+                filter.replace("{zone}", zone);
+                const char* file_label = entry["file"] | "";
+                addRoute(filter.c_str(), entry["style"] | "", (int8_t)(entry["offset"] | 0),
+                         file_label[0]);
+            }
+        }
+    }
+
+    if (route_count > 0) {
+        Serial.print("AlertRouter: Loaded ");
+        Serial.print(route_count);
+        Serial.print(" routes from ");
+        Serial.println(path);
+        return true;
+    }
+
+    // No table: the sign's own zone, as before routing existed
+    String own = "ledSign/" + zone + "/message";
+    addRoute(own.c_str());
+    Serial.print("AlertRouter: Using default route ");
+    Serial.println(own);
+    return false;
+}
+
+bool AlertRouter::matches(const AlertRoute& route, const char* topic) {
+    const char* level = topic;
+    for (uint8_t i = 0; i < route.level_count; i++) {
+        const char* text = route.level_text[i];
+        if (text && text[0] == '#') {
+            return true;  // Rest of the topic, including none ("a/#" matches "a")
+        }
+        if (!level) {
+            return false;  // Topic is shorter than the filter
+        }
+        const char* end = strchr(level, '/');
+        size_t length = end ? (size_t)(end - level) : strlen(level);
+        if (text && (length != route.level_len[i] || memcmp(level, text, length) != 0)) {
+            return false;
+        }
+        level = end ? end + 1 : nullptr;
+    }
+    return level == nullptr;  // Topic must not be longer than the filter
+}
+
+AlertRoute* AlertRouter::match(const char* topic) {
+    for (uint8_t i = 0; i < route_count; i++) {
+        if (matches(routes[i], topic)) {
+            routes[i].hits++;
+            return &routes[i];
+        }
+    }
+    return nullptr;
+}
+
+bool AlertRouter::isOverlapCopy(const char* topic, const uint8_t* payload, size_t length, uint32_t now_ms) {
+    uint8_t matching = 0;
+    for (uint8_t i = 0; i < route_count; i++) {
+        if (matches(routes[i], topic)) {
+            matching++;
+        }
+    }
+    if (matching < 2) {
+        overlap_copies = 0;
+        return false;
+    }
+
+    uint32_t hash = 2166136261u;
+    for (const char* p = topic; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    hash = (hash ^ 0xFF) * 16777619u;  // Topic/payload separator
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ payload[i]) * 16777619u;
+    }
+
+    if (overlap_copies && hash == overlap_hash && now_ms - overlap_ms <= ALERTROUTER_OVERLAP_WINDOW_MS) {
+        overlap_copies--;
+        return true;
+    }
+    overlap_hash = hash;
+    overlap_ms = now_ms;
+    overlap_copies = matching - 1;
+    return false;
+}
+
+const char* AlertRouter::effectiveLevel(const AlertRoute* route, const char* level) {
+    if (!route || (!route->style[0] && route->priority_offset == 0)) {
+        return level;
+    }
+    int index = levelIndex(route->style[0] ? route->style : level);
+    if (index < 0) {
+        index = 0;  // Unknown levels get the info preset anyway
+    }
+    index += route->priority_offset;
+    if (index < 0) {
+        index = 0;
+    } else if (index >= LEVEL_COUNT) {
+        index = LEVEL_COUNT - 1;
+    }
+    return LEVELS[index];
+}
+
+String AlertRouter::getStatus() const {
+    String status = String(route_count) + " routes";
+    for (uint8_t i = 0; i < route_count; i++) {
+        status += i ? ", " : ": ";
+        status += routes[i].filter;
+        status += " (" + String(routes[i].hits) + ")";
+    }
+    return status;
+}
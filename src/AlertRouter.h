@@ -0,0 +1,165 @@
+/**
+ * @file AlertRouter.h
+ * @brief Topic routing table for alert ingestion
+ *
+ * A sign can take alerts from several sources - a site-wide zone, its floor
+ * and its own zone - and show each one differently. Each route is an MQTT
+ * topic filter plus how to show what arrives on it:
+ *
+ *     {"routes": [
+ *       {"filter": "ledSign/site/message",   "style": "warning", "file": "E"},
+ *       {"filter": "ledSign/floor2/message", "offset": -1},
+ *       {"filter": "ledSign/{zone}/message"}
+ *     ]}
+ *
+ * - filter: MQTT filter ('+' one level, '#' the rest); "{zone}" is the sign's zone
+ * - style: level preset to use instead of the alert's own level ("" = alert's)
+ * - offset: steps up or down the info/notice/warning/critical ladder
+ * - file: sign text file to write (one of the configured files), kept out of
+ *   the normal rotation
+ *
+ * Routes are tried in table order and the first match wins, so list the
+ * most specific first. Filters are validated and split into levels once at
+ * load time; matching walks the topic against the pre-split levels without
+ * copying or allocating. MQTTManager subscribes to every filter, so one
+ * subscription set feeds handleMQTTMessage(). An explicit display_config in
+ * the alert still overrides style and offset; file applies to both.
+ *
+ * A broker may deliver a message once per subscription it matches, so a
+ * topic covered by two filters can arrive twice, back to back.
+ * isOverlapCopy() drops those extra copies by topic and payload; alerts
+ * without an id would otherwise be shown twice.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef ALERT_ROUTER_H
+#define ALERT_ROUTER_H
+
+#include <Arduino.h>
+
+// Routing table configuration constants (from defines.h)
+#ifndef ALERTROUTER_MAX_ROUTES
+#define ALERTROUTER_MAX_ROUTES    8
+#endif
+#ifndef ALERTROUTER_MAX_LEVELS
+#define ALERTROUTER_MAX_LEVELS    8         // Topic levels per filter
+#endif
+#ifndef ALERTROUTER_ARENA_SIZE
+#define ALERTROUTER_ARENA_SIZE    512       // Bytes for filter and style strings
+#endif
+#ifndef ALERTROUTER_OVERLAP_WINDOW_MS
+#define ALERTROUTER_OVERLAP_WINDOW_MS 2000  // Extra copies from overlapping filters arrive within this
+#endif
+#ifndef ALERTROUTER_CONFIG_PATH
+#define ALERTROUTER_CONFIG_PATH   "/routes.json"
+#endif
+
+/**
+ * @brief One compiled route
+ */
+struct AlertRoute {
+    const char* filter;                 ///< Filter as configured ({zone} expanded)
+    const char* style;                  ///< Level preset override ("" = alert's own level)
+    int8_t priority_offset;             ///< Severity ladder steps (+ more urgent)
+    char file;                          ///< Sign text file (0 = normal rotation)
+    uint32_t hits;                      ///< Messages routed here since boot
+
+    // Compiled form
+    uint8_t level_count;
+    const char* level_text[ALERTROUTER_MAX_LEVELS];   ///< nullptr for '+', "#" for '#'
+    uint8_t level_len[ALERTROUTER_MAX_LEVELS];
+};
+
+/**
+ * @brief Ordered, compiled topic routing table
+ */
+class AlertRouter {
+public:
+    AlertRouter();
+
+    /**
+     * @brief Replace the table with a JSON configuration file
+     *
+     * Falls back to the single route "ledSign/{zone}/message" if the file is
+     * missing or has no valid routes.
+     *
+     * @param path LittleFS path of the routing configuration
+     * @param zone Sign zone name substituted for {zone}
+     * @return true if the file supplied at least one route
+     */
+    bool load(const char* path, const String& zone);
+
+    /**
+     * @brief Append a route (filters are validated and compiled here)
+     * @param filter MQTT topic filter, {zone} already expanded
+     * @param style Level preset override ("" = alert's own)
+     * @param priority_offset Severity ladder steps
+     * @param file Sign text file, 0 for rotation
+     * @return false if the filter is invalid or the table/arena is full
+     */
+    bool addRoute(const char* filter, const char* style = "", int8_t priority_offset = 0, char file = 0);
+
+    /**
+     * @brief Remove all routes
+     */
+    void clear();
+
+    /**
+     * @brief Find the first route whose filter matches a topic
+     * @param topic Published topic (no wildcards)
+     * @return Route, or nullptr if none matches
+     */
+    AlertRoute* match(const char* topic);
+
+    /**
+     * @brief Check for an extra copy delivered through another overlapping filter
+     *
+     * True if the topic matches more than one filter and this message has
+     * the same topic and payload as the previous one, arrived within
+     * ALERTROUTER_OVERLAP_WINDOW_MS, and fewer copies than matching filters
+     * have been seen. Call for every routed message, before match().
+     *
+     * @param topic Published topic
+     * @param payload Message payload
+     * @param length Payload length
+     * @param now_ms Current time in milliseconds
+     * @return true if the message should be dropped
+     */
+    bool isOverlapCopy(const char* topic, const uint8_t* payload, size_t length, uint32_t now_ms);
+
+    /**
+     * @brief Level to look up the display preset with, after style and offset
+     * @param route Matched route (nullptr = level unchanged)
+     * @param level Alert's own level
+     * @return One of "info", "notice", "warning", "critical", or level unchanged
+     */
+    static const char* effectiveLevel(const AlertRoute* route, const char* level);
+
+    uint8_t count() const { return route_count; }
+    const AlertRoute& route(uint8_t index) const { return routes[index]; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    AlertRoute routes[ALERTROUTER_MAX_ROUTES];
+    uint8_t route_count;
+    char arena[ALERTROUTER_ARENA_SIZE];
+    size_t arena_used;
+
+    // Last message on a topic several filters match
+    uint32_t overlap_hash;              ///< FNV-1a of topic and payload
+    uint32_t overlap_ms;                ///< When it arrived
+    uint8_t overlap_copies;             ///< Copies still expected
+
+    const char* store(const char* text);
+    static bool matches(const AlertRoute& route, const char* topic);
+};
+
+#endif // ALERT_ROUTER_H
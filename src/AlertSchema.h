@@ -0,0 +1,94 @@
+/**
+ * @file AlertSchema.h
+ * @brief Alert key perfect hash and display_config code sets
+ *
+ * Generated by tools/gen_alert_schema.py from its key list and
+ * lib/BETABRITE/BBDEFS.h - do not edit by hand.
+ */
+
+#ifndef ALERT_SCHEMA_H
+#define ALERT_SCHEMA_H
+
+#include <stdint.h>
+
+enum AlertKey : uint8_t {
+    ALERTKEY_NONE,
+    ALERTKEY_TITLE,
+    ALERTKEY_MESSAGE,
+    ALERTKEY_LEVEL,
+    ALERTKEY_CATEGORY,
+    ALERTKEY_ID,
+    ALERTKEY_TIMESTAMP,
+    ALERTKEY_EXPIRES,
+    ALERTKEY_ZONE,
+    ALERTKEY_ECHO,
+    ALERTKEY_DISPLAY_CONFIG,
+    ALERTKEY_MODE_CODE,
+    ALERTKEY_COLOR_CODE,
+    ALERTKEY_CHARSET_CODE,
+    ALERTKEY_POSITION_CODE,
+    ALERTKEY_SPEED_CODE,
+    ALERTKEY_EFFECT_CODE,
+    ALERTKEY_PRIORITY,
+    ALERTKEY_DURATION,
+    ALERTKEY_COUNT
+};
+
+#define ALERT_KEY_SCOPE_ALERT     0         // Keys of the alert object
+#define ALERT_KEY_SCOPE_DISPLAY   1         // Keys of display_config
+#define ALERT_KEY_MAX_LEN         14
+#define ALERT_KEY_SLOTS           32
+#define ALERT_KEY_SLOT(first, last, length) \
+    ((((uint32_t)(uint8_t)(first)) * 1 + ((uint32_t)(uint8_t)(last)) * 10 + (uint32_t)(length) * 5) & 31)
+
+struct AlertKeySlot {
+    const char* name;                   ///< nullptr = empty slot
+    uint8_t length;
+    uint8_t scope;
+    AlertKey key;
+};
+
+static const AlertKeySlot ALERT_KEY_TABLE[ALERT_KEY_SLOTS] = {
+    {"zone", 4, 0, ALERTKEY_ZONE},
+    {"timestamp", 9, 0, ALERTKEY_TIMESTAMP},
+    {"message", 7, 0, ALERTKEY_MESSAGE},
+    {"position_code", 13, 1, ALERTKEY_POSITION_CODE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"category", 8, 0, ALERTKEY_CATEGORY},
+    {"expires", 7, 0, ALERTKEY_EXPIRES},
+    {"color_code", 10, 1, ALERTKEY_COLOR_CODE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"mode_code", 9, 1, ALERTKEY_MODE_CODE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"effect_code", 11, 1, ALERTKEY_EFFECT_CODE},
+    {"echo", 4, 0, ALERTKEY_ECHO},
+    {"display_config", 14, 0, ALERTKEY_DISPLAY_CONFIG},
+    {"charset_code", 12, 1, ALERTKEY_CHARSET_CODE},
+    {"priority", 8, 1, ALERTKEY_PRIORITY},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"speed_code", 10, 1, ALERTKEY_SPEED_CODE},
+    {"duration", 8, 1, ALERTKEY_DURATION},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"id", 2, 0, ALERTKEY_ID},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"level", 5, 0, ALERTKEY_LEVEL},
+    {nullptr, 0, 0, ALERTKEY_NONE},
+    {"title", 5, 0, ALERTKEY_TITLE},
+};
+
+// Valid first characters per display_config code, bit (c & 31) of word (c >> 5)
+static const uint32_t ALERT_CODES_MODE[4] = {0x00000000, 0x00000000, 0x00000000, 0x007FFFEE};  // BB_DM_: abcefghijklmnopqrstuv
+static const uint32_t ALERT_CODES_COLOR[4] = {0x00000000, 0x03FE0000, 0x0000000E, 0x00000000};  // BB_COL_: 123456789ABC
+static const uint32_t ALERT_CODES_CHARSET[4] = {0x00000000, 0x7FFE0000, 0x07800000, 0x00000000};  // BB_CS_: 123456789:;<=>WXYZ
+static const uint32_t ALERT_CODES_POSITION[4] = {0x00000000, 0x00070045, 0x00000000, 0x00000000};  // BB_DP_: \040"&012
+static const uint32_t ALERT_CODES_SPEED[4] = {0x03E00000, 0x00000000, 0x00000000, 0x00000000};  // BB_FC_SPEED[1-5]: \025\026\027\030\031
+static const uint32_t ALERT_CODES_EFFECT[4] = {0x00000000, 0x03FF0000, 0x07E8000E, 0x00000000};  // BB_SDM_: 0123456789ABCSUVWXYZ
+
+#endif // ALERT_SCHEMA_H
@@ -0,0 +1,334 @@
+/**
+ * @file ConfigStore.cpp
+ * @brief Implementation of the runtime configuration store
+ */
+
+#include "defines.h"
+#include "ConfigStore.h"
+#include "Metrics.h"
+#include <EventBus.h>
+#include <MemoryPolicy.h>
+#include <Preferences.h>
+
+namespace {
+MetricGauge metric_version("ledsign_config_version", "Version of the runtime configuration in use");
+MetricCounter metric_changes("ledsign_config_changes_total", "Configuration change sets committed");
+MetricCounter metric_rejected("ledsign_config_rejected_total", "Configuration change sets refused (validation or NVS)");
+
+const char* const GROUP_NAMES[] = {"mqtt", "zone", "ha", "ota", "sign", "power"};
+const uint8_t GROUP_COUNT = sizeof(GROUP_NAMES) / sizeof(GROUP_NAMES[0]);
+}
+
+// Portal fields first, then settings that never had a portal field
+const ConfigKey ConfigStore::KEYS[] = {
+    {"mqtt_server",   CONFIG_STRING, CONFIG_GROUP_MQTT, CONFIG_DEFAULT_MQTT_SERVER, 0, 1, MAX_MQTT_SERVER_LEN, false},
+    {"mqtt_port",     CONFIG_INT,    CONFIG_GROUP_MQTT, nullptr, MQTT_TLS_PORT, 1, 65535, false},
+    {"mqtt_user",     CONFIG_STRING, CONFIG_GROUP_MQTT, "", 0, 0, MAX_MQTT_USER_LEN, false},
+    {"mqtt_pass",     CONFIG_STRING, CONFIG_GROUP_MQTT, "", 0, 0, MAX_MQTT_PASS_LEN, true},
+    {"zone",          CONFIG_STRING, CONFIG_GROUP_ZONE, CONFIG_DEFAULT_ZONE, 0, 1, MAX_ZONE_NAME_LEN, false},
+    {"ha_server",     CONFIG_STRING, CONFIG_GROUP_HA,   "", 0, 0, MAX_HA_MQTT_SERVER_LEN, false},
+    {"ha_port",       CONFIG_INT,    CONFIG_GROUP_HA,   nullptr, HA_MQTT_DEFAULT_PORT, 1, 65535, false},
+    {"ota_check_min", CONFIG_INT,    CONFIG_GROUP_OTA,  nullptr, OTA_CHECK_INTERVAL_HOURS * 60, 5, 10080, false},
+    {"ota_auto",      CONFIG_BOOL,   CONFIG_GROUP_OTA,  nullptr, OTA_AUTO_UPDATE_ENABLED, 0, 1, false},
+    {"prio_warn_ms",  CONFIG_INT,    CONFIG_GROUP_SIGN, nullptr, 2500, 0, 10000, false},
+    {"clock_ms",      CONFIG_INT,    CONFIG_GROUP_SIGN, nullptr, 4000, 1000, 60000, false},
+    {"sign_budget_ma", CONFIG_INT,   CONFIG_GROUP_SIGN, nullptr, SIGNLOAD_BUDGET_MA, 0, 10000, false},
+    {"power_budget_ms", CONFIG_INT,  CONFIG_GROUP_POWER, nullptr, POWER_LATENCY_BUDGET_MS, 0, 5000, false},
+};
+const uint8_t ConfigStore::KEY_COUNT = sizeof(ConfigStore::KEYS) / sizeof(ConfigStore::KEYS[0]);
+
+ConfigStore::ConfigStore()
+    : version(0), changes(0), unapplied(0) {
+    static_assert(sizeof(KEYS) / sizeof(KEYS[0]) <= MAX_KEYS, "ConfigStore: raise MAX_KEYS");
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        values[i] = defaultValue(KEYS[i]);
+    }
+}
+
+String ConfigStore::defaultValue(const ConfigKey& key) {
+    return key.type == CONFIG_STRING ? String(key.default_text) : String(key.default_int);
+}
+
+int ConfigStore::indexOf(const char* name) {
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        if (strcmp(KEYS[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ConfigStore::begin() {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, true)) {
+        // Namespace does not exist until the first commit
+        Serial.println("ConfigStore: No stored configuration - using defaults");
+        return false;
+    }
+
+    version = prefs.getUInt("version", 0);
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        const ConfigKey& key = KEYS[i];
+        switch (key.type) {
+            case CONFIG_STRING:
+                values[i] = prefs.getString(key.name, key.default_text);
+                break;
+            case CONFIG_INT:
+                values[i] = String(prefs.getInt(key.name, key.default_int));
+                break;
+            case CONFIG_BOOL:
+                values[i] = prefs.getBool(key.name, key.default_int != 0) ? "1" : "0";
+                break;
+        }
+    }
+    prefs.end();
+    metric_version.set(version);
+
+    Serial.print("ConfigStore: Loaded version ");
+    Serial.println(version);
+    return true;
+}
+
+const char* ConfigStore::getString(const char* name) const {
+    int index = indexOf(name);
+    return index >= 0 ? values[index].c_str() : "";
+}
+
+int32_t ConfigStore::getInt(const char* name) const {
+    int index = indexOf(name);
+    return index >= 0 ? (int32_t)values[index].toInt() : 0;
+}
+
+bool ConfigStore::getBool(const char* name) const {
+    int index = indexOf(name);
+    return index >= 0 && values[index] == "1";
+}
+
+bool ConfigStore::parse(const ConfigKey& key, JsonVariantConst value, String& text, String& error) {
+    if (key.type == CONFIG_STRING) {
+        if (!value.is<const char*>()) {
+            error = String(key.name) + ": expected a string";
+            return false;
+        }
+        text = value.as<const char*>();
+        if ((int32_t)text.length() < key.min || (int32_t)text.length() > key.max) {
+            error = String(key.name) + ": length must be " + String(key.min) + "-" + String(key.max);
+            return false;
+        }
+        return true;
+    }
+
+    // Ints and bools also come as text from the portal
+    long number = 0;
+    if (value.is<bool>()) {
+        number = value.as<bool>() ? 1 : 0;
+        if (key.type != CONFIG_BOOL) {
+            error = String(key.name) + ": expected a number";
+            return false;
+        }
+    } else if (value.is<long>()) {
+        number = value.as<long>();
+    } else if (value.is<const char*>()) {
+        const char* digits = value.as<const char*>();
+        char* end = nullptr;
+        if (key.type == CONFIG_BOOL && (strcmp(digits, "true") == 0 || strcmp(digits, "false") == 0)) {
+            number = digits[0] == 't' ? 1 : 0;
+        } else {
+            number = strtol(digits, &end, 10);
+            if (!digits[0] || *end) {
+                error = String(key.name) + ": not a number";
+                return false;
+            }
+        }
+    } else {
+        error = String(key.name) + (key.type == CONFIG_BOOL ? ": expected true/false" : ": expected a number");
+        return false;
+    }
+
+    if (number < key.min || number > key.max) {
+        error = String(key.name) + ": must be " + String(key.min) + "-" + String(key.max);
+        return false;
+    }
+    text = String(number);
+    return true;
+}
+
+uint32_t ConfigStore::apply(JsonObjectConst changes_in, String& error) {
+    String next[MAX_KEYS];
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        next[i] = values[i];
+    }
+
+    // Whole set or nothing
+    for (JsonPairConst change : changes_in) {
+        int index = indexOf(change.key().c_str());
+        if (index < 0) {
+            error = String("unknown key ") + change.key().c_str();
+            metric_rejected.inc();
+            return 0;
+        }
+        if (!parse(KEYS[index], change.value(), next[index], error)) {
+            metric_rejected.inc();
+            return 0;
+        }
+    }
+    return commit(next, error);
+}
+
+uint32_t ConfigStore::rollback(uint32_t to_version, String& error) {
+    String next[MAX_KEYS];
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        next[i] = defaultValue(KEYS[i]);
+    }
+
+    if (to_version > 0) {
+        if (to_version > version || version - to_version >= CONFIG_SNAPSHOTS) {
+            error = "version " + String(to_version) + " not kept";
+            metric_rejected.inc();
+            return 0;
+        }
+
+        Preferences prefs;
+        String saved;
+        if (prefs.begin(CONFIG_NVS_NAMESPACE, true)) {
+            char slot[8];
+            snprintf(slot, sizeof(slot), "snap%u", (unsigned)(to_version % CONFIG_SNAPSHOTS));
+            saved = prefs.getString(slot, "");
+            prefs.end();
+        }
+
+        BulkJsonDocument doc(1024);
+        if (deserializeJson(doc, saved) || (doc["v"] | 0UL) != to_version) {
+            error = "snapshot " + String(to_version) + " unreadable";
+            metric_rejected.inc();
+            return 0;
+        }
+        JsonObjectConst saved_values = doc["c"];
+        for (uint8_t i = 0; i < KEY_COUNT; i++) {
+            JsonVariantConst text = saved_values[KEYS[i].name];
+            if (text.is<const char*>()) {
+                next[i] = text.as<const char*>();
+            }
+        }
+    }
+    return commit(next, error);
+}
+
+uint32_t ConfigStore::commit(const String* next, String& error) {
+    uint32_t groups = 0;
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        if (next[i] != values[i]) {
+            groups |= KEYS[i].group;
+        }
+    }
+    if (groups == 0) {
+        return 0;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, false)) {
+        error = "NVS unavailable";
+        metric_rejected.inc();
+        return 0;
+    }
+
+    BulkJsonDocument doc(1024);
+    doc["v"] = version + 1;
+    JsonObject saved = doc.createNestedObject("c");
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        const ConfigKey& key = KEYS[i];
+        if (next[i] != values[i]) {
+            switch (key.type) {
+                case CONFIG_STRING:
+                    prefs.putString(key.name, next[i]);
+                    break;
+                case CONFIG_INT:
+                    prefs.putInt(key.name, next[i].toInt());
+                    break;
+                case CONFIG_BOOL:
+                    prefs.putBool(key.name, next[i] == "1");
+                    break;
+            }
+            values[i] = next[i];
+        }
+        saved[key.name] = values[i];
+    }
+
+    // Version last: a reset mid-commit leaves the new values under the old number
+    version++;
+    String snapshot_text;
+    serializeJson(doc, snapshot_text);
+    char slot[8];
+    snprintf(slot, sizeof(slot), "snap%u", (unsigned)(version % CONFIG_SNAPSHOTS));
+    prefs.putString(slot, snapshot_text);
+    prefs.putUInt("version", version);
+    prefs.end();
+
+    changes++;
+    unapplied |= groups;
+    metric_version.set(version);
+    metric_changes.inc();
+
+    Serial.print("ConfigStore: Committed version ");
+    Serial.print(version);
+    Serial.print(" (groups 0x");
+    Serial.print(groups, HEX);
+    Serial.println(")");
+
+    EventBus::publish(EVT_CONFIG_CHANGED, (int32_t)groups);
+    return groups;
+}
+
+uint32_t ConfigStore::takeChanges() {
+    uint32_t groups = unapplied;
+    unapplied = 0;
+    return groups;
+}
+
+void ConfigStore::reset() {
+    Preferences prefs;
+    if (prefs.begin(CONFIG_NVS_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
+    }
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        values[i] = defaultValue(KEYS[i]);
+    }
+    version = 0;
+    metric_version.set(0);
+    Serial.println("ConfigStore: Reset to defaults");
+}
+
+void ConfigStore::snapshot(JsonObject out, bool include_secrets) const {
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        const ConfigKey& key = KEYS[i];
+        if (key.secret && !include_secrets) {
+            out[key.name] = values[i].length() ? "***" : "";
+        } else if (key.type == CONFIG_INT) {
+            out[key.name] = values[i].toInt();
+        } else if (key.type == CONFIG_BOOL) {
+            out[key.name] = values[i] == "1";
+        } else {
+            out[key.name] = values[i];
+        }
+    }
+}
+
+void ConfigStore::groupNames(uint32_t groups, JsonArray out) {
+    for (uint8_t i = 0; i < GROUP_COUNT; i++) {
+        if (groups & (1UL << i)) {
+            out.add(GROUP_NAMES[i]);
+        }
+    }
+}
+
+String ConfigStore::getStatus() const {
+    uint8_t customized = 0;
+    for (uint8_t i = 0; i < KEY_COUNT; i++) {
+        if (values[i] != defaultValue(KEYS[i])) {
+            customized++;
+        }
+    }
+    return "version " + String(version) + ", " + String(customized) + "/" + String(KEY_COUNT) +
+           " keys set, " + String(changes) + " changes since boot";
+}
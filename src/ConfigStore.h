@@ -0,0 +1,168 @@
+/**
+ * @file ConfigStore.h
+ * @brief Typed, NVS-backed runtime configuration with versioned change sets
+ *
+ * Holds the settings that used to live only in the WiFiManager portal
+ * fields (broker, zone, HA broker) plus OTA and display timing, so they can
+ * be changed over MQTT without a portal visit or a reboot:
+ *
+ *     ledSign/{device_id}/config/set   {"set":{"zone":"lobby","clock_ms":6000},"if_version":7}
+ *                                      {"rollback":6}
+ *                                      {"get":true}
+ *
+ * A change set is validated as a whole (unknown key, wrong type or value
+ * out of range rejects all of it), written to NVS, and becomes the next
+ * version. The full value set of the last CONFIG_SNAPSHOTS versions is kept
+ * in NVS for {"rollback":N}; version 0 is the built-in defaults. Each
+ * committed set publishes EVT_CONFIG_CHANGED with a mask of the
+ * CONFIG_GROUP_* groups it touched, and the owners of those settings
+ * re-apply them live (see handleConfigChanged() in main.cpp).
+ *
+ * Values are kept in RAM as canonical text; snapshot() writes them typed,
+ * with secrets masked unless asked for.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Config store constants (from defines.h)
+#ifndef CONFIG_NVS_NAMESPACE
+#define CONFIG_NVS_NAMESPACE      "config"
+#endif
+#ifndef CONFIG_SNAPSHOTS
+#define CONFIG_SNAPSHOTS          4
+#endif
+#ifndef CONFIG_DEFAULT_MQTT_SERVER
+#define CONFIG_DEFAULT_MQTT_SERVER "alert.d-t.pw"
+#endif
+#ifndef CONFIG_DEFAULT_ZONE
+#define CONFIG_DEFAULT_ZONE       "CHANGEME"
+#endif
+
+/**
+ * @brief Settings re-applied together (EVT_CONFIG_CHANGED value is a mask of these)
+ */
+enum ConfigGroup : uint32_t {
+    CONFIG_GROUP_MQTT = 1UL << 0,       ///< Primary broker: reconnect
+    CONFIG_GROUP_ZONE = 1UL << 1,       ///< Zone: reload routes, resubscribe
+    CONFIG_GROUP_HA   = 1UL << 2,       ///< Home Assistant broker: reconnect
+    CONFIG_GROUP_OTA  = 1UL << 3,       ///< OTA check interval / auto update
+    CONFIG_GROUP_SIGN = 1UL << 4,       ///< SignController timing
+    CONFIG_GROUP_POWER = 1UL << 5       ///< Power governor latency budget
+};
+
+enum ConfigType : uint8_t {
+    CONFIG_STRING,
+    CONFIG_INT,
+    CONFIG_BOOL
+};
+
+/**
+ * @brief One setting in the key table
+ */
+struct ConfigKey {
+    const char* name;                   ///< JSON field and NVS key (at most 15 characters)
+    ConfigType type;
+    uint32_t group;                     ///< CONFIG_GROUP_* to re-apply when it changes
+    const char* default_text;           ///< Default (strings)
+    int32_t default_int;                ///< Default (ints; bools use 0/1)
+    int32_t min;                        ///< Lowest value, or shortest string
+    int32_t max;                        ///< Highest value, or longest string
+    bool secret;                        ///< Masked in published snapshots
+};
+
+/**
+ * @brief Runtime settings cached in RAM and persisted in NVS
+ */
+class ConfigStore {
+public:
+    ConfigStore();
+
+    /**
+     * @brief Load stored values (defaults for anything never set)
+     * @return false if NVS could not be opened (defaults are used)
+     */
+    bool begin();
+
+    const char* getString(const char* name) const;
+    int32_t getInt(const char* name) const;
+    bool getBool(const char* name) const;
+
+    /**
+     * @brief Current version (0 = defaults, +1 per committed change set)
+     */
+    uint32_t getVersion() const { return version; }
+
+    /**
+     * @brief Validate and commit a change set as one new version
+     * @param changes Key -> value; ints and bools may also be given as text
+     * @param error Output: why the set was rejected
+     * @return Groups whose values changed (0 if rejected or nothing changed)
+     */
+    uint32_t apply(JsonObjectConst changes, String& error);
+
+    /**
+     * @brief Commit the values of an earlier version as a new version
+     * @param to_version 0 (defaults) or one of the last CONFIG_SNAPSHOTS versions
+     * @param error Output: why the rollback failed
+     * @return Groups whose values changed (0 if failed or nothing changed)
+     */
+    uint32_t rollback(uint32_t to_version, String& error);
+
+    /**
+     * @brief Groups changed since the last call, then forget them
+     *
+     * EVT_CONFIG_CHANGED carries the groups of one change set; the module
+     * that re-applies them takes them from here instead, so two sets
+     * committed before one dispatch are applied once, and services started
+     * after a change can discard it.
+     */
+    uint32_t takeChanges();
+
+    /**
+     * @brief Erase every stored value and snapshot (factory reset)
+     */
+    void reset();
+
+    /**
+     * @brief Write the current values, typed, into a JSON object
+     * @param out Receives one field per key
+     * @param include_secrets false to replace secrets with "***"
+     */
+    void snapshot(JsonObject out, bool include_secrets = false) const;
+
+    /**
+     * @brief Names of the groups in a mask ("mqtt", "zone", ...)
+     */
+    static void groupNames(uint32_t groups, JsonArray out);
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    static const ConfigKey KEYS[];
+    static const uint8_t KEY_COUNT;
+    static const uint8_t MAX_KEYS = 16;
+
+    String values[MAX_KEYS];            ///< Canonical text per KEYS entry
+    uint32_t version;
+    uint32_t changes;                   ///< Change sets committed since boot
+    uint32_t unapplied;                 ///< Groups changed since takeChanges()
+
+    static int indexOf(const char* name);
+    static String defaultValue(const ConfigKey& key);
+    static bool parse(const ConfigKey& key, JsonVariantConst value, String& text, String& error);
+    uint32_t commit(const String* next, String& error);
+};
+
+#endif // CONFIG_STORE_H
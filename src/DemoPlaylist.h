@@ -0,0 +1,69 @@
+/**
+ * @file DemoPlaylist.h
+ * @brief Built-in playlist compiled from tools/playlists/demo.playlist
+ *
+ * Generated by tools/playlist_compiler.py - do not edit by hand.
+ */
+
+#ifndef DEMO_PLAYLIST_H
+#define DEMO_PLAYLIST_H
+
+#include <stdint.h>
+
+static const uint8_t DEMO_PLAYLIST[] = {
+    0x4C, 0x53, 0x50, 0x4C, 0x01, 0x01, 0x2B, 0x00, 0x01, 0x00, 0x00, 0x32, 0x22, 0x62, 0x30, 0x03,
+    0xF4, 0x01, 0x00, 0x00, 0x1A, 0x33, 0x20, 0x00, 0x31, 0x22, 0x62, 0x30, 0x05, 0xD0, 0x07, 0x00,
+    0x00, 0x1A, 0x36, 0x52, 0x45, 0x44, 0x00, 0x32, 0x22, 0x62, 0x30, 0x07, 0xD0, 0x07, 0x00, 0x00,
+    0x1A, 0x36, 0x47, 0x52, 0x45, 0x45, 0x4E, 0x00, 0x33, 0x22, 0x62, 0x30, 0x07, 0xD0, 0x07, 0x00,
+    0x00, 0x1A, 0x36, 0x41, 0x4D, 0x42, 0x45, 0x52, 0x00, 0x37, 0x22, 0x62, 0x30, 0x08, 0xD0, 0x07,
+    0x00, 0x00, 0x1A, 0x36, 0x4F, 0x52, 0x41, 0x4E, 0x47, 0x45, 0x00, 0x38, 0x22, 0x62, 0x30, 0x08,
+    0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x59, 0x45, 0x4C, 0x4C, 0x4F, 0x57, 0x00, 0x39, 0x22, 0x62,
+    0x30, 0x09, 0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x52, 0x41, 0x49, 0x4E, 0x42, 0x4F, 0x57, 0x00,
+    0x43, 0x22, 0x62, 0x30, 0x06, 0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x41, 0x55, 0x54, 0x4F, 0x00,
+    0x43, 0x22, 0x6E, 0x58, 0x0B, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x46, 0x49, 0x52, 0x45, 0x57,
+    0x4F, 0x52, 0x4B, 0x53, 0x00, 0x43, 0x22, 0x6E, 0x37, 0x0B, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33,
+    0x53, 0x54, 0x41, 0x52, 0x42, 0x55, 0x52, 0x53, 0x54, 0x00, 0x43, 0x22, 0x6E, 0x31, 0x09, 0xA0,
+    0x0F, 0x00, 0x00, 0x1A, 0x33, 0x53, 0x50, 0x41, 0x52, 0x4B, 0x4C, 0x45, 0x00, 0x43, 0x22, 0x6E,
+    0x33, 0x0B, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x49, 0x4E, 0x54, 0x45, 0x52, 0x4C, 0x4F, 0x43,
+    0x4B, 0x00, 0x43, 0x22, 0x6E, 0x41, 0x0B, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x4E, 0x45, 0x57,
+    0x53, 0x46, 0x4C, 0x41, 0x53, 0x48, 0x00, 0x31, 0x22, 0x62, 0x30, 0x17, 0x88, 0x13, 0x00, 0x00,
+    0x1A, 0x36, 0x1C, 0x31, 0x52, 0x1C, 0x37, 0x41, 0x1C, 0x38, 0x49, 0x1C, 0x32, 0x4E, 0x1C, 0x33,
+    0x42, 0x1C, 0x31, 0x4F, 0x1C, 0x32, 0x57, 0x01, 0x43, 0x22, 0x62, 0x30, 0x00, 0xE8, 0x03, 0x00,
+    0x00, 0x00, 0x38, 0x22, 0x6E, 0x42, 0x10, 0x70, 0x17, 0x00, 0x00, 0x1A, 0x36, 0x53, 0x4F, 0x41,
+    0x50, 0x20, 0x42, 0x4F, 0x58, 0x20, 0x44, 0x45, 0x52, 0x42, 0x59, 0x00, 0x33, 0x22, 0x62, 0x30,
+    0x19, 0x88, 0x13, 0x00, 0x00, 0x1A, 0x33, 0x4E, 0x4F, 0x57, 0x3A, 0x20, 0x23, 0x30, 0x30, 0x34,
+    0x32, 0x20, 0x20, 0x4E, 0x45, 0x58, 0x54, 0x3A, 0x20, 0x23, 0x30, 0x31, 0x31, 0x37, 0x00, 0x32,
+    0x22, 0x62, 0x30, 0x0F, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x36, 0x52, 0x41, 0x43, 0x49, 0x4E, 0x47,
+    0x3A, 0x20, 0x23, 0x30, 0x30, 0x34, 0x32, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00,
+    0x00, 0x1A, 0x36, 0x33, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00, 0x1A, 0x36,
+    0x32, 0x00, 0x33, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00, 0x1A, 0x36, 0x31, 0x00, 0x32,
+    0x22, 0x63, 0x30, 0x05, 0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x47, 0x4F, 0x21, 0x00, 0x32, 0x22,
+    0x6D, 0x30, 0x12, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x52, 0x41, 0x43, 0x45, 0x20, 0x49, 0x4E,
+    0x20, 0x50, 0x52, 0x4F, 0x47, 0x52, 0x45, 0x53, 0x53, 0x00, 0x39, 0x22, 0x6E, 0x37, 0x0F, 0x70,
+    0x17, 0x00, 0x00, 0x1A, 0x36, 0x57, 0x49, 0x4E, 0x4E, 0x45, 0x52, 0x21, 0x20, 0x23, 0x30, 0x30,
+    0x34, 0x32, 0x01, 0x43, 0x22, 0x62, 0x30, 0x00, 0xDC, 0x05, 0x00, 0x00, 0x00, 0x33, 0x22, 0x62,
+    0x30, 0x19, 0x88, 0x13, 0x00, 0x00, 0x1A, 0x33, 0x4E, 0x4F, 0x57, 0x3A, 0x20, 0x23, 0x30, 0x32,
+    0x33, 0x35, 0x20, 0x20, 0x4E, 0x45, 0x58, 0x54, 0x3A, 0x20, 0x23, 0x30, 0x30, 0x30, 0x38, 0x00,
+    0x32, 0x22, 0x62, 0x30, 0x0F, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x36, 0x52, 0x41, 0x43, 0x49, 0x4E,
+    0x47, 0x3A, 0x20, 0x23, 0x30, 0x32, 0x33, 0x35, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03,
+    0x00, 0x00, 0x1A, 0x36, 0x33, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00, 0x1A,
+    0x36, 0x32, 0x00, 0x33, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00, 0x1A, 0x36, 0x31, 0x00,
+    0x32, 0x22, 0x63, 0x30, 0x05, 0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x47, 0x4F, 0x21, 0x00, 0x32,
+    0x22, 0x6D, 0x30, 0x12, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x52, 0x41, 0x43, 0x45, 0x20, 0x49,
+    0x4E, 0x20, 0x50, 0x52, 0x4F, 0x47, 0x52, 0x45, 0x53, 0x53, 0x00, 0x39, 0x22, 0x6E, 0x37, 0x0F,
+    0x70, 0x17, 0x00, 0x00, 0x1A, 0x36, 0x57, 0x49, 0x4E, 0x4E, 0x45, 0x52, 0x21, 0x20, 0x23, 0x30,
+    0x32, 0x33, 0x35, 0x01, 0x43, 0x22, 0x62, 0x30, 0x00, 0xDC, 0x05, 0x00, 0x00, 0x00, 0x33, 0x22,
+    0x62, 0x30, 0x19, 0x88, 0x13, 0x00, 0x00, 0x1A, 0x33, 0x4E, 0x4F, 0x57, 0x3A, 0x20, 0x23, 0x30,
+    0x31, 0x36, 0x34, 0x20, 0x20, 0x4E, 0x45, 0x58, 0x54, 0x3A, 0x20, 0x23, 0x30, 0x30, 0x39, 0x31,
+    0x00, 0x32, 0x22, 0x62, 0x30, 0x0F, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x36, 0x52, 0x41, 0x43, 0x49,
+    0x4E, 0x47, 0x3A, 0x20, 0x23, 0x30, 0x31, 0x36, 0x34, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8,
+    0x03, 0x00, 0x00, 0x1A, 0x36, 0x33, 0x00, 0x31, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00,
+    0x1A, 0x36, 0x32, 0x00, 0x33, 0x22, 0x62, 0x30, 0x03, 0xE8, 0x03, 0x00, 0x00, 0x1A, 0x36, 0x31,
+    0x00, 0x32, 0x22, 0x63, 0x30, 0x05, 0xD0, 0x07, 0x00, 0x00, 0x1A, 0x36, 0x47, 0x4F, 0x21, 0x00,
+    0x32, 0x22, 0x6D, 0x30, 0x12, 0xA0, 0x0F, 0x00, 0x00, 0x1A, 0x33, 0x52, 0x41, 0x43, 0x45, 0x20,
+    0x49, 0x4E, 0x20, 0x50, 0x52, 0x4F, 0x47, 0x52, 0x45, 0x53, 0x53, 0x00, 0x39, 0x22, 0x6E, 0x37,
+    0x0F, 0x70, 0x17, 0x00, 0x00, 0x1A, 0x36, 0x57, 0x49, 0x4E, 0x4E, 0x45, 0x52, 0x21, 0x20, 0x23,
+    0x30, 0x31, 0x36, 0x34, 0x01, 0x43, 0x22, 0x62, 0x30, 0x00, 0xDC, 0x05, 0x00, 0x00,
+};
+
+#endif // DEMO_PLAYLIST_H
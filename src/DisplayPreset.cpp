@@ -0,0 +1,71 @@
+/**
+ * @file DisplayPreset.cpp
+ * @brief Implementation of the alert display preset mapping
+ */
+
+#include "DisplayPreset.h"
+#include <HotPath.h>
+#include <string.h>
+
+DisplayPreset getDisplayPreset(const char* level, const char* category) {
+    HOTPATH_PROFILE(HOTPATH_INGEST);
+    DisplayPreset preset;
+
+    // Default safe values
+    preset.color_code = '2';        // Green
+    preset.mode_code = 'a';         // Rotate
+    preset.charset_code = '3';      // 7high
+    preset.position_code = ' ';     // Midline
+    preset.speed_code = "\027";     // Medium (3)
+    preset.effect_code = '0';       // Twinkle
+    preset.priority = false;
+    preset.duration = 15;
+
+    // Determine base preset by level
+    if (strcmp(level, "critical") == 0) {
+        preset.color_code = '1';     // Red
+        preset.mode_code = 'c';      // Flash
+        preset.charset_code = '6';   // 10high (large)
+        preset.position_code = '0';  // Fill
+        preset.speed_code = "\031";  // Fast (5)
+        preset.effect_code = 'Z';    // Bomb (urgent)
+        preset.priority = true;
+        preset.duration = 60;
+    } else if (strcmp(level, "warning") == 0) {
+        preset.color_code = '3';     // Amber
+        preset.mode_code = 'm';      // Scroll
+        preset.charset_code = '3';   // 7high
+        preset.position_code = '\"'; // Topline
+        preset.speed_code = "\027";  // Medium (3)
+        preset.effect_code = '0';    // Twinkle
+        preset.priority = false;
+        preset.duration = 30;
+    } else if (strcmp(level, "notice") == 0) {
+        preset.color_code = '2';     // Green
+        preset.mode_code = 'r';      // Wipein
+        preset.charset_code = '3';   // 7high
+        preset.position_code = ' ';  // Midline
+        preset.speed_code = "\027";  // Medium (3)
+        preset.effect_code = '8';    // Welcome
+        preset.priority = false;
+        preset.duration = 20;
+    }
+    // else: info or unknown - use defaults set above
+
+    // Modify effect based on category (overrides level-based effect for non-critical)
+    if (strcmp(level, "critical") != 0) {  // Don't override critical bomb effect
+        if (strcmp(category, "security") == 0) {
+            preset.effect_code = 'B';    // Trumpet (attention-getting)
+        } else if (strcmp(category, "weather") == 0) {
+            preset.effect_code = '2';    // Snow
+        } else if (strcmp(category, "automation") == 0) {
+            preset.effect_code = '8';    // Welcome/completion
+        } else if (strcmp(category, "system") == 0 || strcmp(category, "network") == 0) {
+            preset.effect_code = '0';    // Twinkle (subtle)
+        } else if (strcmp(category, "personal") == 0) {
+            preset.effect_code = '1';    // Sparkle (friendly)
+        }
+    }
+
+    return preset;
+}
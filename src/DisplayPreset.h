@@ -0,0 +1,57 @@
+/**
+ * @file DisplayPreset.h
+ * @brief Alert level/category to display parameter mapping
+ *
+ * Shared by MQTT/multicast alert ingestion and the handheld remote. The
+ * goldens in goldens/presets are rendered from the frames these presets
+ * produce (tools/scenarios/presets.scn).
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef DISPLAY_PRESET_H
+#define DISPLAY_PRESET_H
+
+/**
+ * @brief Structure for display configuration presets
+ *
+ * Contains all display parameters for an alert level/category combination
+ */
+struct DisplayPreset {
+    char color_code;
+    char mode_code;
+    char charset_code;
+    char position_code;
+    const char* speed_code;
+    char effect_code;
+    bool priority;
+    unsigned int duration;
+};
+
+/**
+ * @brief Get display preset based on alert level and category
+ *
+ * Returns appropriate display configuration based on alert severity and type.
+ * Falls back to safe defaults if level/category not recognized.
+ *
+ * Alert Levels (by severity):
+ * - critical: Red, flash/newsflash, large text, priority, 60s
+ * - warning:  Amber, scroll, normal text, 30s
+ * - notice:   Green, wipein, normal text, 20s
+ * - info:     Green, rotate, normal text, 15s
+ *
+ * Categories influence special effects:
+ * - security: Bomb effect for visual urgency
+ * - weather:  Snow/weather-appropriate effects
+ * - automation: Welcome/completion effects
+ * - system/network: Subtle twinkle effects
+ *
+ * @param level Alert severity level ("critical", "warning", "notice", "info")
+ * @param category Alert category ("security", "weather", "automation", "system", etc.)
+ * @return DisplayPreset struct with appropriate display parameters
+ */
+DisplayPreset getDisplayPreset(const char* level, const char* category);
+
+#endif // DISPLAY_PRESET_H
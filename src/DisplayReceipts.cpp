@@ -0,0 +1,139 @@
+/**
+ * @file DisplayReceipts.cpp
+ * @brief Implementation of batched per-alert display receipts
+ */
+
+#include "defines.h"
+#include "DisplayReceipts.h"
+#include "SimClock.h"
+#include <MemoryPolicy.h>
+#include <ArduinoJson.h>
+#include <sys/time.h>
+
+namespace {
+const char* const STATUS_NAMES[] = {"displayed", "dropped", "coalesced", "expired"};
+}
+
+DisplayReceipts::DisplayReceipts(BETABRITE* sign)
+    : sign(sign), head(0), count(0), pending_count(0), batch_seq(0), lost(0),
+      total_recorded(0), total_sent(0) {
+}
+
+uint64_t DisplayReceipts::epochMillis() {
+    if (SimClock::now() < 1609459200) {  // Same "not synced yet" threshold as MQTTManager
+        return 0;
+    }
+#ifdef SIM_CLOCK
+    return (uint64_t)SimClock::now() * 1000;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+void DisplayReceipts::record(const char* id, uint32_t alert_ts, ReceiptStatus status, uint32_t rx_us,
+                             uint32_t write_us) {
+    if (count == RECEIPTS_RING_SIZE) {
+        // Broker away for a whole ring: oldest goes
+        if (ring[head].pending) {
+            pending_count--;
+        }
+        head = (head + 1) % RECEIPTS_RING_SIZE;
+        count--;
+        lost++;
+    }
+
+    Receipt& r = ring[(head + count) % RECEIPTS_RING_SIZE];
+    strncpy(r.id, id ? id : "", sizeof(r.id) - 1);
+    r.id[sizeof(r.id) - 1] = '\0';
+    r.alert_ts = alert_ts;
+    r.rx_epoch_ms = epochMillis();
+    r.rx_us = rx_us;
+    r.recorded_ms = SimClock::millis();
+    r.first_byte_us = status == RECEIPT_DISPLAYED ? write_us - rx_us : 0;
+    r.glass_us = 0;
+    r.status = status;
+    r.pending = status == RECEIPT_DISPLAYED;
+    if (r.pending) {
+        pending_count++;
+    }
+    count++;
+    total_recorded++;
+}
+
+void DisplayReceipts::loop() {
+    if (pending_count == 0) {
+        return;
+    }
+
+    // One UART check covers every pending frame: they went out in order
+    bool idle = sign->TxIdle();
+    uint32_t now_us = micros();
+    uint32_t now_ms = SimClock::millis();
+    for (uint8_t i = 0; i < count; i++) {
+        Receipt& r = ring[(head + i) % RECEIPTS_RING_SIZE];
+        if (!r.pending) {
+            continue;
+        }
+        if (idle) {
+            r.glass_us = now_us - r.rx_us;
+        } else if (now_ms - r.recorded_ms < RECEIPTS_GLASS_TIMEOUT_MS) {
+            continue;
+        }
+        r.pending = false;
+        pending_count--;
+    }
+}
+
+bool DisplayReceipts::batchReady(uint32_t now_ms) const {
+    if (count == 0 || ring[head].pending) {
+        return false;
+    }
+    if (now_ms - ring[head].recorded_ms >= RECEIPTS_FLUSH_INTERVAL) {
+        return true;
+    }
+
+    // Receipts leave in order, so only the complete run from the head counts
+    uint8_t complete = 0;
+    while (complete < count && !ring[(head + complete) % RECEIPTS_RING_SIZE].pending) {
+        if (++complete >= RECEIPTS_BATCH_SIZE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+String DisplayReceipts::takeBatch() {
+    BulkJsonDocument doc(256 + RECEIPTS_BATCH_SIZE * (160 + RECEIPTS_ID_LEN));
+    doc["seq"] = batch_seq++;
+    doc["lost"] = lost;
+    JsonArray rows = doc.createNestedArray("r");
+
+    uint8_t taken = 0;
+    while (taken < RECEIPTS_BATCH_SIZE && count > 0 && !ring[head].pending) {
+        const Receipt& r = ring[head];
+        JsonArray row = rows.createNestedArray();
+        row.add(r.id);
+        row.add(r.alert_ts);
+        row.add(r.rx_epoch_ms);
+        row.add(r.first_byte_us);
+        row.add(r.glass_us);
+        row.add(STATUS_NAMES[r.status]);
+
+        head = (head + 1) % RECEIPTS_RING_SIZE;
+        count--;
+        taken++;
+    }
+    lost = 0;
+    total_sent += taken;
+
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
+
+String DisplayReceipts::getStatus() const {
+    return String(total_recorded) + " recorded, " + String(total_sent) + " sent in " + String(batch_seq) +
+           " batches, " + String(count) + " held (" + String(pending_count) + " awaiting glass)";
+}
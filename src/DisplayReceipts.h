@@ -0,0 +1,142 @@
+/**
+ * @file DisplayReceipts.h
+ * @brief Batched per-alert display receipts for the Alert Manager
+ *
+ * Each parsed alert leaves a receipt saying what happened to it and when,
+ * so delivery latency can be measured across the fleet. Receipts collect
+ * in a fixed ring and go out as one message per batch on
+ * ledSign/{device_id}/receipts:
+ *
+ *     {"seq":12,"lost":0,"r":[["a1b2",1704045600,1704045600123,840,41200,"displayed"],...]}
+ *
+ * Each row is [id, alert timestamp, received-at (epoch ms, 0 before the
+ * first time sync), first byte (us after receipt), on glass (us after
+ * receipt), status]. Status is one of:
+ * - displayed: written to the sign
+ * - dropped: refused by the sign controller (e.g. a sequence is running)
+ * - coalesced: already shown via the other delivery path (duplicate)
+ * - expired: its "expires" time had passed on arrival
+ *
+ * "On glass" is when the sign UART has sent the last byte of the frame,
+ * polled without blocking from the main loop; for priority alerts that is
+ * the "ALERT" warning frame. It stays 0 if the UART never drained within
+ * RECEIPTS_GLASS_TIMEOUT_MS. A batch is sent when RECEIPTS_BATCH_SIZE
+ * receipts are complete or the oldest has waited RECEIPTS_FLUSH_INTERVAL;
+ * during a broker outage batches wait in the outbound spool. If the ring
+ * fills before MQTT is set up, the oldest receipts are overwritten and
+ * counted in "lost".
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef DISPLAY_RECEIPTS_H
+#define DISPLAY_RECEIPTS_H
+
+#include <Arduino.h>
+#include "BETABRITE.h"
+
+// Receipt configuration constants (from defines.h)
+#ifndef RECEIPTS_RING_SIZE
+#define RECEIPTS_RING_SIZE        32
+#endif
+#ifndef RECEIPTS_BATCH_SIZE
+#define RECEIPTS_BATCH_SIZE       16
+#endif
+#ifndef RECEIPTS_FLUSH_INTERVAL
+#define RECEIPTS_FLUSH_INTERVAL   10000
+#endif
+#ifndef RECEIPTS_GLASS_TIMEOUT_MS
+#define RECEIPTS_GLASS_TIMEOUT_MS 5000
+#endif
+#ifndef RECEIPTS_ID_LEN
+#define RECEIPTS_ID_LEN           40        // Longest alert id kept + 1
+#endif
+
+/**
+ * @brief What happened to an alert
+ */
+enum ReceiptStatus : uint8_t {
+    RECEIPT_DISPLAYED,
+    RECEIPT_DROPPED,
+    RECEIPT_COALESCED,
+    RECEIPT_EXPIRED
+};
+
+/**
+ * @brief Ring of display receipts, flushed in batches
+ */
+class DisplayReceipts {
+public:
+    /**
+     * @param sign Sign interface polled for on-glass time
+     */
+    explicit DisplayReceipts(BETABRITE* sign);
+
+    /**
+     * @brief Add a receipt for an alert
+     * @param id Alert id ("" if the alert has none)
+     * @param alert_ts Alert "timestamp" field (0 if absent)
+     * @param status Outcome
+     * @param rx_us micros() when the message was received
+     * @param write_us micros() as its frame started (displayed only)
+     */
+    void record(const char* id, uint32_t alert_ts, ReceiptStatus status, uint32_t rx_us, uint32_t write_us = 0);
+
+    /**
+     * @brief Complete receipts whose frame has left the UART - call every loop pass
+     */
+    void loop();
+
+    /**
+     * @brief Check whether a batch should be sent now
+     * @param now_ms SimClock::millis()
+     * @return true if RECEIPTS_BATCH_SIZE are complete or the oldest is due
+     */
+    bool batchReady(uint32_t now_ms) const;
+
+    /**
+     * @brief Remove up to RECEIPTS_BATCH_SIZE complete receipts as a batch
+     * @return Batch JSON (see file comment)
+     */
+    String takeBatch();
+
+    /**
+     * @brief Whether any receipt is still waiting for its frame to leave the UART
+     */
+    bool hasPending() const { return pending_count > 0; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    struct Receipt {
+        char id[RECEIPTS_ID_LEN];
+        uint32_t alert_ts;
+        uint64_t rx_epoch_ms;           ///< 0 if the clock was not set
+        uint32_t rx_us;
+        uint32_t recorded_ms;           ///< SimClock::millis() at record()
+        uint32_t first_byte_us;         ///< After rx_us
+        uint32_t glass_us;              ///< After rx_us (0 = unknown)
+        ReceiptStatus status;
+        bool pending;                   ///< Frame still in the UART
+    };
+
+    BETABRITE* sign;
+    Receipt ring[RECEIPTS_RING_SIZE];
+    uint8_t head;                       ///< Oldest receipt
+    uint8_t count;
+    uint8_t pending_count;
+    uint32_t batch_seq;
+    uint32_t lost;                      ///< Overwritten since the last batch
+    uint32_t total_recorded;
+    uint32_t total_sent;
+
+    static uint64_t epochMillis();
+};
+
+#endif // DISPLAY_RECEIPTS_H
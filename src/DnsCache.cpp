@@ -0,0 +1,394 @@
+/**
+ * @file DnsCache.cpp
+ * @brief Host name cache with background refresh, and the clients that use it
+ *
+ * The table is shared by the main task (resolve) and the refresh task, under
+ * one spinlock held only for copies; lookups themselves run unlocked. The
+ * refresh task resolves one due entry per pass, so a slow server delays other
+ * refreshes but never a caller that already has an address.
+ *
+ * Lookups (not the table) take turns on a mutex, because hostByName() waits on
+ * a single shared event bit and two overlapping queries can return each
+ * other's answer. The refresh task never waits for it, and it skips its pass
+ * while a caller is waiting.
+ */
+
+#include "defines.h"
+#include <DnsCache.h>
+#include "Metrics.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+namespace {
+
+struct Entry {
+    char host[DNSCACHE_HOST_LEN];   // Empty = free slot
+    uint32_t address;               // 0 = never resolved
+    uint32_t resolved_ms;           // When address was last confirmed
+    uint32_t used_ms;               // Last resolve() (eviction order)
+    uint32_t refresh_ms;            // Refresh task resolves again at/after this
+};
+
+Entry entries[DNSCACHE_ENTRIES];
+portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t refresh_task = nullptr;
+SemaphoreHandle_t lookup_mutex = nullptr;   // One hostByName() at a time (created with the task)
+volatile uint8_t foreground_lookups = 0;    // Callers waiting for or in a lookup (under cache_lock)
+
+// Refresh before expiry so connects normally find a fresh entry
+const uint32_t REFRESH_AHEAD_MS = DNSCACHE_TTL_MS / 4;
+
+const uint32_t LOOKUP_BOUNDS_US[] = {1000, 5000, 20000, 50000, 100000, 500000, 1000000, 5000000};
+
+MetricCounter metric_hits("ledsign_dns_cache_hits_total", "Host names answered from a fresh cache entry");
+MetricCounter metric_stale("ledsign_dns_cache_stale_hits_total",
+                           "Host names answered from an expired entry while it refreshes");
+MetricCounter metric_misses("ledsign_dns_cache_misses_total", "Host names the caller had to wait for");
+MetricCounter metric_failures("ledsign_dns_failures_total", "Failed DNS lookups (foreground and refresh)");
+MetricHistogram metric_lookup("ledsign_dns_lookup_microseconds", "Time spent in DNS lookups",
+                              LOOKUP_BOUNDS_US, sizeof(LOOKUP_BOUNDS_US) / sizeof(LOOKUP_BOUNDS_US[0]));
+
+inline bool isDue(uint32_t deadline_ms, uint32_t now_ms) {
+    return (int32_t)(deadline_ms - now_ms) <= 0;
+}
+
+// Caller holds cache_lock
+int findLocked(const char* host) {
+    for (int i = 0; i < DNSCACHE_ENTRIES; i++) {
+        if (entries[i].host[0] && strcmp(entries[i].host, host) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Caller holds cache_lock; takes a free slot or the least recently used one
+int claimLocked(const char* host, uint32_t now) {
+    int slot = findLocked(host);
+    if (slot >= 0) {
+        return slot;
+    }
+    slot = 0;
+    for (int i = 0; i < DNSCACHE_ENTRIES; i++) {
+        if (!entries[i].host[0]) {
+            slot = i;
+            break;
+        }
+        if ((int32_t)(entries[i].used_ms - entries[slot].used_ms) < 0) {
+            slot = i;
+        }
+    }
+    Entry& e = entries[slot];
+    strncpy(e.host, host, sizeof(e.host) - 1);
+    e.host[sizeof(e.host) - 1] = '\0';
+    e.address = 0;
+    e.resolved_ms = now;
+    e.used_ms = now;
+    e.refresh_ms = now;
+    return slot;
+}
+
+/**
+ * @brief Resolve with WiFi.hostByName(), one lookup at a time
+ * @param foreground true for a caller waiting on the answer; false for the refresh task,
+ *        which gives up instead of waiting (or making a waiting caller wait)
+ * @return false on failure, or for a background lookup that was skipped
+ */
+bool lookup(const char* host, uint32_t& address, bool foreground) {
+    if (foreground) {
+        portENTER_CRITICAL(&cache_lock);
+        foreground_lookups++;
+        portEXIT_CRITICAL(&cache_lock);
+    }
+    if (lookup_mutex) {
+        // A background lookup in flight finishes first; none starts while a caller waits
+        if (foreground) {
+            xSemaphoreTake(lookup_mutex, portMAX_DELAY);
+        } else if (!xSemaphoreTake(lookup_mutex, 0)) {
+            return false;
+        } else if (foreground_lookups) {
+            xSemaphoreGive(lookup_mutex);
+            return false;
+        }
+    }
+
+    IPAddress ip;
+    uint32_t start_us = micros();
+    bool ok = WiFi.hostByName(host, ip) == 1 && (uint32_t)ip != 0;
+    metric_lookup.observe(micros() - start_us);
+
+    if (lookup_mutex) {
+        xSemaphoreGive(lookup_mutex);
+    }
+    if (foreground) {
+        portENTER_CRITICAL(&cache_lock);
+        foreground_lookups--;
+        portEXIT_CRITICAL(&cache_lock);
+    }
+    if (!ok) {
+        metric_failures.inc();
+        return false;
+    }
+    address = (uint32_t)ip;
+    return true;
+}
+
+void store(const char* host, bool ok, uint32_t address) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&cache_lock);
+    int slot = claimLocked(host, now);
+    Entry& e = entries[slot];
+    if (ok) {
+        e.address = address;
+        e.resolved_ms = now;
+        e.refresh_ms = now + DNSCACHE_TTL_MS - REFRESH_AHEAD_MS;
+    } else {
+        e.refresh_ms = now + DNSCACHE_RETRY_MS;
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void refreshTaskEntry(void*) {
+    char host[DNSCACHE_HOST_LEN];
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        if (WiFi.status() != WL_CONNECTED) {
+            continue;
+        }
+
+        // Most overdue entry first
+        uint32_t now = millis();
+        host[0] = '\0';
+        portENTER_CRITICAL(&cache_lock);
+        int due = -1;
+        for (int i = 0; i < DNSCACHE_ENTRIES; i++) {
+            if (entries[i].host[0] && isDue(entries[i].refresh_ms, now) &&
+                (due < 0 || (int32_t)(entries[i].refresh_ms - entries[due].refresh_ms) < 0)) {
+                due = i;
+            }
+        }
+        if (due >= 0) {
+            strcpy(host, entries[due].host);
+        }
+        portEXIT_CRITICAL(&cache_lock);
+
+        // Skipped while a caller is resolving: the entry stays due for the next pass
+        if (host[0] && !foreground_lookups) {
+            uint32_t address = 0;
+            if (lookup(host, address, false)) {
+                store(host, true, address);
+            } else if (!foreground_lookups) {
+                store(host, false, 0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+namespace DnsCache {
+
+bool begin() {
+    if (refresh_task) {
+        return true;
+    }
+
+    lookup_mutex = xSemaphoreCreateMutex();
+    if (!lookup_mutex) {
+        Serial.println("DnsCache: Error - Failed to create lookup mutex");
+        return false;
+    }
+
+    // Low priority, either core: lookups block on the network, not on the sign
+    BaseType_t result = xTaskCreate(refreshTaskEntry, "dns", 4096, nullptr, 1, &refresh_task);
+    if (result != pdPASS) {
+        Serial.println("DnsCache: Error - Failed to create refresh task");
+        refresh_task = nullptr;
+        return false;
+    }
+
+    Serial.println("DnsCache: Initialized");
+    return true;
+}
+
+bool resolve(const char* host, IPAddress& address, bool* cached) {
+    if (cached) {
+        *cached = true;
+    }
+    if (address.fromString(host)) {
+        return true;
+    }
+    if (strlen(host) >= DNSCACHE_HOST_LEN) {
+        // Too long to cache: plain lookup every time
+        if (cached) {
+            *cached = false;
+        }
+        uint32_t value = 0;
+        bool ok = lookup(host, value, true);
+        address = IPAddress(value);
+        return ok;
+    }
+
+    uint32_t now = millis();
+    uint32_t value = 0;
+    uint32_t age_ms = 0;
+
+    portENTER_CRITICAL(&cache_lock);
+    int slot = findLocked(host);
+    if (slot >= 0 && entries[slot].address) {
+        Entry& e = entries[slot];
+        value = e.address;
+        age_ms = now - e.resolved_ms;
+        e.used_ms = now;
+        if (age_ms >= DNSCACHE_TTL_MS && !isDue(e.refresh_ms, now)) {
+            // Expired between refreshes (task stalled or WiFi was down): refresh now
+            e.refresh_ms = now;
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+
+    if (value && age_ms < DNSCACHE_TTL_MS) {
+        metric_hits.inc();
+        address = IPAddress(value);
+        return true;
+    }
+    if (value && age_ms < DNSCACHE_MAX_STALE_MS) {
+        metric_stale.inc();
+        address = IPAddress(value);
+        return true;
+    }
+
+    // Never resolved, or too old to trust without asking: the caller waits
+    if (cached) {
+        *cached = false;
+    }
+    metric_misses.inc();
+    uint32_t fresh = 0;
+    bool ok = lookup(host, fresh, true);
+    store(host, ok, fresh);
+    if (ok) {
+        address = IPAddress(fresh);
+        return true;
+    }
+    if (value) {
+        // DNS is down: the last good address beats no address
+        address = IPAddress(value);
+        return true;
+    }
+    return false;
+}
+
+void prefetch(const char* host) {
+    IPAddress literal;
+    if (!host || !host[0] || strlen(host) >= DNSCACHE_HOST_LEN || literal.fromString(host)) {
+        return;
+    }
+    uint32_t now = millis();
+    portENTER_CRITICAL(&cache_lock);
+    int slot = claimLocked(host, now);
+    if (!entries[slot].address) {
+        entries[slot].refresh_ms = now;
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+String getStatus() {
+    uint8_t hosts = 0;
+    uint8_t resolved = 0;
+    portENTER_CRITICAL(&cache_lock);
+    for (int i = 0; i < DNSCACHE_ENTRIES; i++) {
+        if (entries[i].host[0]) {
+            hosts++;
+            if (entries[i].address) {
+                resolved++;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+
+    return String(resolved) + "/" + String(hosts) + " hosts resolved, " +
+           String(metric_hits.get()) + " hits, " + String(metric_stale.get()) + " stale, " +
+           String(metric_misses.get()) + " misses, " + String(metric_failures.get()) + " failures" +
+           (refresh_task ? "" : " (no refresh task)");
+}
+
+} // namespace DnsCache
+
+/////////////////////////////////////////////
+// Clients
+/////////////////////////////////////////////
+
+int DnsCachedClient::connect(const char* host, uint16_t port) {
+    IPAddress address;
+    uint32_t start_us = micros();
+    bool ok = DnsCache::resolve(host, address, &timing.dns_cached);
+    timing.dns_us = micros() - start_us;
+    timing.connect_us = 0;
+    timing.tls_us = 0;
+    if (!ok) {
+        return 0;
+    }
+
+    start_us = micros();
+    int result = WiFiClient::connect(address, port);
+    timing.connect_us = micros() - start_us;
+    return result;
+}
+
+int DnsCachedClient::connect(const char* host, uint16_t port, int32_t timeout_ms) {
+    IPAddress address;
+    uint32_t start_us = micros();
+    bool ok = DnsCache::resolve(host, address, &timing.dns_cached);
+    timing.dns_us = micros() - start_us;
+    timing.connect_us = 0;
+    timing.tls_us = 0;
+    if (!ok) {
+        return 0;
+    }
+
+    start_us = micros();
+    int result = WiFiClient::connect(address, port, timeout_ms);
+    timing.connect_us = micros() - start_us;
+    return result;
+}
+
+int DnsCachedClientSecure::connect(const char* host, uint16_t port) {
+    if (_pskIdent && _psKey) {
+        // PSK sessions keep the library path
+        return WiFiClientSecure::connect(host, port);
+    }
+
+    IPAddress address;
+    uint32_t start_us = micros();
+    bool ok = DnsCache::resolve(host, address, &timing.dns_cached);
+    timing.dns_us = micros() - start_us;
+    timing.connect_us = 0;
+    timing.tls_us = 0;
+    if (!ok) {
+        return 0;
+    }
+
+    // Same call WiFiClientSecure makes after its own lookup; host keeps SNI and name checks.
+    // Plain start stops it after the TCP connect so startTLS() can time the handshake alone.
+    setPlainStart();
+    start_us = micros();
+    int result = WiFiClientSecure::connect(address, port, host, _CA_cert, _cert, _private_key);
+    timing.connect_us = micros() - start_us;
+    if (result <= 0) {
+        return result;
+    }
+
+    start_us = micros();
+    result = startTLS();
+    timing.tls_us = micros() - start_us;
+    if (result <= 0) {
+        stop();
+    }
+    return result;
+}
+
+int DnsCachedClientSecure::connect(const char* host, uint16_t port, int32_t timeout_ms) {
+    _timeout = timeout_ms;
+    return connect(host, port);
+}
@@ -0,0 +1,457 @@
+/**
+ * @file EspNowReceiver.cpp
+ * @brief Implementation of the ESP-NOW command channel for the handheld remote
+ *
+ * The receive callback runs in the WiFi task and must return quickly, so it
+ * only validates framing and queues the command. Peer checks, pairing,
+ * de-duplication, sign writes and acks all happen in loop().
+ *
+ * The virtual-clock build (SIM_CLOCK) has no radio. The transport calls
+ * (peer table, send) become stand-ins: frames arrive through injectFrame(),
+ * acks are logged as SIM events and complete at once, and paired peers are
+ * not persisted, so each run starts unpaired.
+ */
+
+#include "defines.h"
+#include "EspNowReceiver.h"
+#include "SimClock.h"
+#include <esp_timer.h>
+
+// Static instance pointer for callback routing
+EspNowReceiver* EspNowReceiver::instance = nullptr;
+
+namespace {
+// Keys earlier releases shipped as defaults; they are public, so never accept them
+const char* const PUBLISHED_KEYS[] = {"ledSignRemotePMK", "ledSignRemoteLMK"};
+
+bool isPublishedKey(const uint8_t* key) {
+    for (const char* published : PUBLISHED_KEYS) {
+        if (memcmp(key, published, ESP_NOW_KEY_LEN) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+EspNowReceiver::EspNowReceiver()
+    : peer_count(0), initialized(false), pairing_until(0), rx_queue(nullptr),
+      pair_ack_inflight(false), encrypt_pending(false) {
+    memset(peers, 0, sizeof(peers));
+    memset(encrypt_mac, 0, sizeof(encrypt_mac));
+    memset(pmk, 0, sizeof(pmk));
+    memset(lmk, 0, sizeof(lmk));
+    memset(&stats, 0, sizeof(stats));
+    stats.latency_min_us = UINT32_MAX;
+    instance = this;
+}
+
+EspNowReceiver::~EspNowReceiver() {
+#ifndef SIM_CLOCK
+    if (initialized) {
+        esp_now_deinit();
+    }
+#endif
+    if (rx_queue) {
+        vQueueDelete(rx_queue);
+    }
+    instance = nullptr;
+}
+
+bool EspNowReceiver::begin() {
+    if (initialized) {
+        return true;
+    }
+
+#ifdef SIM_CLOCK
+    // No radio and no encryption: scenario frames go straight to the queue
+    rx_queue = xQueueCreate(ESPNOW_QUEUE_DEPTH, sizeof(Command));
+    if (rx_queue == nullptr) {
+        Serial.println("EspNowReceiver: Error - Failed to create command queue");
+        return false;
+    }
+    initialized = true;
+    Serial.println("EspNowReceiver: Simulated transport, no paired remotes");
+    return true;
+#endif
+
+    if (!loadKeys()) {
+        Serial.println("EspNowReceiver: Error - No encryption keys (set ESPNOW_PMK/ESPNOW_LMK in Credentials.h "
+                       "or provision them in NVS) - remote disabled");
+        return false;
+    }
+
+    rx_queue = xQueueCreate(ESPNOW_QUEUE_DEPTH, sizeof(Command));
+    if (rx_queue == nullptr) {
+        Serial.println("EspNowReceiver: Error - Failed to create command queue");
+        return false;
+    }
+
+    if (esp_now_init() != ESP_OK) {
+        Serial.println("EspNowReceiver: Error - esp_now_init failed");
+        return false;
+    }
+
+    esp_now_set_pmk(pmk);
+    esp_now_register_recv_cb(onReceive);
+    esp_now_register_send_cb(onSent);
+    initialized = true;
+
+    loadPeers();
+
+    Serial.print("EspNowReceiver: Initialized on channel ");
+    Serial.print(WiFi.channel());
+    Serial.print(", ");
+    Serial.print(peer_count);
+    Serial.println(" paired remote(s)");
+    return true;
+}
+
+bool EspNowReceiver::loadKeys() {
+#if defined(ESPNOW_PMK) && defined(ESPNOW_LMK)
+    static_assert(sizeof(ESPNOW_PMK) == ESP_NOW_KEY_LEN + 1 && sizeof(ESPNOW_LMK) == ESP_NOW_KEY_LEN + 1,
+                  "ESPNOW_PMK and ESPNOW_LMK must be 16 characters");
+    memcpy(pmk, ESPNOW_PMK, ESP_NOW_KEY_LEN);
+    memcpy(lmk, ESPNOW_LMK, ESP_NOW_KEY_LEN);
+#else
+    prefs.begin(ESPNOW_NVS_NAMESPACE, true);
+    bool found = prefs.getBytes("pmk", pmk, sizeof(pmk)) == sizeof(pmk) &&
+                 prefs.getBytes("lmk", lmk, sizeof(lmk)) == sizeof(lmk);
+    prefs.end();
+    if (!found) {
+        return false;
+    }
+#endif
+    if (isPublishedKey(pmk) || isPublishedKey(lmk)) {
+        Serial.println("EspNowReceiver: Error - Refusing the published default keys");
+        return false;
+    }
+    return true;
+}
+
+void EspNowReceiver::setCommandCallback(CommandCallback callback) {
+    command_callback = callback;
+}
+
+void EspNowReceiver::openPairingWindow(unsigned long duration_ms) {
+    pairing_until = SimClock::millis() + duration_ms;
+    if (pairing_until == 0) pairing_until = 1;  // 0 means closed
+    Serial.print("EspNowReceiver: Pairing window open for ");
+    Serial.print(duration_ms / 1000);
+    Serial.println(" seconds");
+    SIM_EVENT("espnow", "pairing open " + String(duration_ms / 1000) + "s");
+}
+
+bool EspNowReceiver::isPairing() const {
+    return pairing_until != 0 && (long)(pairing_until - SimClock::millis()) > 0;
+}
+
+void EspNowReceiver::clearPeers() {
+    for (int i = 0; i < peer_count; i++) {
+        delEspNowPeer(peers[i].mac);
+    }
+    memset(peers, 0, sizeof(peers));
+    peer_count = 0;
+    savePeers();
+    Serial.println("EspNowReceiver: All paired remotes removed");
+}
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+void EspNowReceiver::onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+    if (instance) instance->enqueue(info->src_addr, data, len);
+}
+#else
+void EspNowReceiver::onReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    if (instance) instance->enqueue(mac, data, len);
+}
+#endif
+
+#ifdef SIM_CLOCK
+void EspNowReceiver::injectFrame(const uint8_t* mac, const uint8_t* data, int len) {
+    enqueue(mac, data, len);
+}
+#endif
+
+void EspNowReceiver::onSent(const uint8_t* mac, esp_now_send_status_t status) {
+    (void)status;
+    // Pair ack has left the radio in plaintext; switch the peer to encrypted from loop()
+    if (instance && instance->pair_ack_inflight && memcmp(mac, instance->encrypt_mac, 6) == 0) {
+        instance->pair_ack_inflight = false;
+        instance->encrypt_pending = true;
+    }
+}
+
+void EspNowReceiver::enqueue(const uint8_t* mac, const uint8_t* data, int len) {
+    int64_t rx_us = esp_timer_get_time();
+
+    if (len < (int)HEADER_SIZE || data[0] != FRAME_MAGIC || data[1] != PROTOCOL_VERSION ||
+        data[8] > ESPNOW_MAX_TEXT || (int)HEADER_SIZE + data[8] != len) {
+        stats.rejected++;
+        SIM_EVENT("espnow", "rejected malformed frame (" + String(len) + " bytes)");
+        return;
+    }
+
+    Command cmd;
+    memcpy(cmd.mac, mac, 6);
+    cmd.type = data[2];
+    cmd.flags = data[3];
+    cmd.seq = (uint16_t)(data[4] | (data[5] << 8));
+    cmd.preset = data[6];
+    cmd.arg = data[7];
+    memcpy(cmd.text, &data[HEADER_SIZE], data[8]);
+    cmd.text[data[8]] = '\0';
+    cmd.rx_us = rx_us;
+
+    if (xQueueSend(rx_queue, &cmd, 0) != pdTRUE) {
+        stats.dropped++;
+        return;
+    }
+    stats.received++;
+}
+
+void EspNowReceiver::loop() {
+    if (!initialized) {
+        return;
+    }
+
+    if (pairing_until != 0 && !isPairing()) {
+        pairing_until = 0;
+        Serial.println("EspNowReceiver: Pairing window closed");
+        SIM_EVENT("espnow", "pairing closed");
+    } else if (pairing_until != 0) {
+        SimClock::wakeAt(pairing_until);
+    }
+
+    if (encrypt_pending) {
+        if (addEspNowPeer(encrypt_mac, true)) {
+            Serial.println("EspNowReceiver: Paired remote now encrypted");
+        }
+        memset(encrypt_mac, 0, sizeof(encrypt_mac));
+        encrypt_pending = false;
+    }
+
+    Command cmd;
+    while (xQueueReceive(rx_queue, &cmd, 0) == pdTRUE) {
+        if (cmd.type == ESPNOW_CMD_PAIR) {
+            handlePair(cmd);
+            continue;
+        }
+
+        Peer* peer = findPeer(cmd.mac);
+        if (peer == nullptr) {
+            // Unpaired senders get no reply (nothing to encrypt it with)
+            stats.rejected++;
+            SIM_EVENT("espnow", "rejected unpaired " + macString(cmd.mac));
+            continue;
+        }
+
+        if (peer->has_seq && peer->last_seq == cmd.seq) {
+            // Remote missed our ack and retransmitted
+            stats.duplicates++;
+            sendAck(cmd.mac, ESPNOW_ACK_DUPLICATE, cmd.seq, 0);
+            continue;
+        }
+
+        uint8_t status;
+        if (cmd.type == ESPNOW_CMD_PING) {
+            status = ESPNOW_ACK_OK;
+        } else if (cmd.type == ESPNOW_CMD_TEXT || cmd.type == ESPNOW_CMD_CLEAR ||
+                   cmd.type == ESPNOW_CMD_COUNTDOWN) {
+            bool ok = command_callback ? command_callback(cmd) : false;
+            status = ok ? ESPNOW_ACK_OK : ESPNOW_ACK_FAILED;
+        } else {
+            sendAck(cmd.mac, ESPNOW_ACK_INVALID, cmd.seq, 0);
+            continue;
+        }
+
+        peer->last_seq = cmd.seq;
+        peer->has_seq = true;
+
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - cmd.rx_us);
+        if (cmd.type != ESPNOW_CMD_PING && status == ESPNOW_ACK_OK) {
+            stats.executed++;
+            recordLatency(latency_us);
+        }
+
+        uint32_t latency_ms = latency_us / 1000;
+        sendAck(cmd.mac, status, cmd.seq, latency_ms > 0xFFFF ? 0xFFFF : (uint16_t)latency_ms);
+    }
+}
+
+void EspNowReceiver::handlePair(const Command& cmd) {
+    if (findPeer(cmd.mac) != nullptr) {
+        // Already paired (remote lost its state); re-ack over the encrypted link
+        sendAck(cmd.mac, ESPNOW_ACK_PAIRED, cmd.seq, 0);
+        return;
+    }
+
+    if (!isPairing()) {
+        stats.rejected++;
+        SIM_EVENT("espnow", "pair refused, window closed " + macString(cmd.mac));
+        return;
+    }
+
+    if (peer_count >= ESPNOW_MAX_PEERS) {
+        Serial.println("EspNowReceiver: Pairing refused - peer table full");
+        if (addEspNowPeer(cmd.mac, false)) {
+            sendAck(cmd.mac, ESPNOW_ACK_PAIR_FULL, cmd.seq, 0);
+            delEspNowPeer(cmd.mac);
+        }
+        return;
+    }
+
+    // Register in plaintext so the pair ack can reach a remote that has no key yet
+    if (!addEspNowPeer(cmd.mac, false)) {
+        Serial.println("EspNowReceiver: Error - Failed to add peer");
+        return;
+    }
+
+    Peer& peer = peers[peer_count++];
+    memcpy(peer.mac, cmd.mac, 6);
+    peer.has_seq = false;
+    savePeers();
+
+    memcpy(encrypt_mac, cmd.mac, 6);
+    pair_ack_inflight = true;
+    sendAck(cmd.mac, ESPNOW_ACK_PAIRED, cmd.seq, 0);
+
+    pairing_until = 0;  // One remote per window
+    Serial.printf("EspNowReceiver: Paired remote %02X:%02X:%02X:%02X:%02X:%02X\n",
+                  cmd.mac[0], cmd.mac[1], cmd.mac[2], cmd.mac[3], cmd.mac[4], cmd.mac[5]);
+    SIM_EVENT("espnow", "paired " + macString(cmd.mac));
+}
+
+void EspNowReceiver::sendAck(const uint8_t* mac, uint8_t status, uint16_t seq, uint16_t latency_ms) {
+    uint8_t ack[9];
+    ack[0] = ACK_MAGIC;
+    ack[1] = PROTOCOL_VERSION;
+    ack[2] = ESPNOW_CMD_ACK;
+    ack[3] = status;
+    ack[4] = seq & 0xFF;
+    ack[5] = seq >> 8;
+    ack[6] = latency_ms & 0xFF;
+    ack[7] = latency_ms >> 8;
+    ack[8] = (uint8_t)WiFi.channel();  // Lets the remote follow AP channel changes
+#ifdef SIM_CLOCK
+    // Latency is real time, so it stays out of the log to keep runs diffable
+    SIM_EVENT("espnow", "ack " + macString(mac) + " seq " + String(seq) + " status " + String(status));
+    onSent(mac, ESP_NOW_SEND_SUCCESS);
+#else
+    esp_now_send(mac, ack, sizeof(ack));
+#endif
+}
+
+EspNowReceiver::Peer* EspNowReceiver::findPeer(const uint8_t* mac) {
+    for (int i = 0; i < peer_count; i++) {
+        if (memcmp(peers[i].mac, mac, 6) == 0) {
+            return &peers[i];
+        }
+    }
+    return nullptr;
+}
+
+bool EspNowReceiver::addEspNowPeer(const uint8_t* mac, bool encrypt) {
+#ifdef SIM_CLOCK
+    (void)mac;
+    (void)encrypt;
+    return true;  // The receiver's own table is the whole peer list here
+#else
+    esp_now_peer_info_t info;
+    memset(&info, 0, sizeof(info));
+    memcpy(info.peer_addr, mac, 6);
+    info.channel = 0;  // Follow the station's current channel
+    info.ifidx = WIFI_IF_STA;
+    info.encrypt = encrypt;
+    if (encrypt) {
+        memcpy(info.lmk, lmk, ESP_NOW_KEY_LEN);
+    }
+
+    if (esp_now_is_peer_exist(mac)) {
+        return esp_now_mod_peer(&info) == ESP_OK;
+    }
+    return esp_now_add_peer(&info) == ESP_OK;
+#endif
+}
+
+void EspNowReceiver::delEspNowPeer(const uint8_t* mac) {
+#ifndef SIM_CLOCK
+    esp_now_del_peer(mac);
+#else
+    (void)mac;
+#endif
+}
+
+void EspNowReceiver::loadPeers() {
+#ifdef SIM_CLOCK
+    return;  // Every run starts unpaired
+#endif
+    prefs.begin(ESPNOW_NVS_NAMESPACE, true);
+    uint8_t count = prefs.getUChar("count", 0);
+    if (count > ESPNOW_MAX_PEERS) count = 0;
+
+    uint8_t macs[ESPNOW_MAX_PEERS * 6];
+    if (count > 0 && prefs.getBytes("peers", macs, count * 6) != (size_t)count * 6) {
+        count = 0;
+    }
+    prefs.end();
+
+    peer_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (addEspNowPeer(&macs[i * 6], true)) {
+            memcpy(peers[peer_count].mac, &macs[i * 6], 6);
+            peers[peer_count].has_seq = false;
+            peer_count++;
+        }
+    }
+}
+
+void EspNowReceiver::savePeers() {
+#ifdef SIM_CLOCK
+    return;  // Leave the board's real pairings alone
+#endif
+    uint8_t macs[ESPNOW_MAX_PEERS * 6];
+    for (int i = 0; i < peer_count; i++) {
+        memcpy(&macs[i * 6], peers[i].mac, 6);
+    }
+
+    prefs.begin(ESPNOW_NVS_NAMESPACE, false);
+    prefs.putUChar("count", (uint8_t)peer_count);
+    if (peer_count > 0) {
+        prefs.putBytes("peers", macs, peer_count * 6);
+    } else {
+        prefs.remove("peers");
+    }
+    prefs.end();
+}
+
+String EspNowReceiver::macString(const uint8_t* mac) {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return String(text);
+}
+
+void EspNowReceiver::recordLatency(uint32_t latency_us) {
+    if (latency_us < stats.latency_min_us) stats.latency_min_us = latency_us;
+    if (latency_us > stats.latency_max_us) stats.latency_max_us = latency_us;
+    stats.latency_sum_us += latency_us;
+}
+
+String EspNowReceiver::getStatus() const {
+    if (!initialized) {
+        return "Disabled";
+    }
+
+    String status = String(peer_count) + " peer(s)";
+    if (isPairing()) status += " [pairing]";
+    status += ", executed=" + String(stats.executed);
+    status += " dup=" + String(stats.duplicates);
+    status += " rejected=" + String(stats.rejected);
+    status += " dropped=" + String(stats.dropped);
+    if (stats.executed > 0) {
+        status += ", rx->sign us min/avg/max=";
+        status += String(stats.latency_min_us) + "/";
+        status += String((uint32_t)(stats.latency_sum_us / stats.executed)) + "/";
+        status += String(stats.latency_max_us);
+    }
+    return status;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file EspNowReceiver.h
+ * @brief ESP-NOW command channel for the handheld remote
+ *
+ * Gives the handheld remote (see handheld-remote/PROJECT_PLAN.md) a direct
+ * radio path to the sign that bypasses WiFi association, the broker and JSON:
+ * - Compact binary command frames (preset + text, clear, countdown, ping)
+ * - Pairing window (from Home Assistant or a long press of the pair button)
+ *   that adds the remote as an encrypted peer; the peer list persists in NVS
+ *   via Preferences
+ * - No built-in keys: ESPNOW_PMK/ESPNOW_LMK come from Credentials.h or from
+ *   16-byte "pmk"/"lmk" entries provisioned in the "espnow" NVS namespace.
+ *   Without either, begin() fails and the remote stays disabled
+ * - Per-peer sequence numbers with ack replies; retransmits are re-acked
+ *   without being displayed twice
+ * - Receive callback only copies into a FreeRTOS queue; commands are executed
+ *   from loop() so sign writes never happen in the WiFi task
+ * - Receive-to-sign latency is measured for every command and returned in the ack
+ * - The virtual-clock build swaps the radio for a stand-in: scenario "espnow"
+ *   lines inject frames (injectFrame()) and acks are logged as SIM events
+ *
+ * Frame layout (little-endian, both ends are ESP32):
+ * | Offset | Size | Field                                          |
+ * |--------|------|------------------------------------------------|
+ * | 0      | 1    | Magic 'B' (command) / 'b' (ack)                |
+ * | 1      | 1    | Version (1)                                    |
+ * | 2      | 1    | Type (EspNowCommandType)                       |
+ * | 3      | 1    | Flags (bit0 = priority)                        |
+ * | 4      | 2    | Sequence number                                |
+ * | 6      | 1    | Preset (0=info, 1=notice, 2=warning, 3=critical)|
+ * | 7      | 1    | Argument (duration or countdown seconds)       |
+ * | 8      | 1    | Text length N                                  |
+ * | 9      | N    | Text (not NUL-terminated)                      |
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef ESPNOW_RECEIVER_H
+#define ESPNOW_RECEIVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <functional>
+
+// ESP-NOW configuration constants (from defines.h)
+#ifndef ESPNOW_MAX_PEERS
+#define ESPNOW_MAX_PEERS          4
+#endif
+#ifndef ESPNOW_QUEUE_DEPTH
+#define ESPNOW_QUEUE_DEPTH        8
+#endif
+#define ESPNOW_MAX_TEXT           240     ///< 250-byte ESP-NOW limit minus 9-byte header
+#define ESPNOW_NVS_NAMESPACE      "espnow"
+
+/**
+ * @brief Command types carried in the frame type byte
+ */
+enum EspNowCommandType : uint8_t {
+    ESPNOW_CMD_PAIR      = 0x01,  ///< Request pairing (only honoured while window is open)
+    ESPNOW_CMD_PING      = 0x02,  ///< Link check, acked without touching the sign
+    ESPNOW_CMD_TEXT      = 0x10,  ///< Display text using a style preset
+    ESPNOW_CMD_CLEAR     = 0x11,  ///< Clear the sign
+    ESPNOW_CMD_COUNTDOWN = 0x12,  ///< Start a countdown of arg seconds
+    ESPNOW_CMD_ACK       = 0x80   ///< Controller -> remote reply
+};
+
+/**
+ * @brief Ack status codes
+ */
+enum EspNowAckStatus : uint8_t {
+    ESPNOW_ACK_OK        = 0,     ///< Command executed
+    ESPNOW_ACK_DUPLICATE = 1,     ///< Retransmit of an already executed command
+    ESPNOW_ACK_FAILED    = 2,     ///< Command rejected by the sign layer
+    ESPNOW_ACK_INVALID   = 3,     ///< Malformed or unknown command
+    ESPNOW_ACK_PAIRED    = 4,     ///< Pairing accepted
+    ESPNOW_ACK_PAIR_FULL = 5      ///< Pairing refused, peer table full
+};
+
+/**
+ * @brief ESP-NOW receiver with pairing, de-duplication and latency tracking
+ */
+class EspNowReceiver {
+public:
+    static const uint8_t FRAME_MAGIC = 'B';
+    static const uint8_t ACK_MAGIC = 'b';
+    static const uint8_t PROTOCOL_VERSION = 1;
+    static const size_t HEADER_SIZE = 9;
+    static const uint8_t FLAG_PRIORITY = 0x01;
+
+    /**
+     * @brief Decoded command handed to the application
+     */
+    struct Command {
+        uint8_t mac[6];                    ///< Sender address
+        uint8_t type;                      ///< EspNowCommandType
+        uint8_t flags;                     ///< FLAG_* bits
+        uint16_t seq;                      ///< Sender sequence number
+        uint8_t preset;                    ///< Style preset index
+        uint8_t arg;                       ///< Duration / countdown seconds
+        char text[ESPNOW_MAX_TEXT + 1];    ///< NUL-terminated text
+        int64_t rx_us;                     ///< esp_timer timestamp at radio receive
+    };
+
+    /**
+     * @brief Latency and traffic counters
+     */
+    struct Stats {
+        uint32_t received;       ///< Frames accepted into the queue
+        uint32_t executed;       ///< Commands executed on the sign
+        uint32_t duplicates;     ///< Retransmits re-acked without execution
+        uint32_t rejected;       ///< Malformed frames or unpaired senders
+        uint32_t dropped;        ///< Queue full in receive callback
+        uint32_t latency_min_us; ///< Fastest receive-to-sign time
+        uint32_t latency_max_us; ///< Slowest receive-to-sign time
+        uint64_t latency_sum_us; ///< Sum for averaging over executed
+    };
+
+    /**
+     * @brief Application handler; return false to ack ESPNOW_ACK_FAILED
+     */
+    using CommandCallback = std::function<bool(const Command& cmd)>;
+
+    EspNowReceiver();
+    ~EspNowReceiver();
+
+    /**
+     * @brief Initialize ESP-NOW, restore paired peers and register callbacks
+     *
+     * WiFi must already be in STA mode. ESP-NOW keeps working if the
+     * access point is later lost, on the channel last used by the station.
+     *
+     * @return true if ESP-NOW started; false if no keys are configured
+     */
+    bool begin();
+
+    /**
+     * @brief Set handler for executed commands
+     * @param callback Function invoked from loop() for each new command
+     */
+    void setCommandCallback(CommandCallback callback);
+
+    /**
+     * @brief Accept pairing requests for a limited time
+     * @param duration_ms Window length in milliseconds
+     */
+    void openPairingWindow(unsigned long duration_ms);
+
+    /**
+     * @brief Check whether pairing requests are currently accepted
+     * @return true if the pairing window is open
+     */
+    bool isPairing() const;
+
+    /**
+     * @brief Remove all paired remotes (RAM, ESP-NOW and NVS)
+     */
+    void clearPeers();
+
+    /**
+     * @brief Execute queued commands and send acks - call from the main loop
+     */
+    void loop();
+
+    /**
+     * @brief Get the number of paired remotes
+     * @return Peer count
+     */
+    int getPeerCount() const { return peer_count; }
+
+    /**
+     * @brief Get traffic and latency counters
+     * @return Reference to statistics
+     */
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief Get human-readable status for health logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+#ifdef SIM_CLOCK
+    /**
+     * @brief Deliver a frame as if the radio had received it (virtual-clock build)
+     * @param mac Sender address
+     * @param data Frame bytes (layout above)
+     * @param len Frame length
+     */
+    void injectFrame(const uint8_t* mac, const uint8_t* data, int len);
+#endif
+
+    // Static instance pointer for callback routing
+    static EspNowReceiver* instance;
+
+private:
+    /**
+     * @brief Paired remote state
+     */
+    struct Peer {
+        uint8_t mac[6];       ///< Remote address
+        uint16_t last_seq;    ///< Last executed sequence number
+        bool has_seq;         ///< Whether last_seq is valid
+    };
+
+    Peer peers[ESPNOW_MAX_PEERS];
+    int peer_count;
+    bool initialized;
+    unsigned long pairing_until;          ///< millis() deadline, 0 = closed
+    QueueHandle_t rx_queue;               ///< Command queue filled from the WiFi task
+    volatile bool pair_ack_inflight;      ///< Plaintext pair ack queued for encrypt_mac
+    volatile bool encrypt_pending;        ///< Pair ack sent, switch encrypt_mac to encrypted
+    uint8_t encrypt_mac[6];
+    uint8_t pmk[ESP_NOW_KEY_LEN];         ///< Primary master key
+    uint8_t lmk[ESP_NOW_KEY_LEN];         ///< Local master key for paired peers
+    Stats stats;
+    Preferences prefs;
+    CommandCallback command_callback;
+
+    /**
+     * @brief ESP-NOW receive callback (WiFi task context - copy and return)
+     */
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    static void onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int len);
+#else
+    static void onReceive(const uint8_t* mac, const uint8_t* data, int len);
+#endif
+
+    /**
+     * @brief ESP-NOW send-complete callback (WiFi task context)
+     */
+    static void onSent(const uint8_t* mac, esp_now_send_status_t status);
+
+    bool loadKeys();
+    void enqueue(const uint8_t* mac, const uint8_t* data, int len);
+    void handlePair(const Command& cmd);
+    void sendAck(const uint8_t* mac, uint8_t status, uint16_t seq, uint16_t latency_ms);
+    Peer* findPeer(const uint8_t* mac);
+    bool addEspNowPeer(const uint8_t* mac, bool encrypt);
+    void delEspNowPeer(const uint8_t* mac);
+    void loadPeers();
+    void savePeers();
+    void recordLatency(uint32_t latency_us);
+    static String macString(const uint8_t* mac);
+};
+
+#endif // ESPNOW_RECEIVER_H
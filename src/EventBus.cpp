@@ -0,0 +1,155 @@
+/**
+ * @file EventBus.cpp
+ * @brief Lock-free event queue and static subscriber table
+ *
+ * The queue is a bounded ring of slots, each carrying a sequence number
+ * (Vyukov's bounded queue, single consumer): a producer claims a position
+ * with one CAS on enqueue_pos, writes the slot, then publishes it by storing
+ * position + 1 in the slot's sequence. The consumer takes a slot only once
+ * its sequence says it is complete, and frees it for the next lap by storing
+ * position + EVENTBUS_QUEUE_SIZE.
+ *
+ * Sequences are stored relative to the slot index, so the zero-initialized
+ * table is already the empty queue and no init call is needed.
+ */
+
+#include "defines.h"
+#include <EventBus.h>
+#include <atomic>
+#include "Metrics.h"
+
+static_assert((EVENTBUS_QUEUE_SIZE & (EVENTBUS_QUEUE_SIZE - 1)) == 0, "EVENTBUS_QUEUE_SIZE must be a power of two");
+static_assert(EVT_TYPE_COUNT <= 32, "Event types must fit a 32-bit subscription mask");
+
+namespace {
+
+struct Slot {
+    std::atomic<uint32_t> sequence;       // Minus the slot index (see loadSequence)
+    Event event;
+};
+
+struct Subscriber {
+    uint32_t mask;
+    EventHandler handler;
+    void* context;
+};
+
+const uint32_t QUEUE_MASK = EVENTBUS_QUEUE_SIZE - 1;
+
+Slot slots[EVENTBUS_QUEUE_SIZE];
+std::atomic<uint32_t> enqueue_pos(0);
+uint32_t dequeue_pos = 0;                 // Consumer (main task) only
+
+Subscriber subscribers[EVENTBUS_MAX_SUBSCRIBERS];
+uint8_t subscriber_count = 0;
+
+uint32_t max_latency_us = 0;
+
+const uint32_t LATENCY_BOUNDS_US[] = {100, 500, 1000, 5000, 10000, 50000, 100000, 500000};
+
+MetricCounter metric_published("ledsign_events_published_total", "Events queued on the event bus");
+MetricCounter metric_dropped("ledsign_events_dropped_total", "Events dropped because the queue was full");
+MetricGauge metric_depth_max("ledsign_event_queue_depth_max", "Most events seen waiting at one dispatch");
+MetricHistogram metric_latency("ledsign_event_dispatch_latency_microseconds",
+                               "Time from publish to delivery",
+                               LATENCY_BOUNDS_US, sizeof(LATENCY_BOUNDS_US) / sizeof(LATENCY_BOUNDS_US[0]));
+
+// Slot i starts free for the producer that claims position i
+inline uint32_t loadSequence(uint32_t pos) {
+    return slots[pos & QUEUE_MASK].sequence.load(std::memory_order_acquire) + (pos & QUEUE_MASK);
+}
+
+inline void storeSequence(uint32_t pos, uint32_t sequence) {
+    slots[pos & QUEUE_MASK].sequence.store(sequence - (pos & QUEUE_MASK), std::memory_order_release);
+}
+
+} // namespace
+
+namespace EventBus {
+
+bool publish(EventType type, int32_t value) {
+    uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    for (;;) {
+        slot = &slots[pos & QUEUE_MASK];
+        int32_t diff = (int32_t)(loadSequence(pos) - pos);
+        if (diff == 0) {
+            // Slot free for this lap: claim the position
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer is a full lap behind
+            metric_dropped.inc();
+            return false;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->event.type = type;
+    slot->event.value = value;
+    slot->event.posted_us = micros();
+    storeSequence(pos, pos + 1);
+    metric_published.inc();
+    return true;
+}
+
+bool subscribe(uint32_t mask, EventHandler handler, void* context) {
+    if (!handler || subscriber_count >= EVENTBUS_MAX_SUBSCRIBERS) {
+        Serial.println("EventBus: Subscriber table full");
+        return false;
+    }
+    subscribers[subscriber_count].mask = mask;
+    subscribers[subscriber_count].handler = handler;
+    subscribers[subscriber_count].context = context;
+    subscriber_count++;
+    return true;
+}
+
+uint16_t dispatch(uint16_t budget) {
+    uint16_t waiting = depth();
+    if ((int32_t)waiting > metric_depth_max.get()) {
+        metric_depth_max.set(waiting);
+    }
+
+    uint16_t delivered = 0;
+    while (delivered < budget) {
+        Slot& slot = slots[dequeue_pos & QUEUE_MASK];
+        if (loadSequence(dequeue_pos) != dequeue_pos + 1) {
+            break;  // Empty, or the producer of the next slot has not finished writing it
+        }
+
+        Event event = slot.event;
+        storeSequence(dequeue_pos, dequeue_pos + EVENTBUS_QUEUE_SIZE);
+        dequeue_pos++;
+
+        uint32_t latency = micros() - event.posted_us;
+        metric_latency.observe(latency);
+        if (latency > max_latency_us) {
+            max_latency_us = latency;
+        }
+
+        uint32_t bit = EVENT_MASK(event.type);
+        for (uint8_t i = 0; i < subscriber_count; i++) {
+            if (subscribers[i].mask & bit) {
+                subscribers[i].handler(event, subscribers[i].context);
+            }
+        }
+        delivered++;
+    }
+    return delivered;
+}
+
+uint16_t depth() {
+    return (uint16_t)(enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos);
+}
+
+String getStatus() {
+    return String(metric_published.get()) + " published, " + String(metric_dropped.get()) + " dropped, depth " +
+           String(depth()) + " (max " + String(metric_depth_max.get()) + "), max latency " +
+           String(max_latency_us) + "us, " + String(subscriber_count) + " subscribers";
+}
+
+} // namespace EventBus
@@ -4,6 +4,7 @@
  */
 
 #include "HADiscovery.h"
+#include <MemoryPolicy.h>
 
 // Forward declare what we need from defines.h to avoid multiple definition issues
 #ifndef FIRMWARE_VERSION
@@ -69,6 +70,14 @@ void HADiscovery::setBuzzerTestCallback(ButtonCallback callback) {
     buzzer_test_callback = callback;
 }
 
+void HADiscovery::setPairRemoteCallback(ButtonCallback callback) {
+    pair_remote_callback = callback;
+}
+
+void HADiscovery::setSequenceCallback(ButtonCallback callback) {
+    sequence_callback = callback;
+}
+
 // Topic builders
 String HADiscovery::getDiscoveryTopic(const char* component, const char* object_id) const {
     // Format: homeassistant/{component}/{node_id}/{object_id}/config
@@ -104,7 +113,7 @@ void HADiscovery::addDeviceInfo(JsonObject& doc) {
     device["sw_version"] = FIRMWARE_VERSION;
 }
 
-bool HADiscovery::publishJson(const char* topic, DynamicJsonDocument& doc, bool retain) {
+bool HADiscovery::publishJson(const char* topic, JsonDocument& doc, bool retain) {
     String payload;
     serializeJson(doc, payload);
 
@@ -141,6 +150,8 @@ bool HADiscovery::publishDiscovery() {
     success &= publishLEDModeSelect();
     success &= publishBuzzerMuteSwitch();
     success &= publishBuzzerTestButton();
+    success &= publishPairRemoteButton();
+    success &= publishSequenceButton();
 
     // Sensors
     success &= publishStatusSensor();
@@ -171,6 +182,8 @@ bool HADiscovery::removeDiscovery() {
         "select/led_mode",
         "switch/buzzer_mute",
         "button/buzzer_test",
+        "button/pair_remote",
+        "button/sequence",
         "binary_sensor/status",
         "sensor/rssi",
         "sensor/uptime",
@@ -208,6 +221,8 @@ bool HADiscovery::subscribeToCommands() {
     String led_mode_cmd = getCommandTopic("led_mode");
     String buzzer_mute_cmd = getCommandTopic("buzzer_mute");
     String buzzer_test_cmd = getCommandTopic("buzzer_test");
+    String pair_remote_cmd = getCommandTopic("pair_remote");
+    String sequence_cmd = getCommandTopic("sequence");
 
     success &= mqtt_client->subscribe(message_cmd.c_str());
     success &= mqtt_client->subscribe(effect_cmd.c_str());
@@ -217,6 +232,8 @@ bool HADiscovery::subscribeToCommands() {
     success &= mqtt_client->subscribe(led_mode_cmd.c_str());
     success &= mqtt_client->subscribe(buzzer_mute_cmd.c_str());
     success &= mqtt_client->subscribe(buzzer_test_cmd.c_str());
+    success &= mqtt_client->subscribe(pair_remote_cmd.c_str());
+    success &= mqtt_client->subscribe(sequence_cmd.c_str());
 
     if (success) {
         Serial.println("HADiscovery: Subscribed to all command topics");
@@ -303,6 +320,20 @@ bool HADiscovery::handleMessage(const char* topic, const uint8_t* payload, unsig
         return true;
     }
 
+    if (topic_str == getCommandTopic("pair_remote")) {
+        if (pair_remote_callback) {
+            pair_remote_callback();
+        }
+        return true;
+    }
+
+    if (topic_str == getCommandTopic("sequence")) {
+        if (sequence_callback) {
+            sequence_callback();
+        }
+        return true;
+    }
+
     return false; // Not handled
 }
 
@@ -323,7 +354,7 @@ void HADiscovery::updateAvailability(bool online) {
 // Entity publishers
 
 bool HADiscovery::publishTextEntity() {
-    DynamicJsonDocument doc(1024);
+    BulkJsonDocument doc(1024);
 
     doc["name"] = "Message";
     doc["unique_id"] = unique_id_prefix + "_message";
@@ -344,7 +375,7 @@ bool HADiscovery::publishTextEntity() {
 }
 
 bool HADiscovery::publishEffectSelect() {
-    DynamicJsonDocument doc(1536);
+    BulkJsonDocument doc(1536);
 
     doc["name"] = "Display Effect";
     doc["unique_id"] = unique_id_prefix + "_effect";
@@ -386,7 +417,7 @@ bool HADiscovery::publishEffectSelect() {
 }
 
 bool HADiscovery::publishColorSelect() {
-    DynamicJsonDocument doc(1024);
+    BulkJsonDocument doc(1024);
 
     doc["name"] = "Display Color";
     doc["unique_id"] = unique_id_prefix + "_color";
@@ -419,7 +450,7 @@ bool HADiscovery::publishColorSelect() {
 }
 
 bool HADiscovery::publishClearButton() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Clear Display";
     doc["unique_id"] = unique_id_prefix + "_clear";
@@ -437,7 +468,7 @@ bool HADiscovery::publishClearButton() {
 }
 
 bool HADiscovery::publishRebootButton() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Reboot";
     doc["unique_id"] = unique_id_prefix + "_reboot";
@@ -456,7 +487,7 @@ bool HADiscovery::publishRebootButton() {
 }
 
 bool HADiscovery::publishStatusSensor() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Status";
     doc["unique_id"] = unique_id_prefix + "_status";
@@ -473,7 +504,7 @@ bool HADiscovery::publishStatusSensor() {
 }
 
 bool HADiscovery::publishRSSISensor() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "WiFi Signal";
     doc["unique_id"] = unique_id_prefix + "_rssi";
@@ -493,7 +524,7 @@ bool HADiscovery::publishRSSISensor() {
 }
 
 bool HADiscovery::publishUptimeSensor() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Uptime";
     doc["unique_id"] = unique_id_prefix + "_uptime";
@@ -513,7 +544,7 @@ bool HADiscovery::publishUptimeSensor() {
 }
 
 bool HADiscovery::publishIPSensor() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "IP Address";
     doc["unique_id"] = unique_id_prefix + "_ip";
@@ -530,7 +561,7 @@ bool HADiscovery::publishIPSensor() {
 }
 
 bool HADiscovery::publishMemorySensor() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Free Memory";
     doc["unique_id"] = unique_id_prefix + "_memory";
@@ -550,7 +581,7 @@ bool HADiscovery::publishMemorySensor() {
 }
 
 bool HADiscovery::publishLEDModeSelect() {
-    DynamicJsonDocument doc(1024);
+    BulkJsonDocument doc(1024);
 
     doc["name"] = "Status LED";
     doc["unique_id"] = unique_id_prefix + "_led_mode";
@@ -577,7 +608,7 @@ bool HADiscovery::publishLEDModeSelect() {
 }
 
 bool HADiscovery::publishBuzzerMuteSwitch() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Buzzer Mute";
     doc["unique_id"] = unique_id_prefix + "_buzzer_mute";
@@ -595,7 +626,7 @@ bool HADiscovery::publishBuzzerMuteSwitch() {
 }
 
 bool HADiscovery::publishBuzzerTestButton() {
-    DynamicJsonDocument doc(512);
+    BulkJsonDocument doc(512);
 
     doc["name"] = "Test Buzzer";
     doc["unique_id"] = unique_id_prefix + "_buzzer_test";
@@ -611,3 +642,38 @@ bool HADiscovery::publishBuzzerTestButton() {
 
     return publishJson(getDiscoveryTopic("button", "buzzer_test").c_str(), doc);
 }
+
+bool HADiscovery::publishPairRemoteButton() {
+    BulkJsonDocument doc(512);
+
+    doc["name"] = "Pair Remote";
+    doc["unique_id"] = unique_id_prefix + "_pair_remote";
+    doc["command_topic"] = getCommandTopic("pair_remote");
+    doc["payload_press"] = "PRESS";
+    doc["icon"] = "mdi:remote";
+    doc["entity_category"] = HA_CATEGORY_CONFIG;
+
+    doc["availability_topic"] = getAvailabilityTopic();
+
+    JsonObject obj = doc.as<JsonObject>();
+    addDeviceInfo(obj);
+
+    return publishJson(getDiscoveryTopic("button", "pair_remote").c_str(), doc);
+}
+
+bool HADiscovery::publishSequenceButton() {
+    BulkJsonDocument doc(512);
+
+    doc["name"] = "Start Sequence";
+    doc["unique_id"] = unique_id_prefix + "_sequence";
+    doc["command_topic"] = getCommandTopic("sequence");
+    doc["payload_press"] = "PRESS";
+    doc["icon"] = "mdi:timer-play";
+
+    doc["availability_topic"] = getAvailabilityTopic();
+
+    JsonObject obj = doc.as<JsonObject>();
+    addDeviceInfo(obj);
+
+    return publishJson(getDiscoveryTopic("button", "sequence").c_str(), doc);
+}
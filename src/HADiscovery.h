@@ -11,6 +11,8 @@
  * - select: color - Choose color (red, green, amber)
  * - button: clear_sign - Clear all messages
  * - button: reboot - Restart device
+ * - button: pair_remote - Open ESP-NOW pairing window for the handheld remote
+ * - button: sequence - Start the preloaded countdown sequence
  *
  * Sensors:
  * - binary_sensor: status - Online/offline (via LWT)
@@ -131,6 +133,16 @@ public:
      */
     void setBuzzerTestCallback(ButtonCallback callback);
 
+    /**
+     * @brief Set callback for pair remote button
+     */
+    void setPairRemoteCallback(ButtonCallback callback);
+
+    /**
+     * @brief Set callback for start sequence button
+     */
+    void setSequenceCallback(ButtonCallback callback);
+
     /**
      * @brief Publish all discovery messages to Home Assistant
      * @return true if all messages published successfully
@@ -206,6 +218,8 @@ private:
     MessageCallback led_mode_callback;
     MessageCallback buzzer_mute_callback;
     ButtonCallback buzzer_test_callback;
+    ButtonCallback pair_remote_callback;
+    ButtonCallback sequence_callback;
 
     // Topic builders
     String getDiscoveryTopic(const char* component, const char* object_id) const;
@@ -227,12 +241,14 @@ private:
     bool publishLEDModeSelect();
     bool publishBuzzerMuteSwitch();
     bool publishBuzzerTestButton();
+    bool publishPairRemoteButton();
+    bool publishSequenceButton();
 
     // Helper to build device info JSON object
     void addDeviceInfo(JsonObject& doc);
 
     // Helper to publish JSON document
-    bool publishJson(const char* topic, DynamicJsonDocument& doc, bool retain = true);
+    bool publishJson(const char* topic, JsonDocument& doc, bool retain = true);
 };
 
 #endif // HA_DISCOVERY_H
@@ -6,6 +6,7 @@
  *****************************************************************************************************************************/
 
 #include "HAMQTTClient.h"
+#include <MemoryPolicy.h>
 
 // Static instance for callback routing
 HAMQTTClient* HAMQTTClient::instance = nullptr;
@@ -80,16 +81,22 @@ bool HAMQTTClient::begin() {
         return false;
     }
 
-    // Create PubSubClient with plain WiFiClient (no TLS)
-    mqtt_client = new PubSubClient(wifi_client);
+    // Create PubSubClient with plain WiFiClient (no TLS); kept across re-configuration
+    if (!mqtt_client) {
+        mqtt_client = new PubSubClient(wifi_client);
+    }
 
     // Configure server and callback
     mqtt_client->setServer(server, port);
     mqtt_client->setCallback(staticCallback);
     mqtt_client->setKeepAlive(HA_MQTT_KEEPALIVE);
+    DnsCache::prefetch(server);
 
-    // Set buffer size for JSON payloads
-    mqtt_client->setBufferSize(1024);
+    // Set buffer size for JSON payloads (packet buffer is bulk: PSRAM when present)
+    {
+        MemoryPolicy::BulkScope bulk;
+        mqtt_client->setBufferSize(1024);
+    }
 
     Serial.println("HAMQTTClient: Client initialized (plain MQTT, no auth)");
     return true;
@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <PubSubClient.h>
+#include <DnsCache.h>
 #include <functional>
 #include "defines.h"
 
@@ -61,6 +62,10 @@ public:
 
     /**
      * @brief Initialize the MQTT client
+     *
+     * May be called again after configure() to move to a new broker (call
+     * forceReconnect() first to drop the old session).
+     *
      * @return true if initialization successful
      */
     bool begin();
@@ -123,7 +128,7 @@ public:
 
 private:
     // WiFi and MQTT clients
-    WiFiClient wifi_client;
+    DnsCachedClient wifi_client;    ///< Resolves the broker through DnsCache
     PubSubClient* mqtt_client;
 
     // Configuration
@@ -0,0 +1,189 @@
+/**
+ * @file HotPath.cpp
+ * @brief Cycle-counter profiler for the sign-writer, ingestion and indicator paths
+ *
+ * Sites register themselves on first use. The PC is taken from the Scope
+ * constructor's return address (never inlined), so it points into the
+ * instrumented function, and is matched against the flash-mapped
+ * instruction range once per site.
+ */
+
+#include "defines.h"
+#include <HotPath.h>
+#include <ArduinoJson.h>
+#include <soc/soc.h>
+#include <atomic>
+
+namespace {
+
+const char* const PATH_NAMES[HOTPATH_COUNT] = {"sign_write", "ingest", "indicator"};
+
+HotPath::Site* sites[HOTPATH_MAX_SITES];
+uint8_t site_count = 0;
+uint8_t sites_dropped = 0;
+
+std::atomic<uint8_t> flash_windows(0);
+
+// Cycles above the fastest run, in total and inside flash write windows
+uint64_t stallCycles(const HotPath::Site& site) {
+    return site.calls ? site.total_cycles - (uint64_t)site.calls * site.min_cycles : 0;
+}
+
+uint64_t busyStallCycles(const HotPath::Site& site) {
+    return site.busy_calls ? site.busy_cycles - (uint64_t)site.busy_calls * site.min_cycles : 0;
+}
+
+} // namespace
+
+namespace HotPath {
+
+void flashWriteBegin() {
+    flash_windows.fetch_add(1, std::memory_order_relaxed);
+}
+
+void flashWriteEnd() {
+    flash_windows.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool enabled() {
+#ifdef SIGN_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+Site::Site(HotPathId path, const char* function)
+    : path(path), function(function), pc(0), in_flash(false), calls(0), min_cycles(UINT32_MAX),
+      max_cycles(0), total_cycles(0), busy_calls(0), busy_cycles(0) {
+    if (site_count < HOTPATH_MAX_SITES) {
+        sites[site_count++] = this;
+    } else {
+        sites_dropped++;
+    }
+}
+
+void Site::locate(uintptr_t return_address) {
+#ifdef __XTENSA__
+    // Windowed ABI: the top two bits hold the caller's window increment, not the address
+    return_address = (return_address & 0x3fffffff) | 0x40000000;
+#endif
+    pc = return_address;
+    in_flash = pc >= SOC_IROM_LOW && pc < SOC_IROM_HIGH;
+}
+
+void Site::record(uint32_t cycles, bool flash_busy) {
+    calls++;
+    total_cycles += cycles;
+    if (cycles < min_cycles) {
+        min_cycles = cycles;
+    }
+    if (cycles > max_cycles) {
+        max_cycles = cycles;
+    }
+    if (flash_busy) {
+        busy_calls++;
+        busy_cycles += cycles;
+    }
+}
+
+__attribute__((noinline)) Scope::Scope(Site& site)
+    : site(site), start(0), busy(flash_windows.load(std::memory_order_relaxed) > 0) {
+    if (!site.pc) {
+        site.locate((uintptr_t)__builtin_return_address(0));
+    }
+    start = ESP.getCycleCount();
+}
+
+Scope::~Scope() {
+    uint32_t cycles = ESP.getCycleCount() - start;
+    // A window opened or closed mid-run counts as busy
+    site.record(cycles, busy || flash_windows.load(std::memory_order_relaxed) > 0);
+}
+
+String report() {
+    DynamicJsonDocument doc(512 + site_count * 192);
+    doc["cpu_mhz"] = getCpuFrequencyMhz();
+    doc["iram"] = HOTPATH_IRAM ? true : false;
+    if (sites_dropped) {
+        doc["sites_dropped"] = sites_dropped;
+    }
+
+    uint32_t path_calls[HOTPATH_COUNT] = {};
+    uint64_t path_cycles[HOTPATH_COUNT] = {};
+    uint64_t flash_stall[HOTPATH_COUNT] = {};
+    uint64_t iram_stall[HOTPATH_COUNT] = {};
+
+    JsonArray site_array = doc.createNestedArray("sites");
+    for (uint8_t i = 0; i < site_count; i++) {
+        const Site& site = *sites[i];
+        if (!site.calls) {
+            continue;
+        }
+        char pc_text[11];
+        snprintf(pc_text, sizeof(pc_text), "0x%08lx", (unsigned long)site.pc);
+
+        JsonObject entry = site_array.createNestedObject();
+        entry["fn"] = site.function;
+        entry["path"] = PATH_NAMES[site.path];
+        entry["pc"] = pc_text;
+        entry["flash"] = site.in_flash;
+        entry["n"] = site.calls;
+        entry["min"] = site.min_cycles;
+        entry["avg"] = (uint32_t)(site.total_cycles / site.calls);
+        entry["max"] = site.max_cycles;
+        entry["stall"] = stallCycles(site);
+        entry["ota_n"] = site.busy_calls;
+        entry["ota_stall"] = busyStallCycles(site);
+
+        path_calls[site.path] += site.calls;
+        path_cycles[site.path] += site.total_cycles;
+        (site.in_flash ? flash_stall : iram_stall)[site.path] += stallCycles(site);
+    }
+
+    JsonArray path_array = doc.createNestedArray("paths");
+    for (uint8_t p = 0; p < HOTPATH_COUNT; p++) {
+        JsonObject entry = path_array.createNestedObject();
+        entry["path"] = PATH_NAMES[p];
+        entry["n"] = path_calls[p];
+        entry["cycles"] = path_cycles[p];
+        entry["flash_stall"] = flash_stall[p];
+        entry["iram_stall"] = iram_stall[p];
+    }
+
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
+
+String getStatus() {
+    if (!enabled()) {
+        return String(HOTPATH_IRAM ? "IRAM placement on" : "IRAM placement off") + ", profiler not built (SIGN_PROFILE)";
+    }
+
+    // Worst stall per call, the site most worth moving out of flash
+    const Site* worst = nullptr;
+    uint64_t worst_stall = 0;
+    uint8_t in_flash = 0;
+    for (uint8_t i = 0; i < site_count; i++) {
+        const Site& site = *sites[i];
+        if (site.in_flash) {
+            in_flash++;
+        }
+        uint64_t stall = site.calls ? stallCycles(site) / site.calls : 0;
+        if (stall > worst_stall) {
+            worst_stall = stall;
+            worst = &site;
+        }
+    }
+
+    String status = String(site_count) + " sites (" + String(in_flash) + " in flash)";
+    status += HOTPATH_IRAM ? ", IRAM placement on" : ", IRAM placement off";
+    if (worst) {
+        status += ", worst stall " + String((uint32_t)worst_stall) + " cycles/call in " + worst->function +
+                  (worst->in_flash ? " (flash)" : " (IRAM)");
+    }
+    return status;
+}
+
+} // namespace HotPath
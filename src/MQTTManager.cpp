@@ -7,12 +7,38 @@
  */
 
 #include "MQTTManager.h"
+#include "SimClock.h"
+#include "Metrics.h"
+#include <EventBus.h>
+#include <MemoryPolicy.h>
+#ifdef SIM_CLOCK
+#include "Simulation.h"
+#endif
 #include <time.h>
+#include <algorithm>
 
 // Static instance pointer for callback routing
 MQTTManager* MQTTManager::instance = nullptr;
 
-MQTTManager::MQTTManager(WiFiClient* wifi_client, const String& device_id, const String& zone_name)
+static MetricCounter metric_messages("ledsign_mqtt_messages_received_total",
+                                     "Messages received from the alert broker");
+static MetricCounter metric_connect_attempts("ledsign_mqtt_connect_attempts_total",
+                                             "Connection attempts to the alert broker");
+static MetricCounter metric_connect_failures("ledsign_mqtt_connect_failures_total",
+                                             "Failed connection attempts to the alert broker");
+static MetricCounter metric_publish_failures("ledsign_mqtt_publish_failures_total",
+                                             "Publishes dropped (not connected or rejected by the client)");
+static MetricGauge metric_connected("ledsign_mqtt_connected",
+                                    "1 while connected to the alert broker");
+
+// Wall clock valid for TLS certificate checks (process-wide: survives re-creation on reconnect)
+static bool time_valid = false;
+
+static void handleTimeSynced(const Event&, void*) {
+    time_valid = true;
+}
+
+MQTTManager::MQTTManager(DnsCachedClient* wifi_client, const String& device_id, const String& zone_name)
     : wifi_client(wifi_client), device_id(device_id), zone_name(zone_name) {
 
     // Initialize connection parameters
@@ -31,9 +57,17 @@ MQTTManager::MQTTManager(WiFiClient* wifi_client, const String& device_id, const
 
     // Initialize state variables
     is_configured = false;
+    was_connected = false;
+    waiting_for_time = false;
+    router = nullptr;
+    spool = nullptr;
+#ifdef SIM_CLOCK
+    sim_connected = false;
+#endif
     last_attempt_time = 0;
     reconnect_attempts = 0;
     backoff_delay = INITIAL_BACKOFF;
+    long_wait = false;
     last_telemetry_time = 0;
 
     // Create MQTT client (will set actual client in configure())
@@ -59,13 +93,13 @@ MQTTManager::~MQTTManager() {
     }
     // Free certificate memory
     if (ca_cert_data) {
-        free(ca_cert_data);
+        MemoryPolicy::release(ca_cert_data);
     }
     if (client_cert_data) {
-        free(client_cert_data);
+        MemoryPolicy::release(client_cert_data);
     }
     if (client_key_data) {
-        free(client_key_data);
+        MemoryPolicy::release(client_key_data);
     }
     instance = nullptr;
 }
@@ -110,7 +144,7 @@ bool MQTTManager::configure(const char* server, uint16_t port,
 
         // Create secure client
         if (!wifi_client_secure) {
-            wifi_client_secure = new WiFiClientSecure();
+            wifi_client_secure = new DnsCachedClientSecure();
         }
 
         // Load certificates from LittleFS
@@ -163,6 +197,14 @@ void MQTTManager::setMessageCallback(std::function<void(char*, uint8_t*, unsigne
     message_callback = callback;
 }
 
+void MQTTManager::setRouter(const AlertRouter* alert_router) {
+    router = alert_router;
+}
+
+void MQTTManager::setSpool(OutboundSpool* outbound_spool) {
+    spool = outbound_spool;
+}
+
 bool MQTTManager::begin() {
     if (!is_configured) {
         Serial.println("MQTTManager: Error - Not configured");
@@ -172,12 +214,26 @@ bool MQTTManager::begin() {
     // Configure MQTT client
     mqtt_client->setServer(mqtt_server, mqtt_port);
     mqtt_client->setCallback(staticCallback);
+
+    // Resolve the broker in the background so the first attempt finds it cached
+    DnsCache::prefetch(mqtt_server);
+
+    // TLS connects once EVT_TIME_SYNCED arrives; a clock set before we subscribed counts too
+    static bool subscribed = false;
+    if (!subscribed) {
+        EventBus::subscribe(EVENT_MASK(EVT_TIME_SYNCED), handleTimeSynced);
+        subscribed = true;
+    }
+    if (SimClock::now() >= 1609459200) {  // January 1, 2021
+        time_valid = true;
+    }
     
     Serial.println("MQTTManager: Ready for connections");
     return true;
 }
 
 void MQTTManager::staticCallback(char* topic, byte* payload, unsigned int length) {
+    metric_messages.inc();
     if (instance && instance->message_callback) {
         instance->message_callback(topic, payload, length);
     }
@@ -186,6 +242,7 @@ void MQTTManager::staticCallback(char* topic, byte* payload, unsigned int length
 void MQTTManager::resetConnectionState() {
     reconnect_attempts = 0;
     backoff_delay = INITIAL_BACKOFF;
+    long_wait = false;
     last_attempt_time = 0;
 }
 
@@ -244,13 +301,12 @@ bool MQTTManager::loadCertificates() {
         return false;
     }
 
-    // Allocate heap memory and copy (add 1 for null terminator)
-    ca_cert_data = (char*)malloc(caCertStr.length() + 1);
+    // Copy to the heap (PSRAM on boards that have it - only read during the handshake)
+    ca_cert_data = MemoryPolicy::duplicate(caCertStr, MEM_BULK);
     if (!ca_cert_data) {
         Serial.println("MQTTManager: Error - Failed to allocate memory for CA cert");
         return false;
     }
-    strcpy(ca_cert_data, caCertStr.c_str());
     Serial.print("MQTTManager: CA certificate loaded (");
     Serial.print(strlen(ca_cert_data));
     Serial.println(" bytes)");
@@ -261,13 +317,12 @@ bool MQTTManager::loadCertificates() {
         // Mutual TLS mode: CA cert + client cert + private key
         Serial.println("MQTTManager: Client certificate found - mutual TLS mode");
 
-        // Allocate heap memory and copy
-        client_cert_data = (char*)malloc(clientCertStr.length() + 1);
+        // Copy to the heap
+        client_cert_data = MemoryPolicy::duplicate(clientCertStr, MEM_BULK);
         if (!client_cert_data) {
             Serial.println("MQTTManager: Error - Failed to allocate memory for client cert");
             return false;
         }
-        strcpy(client_cert_data, clientCertStr.c_str());
         Serial.print("MQTTManager: Client certificate loaded (");
         Serial.print(strlen(client_cert_data));
         Serial.println(" bytes)");
@@ -280,13 +335,12 @@ bool MQTTManager::loadCertificates() {
             return false;
         }
 
-        // Allocate heap memory and copy
-        client_key_data = (char*)malloc(clientKeyStr.length() + 1);
+        // Copy to the heap
+        client_key_data = MemoryPolicy::duplicate(clientKeyStr, MEM_BULK);
         if (!client_key_data) {
             Serial.println("MQTTManager: Error - Failed to allocate memory for private key");
             return false;
         }
-        strcpy(client_key_data, clientKeyStr.c_str());
         Serial.print("MQTTManager: Private key loaded (");
         Serial.print(strlen(client_key_data));
         Serial.println(" bytes)");
@@ -359,49 +413,94 @@ void MQTTManager::loop() {
         return;
     }
     
-    unsigned long current_time = millis();
+    unsigned long current_time = SimClock::millis();
+
+#ifdef SIM_CLOCK
+    // Simulated broker: the session drops when the scenario takes the broker down
+    if (sim_connected && !Simulation::isBrokerUp()) {
+        sim_connected = false;
+        SIM_EVENT("mqtt", "connection lost");
+    }
+#endif
+
+    // Announce connection edges (status LED and other subscribers react on the bus)
+    bool connected_now = isConnected();
+    if (connected_now != was_connected) {
+        EventBus::publish(connected_now ? EVT_MQTT_CONNECTED : EVT_MQTT_DISCONNECTED);
+        was_connected = connected_now;
+    }
+    metric_connected.set(connected_now ? 1 : 0);
     
     // Handle MQTT client loop if connected
-    if (mqtt_client->connected()) {
+    if (isConnected()) {
+#ifndef SIM_CLOCK
         mqtt_client->loop();
+#endif
         
         // Reset connection state on successful connection
         if (reconnect_attempts > 0) {
             Serial.println("MQTTManager: Connection restored");
             resetConnectionState();
         }
+
+        // Rate-limited catch-up; inbound messages keep flowing between batches
+        if (spool && !spool->isEmpty()) {
+            spool->drain([this](const char* topic, const char* message, bool retain) {
+                return send(topic, message, retain);
+            });
+            if (!spool->isEmpty()) {
+                SimClock::wakeAt(current_time + 1000 / SPOOL_DRAIN_RATE);
+            }
+        }
         
         // Publish telemetry at regular intervals
         if (current_time - last_telemetry_time > TELEMETRY_INTERVAL) {
             publishTelemetry();
             last_telemetry_time = current_time;
         }
+        SimClock::wakeAt(last_telemetry_time + TELEMETRY_INTERVAL + 1);
         
         return;
     }
     
+    // TLS certificate validation needs the wall clock: hold off until the sync event
+    if (use_tls && certificates_loaded && !time_valid) {
+        if (!waiting_for_time) {
+            Serial.println("MQTTManager: Waiting for NTP time sync (required for TLS)...");
+            waiting_for_time = true;
+        }
+        return;
+    }
+    waiting_for_time = false;
+
     // Handle reconnection attempts with exponential backoff
     if (current_time - last_attempt_time < backoff_delay) {
+        SimClock::wakeAt(last_attempt_time + backoff_delay);
         return; // Not time to retry yet
     }
     
     last_attempt_time = current_time;
+
+    // Long wait over: the next cycle backs off from INITIAL_BACKOFF again
+    if (long_wait) {
+        backoff_delay = INITIAL_BACKOFF;
+        long_wait = false;
+    }
     
     // Check if we've exceeded maximum attempts
     if (reconnect_attempts >= MAX_ATTEMPTS) {
         Serial.println("MQTTManager: Max reconnection attempts reached, waiting longer...");
-        last_attempt_time = current_time + LONG_DELAY;
+        SIM_EVENT("mqtt", "max attempts, waiting " + String(LONG_DELAY / 1000) + "s");
+        // Reset first: it clears last_attempt_time, which used to cancel the long wait
         resetConnectionState();
+        last_attempt_time = current_time;
+        backoff_delay = LONG_DELAY;
+        long_wait = true;
         return;
     }
     
-    // Check if system time is valid (required for TLS certificate validation)
     if (use_tls && certificates_loaded) {
-        time_t now = time(nullptr);
-        if (now < 1609459200) {  // January 1, 2021 - if time is before this, NTP hasn't synced
-            Serial.println("MQTTManager: Waiting for NTP time sync (required for TLS)...");
-            return;  // Don't attempt connection until time is synced
-        }
+        time_t now = SimClock::now();
         Serial.print("MQTTManager: System time is valid: ");
         Serial.println(ctime(&now));
     }
@@ -417,14 +516,26 @@ void MQTTManager::loop() {
     String client_id = "esp32-betabrite-" + zone_name + "-" + device_id;
     bool connected = false;
 
-    // Set buffer size for larger JSON payloads
-    mqtt_client->setBufferSize(MQTT_MAX_PACKET_SIZE);
+    SIM_EVENT("mqtt", "attempt " + String(reconnect_attempts + 1));
+    metric_connect_attempts.inc();
+
+    // Set buffer size for larger JSON payloads (packet buffer is bulk: PSRAM when present)
+    {
+        MemoryPolicy::BulkScope bulk;
+        mqtt_client->setBufferSize(MQTT_MAX_PACKET_SIZE);
+    }
 
     Serial.print("MQTTManager: Client ID: ");
     Serial.println(client_id);
     Serial.print("MQTTManager: Username: ");
     Serial.println(strlen(mqtt_user) > 0 ? mqtt_user : "(none)");
 
+#ifdef SIM_CLOCK
+    // No broker traffic in simulation - the scenario decides whether it answers
+    sim_connected = Simulation::isBrokerUp();
+    connected = sim_connected;
+#else
+    uint32_t connect_start_us = micros();
     if (strlen(mqtt_user) > 0) {
         // Connect with credentials and clean session = false (persistent session)
         connected = mqtt_client->connect(client_id.c_str(), mqtt_user, mqtt_pass,
@@ -434,9 +545,12 @@ void MQTTManager::loop() {
         connected = mqtt_client->connect(client_id.c_str(), NULL, NULL,
                                         NULL, 0, false, NULL, !MQTT_CLEAN_SESSION);
     }
+    recordConnectTiming(connected, micros() - connect_start_us);
+#endif
     
     if (connected) {
         Serial.println("connected");
+        SIM_EVENT("mqtt", "connected");
         
         // Subscribe to topics
         if (subscribeToTopics()) {
@@ -448,6 +562,7 @@ void MQTTManager::loop() {
         resetConnectionState();
     } else {
         reconnect_attempts++;
+        metric_connect_failures.inc();
         
         Serial.print("failed, rc=");
         Serial.print(mqtt_client->state());
@@ -462,6 +577,7 @@ void MQTTManager::loop() {
         // Exponential backoff with jitter
         backoff_delay = min(backoff_delay * 2, MAX_BACKOFF);
         backoff_delay += random(0, 1000); // Add jitter to prevent thundering herd
+        SIM_EVENT("mqtt", "failed, backoff " + String(backoff_delay) + "ms");
         
         if (reconnect_attempts >= MAX_ATTEMPTS) {
             Serial.println("MQTTManager: Multiple failures - check server configuration:");
@@ -475,23 +591,47 @@ void MQTTManager::loop() {
 }
 
 bool MQTTManager::isConnected() const {
+#ifdef SIM_CLOCK
+    return sim_connected;
+#else
     return mqtt_client && mqtt_client->connected();
+#endif
 }
 
 bool MQTTManager::isConfigured() const {
     return is_configured;
 }
 
-bool MQTTManager::publish(const char* topic, const char* message, bool retain) {
+bool MQTTManager::publish(const char* topic, const char* message, bool retain, bool allow_spool) {
+    if (topic == NULL || message == NULL) {
+        Serial.println("MQTTManager: Invalid publish parameters");
+        return false;
+    }
+
+    // Keep order: once anything is spooled, new messages queue behind it
+    bool use_spool = allow_spool && spool;
+    if (use_spool && (!isConnected() || !spool->isEmpty())) {
+        return spool->enqueue(topic, message, retain);
+    }
+
     if (!isConnected()) {
         Serial.println("MQTTManager: Cannot publish - not connected");
+        metric_publish_failures.inc();
         return false;
     }
-    
-    if (topic == NULL || message == NULL) {
-        Serial.println("MQTTManager: Invalid publish parameters");
-        return false;
+
+    if (send(topic, message, retain)) {
+        return true;
     }
+    return use_spool && spool->enqueue(topic, message, retain);
+}
+
+bool MQTTManager::send(const char* topic, const char* message, bool retain) {
+#ifdef SIM_CLOCK
+    // Topic only: payloads carry heap and RSSI figures that differ run to run
+    SIM_EVENT("mqtt", String("publish ") + topic);
+    return true;
+#endif
     
     bool result = mqtt_client->publish(topic, message, retain);
     
@@ -503,6 +643,7 @@ bool MQTTManager::publish(const char* topic, const char* message, bool retain) {
     } else {
         Serial.print("MQTTManager: Publish failed to ");
         Serial.println(topic);
+        metric_publish_failures.inc();
     }
     
     return result;
@@ -525,7 +666,7 @@ void MQTTManager::publishTelemetry() {
     
     // Publish uptime in seconds
     String uptime_topic = "ledSign/" + device_id + "/uptime";
-    String uptime_value = String(millis() / 1000);
+    String uptime_value = String(SimClock::millis() / 1000);
     publish(uptime_topic.c_str(), uptime_value.c_str(), true);
     
     // Publish memory statistics
@@ -533,32 +674,129 @@ void MQTTManager::publishTelemetry() {
     String memory_value = String(ESP.getFreeHeap());
     publish(memory_topic.c_str(), memory_value.c_str(), true);
     
+    // Where the last connect attempt spent its time
+    if (last_connect_report.length() > 0) {
+        String connect_topic = "ledSign/" + device_id + "/connect";
+        publish(connect_topic.c_str(), last_connect_report.c_str(), true);
+    }
+    
     Serial.print("MQTTManager: Telemetry published - RSSI: ");
     Serial.print(WiFi.RSSI());
     Serial.print(", Free Memory: ");
     Serial.println(ESP.getFreeHeap());
+}
+void MQTTManager::recordConnectTiming(bool connected, uint32_t total_us) {
+    // PubSubClient connects the transport, then sends CONNECT and waits for CONNACK;
+    // the secure client times its TCP connect and TLS handshake separately
+    bool secure = use_tls && certificates_loaded;
+    const DnsConnectTiming& timing = secure ? wifi_client_secure->connectTiming()
+                                            : wifi_client->connectTiming();
+    uint32_t transport_us = timing.dns_us + timing.connect_us + timing.tls_us;
+    uint32_t mqtt_us = total_us > transport_us ? total_us - transport_us : 0;
+
+    last_connect_report = "{\"ok\":" + String(connected ? "true" : "false") +
+                          ",\"dns_us\":" + String(timing.dns_us) +
+                          ",\"dns_cached\":" + String(timing.dns_cached ? "true" : "false") +
+                          ",\"tcp_us\":" + String(timing.connect_us) +
+                          (secure ? ",\"tls_us\":" + String(timing.tls_us) : String()) +
+                          ",\"mqtt_us\":" + String(mqtt_us) +
+                          ",\"total_us\":" + String(total_us) + "}";
+
+    Serial.print("MQTTManager: Connect timing ");
+    Serial.println(last_connect_report);
 }
+
 
 bool MQTTManager::subscribeToTopics() {
     if (!isConnected()) {
         return false;
     }
 
-    // Subscribe to zone-specific message topic (per ESP32_BETABRITE_IMPLEMENTATION.md)
-    // Format: ledSign/{zone}/message
-    String zone_topic = "ledSign/" + zone_name + "/message";
-    bool zone_sub = mqtt_client->subscribe(zone_topic.c_str(), MQTT_QOS_LEVEL);
+#ifdef SIM_CLOCK
+    return true;  // Scenario commands are injected directly, nothing to subscribe to
+#endif
+
+    std::vector<String> topics;
+
+    // Alert topics: every routing table filter, or the zone-specific message topic
+    // (per ESP32_BETABRITE_IMPLEMENTATION.md, format: ledSign/{zone}/message)
+    bool zone_sub = true;
+    if (router && router->count() > 0) {
+        for (uint8_t i = 0; i < router->count(); i++) {
+            const char* filter = router->route(i).filter;
+            if (mqtt_client->subscribe(filter, MQTT_QOS_LEVEL)) {
+                Serial.print("MQTTManager: Subscribed to route: ");
+                Serial.println(filter);
+                topics.push_back(filter);
+            } else {
+                Serial.print("MQTTManager: Route subscription failed: ");
+                Serial.println(filter);
+                zone_sub = false;
+            }
+        }
+    } else {
+        String zone_topic = "ledSign/" + zone_name + "/message";
+        zone_sub = mqtt_client->subscribe(zone_topic.c_str(), MQTT_QOS_LEVEL);
+        if (zone_sub) {
+            Serial.print("MQTTManager: Subscribed to zone topic: ");
+            Serial.println(zone_topic);
+            topics.push_back(zone_topic);
+        }
+    }
 
     if (zone_sub) {
-        Serial.print("MQTTManager: Subscribed to zone topic: ");
-        Serial.println(zone_topic);
         Serial.print("MQTTManager: QoS Level: ");
         Serial.println(MQTT_QOS_LEVEL);
-        return true;
+
+        // Sequence triggers (start/stop/load) for timed countdowns
+        String sequence_topic = "ledSign/" + zone_name + "/sequence";
+        if (mqtt_client->subscribe(sequence_topic.c_str(), MQTT_QOS_LEVEL)) {
+            Serial.print("MQTTManager: Subscribed to sequence topic: ");
+            Serial.println(sequence_topic);
+            topics.push_back(sequence_topic);
+        } else {
+            Serial.println("MQTTManager: Sequence topic subscription failed");
+        }
+
+        // Traffic capture control (start/stop/clear/dump)
+        String capture_topic = "ledSign/" + zone_name + "/capture";
+        if (mqtt_client->subscribe(capture_topic.c_str(), MQTT_QOS_LEVEL)) {
+            Serial.print("MQTTManager: Subscribed to capture topic: ");
+            Serial.println(capture_topic);
+            topics.push_back(capture_topic);
+        } else {
+            Serial.println("MQTTManager: Capture topic subscription failed");
+        }
     } else {
         Serial.println("MQTTManager: Zone topic subscription failed");
-        return false;
     }
+
+    // Runtime configuration (ConfigStore) is per device, so it survives a zone change
+    String config_topic = "ledSign/" + device_id + "/config/set";
+    if (mqtt_client->subscribe(config_topic.c_str(), MQTT_QOS_LEVEL)) {
+        Serial.print("MQTTManager: Subscribed to config topic: ");
+        Serial.println(config_topic);
+        topics.push_back(config_topic);
+    } else {
+        Serial.println("MQTTManager: Config topic subscription failed");
+    }
+
+    // Make before break: drop what a previous zone or routing table wanted only now
+    for (const String& old_topic : subscriptions) {
+        if (std::find(topics.begin(), topics.end(), old_topic) == topics.end()) {
+            mqtt_client->unsubscribe(old_topic.c_str());
+            Serial.print("MQTTManager: Unsubscribed from: ");
+            Serial.println(old_topic);
+        }
+    }
+    subscriptions = topics;
+    return zone_sub;
+}
+
+void MQTTManager::setZone(const String& zone) {
+    zone_name = zone;
+    Serial.print("MQTTManager: Zone: ");
+    Serial.println(zone_name);
 }
 
 String MQTTManager::getConnectionStatus() const {
@@ -604,6 +842,9 @@ void MQTTManager::getConnectionStats(int* attempts, int* backoff, unsigned long*
 
 void MQTTManager::forceReconnect() {
     Serial.println("MQTTManager: Forcing reconnection attempt");
+#ifdef SIM_CLOCK
+    sim_connected = false;
+#endif
     if (mqtt_client->connected()) {
         mqtt_client->disconnect();
     }
@@ -28,8 +28,12 @@
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <PubSubClient.h>
+#include <DnsCache.h>
+#include "AlertRouter.h"
+#include "OutboundSpool.h"
 #include <LittleFS.h>
 #include <functional>
+#include <vector>
 
 // Certificate paths for TLS authentication (from defines.h)
 #ifndef CERT_PATH_CA
@@ -73,8 +77,8 @@ private:
     char* client_key_data;          ///< Private key storage on heap (must persist for WiFiClientSecure)
 
     // MQTT client instances
-    WiFiClient* wifi_client;              ///< Basic WiFi client (fallback)
-    WiFiClientSecure* wifi_client_secure; ///< Secure WiFi client for TLS
+    DnsCachedClient* wifi_client;              ///< Basic WiFi client (fallback)
+    DnsCachedClientSecure* wifi_client_secure; ///< Secure WiFi client for TLS
     PubSubClient* mqtt_client;            ///< MQTT client instance
     
     // Connection management
@@ -82,6 +86,13 @@ private:
     unsigned long last_attempt_time; ///< Last connection attempt timestamp
     int reconnect_attempts;         ///< Current reconnection attempt count
     int backoff_delay;              ///< Current backoff delay in ms
+    bool long_wait;                 ///< backoff_delay is the LONG_DELAY pause after MAX_ATTEMPTS
+    bool was_connected;             ///< Connection state at the last loop (edge events)
+    bool waiting_for_time;          ///< TLS connect held until EVT_TIME_SYNCED (logged once)
+    String last_connect_report;     ///< Phase timing of the last connect attempt (JSON, telemetry)
+#ifdef SIM_CLOCK
+    bool sim_connected;             ///< Simulated session state (virtual-clock build)
+#endif
     
     // Connection parameters
     static const int MAX_BACKOFF = 60000;      ///< Maximum backoff delay (60s)
@@ -95,6 +106,15 @@ private:
     
     // Message callback function
     std::function<void(char*, uint8_t*, unsigned int)> message_callback;
+
+    // Alert topics to subscribe (nullptr = the zone's own message topic)
+    const AlertRouter* router;
+
+    // Holds outbound messages while the broker is away (nullptr = drop them)
+    OutboundSpool* spool;
+
+    // Topics subscribed on the broker, so a zone or route change can drop the old ones
+    std::vector<String> subscriptions;
     
     /**
      * @brief Internal callback wrapper for PubSubClient
@@ -109,6 +129,19 @@ private:
      */
     void resetConnectionState();
 
+    /**
+     * @brief Build last_connect_report from the transport client's DNS/connect timing
+     * @param connected Result of the attempt
+     * @param total_us Whole PubSubClient::connect() call
+     */
+    void recordConnectTiming(bool connected, uint32_t total_us);
+
+    /**
+     * @brief Send one message on the live connection (no spooling)
+     * @return true if the client accepted it
+     */
+    bool send(const char* topic, const char* message, bool retain);
+
     /**
      * @brief Load TLS certificates from SPIFFS
      * @return true if all certificates loaded successfully, false otherwise
@@ -125,11 +158,11 @@ private:
 public:
     /**
      * @brief Constructor - initializes MQTT manager
-     * @param wifi_client Pointer to WiFiClient instance (for fallback)
+     * @param wifi_client Pointer to DNS-cached WiFiClient instance (for fallback)
      * @param device_id Unique device identifier string (MAC-based)
      * @param zone_name Zone name for topic routing (default: "default")
      */
-    MQTTManager(WiFiClient* wifi_client, const String& device_id, const String& zone_name = "default");
+    MQTTManager(DnsCachedClient* wifi_client, const String& device_id, const String& zone_name = "default");
 
     /**
      * @brief Destructor - cleans up resources
@@ -154,6 +187,18 @@ public:
      * @param callback Function to call when message received
      */
     void setMessageCallback(std::function<void(char*, uint8_t*, unsigned int)> callback);
+
+    /**
+     * @brief Subscribe to every route filter instead of the zone's message topic
+     * @param alert_router Compiled routing table (must outlive the manager)
+     */
+    void setRouter(const AlertRouter* alert_router);
+
+    /**
+     * @brief Queue publishes while disconnected and drain them after reconnecting
+     * @param outbound_spool Spool (must outlive the manager)
+     */
+    void setSpool(OutboundSpool* outbound_spool);
     
     /**
      * @brief Initialize MQTT connection
@@ -184,9 +229,10 @@ public:
      * @param topic MQTT topic to publish to
      * @param message Message content
      * @param retain Whether message should be retained
-     * @return true if publish successful, false otherwise
+     * @param allow_spool Queue it in the spool if it cannot be sent now (see setSpool())
+     * @return true if published or spooled, false otherwise
      */
-    bool publish(const char* topic, const char* message, bool retain = false);
+    bool publish(const char* topic, const char* message, bool retain = false, bool allow_spool = true);
     
     /**
      * @brief Publish telemetry data (RSSI, IP, uptime)
@@ -195,10 +241,24 @@ public:
     void publishTelemetry();
     
     /**
-     * @brief Subscribe to device-specific and general message topics
-     * @return true if subscription successful, false otherwise
+     * @brief Subscribe to zone message, sequence trigger, capture control and config topics
+     *
+     * Safe to call again after setZone() or a routing table reload: new topics
+     * are subscribed before topics no longer wanted are unsubscribed.
+     *
+     * @return true if the alert topics were subscribed, false otherwise
      */
     bool subscribeToTopics();
+
+    /**
+     * @brief Change the zone used for topics and the client ID
+     *
+     * Takes effect at the next subscribeToTopics() (the client ID at the next
+     * connect).
+     *
+     * @param zone New zone name
+     */
+    void setZone(const String& zone);
     
     /**
      * @brief Get current connection status as string
@@ -0,0 +1,132 @@
+/**
+ * @file MemoryPolicy.cpp
+ * @brief Buffer placement between internal RAM and PSRAM
+ *
+ * Every block goes through heap_caps_* with explicit capabilities, so a bulk
+ * block really is in PSRAM and an internal one is never moved there by the
+ * SDK's own malloc() threshold.
+ */
+
+#include "defines.h"
+#include <MemoryPolicy.h>
+#include "Metrics.h"
+#include <esp_heap_caps.h>
+
+namespace {
+
+const uint32_t CAPS_INTERNAL = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+const uint32_t CAPS_PSRAM = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+bool psram_available = false;
+
+MetricGauge metric_internal_free("ledsign_heap_internal_free_bytes", "Free internal RAM (DMA/ISR-capable heap)");
+MetricGauge metric_internal_min("ledsign_heap_internal_min_free_bytes", "Lowest free internal RAM since boot");
+MetricGauge metric_internal_block("ledsign_heap_internal_largest_block_bytes", "Largest free internal block");
+MetricGauge metric_psram_size("ledsign_psram_size_bytes", "PSRAM available to the heap (0 = none)");
+MetricGauge metric_psram_free("ledsign_psram_free_bytes", "Free PSRAM");
+MetricGauge metric_alert_doc_psram("ledsign_alert_doc_psram", "1 when the alert JSON document is placed in PSRAM");
+MetricCounter metric_psram_allocs("ledsign_psram_allocations_total", "Bulk buffers placed in PSRAM");
+MetricCounter metric_psram_fallbacks("ledsign_psram_fallbacks_total", "Bulk buffers placed internally because PSRAM was full");
+
+bool wantsPsram(size_t size, MemoryClass type) {
+    if (!psram_available || size < MEMPOLICY_PSRAM_MIN_BYTES) {
+        return false;
+    }
+    return type == MEM_BULK || (type == MEM_ALERT && MEMPOLICY_ALERT_DOC_PSRAM);
+}
+
+} // namespace
+
+namespace MemoryPolicy {
+
+bool begin() {
+    psram_available = psramFound() && ESP.getPsramSize() > 0;
+    metric_alert_doc_psram.set(psram_available && MEMPOLICY_ALERT_DOC_PSRAM ? 1 : 0);
+    updateMetrics();
+
+    Serial.print("MemoryPolicy: ");
+    Serial.println(getStatus());
+    return psram_available;
+}
+
+bool hasPsram() {
+    return psram_available;
+}
+
+void* allocate(size_t size, MemoryClass type) {
+    if (wantsPsram(size, type)) {
+        void* ptr = heap_caps_malloc(size, CAPS_PSRAM);
+        if (ptr) {
+            metric_psram_allocs.inc();
+            return ptr;
+        }
+        metric_psram_fallbacks.inc();
+    }
+    return heap_caps_malloc(size, CAPS_INTERNAL);
+}
+
+void* reallocate(void* ptr, size_t size, MemoryClass type) {
+    if (!ptr) {
+        return allocate(size, type);
+    }
+    // Stay in the heap the block came from (a grown bulk block may have fallen back)
+    uint32_t caps = wantsPsram(size, type) ? CAPS_PSRAM : CAPS_INTERNAL;
+    void* grown = heap_caps_realloc(ptr, size, caps);
+    if (!grown && caps == CAPS_PSRAM) {
+        metric_psram_fallbacks.inc();
+        grown = heap_caps_realloc(ptr, size, CAPS_INTERNAL);
+    }
+    return grown;
+}
+
+void release(void* ptr) {
+    if (ptr) {
+        heap_caps_free(ptr);
+    }
+}
+
+char* duplicate(const String& text, MemoryClass type) {
+    char* copy = (char*)allocate(text.length() + 1, type);
+    if (copy) {
+        memcpy(copy, text.c_str(), text.length() + 1);
+    }
+    return copy;
+}
+
+void updateMetrics() {
+    metric_internal_free.set(heap_caps_get_free_size(CAPS_INTERNAL));
+    metric_internal_min.set(heap_caps_get_minimum_free_size(CAPS_INTERNAL));
+    metric_internal_block.set(heap_caps_get_largest_free_block(CAPS_INTERNAL));
+    metric_psram_size.set(psram_available ? ESP.getPsramSize() : 0);
+    metric_psram_free.set(psram_available ? heap_caps_get_free_size(CAPS_PSRAM) : 0);
+}
+
+String getStatus() {
+    String status = "internal " + String(heap_caps_get_free_size(CAPS_INTERNAL)) + " free (min " +
+                    String(heap_caps_get_minimum_free_size(CAPS_INTERNAL)) + ", largest block " +
+                    String(heap_caps_get_largest_free_block(CAPS_INTERNAL)) + ")";
+    if (!psram_available) {
+        return status + ", no PSRAM - bulk buffers internal";
+    }
+    status += ", PSRAM " + String(heap_caps_get_free_size(CAPS_PSRAM)) + "/" + String(ESP.getPsramSize()) +
+              " free, " + String(metric_psram_allocs.get()) + " bulk buffers placed";
+    if (metric_psram_fallbacks.get()) {
+        status += " (" + String(metric_psram_fallbacks.get()) + " fell back)";
+    }
+    status += MEMPOLICY_ALERT_DOC_PSRAM ? ", alert doc in PSRAM" : ", alert doc internal";
+    return status;
+}
+
+BulkScope::BulkScope() : active(psram_available) {
+    if (active) {
+        heap_caps_malloc_extmem_enable(MEMPOLICY_PSRAM_MIN_BYTES);
+    }
+}
+
+BulkScope::~BulkScope() {
+    if (active) {
+        heap_caps_malloc_extmem_enable(MEMPOLICY_MALLOC_INTERNAL_LIMIT);
+    }
+}
+
+} // namespace MemoryPolicy
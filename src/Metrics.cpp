@@ -0,0 +1,136 @@
+/**
+ * @file Metrics.cpp
+ * @brief Metric registration and Prometheus / JSON exposition
+ */
+
+#include "defines.h"
+#include "Metrics.h"
+#include "SimClock.h"
+
+// Constant-initialized, so registration from other translation units' static
+// constructors is safe regardless of initialization order
+Metric* Metrics::head = nullptr;
+Metric* Metrics::tail = nullptr;
+
+Metric::Metric(const char* name, const char* help, MetricType type)
+    : name(name), help(help), type(type), next(nullptr) {
+    // Static constructors run before any task starts: no locking needed
+    if (Metrics::tail) {
+        Metrics::tail->next = this;
+    } else {
+        Metrics::head = this;
+    }
+    Metrics::tail = this;
+}
+
+MetricHistogram::MetricHistogram(const char* name, const char* help, const uint32_t* bounds, uint8_t bound_count)
+    : Metric(name, help, METRIC_HISTOGRAM), bounds(bounds),
+      bound_count(bound_count > METRICS_MAX_BUCKETS ? METRICS_MAX_BUCKETS : bound_count), sum(0) {
+    for (uint8_t i = 0; i <= METRICS_MAX_BUCKETS; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint32_t MetricHistogram::getCount() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i <= bound_count; i++) {
+        total += getBucket(i);
+    }
+    return total;
+}
+
+size_t Metrics::count() {
+    size_t n = 0;
+    for (Metric* m = head; m; m = m->getNext()) {
+        n++;
+    }
+    return n;
+}
+
+size_t Metrics::writePrometheus(Print& out) {
+    static const char* const type_names[] = { "counter", "gauge", "histogram" };
+    size_t written = 0;
+
+    for (Metric* m = head; m; m = m->getNext()) {
+        written += out.printf("# HELP %s %s\n# TYPE %s %s\n",
+                              m->getName(), m->getHelp(), m->getName(), type_names[m->getType()]);
+
+        switch (m->getType()) {
+            case METRIC_COUNTER:
+                written += out.printf("%s %u\n", m->getName(), (unsigned)static_cast<MetricCounter*>(m)->get());
+                break;
+
+            case METRIC_GAUGE:
+                written += out.printf("%s %d\n", m->getName(), (int)static_cast<MetricGauge*>(m)->get());
+                break;
+
+            case METRIC_HISTOGRAM: {
+                MetricHistogram* h = static_cast<MetricHistogram*>(m);
+                uint32_t cumulative = 0;
+                for (uint8_t i = 0; i < h->getBoundCount(); i++) {
+                    cumulative += h->getBucket(i);
+                    written += out.printf("%s_bucket{le=\"%u\"} %u\n", m->getName(),
+                                          (unsigned)h->getBound(i), (unsigned)cumulative);
+                }
+                cumulative += h->getBucket(h->getBoundCount());
+                written += out.printf("%s_bucket{le=\"+Inf\"} %u\n", m->getName(), (unsigned)cumulative);
+                written += out.printf("%s_sum %u\n%s_count %u\n", m->getName(), (unsigned)h->getSum(),
+                                      m->getName(), (unsigned)cumulative);
+                break;
+            }
+        }
+    }
+    return written;
+}
+
+String Metrics::snapshotJson() {
+    String json;
+    json.reserve(48 + count() * 40);
+    json += "{\"uptime\":";
+    json += String(SimClock::millis() / 1000);
+    json += ",\"m\":{";
+
+    bool first_metric = true;
+    for (Metric* m = head; m; m = m->getNext()) {
+        const char* name = m->getName();
+        if (strncmp(name, "ledsign_", 8) == 0) {
+            name += 8;
+        }
+        if (!first_metric) {
+            json += ',';
+        }
+        first_metric = false;
+        json += '"';
+        json += name;
+        json += "\":";
+
+        switch (m->getType()) {
+            case METRIC_COUNTER:
+                json += String(static_cast<MetricCounter*>(m)->get());
+                break;
+
+            case METRIC_GAUGE:
+                json += String(static_cast<MetricGauge*>(m)->get());
+                break;
+
+            case METRIC_HISTOGRAM: {
+                MetricHistogram* h = static_cast<MetricHistogram*>(m);
+                String buckets;
+                uint32_t total = 0;
+                for (uint8_t i = 0; i <= h->getBoundCount(); i++) {
+                    uint32_t n = h->getBucket(i);
+                    total += n;
+                    if (i) {
+                        buckets += ',';
+                    }
+                    buckets += String(n);
+                }
+                json += "{\"n\":" + String(total) + ",\"sum\":" + String(h->getSum()) + ",\"b\":[" + buckets + "]}";
+                break;
+            }
+        }
+    }
+
+    json += "}}";
+    return json;
+}
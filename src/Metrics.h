@@ -0,0 +1,178 @@
+/**
+ * @file Metrics.h
+ * @brief Central registry of counters, gauges and histograms
+ *
+ * Each module defines its metrics as file-scope statics; the constructors link
+ * them into one registry before setup() runs, so there is no registration
+ * call and no heap use:
+ *
+ *     static MetricCounter mqtt_messages("ledsign_mqtt_messages_received_total",
+ *                                        "Messages received from the alert broker");
+ *     ...
+ *     mqtt_messages.inc();
+ *
+ * Updates are single relaxed atomic operations (an S32C1I loop on the ESP32),
+ * safe from any task or ISR and never blocking. Readers see each value
+ * atomically, but not a consistent cut across metrics - a histogram's buckets
+ * may be one observation apart while it is being updated.
+ *
+ * The registry is exposed as Prometheus text (MetricsServer, GET /metrics) and
+ * as a compact JSON snapshot published over MQTT.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Metrics configuration constants (from defines.h)
+#ifndef METRICS_MAX_BUCKETS
+#define METRICS_MAX_BUCKETS       8
+#endif
+
+/**
+ * @brief Metric kinds, as named in the exposition format
+ */
+enum MetricType : uint8_t {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+/**
+ * @brief Registry entry shared by all metric kinds
+ *
+ * Metrics must have static storage duration: they are never unregistered.
+ */
+class Metric {
+public:
+    const char* getName() const { return name; }
+    const char* getHelp() const { return help; }
+    MetricType getType() const { return type; }
+    Metric* getNext() const { return next; }
+
+protected:
+    Metric(const char* name, const char* help, MetricType type);
+
+private:
+    const char* name;               ///< Prometheus name (ledsign_..., counters end in _total)
+    const char* help;               ///< One-line HELP text
+    MetricType type;
+    Metric* next;                   ///< Next registered metric
+
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+};
+
+/**
+ * @brief Monotonic event count (wraps at 2^32; Prometheus treats that as a reset)
+ */
+class MetricCounter : public Metric {
+public:
+    MetricCounter(const char* name, const char* help)
+        : Metric(name, help, METRIC_COUNTER), value(0) {}
+
+    inline void inc(uint32_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> value;
+};
+
+/**
+ * @brief Value that can go up and down (heap, RSSI, connection state)
+ */
+class MetricGauge : public Metric {
+public:
+    MetricGauge(const char* name, const char* help)
+        : Metric(name, help, METRIC_GAUGE), value(0) {}
+
+    inline void set(int32_t v) { value.store(v, std::memory_order_relaxed); }
+    inline void add(int32_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+    int32_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int32_t> value;
+};
+
+/**
+ * @brief Distribution over fixed upper bounds (plus an implicit +Inf bucket)
+ *
+ * Bucket counts are stored per bucket and made cumulative at exposition, so
+ * observe() touches one bucket and the sum.
+ */
+class MetricHistogram : public Metric {
+public:
+    /**
+     * @param bounds Ascending bucket upper bounds (inclusive); must outlive the metric
+     * @param bound_count Number of bounds (at most METRICS_MAX_BUCKETS)
+     */
+    MetricHistogram(const char* name, const char* help, const uint32_t* bounds, uint8_t bound_count);
+
+    inline void observe(uint32_t v) {
+        uint8_t i = 0;
+        while (i < bound_count && v > bounds[i]) {
+            i++;
+        }
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    uint8_t getBoundCount() const { return bound_count; }
+    uint32_t getBound(uint8_t index) const { return bounds[index]; }
+    uint32_t getBucket(uint8_t index) const { return buckets[index].load(std::memory_order_relaxed); }
+    uint32_t getSum() const { return sum.load(std::memory_order_relaxed); }
+    uint32_t getCount() const;
+
+private:
+    const uint32_t* bounds;
+    uint8_t bound_count;
+    std::atomic<uint32_t> buckets[METRICS_MAX_BUCKETS + 1];   ///< Last entry is +Inf
+    std::atomic<uint32_t> sum;
+};
+
+/**
+ * @brief Registry access and exposition
+ */
+class Metrics {
+public:
+    /**
+     * @brief First registered metric (walk with Metric::getNext())
+     */
+    static Metric* first() { return head; }
+
+    /**
+     * @brief Number of registered metrics
+     */
+    static size_t count();
+
+    /**
+     * @brief Write every metric in Prometheus text format (version 0.0.4)
+     * @param out Destination (HTTP client, Serial, ...)
+     * @return Bytes written
+     */
+    static size_t writePrometheus(Print& out);
+
+    /**
+     * @brief Compact JSON snapshot for MQTT
+     *
+     * {"uptime":s,"m":{"<name without ledsign_>":v,...}}; histograms are
+     * {"n":count,"sum":s,"b":[per-bucket counts, +Inf last]}.
+     *
+     * @return Snapshot text
+     */
+    static String snapshotJson();
+
+private:
+    friend class Metric;
+
+    static Metric* head;
+    static Metric* tail;
+};
+
+#endif // METRICS_H
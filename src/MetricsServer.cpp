@@ -0,0 +1,165 @@
+/**
+ * @file MetricsServer.cpp
+ * @brief Minimal HTTP endpoint serving the metrics registry to Prometheus
+ */
+
+#include "defines.h"
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "SimClock.h"
+
+namespace {
+
+/**
+ * Coalesces the exposition's many small printf() calls into TCP-sized writes
+ */
+class BufferedClientPrint : public Print {
+public:
+    explicit BufferedClientPrint(WiFiClient& client) : client(client), used(0) {}
+    ~BufferedClientPrint() { flush(); }
+
+    size_t write(uint8_t c) override {
+        if (used == sizeof(buffer)) {
+            flush();
+        }
+        buffer[used++] = c;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            write(data[i]);
+        }
+        return size;
+    }
+
+    void flush() {
+        if (used) {
+            client.write(buffer, used);
+            used = 0;
+        }
+    }
+
+private:
+    WiFiClient& client;
+    uint8_t buffer[512];
+    size_t used;
+};
+
+} // namespace
+
+MetricsServer::MetricsServer(uint16_t port)
+    : server(port), port(port), running(false), scrapes(0), rejected(0),
+      reading(false), client_since(0), line_used(0), line_done(false), newlines(0) {
+    line[0] = '\0';
+}
+
+void MetricsServer::begin() {
+    if (running) {
+        return;
+    }
+    server.begin();
+    server.setNoDelay(true);
+    running = true;
+
+    Serial.print("MetricsServer: Listening on port ");
+    Serial.println(port);
+}
+
+void MetricsServer::setCollectCallback(std::function<void()> callback) {
+    collect_callback = callback;
+}
+
+void MetricsServer::loop() {
+    if (!running) {
+        return;
+    }
+
+    if (!reading) {
+        client = server.available();
+        if (!client) {
+            return;
+        }
+        accept();
+    }
+
+    if (readRequest()) {
+        respond();
+    } else if (!client.connected() && !client.available()) {
+        rejected++;             // Closed before the headers ended
+        drop();
+    } else if (SimClock::millis() - client_since >= METRICS_HTTP_TIMEOUT_MS) {
+        rejected++;             // Slow or half-open scraper
+        drop();
+    }
+}
+
+void MetricsServer::accept() {
+    reading = true;
+    client_since = SimClock::millis();
+    line_used = 0;
+    line_done = false;
+    newlines = 0;
+}
+
+bool MetricsServer::readRequest() {
+    // Take what has arrived: the request line, then headers up to the blank line
+    while (client.available() > 0) {
+        int c = client.read();
+        if (c < 0 || c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            line_done = true;
+            if (++newlines == 2) {
+                line[line_used] = '\0';
+                return true;
+            }
+            continue;
+        }
+        newlines = 0;
+        if (!line_done && line_used + 1 < sizeof(line)) {
+            line[line_used++] = (char)c;
+        }
+    }
+    return false;
+}
+
+void MetricsServer::respond() {
+    // Only the path matters; query strings and HTTP version are ignored
+    bool is_metrics = strncmp(line, "GET /metrics", 12) == 0 &&
+                      (line[12] == ' ' || line[12] == '?' || line[12] == '\0');
+    if (!is_metrics) {
+        rejected++;
+        client.print("HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nnot found\n");
+        drop();
+        return;
+    }
+
+    if (collect_callback) {
+        collect_callback();
+    }
+
+    client.print("HTTP/1.0 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                 "Connection: close\r\n\r\n");
+    {
+        BufferedClientPrint out(client);
+        Metrics::writePrometheus(out);
+    }
+    drop();
+    scrapes++;
+}
+
+void MetricsServer::drop() {
+    client.stop();
+    client = WiFiClient();
+    reading = false;
+}
+
+String MetricsServer::getStatus() const {
+    if (!running) {
+        return "stopped";
+    }
+    return "port " + String(port) + ", " + String(scrapes) + " scrapes, " + String(rejected) + " rejected";
+}
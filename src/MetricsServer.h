@@ -0,0 +1,100 @@
+/**
+ * @file MetricsServer.h
+ * @brief Minimal HTTP endpoint serving the metrics registry to Prometheus
+ *
+ * One connection at a time, no heap-allocated response: the exposition is
+ * streamed through a small stack buffer. The request is read a little per
+ * loop() call, from whatever bytes have arrived, so a slow or half-open
+ * scraper never holds up the main task; it is dropped after
+ * METRICS_HTTP_TIMEOUT_MS.
+ * - GET /metrics -> Prometheus text format (version 0.0.4)
+ * - anything else -> 404
+ *
+ * Scrape config:
+ *
+ *     - job_name: ledsign
+ *       static_configs:
+ *         - targets: ['ledsign-kitchen.lan:9100']
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+
+// Metrics endpoint configuration constants (from defines.h)
+#ifndef METRICS_HTTP_PORT
+#define METRICS_HTTP_PORT         9100
+#endif
+#ifndef METRICS_HTTP_TIMEOUT_MS
+#define METRICS_HTTP_TIMEOUT_MS   250
+#endif
+
+/**
+ * @brief Serves Metrics::writePrometheus() over HTTP
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Constructor
+     * @param port TCP port to listen on
+     */
+    explicit MetricsServer(uint16_t port = METRICS_HTTP_PORT);
+
+    /**
+     * @brief Start listening (call once WiFi is up; later calls are no-ops)
+     */
+    void begin();
+
+    /**
+     * @brief Run before each scrape to refresh sampled gauges (heap, RSSI, ...)
+     * @param callback Collector, called on the main task
+     */
+    void setCollectCallback(std::function<void()> callback);
+
+    /**
+     * @brief Accept a connection or read what its request has sent so far,
+     *        and answer once the headers are complete - call from the main loop
+     */
+    void loop();
+
+    /**
+     * @brief Check whether the server is listening
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    WiFiServer server;
+    uint16_t port;
+    bool running;
+    std::function<void()> collect_callback;
+    uint32_t scrapes;                  ///< Successful /metrics responses
+    uint32_t rejected;                 ///< Timeouts, bad requests and 404s
+
+    WiFiClient client;                 ///< Connection being read (one at a time)
+    bool reading;                      ///< client holds an accepted connection
+    unsigned long client_since;        ///< When it was accepted
+    char line[64];                     ///< Request line so far
+    size_t line_used;
+    bool line_done;                    ///< Request line complete, draining headers
+    uint8_t newlines;                  ///< Consecutive line ends (2 = end of headers)
+
+    void accept();
+    bool readRequest();
+    void respond();
+    void drop();
+};
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,279 @@
+/**
+ * @file MulticastListener.cpp
+ * @brief Implementation of authenticated UDP multicast alert ingress
+ *
+ * Datagrams are validated in order of increasing cost: framing first, then
+ * HMAC, then the replay window. Only authenticated datagrams are allowed to
+ * move a sender's sequence window, so forged packets cannot poison it.
+ */
+
+#include "MulticastListener.h"
+#include <mbedtls/md.h>
+#include <time.h>
+
+MulticastListener::MulticastListener(const char* group, uint16_t port)
+    : port(port), active(false), key_set(false), clock_valid(false) {
+
+    if (!group_ip.fromString(group)) {
+        Serial.print("MulticastListener: Invalid group address: ");
+        Serial.println(group);
+    }
+
+    memset(key, 0, sizeof(key));
+    memset(senders, 0, sizeof(senders));
+    memset(&stats, 0, sizeof(stats));
+    strncpy(topic, "ledSign/multicast", sizeof(topic) - 1);
+    topic[sizeof(topic) - 1] = '\0';
+}
+
+MulticastListener::~MulticastListener() {
+    stop();
+    memset(key, 0, sizeof(key));
+}
+
+bool MulticastListener::setKeyHex(const char* hex_key) {
+    if (hex_key == nullptr || strlen(hex_key) != KEY_SIZE * 2) {
+        Serial.println("MulticastListener: Error - Key must be 64 hex characters");
+        return false;
+    }
+
+    for (size_t i = 0; i < KEY_SIZE; i++) {
+        uint8_t byte = 0;
+        for (int n = 0; n < 2; n++) {
+            char c = hex_key[i * 2 + n];
+            uint8_t nibble;
+            if (c >= '0' && c <= '9') nibble = c - '0';
+            else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+            else {
+                Serial.println("MulticastListener: Error - Key contains non-hex characters");
+                memset(key, 0, sizeof(key));
+                return false;
+            }
+            byte = (byte << 4) | nibble;
+        }
+        key[i] = byte;
+    }
+
+    key_set = true;
+    return true;
+}
+
+void MulticastListener::setMessageCallback(std::function<void(char*, uint8_t*, unsigned int)> callback) {
+    message_callback = callback;
+}
+
+bool MulticastListener::begin() {
+    if (!key_set) {
+        Serial.println("MulticastListener: No site key - multicast ingress disabled");
+        return false;
+    }
+
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("MulticastListener: WiFi not connected");
+        return false;
+    }
+
+    if (!udp.beginMulticast(group_ip, port)) {
+        Serial.println("MulticastListener: Failed to join multicast group");
+        return false;
+    }
+
+    active = true;
+    Serial.print("MulticastListener: Listening on ");
+    Serial.print(group_ip.toString());
+    Serial.print(":");
+    Serial.println(port);
+    return true;
+}
+
+void MulticastListener::stop() {
+    if (active) {
+        udp.stop();
+        active = false;
+        Serial.println("MulticastListener: Stopped");
+    }
+}
+
+void MulticastListener::loop() {
+    if (!active) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_DATAGRAMS_PER_LOOP; i++) {
+        int size = udp.parsePacket();
+        if (size <= 0) {
+            return;
+        }
+
+        stats.received++;
+
+        if ((size_t)size > MAX_DATAGRAM) {
+            // Oversized datagrams cannot be ours; drain and discard
+            udp.flush();
+            stats.malformed++;
+            continue;
+        }
+
+        int length = udp.read(rx_buffer, size);
+        if (length <= 0) {
+            stats.malformed++;
+            continue;
+        }
+
+        handleDatagram((size_t)length);
+    }
+}
+
+void MulticastListener::handleDatagram(size_t length) {
+    // Framing checks
+    if (length < HEADER_SIZE + MAC_SIZE ||
+        rx_buffer[0] != 'L' || rx_buffer[1] != 'S' ||
+        rx_buffer[2] != PROTOCOL_VERSION) {
+        stats.malformed++;
+        return;
+    }
+
+    uint32_t sender_id = readU32(&rx_buffer[4]);
+    uint32_t seq = readU32(&rx_buffer[8]);
+    uint32_t timestamp = readU32(&rx_buffer[12]);
+    uint16_t payload_len = readU16(&rx_buffer[16]);
+
+    size_t signed_len = HEADER_SIZE + payload_len;
+    if (payload_len == 0 || signed_len + MAC_SIZE != length) {
+        stats.malformed++;
+        return;
+    }
+
+    // Authenticate before touching any per-sender state
+    if (!verifyMac(signed_len)) {
+        stats.auth_failed++;
+        return;
+    }
+
+    // No synced clock, no timestamp check - and the replay window is empty after a reboot
+    if (!clock_valid) {
+        stats.unsynced++;
+        return;
+    }
+
+    long skew = (long)time(nullptr) - (long)timestamp;
+    if (skew > MULTICAST_MAX_SKEW_S || skew < -MULTICAST_MAX_SKEW_S) {
+        stats.stale++;
+        return;
+    }
+
+    if (!acceptSequence(sender_id, seq)) {
+        stats.replayed++;
+        return;
+    }
+
+    stats.accepted++;
+
+    if (message_callback) {
+        // MAC is no longer needed - NUL-terminate the payload in place
+        uint8_t* payload = &rx_buffer[HEADER_SIZE];
+        payload[payload_len] = '\0';
+        message_callback(topic, payload, payload_len);
+    }
+}
+
+bool MulticastListener::verifyMac(size_t signed_len) const {
+    uint8_t mac[32];
+    const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (info == nullptr ||
+        mbedtls_md_hmac(info, key, KEY_SIZE, rx_buffer, signed_len, mac) != 0) {
+        return false;
+    }
+
+    // Constant-time comparison
+    const uint8_t* received = &rx_buffer[signed_len];
+    uint8_t diff = 0;
+    for (size_t i = 0; i < MAC_SIZE; i++) {
+        diff |= mac[i] ^ received[i];
+    }
+    return diff == 0;
+}
+
+bool MulticastListener::acceptSequence(uint32_t sender_id, uint32_t seq) {
+    SenderState* state = nullptr;
+    SenderState* slot = nullptr;  // Free slot, else least recently seen
+
+    for (int i = 0; i < MAX_SENDERS; i++) {
+        if (senders[i].in_use && senders[i].sender_id == sender_id) {
+            state = &senders[i];
+            break;
+        }
+        if (!senders[i].in_use) {
+            if (slot == nullptr || slot->in_use) slot = &senders[i];
+        } else if (slot == nullptr || (slot->in_use && senders[i].last_seen < slot->last_seen)) {
+            slot = &senders[i];
+        }
+    }
+
+    if (state == nullptr) {
+        // New sender (or evicted one); the timestamp check bounds replays across eviction
+        state = slot;
+        state->sender_id = sender_id;
+        state->highest_seq = seq;
+        state->window = 1;
+        state->last_seen = millis();
+        state->in_use = true;
+        return true;
+    }
+
+    if (seq > state->highest_seq) {
+        uint32_t shift = seq - state->highest_seq;
+        stats.lost += shift - 1;  // Provisional; late arrivals give these back
+        state->window = (shift >= REPLAY_WINDOW) ? 1 : ((state->window << shift) | 1);
+        state->highest_seq = seq;
+        state->last_seen = millis();
+        return true;
+    }
+
+    uint32_t offset = state->highest_seq - seq;
+    if (offset >= REPLAY_WINDOW) {
+        return false;  // Too old to tell apart from a replay
+    }
+
+    uint64_t bit = (uint64_t)1 << offset;
+    if (state->window & bit) {
+        return false;  // Duplicate
+    }
+
+    // Late (reordered) arrival fills a gap counted as lost
+    state->window |= bit;
+    state->last_seen = millis();
+    if (stats.lost > 0) stats.lost--;
+    return true;
+}
+
+String MulticastListener::getStatus() const {
+    if (!active) {
+        return key_set ? "Inactive" : "Disabled (no key)";
+    }
+
+    String status = "Active, accepted=";
+    status += String(stats.accepted);
+    status += " received=";
+    status += String(stats.received);
+    status += " auth_failed=";
+    status += String(stats.auth_failed);
+    status += " replayed=";
+    status += String(stats.replayed);
+    status += " stale=";
+    status += String(stats.stale);
+    status += " unsynced=";
+    status += String(stats.unsynced);
+    status += " lost=";
+    status += String(stats.lost);
+    return status;
+}
+
+uint32_t MulticastListener::readU32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+uint16_t MulticastListener::readU16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
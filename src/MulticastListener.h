@@ -0,0 +1,205 @@
+/**
+ * @file MulticastListener.h
+ * @brief Authenticated UDP multicast alert ingress for site-wide fan-out
+ *
+ * Lets one datagram reach every sign on the LAN instead of one broker
+ * delivery (and one TLS session) per sign:
+ * - Listens on a site multicast group (MULTICAST_GROUP:MULTICAST_PORT)
+ * - Authenticates each datagram with HMAC-SHA256 over a shared site key
+ * - Rejects replays with a per-sender sequence window and a timestamp skew check
+ * - Detects loss through sequence gaps (MQTT delivery remains the fallback)
+ * - Hands accepted payloads to the same callback signature as MQTTManager,
+ *   so alerts go through the normal handleMQTTMessage() ingestion path
+ *
+ * Datagram layout (all integers big-endian):
+ * | Offset | Size | Field                                         |
+ * |--------|------|-----------------------------------------------|
+ * | 0      | 2    | Magic "LS"                                    |
+ * | 2      | 1    | Version (1)                                   |
+ * | 3      | 1    | Flags (reserved, 0)                           |
+ * | 4      | 4    | Sender ID (publisher instance)                |
+ * | 8      | 4    | Sequence number (per sender, monotonic)       |
+ * | 12     | 4    | Timestamp (Unix seconds)                      |
+ * | 16     | 2    | Payload length N                              |
+ * | 18     | N    | Payload (Alert Manager JSON)                  |
+ * | 18+N   | 16   | HMAC-SHA256(key, bytes[0 .. 18+N)) truncated  |
+ *
+ * @see tools/multicast_alert.py for the matching sender and fan-out benchmark
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef MULTICAST_LISTENER_H
+#define MULTICAST_LISTENER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <functional>
+
+// Multicast configuration constants (from defines.h)
+#ifndef MULTICAST_GROUP
+#define MULTICAST_GROUP           "239.255.76.83"
+#endif
+#ifndef MULTICAST_PORT
+#define MULTICAST_PORT            42691
+#endif
+#ifndef MULTICAST_MAX_SKEW_S
+#define MULTICAST_MAX_SKEW_S      300
+#endif
+
+/**
+ * @brief UDP multicast listener with HMAC authentication and replay protection
+ *
+ * Non-blocking: loop() drains at most a few queued datagrams per call so
+ * the rest of the main loop keeps its cadence during bursts.
+ */
+class MulticastListener {
+public:
+    static const size_t KEY_SIZE = 32;             ///< Site key length (HMAC-SHA256)
+    static const size_t HEADER_SIZE = 18;          ///< Fixed header before payload
+    static const size_t MAC_SIZE = 16;             ///< Truncated HMAC length
+    static const size_t MAX_DATAGRAM = 1472;       ///< Single Ethernet frame, no IP fragmentation
+
+    /**
+     * @brief Counters exposed for health checks and telemetry
+     */
+    struct Stats {
+        uint32_t received;       ///< Datagrams read from the socket
+        uint32_t accepted;       ///< Datagrams authenticated and delivered
+        uint32_t malformed;      ///< Bad magic/version/length
+        uint32_t auth_failed;    ///< HMAC mismatch
+        uint32_t replayed;       ///< Duplicate or too-old sequence numbers
+        uint32_t stale;          ///< Timestamp outside MULTICAST_MAX_SKEW_S
+        uint32_t unsynced;       ///< Authenticated but dropped before the first time sync
+        uint32_t lost;           ///< Sequence gaps not (yet) filled by late arrivals
+    };
+
+    /**
+     * @brief Constructor
+     * @param group Multicast group address (e.g., "239.255.76.83")
+     * @param port UDP port
+     */
+    MulticastListener(const char* group = MULTICAST_GROUP, uint16_t port = MULTICAST_PORT);
+
+    /**
+     * @brief Destructor - leaves the multicast group
+     */
+    ~MulticastListener();
+
+    /**
+     * @brief Set the shared site key from a hex string (64 hex characters)
+     * @param hex_key Hex-encoded 32-byte key
+     * @return true if the key was valid
+     */
+    bool setKeyHex(const char* hex_key);
+
+    /**
+     * @brief Set message callback (same signature as MQTTManager)
+     * @param callback Function receiving (topic, payload, length)
+     */
+    void setMessageCallback(std::function<void(char*, uint8_t*, unsigned int)> callback);
+
+    /**
+     * @brief Report whether the system clock has been synced
+     *
+     * Until it has, authenticated datagrams are dropped: the timestamp check
+     * cannot run and the replay window (RAM only) starts empty after a
+     * reboot, so a captured datagram would otherwise be accepted again.
+     *
+     * @param valid true once time sync has set the clock
+     */
+    void setClockValid(bool valid) { clock_valid = valid; }
+
+    /**
+     * @brief Join the multicast group
+     * @return true if the socket joined the group
+     */
+    bool begin();
+
+    /**
+     * @brief Stop listening and leave the group
+     */
+    void stop();
+
+    /**
+     * @brief Service pending datagrams - call regularly from the main loop
+     */
+    void loop();
+
+    /**
+     * @brief Check whether the listener is joined and keyed
+     * @return true if active
+     */
+    bool isActive() const { return active; }
+
+    /**
+     * @brief Get ingress counters
+     * @return Reference to current statistics
+     */
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief Get human-readable status for health logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    static const uint8_t PROTOCOL_VERSION = 1;
+    static const int MAX_SENDERS = 4;              ///< Tracked publisher instances
+    static const int MAX_DATAGRAMS_PER_LOOP = 4;   ///< Bound work per loop() call
+    static const uint32_t REPLAY_WINDOW = 64;      ///< Sequence window width (bitmap bits)
+
+    /**
+     * @brief Per-sender replay window state
+     */
+    struct SenderState {
+        uint32_t sender_id;      ///< Publisher instance ID
+        uint32_t highest_seq;    ///< Highest sequence accepted
+        uint64_t window;         ///< Bit i set = (highest_seq - i) seen
+        unsigned long last_seen; ///< millis() of last accepted datagram (for LRU)
+        bool in_use;
+    };
+
+    WiFiUDP udp;
+    IPAddress group_ip;
+    uint16_t port;
+    bool active;
+    bool key_set;
+    bool clock_valid;                              ///< Time synced since boot (setClockValid())
+    uint8_t key[KEY_SIZE];
+    uint8_t rx_buffer[MAX_DATAGRAM + 1];          ///< +1 so the payload can be NUL-terminated in place
+    SenderState senders[MAX_SENDERS];
+    Stats stats;
+    char topic[24];                                ///< Pseudo-topic passed to the callback
+
+    std::function<void(char*, uint8_t*, unsigned int)> message_callback;
+
+    /**
+     * @brief Validate and deliver one datagram
+     * @param length Bytes in rx_buffer
+     */
+    void handleDatagram(size_t length);
+
+    /**
+     * @brief Verify the truncated HMAC in constant time
+     * @param signed_len Bytes covered by the MAC
+     * @return true if the MAC matches
+     */
+    bool verifyMac(size_t signed_len) const;
+
+    /**
+     * @brief Check and record a sequence number against the sender's window
+     * @param sender_id Publisher instance
+     * @param seq Sequence number
+     * @return true if fresh (not a replay)
+     */
+    bool acceptSequence(uint32_t sender_id, uint32_t seq);
+
+    static uint32_t readU32(const uint8_t* p);
+    static uint16_t readU16(const uint8_t* p);
+};
+
+#endif // MULTICAST_LISTENER_H
@@ -0,0 +1,459 @@
+/**
+ * @file OutboundSpool.cpp
+ * @brief Implementation of the outbound MQTT spool
+ *
+ * Flash layout: each segment file starts with "LSSP", a format version and
+ * a 32-bit sequence number (oldest segment = lowest sequence). Records
+ * follow back to back: flags (bit 0 = retain), topic length and payload
+ * length (16-bit little endian), a 16-bit checksum, then topic and payload.
+ */
+
+#include "defines.h"
+#include "OutboundSpool.h"
+#include <HotPath.h>
+#include "SimClock.h"
+#include "Metrics.h"
+#include <LittleFS.h>
+
+namespace {
+const uint8_t SEGMENT_MAGIC[4] = {'L', 'S', 'S', 'P'};
+const uint8_t FORMAT_VERSION = 1;
+const size_t SEGMENT_HEADER_SIZE = 9;
+const size_t RECORD_HEADER_SIZE = 7;
+
+MetricGauge metric_depth("ledsign_spool_depth", "Outbound messages waiting for the broker (RAM and flash)");
+MetricGauge metric_flash_bytes("ledsign_spool_flash_bytes", "Flash used by spooled outbound messages");
+MetricGauge metric_drain_rate("ledsign_spool_drain_per_second", "Spooled messages sent in the last second");
+MetricCounter metric_drained("ledsign_spool_drained_total", "Spooled messages sent after reconnecting");
+MetricCounter metric_dropped("ledsign_spool_dropped_total", "Outbound messages lost to a full spool");
+MetricCounter metric_coalesced("ledsign_spool_coalesced_total",
+                               "Retained messages replaced by a newer value before sending");
+
+void putU16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+// FNV-1a folded to 16 bits; catches records torn by a reset mid-write
+uint16_t checksum(uint8_t flags, const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ flags) * 16777619u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+}
+
+OutboundSpool::OutboundSpool()
+    : ram_head(0), ram_count(0), ram_bytes(0), flash_ready(false), write_segment(0), write_sealed(true),
+      last_sequence(0), read_offset(0), flash_records(0), tokens_milli(SPOOL_DRAIN_BATCH * 1000),
+      last_refill_ms(0), window_start_ms(0), window_sent(0) {
+    for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+        segment_sequence[i] = 0;
+        segment_size[i] = 0;
+        segment_records[i] = 0;
+    }
+}
+
+String OutboundSpool::segmentPath(uint8_t index) {
+    char path[32];
+    snprintf(path, sizeof(path), SPOOL_SEGMENT_PATH, (unsigned)index);
+    return String(path);
+}
+
+bool OutboundSpool::begin() {
+    if (!LittleFS.begin(false)) {
+        Serial.println("OutboundSpool: LittleFS not available - RAM only");
+        return false;
+    }
+
+    for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+        String path = segmentPath(i);
+        if (!LittleFS.exists(path)) {
+            continue;
+        }
+
+        File file = LittleFS.open(path, "r");
+        uint8_t header[SEGMENT_HEADER_SIZE];
+        bool valid = file && file.read(header, sizeof(header)) == sizeof(header) &&
+                     memcmp(header, SEGMENT_MAGIC, 4) == 0 && header[4] == FORMAT_VERSION;
+        if (!valid) {
+            if (file) {
+                file.close();
+            }
+            LittleFS.remove(path);
+            continue;
+        }
+
+        // Count whole records; a torn tail from a reset ends the segment
+        size_t file_size = file.size();
+        size_t offset = SEGMENT_HEADER_SIZE;
+        uint16_t records = 0;
+        uint8_t record[RECORD_HEADER_SIZE];
+        while (offset + RECORD_HEADER_SIZE <= file_size && file.seek(offset) &&
+               file.read(record, sizeof(record)) == sizeof(record)) {
+            size_t length = RECORD_HEADER_SIZE + getU16(record + 1) + getU16(record + 3);
+            if (offset + length > file_size) {
+                break;
+            }
+            offset += length;
+            records++;
+        }
+        file.close();
+
+        if (records == 0) {
+            LittleFS.remove(path);
+            continue;
+        }
+        segment_sequence[i] = header[5] | (header[6] << 8) | (header[7] << 16) | ((uint32_t)header[8] << 24);
+        segment_size[i] = offset;
+        segment_records[i] = records;
+        flash_records += records;
+        if (segment_sequence[i] > last_sequence) {
+            last_sequence = segment_sequence[i];
+        }
+    }
+
+    // Never append behind a possibly torn tail: new messages start a fresh segment
+    write_sealed = true;
+    read_offset = 0;
+    flash_ready = true;
+    updateGauges();
+
+    Serial.print("OutboundSpool: ");
+    Serial.print(flash_records);
+    Serial.println(" messages on flash from before reset");
+    return true;
+}
+
+void OutboundSpool::clear() {
+    for (uint8_t i = 0; i < SPOOL_RAM_SLOTS; i++) {
+        ram[i].topic = String();
+        ram[i].payload = String();
+    }
+    ram_head = 0;
+    ram_count = 0;
+    ram_bytes = 0;
+
+    for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+        if (segment_size[i] || LittleFS.exists(segmentPath(i))) {
+            LittleFS.remove(segmentPath(i));
+        }
+        segment_size[i] = 0;
+        segment_records[i] = 0;
+    }
+    flash_records = 0;
+    read_offset = 0;
+    write_sealed = true;
+    updateGauges();
+}
+
+int OutboundSpool::oldestSegment() const {
+    int oldest = -1;
+    for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+        if (segment_size[i] && (oldest < 0 || segment_sequence[i] < segment_sequence[oldest])) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+void OutboundSpool::dropSegment(uint8_t index, bool count_as_dropped) {
+    if (count_as_dropped) {
+        metric_dropped.inc(segment_records[index]);
+    }
+    if ((int)index == oldestSegment()) {
+        read_offset = 0;
+    }
+    flash_records -= segment_records[index];
+    LittleFS.remove(segmentPath(index));
+    segment_size[index] = 0;
+    segment_records[index] = 0;
+}
+
+bool OutboundSpool::writeRecord(const Message& message) {
+    HotPath::FlashWrite flash_write;
+    size_t topic_length = message.topic.length();
+    size_t payload_length = message.payload.length();
+    size_t length = RECORD_HEADER_SIZE + topic_length + payload_length;
+    if (SEGMENT_HEADER_SIZE + length > SPOOL_SEGMENT_BYTES) {
+        return false;
+    }
+
+    if (write_sealed || segment_size[write_segment] == 0 ||
+        segment_size[write_segment] + length > SPOOL_SEGMENT_BYTES) {
+        // Next segment: a free one, else the oldest is overwritten
+        int slot = -1;
+        for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+            if (segment_size[i] == 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            slot = oldestSegment();
+            Serial.println("OutboundSpool: Flash full - dropping oldest segment");
+            dropSegment(slot, true);
+        }
+
+        File file = LittleFS.open(segmentPath(slot), "w");
+        if (!file) {
+            return false;
+        }
+        uint8_t header[SEGMENT_HEADER_SIZE];
+        memcpy(header, SEGMENT_MAGIC, 4);
+        header[4] = FORMAT_VERSION;
+        ++last_sequence;
+        header[5] = last_sequence & 0xFF;
+        header[6] = (last_sequence >> 8) & 0xFF;
+        header[7] = (last_sequence >> 16) & 0xFF;
+        header[8] = (last_sequence >> 24) & 0xFF;
+        size_t written = file.write(header, sizeof(header));
+        file.close();
+        if (written != sizeof(header)) {
+            LittleFS.remove(segmentPath(slot));
+            return false;
+        }
+        segment_sequence[slot] = last_sequence;
+        segment_size[slot] = SEGMENT_HEADER_SIZE;
+        segment_records[slot] = 0;
+        write_segment = slot;
+        write_sealed = false;
+    }
+
+    uint8_t flags = message.retain ? 1 : 0;
+    uint16_t check = checksum(flags, message.topic.c_str(), topic_length);
+    check ^= checksum(0, message.payload.c_str(), payload_length);
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    header[0] = flags;
+    putU16(header + 1, topic_length);
+    putU16(header + 3, payload_length);
+    putU16(header + 5, check);
+
+    // One open/close per record: LittleFS commits the record on close
+    File file = LittleFS.open(segmentPath(write_segment), "a");
+    if (!file) {
+        return false;
+    }
+    size_t written = file.write(header, sizeof(header));
+    written += file.write((const uint8_t*)message.topic.c_str(), topic_length);
+    written += file.write((const uint8_t*)message.payload.c_str(), payload_length);
+    file.close();
+
+    if (written != length) {
+        // Partial record past segment_size is never read; start clean next time
+        write_sealed = true;
+        return false;
+    }
+    segment_size[write_segment] += length;
+    segment_records[write_segment]++;
+    flash_records++;
+    return true;
+}
+
+bool OutboundSpool::readRecord(uint8_t index, Message& message, size_t& next_offset) {
+    size_t offset = read_offset < SEGMENT_HEADER_SIZE ? SEGMENT_HEADER_SIZE : read_offset;
+    File file = LittleFS.open(segmentPath(index), "r");
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    bool ok = file.seek(offset) && file.read(header, sizeof(header)) == sizeof(header);
+    size_t topic_length = ok ? getU16(header + 1) : 0;
+    size_t payload_length = ok ? getU16(header + 3) : 0;
+    next_offset = offset + RECORD_HEADER_SIZE + topic_length + payload_length;
+    ok = ok && next_offset <= segment_size[index];
+
+    char* buffer = ok ? (char*)malloc(topic_length + payload_length + 2) : nullptr;
+    if (buffer) {
+        char* topic = buffer;
+        char* payload = buffer + topic_length + 1;
+        ok = file.read((uint8_t*)topic, topic_length) == topic_length &&
+             file.read((uint8_t*)payload, payload_length) == payload_length &&
+             (checksum(header[0], topic, topic_length) ^ checksum(0, payload, payload_length)) ==
+                 getU16(header + 5);
+        if (ok) {
+            topic[topic_length] = '\0';
+            payload[payload_length] = '\0';
+            message.topic = topic;
+            message.payload = payload;
+            message.retain = header[0] & 1;
+        }
+        free(buffer);
+    } else {
+        ok = false;
+    }
+    file.close();
+    return ok;
+}
+
+bool OutboundSpool::newerRetainedInRam(const String& topic) const {
+    for (uint8_t i = 0; i < ram_count; i++) {
+        const Message& m = ram[(ram_head + i) % SPOOL_RAM_SLOTS];
+        if (m.retain && m.topic == topic) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OutboundSpool::spillOldest() {
+    Message& oldest = ram[ram_head];
+    bool ok = flash_ready && writeRecord(oldest);
+    if (!ok) {
+        metric_dropped.inc();
+    }
+
+    ram_bytes -= oldest.topic.length() + oldest.payload.length();
+    oldest.topic = String();
+    oldest.payload = String();
+    ram_head = (ram_head + 1) % SPOOL_RAM_SLOTS;
+    ram_count--;
+    return ok;
+}
+
+bool OutboundSpool::enqueue(const char* topic, const char* payload, bool retain) {
+    if (!topic || !payload) {
+        return false;
+    }
+    size_t size = strlen(topic) + strlen(payload);
+
+    // A newer state value replaces the queued one
+    if (retain) {
+        for (uint8_t i = 0; i < ram_count; i++) {
+            Message& m = ram[(ram_head + i) % SPOOL_RAM_SLOTS];
+            if (m.retain && m.topic == topic) {
+                ram_bytes = ram_bytes - m.payload.length() + strlen(payload);
+                m.payload = payload;
+                metric_coalesced.inc();
+                return true;
+            }
+        }
+    }
+
+    if (size > SPOOL_RAM_BYTES) {
+        metric_dropped.inc();
+        return false;
+    }
+
+    if (isEmpty()) {
+        Serial.println("OutboundSpool: Broker unavailable - spooling outbound messages");
+        SIM_EVENT("spool", "started");
+    }
+
+    while (ram_count == SPOOL_RAM_SLOTS || ram_bytes + size > SPOOL_RAM_BYTES) {
+        spillOldest();
+    }
+
+    Message& m = ram[(ram_head + ram_count) % SPOOL_RAM_SLOTS];
+    m.topic = topic;
+    m.payload = payload;
+    m.retain = retain;
+    ram_count++;
+    ram_bytes += size;
+
+    updateGauges();
+    return true;
+}
+
+uint8_t OutboundSpool::drain(const SendFunction& send) {
+    uint32_t now = SimClock::millis();
+
+    // Token bucket: SPOOL_DRAIN_RATE per second, at most one batch banked
+    uint32_t elapsed = now - last_refill_ms;
+    last_refill_ms = now;
+    if (elapsed > 1000) {
+        elapsed = 1000;
+    }
+    tokens_milli += elapsed * SPOOL_DRAIN_RATE;
+    if (tokens_milli > SPOOL_DRAIN_BATCH * 1000) {
+        tokens_milli = SPOOL_DRAIN_BATCH * 1000;
+    }
+
+    if (now - window_start_ms >= 1000) {
+        metric_drain_rate.set(window_sent * 1000 / (now - window_start_ms));
+        window_start_ms = now;
+        window_sent = 0;
+    }
+
+    if (isEmpty()) {
+        return 0;
+    }
+
+    uint8_t sent = 0;
+    while (!isEmpty() && sent < SPOOL_DRAIN_BATCH && tokens_milli >= 1000) {
+        int oldest = oldestSegment();
+        if (oldest < 0) {
+            Message& m = ram[ram_head];
+            if (!send(m.topic.c_str(), m.payload.c_str(), m.retain)) {
+                break;
+            }
+            ram_bytes -= m.topic.length() + m.payload.length();
+            m.topic = String();
+            m.payload = String();
+            ram_head = (ram_head + 1) % SPOOL_RAM_SLOTS;
+            ram_count--;
+        } else {
+            Message m;
+            size_t next_offset = 0;
+            if (!readRecord(oldest, m, next_offset)) {
+                Serial.println("OutboundSpool: Unreadable record - dropping rest of segment");
+                dropSegment(oldest, true);
+                continue;
+            }
+
+            // A newer value for the same retained topic is still to come
+            bool superseded = m.retain && newerRetainedInRam(m.topic);
+            if (!superseded && !send(m.topic.c_str(), m.payload.c_str(), m.retain)) {
+                break;
+            }
+            read_offset = next_offset;
+            segment_records[oldest]--;
+            flash_records--;
+            if (segment_records[oldest] == 0) {
+                dropSegment(oldest, false);
+            }
+            if (superseded) {
+                metric_coalesced.inc();
+                continue;
+            }
+        }
+
+        sent++;
+        window_sent++;
+        tokens_milli -= 1000;
+        metric_drained.inc();
+    }
+
+    if (sent && isEmpty()) {
+        Serial.print("OutboundSpool: Drained (");
+        Serial.print(metric_drained.get());
+        Serial.println(" sent since boot)");
+        SIM_EVENT("spool", "drained");
+    }
+    updateGauges();
+    return sent;
+}
+
+void OutboundSpool::updateGauges() {
+    size_t flash_bytes = 0;
+    for (uint8_t i = 0; i < SPOOL_SEGMENTS; i++) {
+        flash_bytes += segment_size[i];
+    }
+    metric_depth.set(depth());
+    metric_flash_bytes.set(flash_bytes);
+}
+
+String OutboundSpool::getStatus() const {
+    return String(ram_count) + " in RAM, " + String(flash_records) + " on flash" +
+           (flash_ready ? "" : " (no flash)") + ", " + String(metric_drained.get()) + " drained, " +
+           String(metric_dropped.get()) + " dropped, " + String(metric_coalesced.get()) + " coalesced, " +
+           String(metric_drain_rate.get()) + "/s (limit " + String(SPOOL_DRAIN_RATE) + "/s)";
+}
@@ -0,0 +1,159 @@
+/**
+ * @file OutboundSpool.h
+ * @brief Bounded outbound MQTT spool for broker outages
+ *
+ * MQTTManager::publish() hands messages here while the broker is away, and
+ * drains them once it is back, so an outage no longer leaves a hole in the
+ * metrics snapshots, scheduler reports and display receipts.
+ *
+ * - New messages go to a RAM ring (SPOOL_RAM_SLOTS / SPOOL_RAM_BYTES)
+ * - When the ring is full its oldest message moves to a LittleFS segment;
+ *   SPOOL_SEGMENTS segments of SPOOL_SEGMENT_BYTES form a ring on flash,
+ *   and the oldest segment is dropped when it wraps
+ * - Retained messages are state (RSSI, uptime, connect timing): a newer
+ *   value replaces one still queued in RAM, and a flash copy is skipped
+ *   if RAM holds a newer one
+ * - Order is kept: flash (oldest) drains before RAM, and while anything is
+ *   queued new messages queue behind it
+ * - drain() sends at most SPOOL_DRAIN_BATCH per call and SPOOL_DRAIN_RATE
+ *   per second, so a long backlog never holds up inbound alerts
+ *
+ * Each flash record is closed as it is written (LittleFS commits on close),
+ * and records carry a checksum, so a reset loses at most the RAM ring; a
+ * torn record ends its segment. Segments left from before a reset drain
+ * first on the next connect. Delivery is at least once: a reset during a
+ * drain resends the current segment.
+ *
+ * Depth, flash use, drained/dropped/coalesced counts and the drain rate
+ * are exported as ledsign_spool_* metrics (src/Metrics.h).
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef OUTBOUND_SPOOL_H
+#define OUTBOUND_SPOOL_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Spool configuration constants (from defines.h)
+#ifndef SPOOL_RAM_SLOTS
+#define SPOOL_RAM_SLOTS           16
+#endif
+#ifndef SPOOL_RAM_BYTES
+#define SPOOL_RAM_BYTES           8192
+#endif
+#ifndef SPOOL_SEGMENT_PATH
+#define SPOOL_SEGMENT_PATH        "/spool%u.bin"
+#endif
+#ifndef SPOOL_SEGMENTS
+#define SPOOL_SEGMENTS            4
+#endif
+#ifndef SPOOL_SEGMENT_BYTES
+#define SPOOL_SEGMENT_BYTES       16384
+#endif
+#ifndef SPOOL_DRAIN_RATE
+#define SPOOL_DRAIN_RATE          10        // Messages per second
+#endif
+#ifndef SPOOL_DRAIN_BATCH
+#define SPOOL_DRAIN_BATCH         2         // Messages per drain() call
+#endif
+
+/**
+ * @brief RAM ring with LittleFS overflow for messages that could not be sent
+ */
+class OutboundSpool {
+public:
+    /**
+     * @brief Sends one message; return false to stop draining (it stays queued)
+     */
+    typedef std::function<bool(const char* topic, const char* payload, bool retain)> SendFunction;
+
+    OutboundSpool();
+
+    /**
+     * @brief Pick up segments left from before a reset (LittleFS must be mounted)
+     * @return true if flash overflow is available
+     */
+    bool begin();
+
+    /**
+     * @brief Discard everything queued, in RAM and on flash
+     */
+    void clear();
+
+    /**
+     * @brief Queue a message
+     * @param topic MQTT topic
+     * @param payload Message text
+     * @param retain Retained (state) message - replaces a queued one on the same topic
+     * @return false if the message was dropped
+     */
+    bool enqueue(const char* topic, const char* payload, bool retain);
+
+    /**
+     * @brief Send queued messages, oldest first, within the drain rate
+     * @param send Sender (called on the calling task)
+     * @return Messages sent
+     */
+    uint8_t drain(const SendFunction& send);
+
+    /**
+     * @brief Whether nothing is queued
+     */
+    bool isEmpty() const { return ram_count == 0 && flash_records == 0; }
+
+    /**
+     * @brief Messages queued in RAM and on flash
+     */
+    uint32_t depth() const { return ram_count + flash_records; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    struct Message {
+        String topic;
+        String payload;
+        bool retain;
+    };
+
+    // RAM ring (newest messages)
+    Message ram[SPOOL_RAM_SLOTS];
+    uint8_t ram_head;
+    uint8_t ram_count;
+    size_t ram_bytes;
+
+    // Flash ring (older messages); an empty segment has size 0
+    bool flash_ready;
+    uint32_t segment_sequence[SPOOL_SEGMENTS];
+    size_t segment_size[SPOOL_SEGMENTS];
+    uint16_t segment_records[SPOOL_SEGMENTS];
+    uint8_t write_segment;              ///< Segment receiving spilled messages
+    bool write_sealed;                  ///< Start a new segment before the next write
+    uint32_t last_sequence;
+    size_t read_offset;                 ///< Next record in the oldest segment
+    uint32_t flash_records;
+
+    // Drain rate limit
+    uint32_t tokens_milli;              ///< Send allowance x1000
+    uint32_t last_refill_ms;
+    uint32_t window_start_ms;
+    uint32_t window_sent;
+
+    static String segmentPath(uint8_t index);
+    int oldestSegment() const;
+    bool spillOldest();
+    bool writeRecord(const Message& message);
+    void dropSegment(uint8_t index, bool count_as_dropped);
+    bool readRecord(uint8_t index, Message& message, size_t& next_offset);
+    bool newerRetainedInRam(const String& topic) const;
+    void updateGauges();
+};
+
+#endif // OUTBOUND_SPOOL_H
@@ -0,0 +1,279 @@
+/**
+ * @file PlaylistPlayer.cpp
+ * @brief Implementation of the binary playlist sequencer
+ */
+
+#include "defines.h"
+#include "PlaylistPlayer.h"
+#include <MemoryPolicy.h>
+#include <HotPath.h>
+#include <LittleFS.h>
+#include <esp_timer.h>
+
+PlaylistPlayer::PlaylistPlayer(BETABRITE* sign)
+    : sign(sign), data(nullptr), data_length(0), owned(nullptr),
+      step_count(0), loop_start(0), looping(false), loop_offset(0),
+      slot_head(0), slot_fill(0), encode_offset(0), encode_step(0), encode_done(false),
+      running(false), next_deadline_us(0), latency_sum_us(0) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+PlaylistPlayer::~PlaylistPlayer() {
+    MemoryPolicy::release(owned);
+}
+
+bool PlaylistPlayer::loadFile(const char* path) {
+    if (running) {
+        return false;
+    }
+
+    // No auto-format here: a missing filesystem just means "use the built-in playlist"
+    if (!LittleFS.begin(false)) {
+        Serial.println("PlaylistPlayer: LittleFS not available");
+        return false;
+    }
+
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.print("PlaylistPlayer: No playlist at ");
+        Serial.println(path);
+        return false;
+    }
+
+    size_t size = file.size();
+    if (size < PLAYLIST_HEADER_SIZE || size > PLAYLIST_MAX_FILE_SIZE) {
+        Serial.print("PlaylistPlayer: Error - Invalid playlist size: ");
+        Serial.println(size);
+        file.close();
+        return false;
+    }
+
+    uint8_t* buffer = (uint8_t*)MemoryPolicy::allocate(size, MEM_BULK);
+    if (!buffer) {
+        Serial.println("PlaylistPlayer: Error - Out of memory");
+        file.close();
+        return false;
+    }
+
+    size_t read = file.read(buffer, size);
+    file.close();
+
+    if (read != size || !validate(buffer, size)) {
+        MemoryPolicy::release(buffer);
+        return false;
+    }
+
+    MemoryPolicy::release(owned);
+    owned = buffer;
+    data = buffer;
+    data_length = size;
+
+    Serial.print("PlaylistPlayer: Loaded ");
+    Serial.print(path);
+    Serial.print(" (");
+    Serial.print(step_count);
+    Serial.print(" steps, ");
+    Serial.print(size);
+    Serial.println(" bytes)");
+    return true;
+}
+
+bool PlaylistPlayer::loadBuffer(const uint8_t* buffer, size_t length) {
+    if (running || !buffer || !validate(buffer, length)) {
+        return false;
+    }
+
+    MemoryPolicy::release(owned);
+    owned = nullptr;
+    data = buffer;
+    data_length = length;
+
+    Serial.print("PlaylistPlayer: Loaded built-in playlist (");
+    Serial.print(step_count);
+    Serial.println(" steps)");
+    return true;
+}
+
+bool PlaylistPlayer::validate(const uint8_t* buffer, size_t length) {
+    if (length < PLAYLIST_HEADER_SIZE || memcmp(buffer, PLAYLIST_MAGIC, 4) != 0 ||
+        buffer[4] != PLAYLIST_VERSION) {
+        Serial.println("PlaylistPlayer: Error - Not a compiled playlist (run tools/playlist_compiler.py)");
+        return false;
+    }
+
+    uint16_t count = buffer[6] | (buffer[7] << 8);
+    uint16_t loop_index = buffer[8] | (buffer[9] << 8);
+    bool loop_flag = buffer[5] & PLAYLIST_FLAG_LOOP;
+
+    if (count == 0 || (loop_flag && loop_index >= count)) {
+        Serial.println("PlaylistPlayer: Error - Bad step count or loop start");
+        return false;
+    }
+
+    // Walk every step once so playback never has to bounds-check
+    size_t offset = PLAYLIST_HEADER_SIZE;
+    size_t loop_at = offset;
+    for (uint16_t i = 0; i < count; i++) {
+        if (i == loop_index) {
+            loop_at = offset;
+        }
+        if (offset + PLAYLIST_STEP_SIZE > length) {
+            Serial.println("PlaylistPlayer: Error - Truncated playlist");
+            return false;
+        }
+
+        uint8_t kind = buffer[offset];
+        uint8_t text_len = buffer[offset + 5];
+        if (kind > PLAYLIST_STEP_BLANK || text_len > PLAYLIST_MAX_TEXT ||
+            offset + PLAYLIST_STEP_SIZE + text_len > length) {
+            Serial.print("PlaylistPlayer: Error - Bad step ");
+            Serial.println(i);
+            return false;
+        }
+        offset += PLAYLIST_STEP_SIZE + text_len;
+    }
+
+    if (offset != length) {
+        Serial.println("PlaylistPlayer: Error - Trailing bytes after last step");
+        return false;
+    }
+
+    step_count = count;
+    looping = loop_flag;
+    loop_start = loop_flag ? loop_index : 0;
+    loop_offset = loop_at;
+    return true;
+}
+
+bool PlaylistPlayer::start() {
+    if (!data) {
+        return false;
+    }
+
+    slot_head = 0;
+    slot_fill = 0;
+    encode_offset = PLAYLIST_HEADER_SIZE;
+    encode_step = 0;
+    encode_done = false;
+    memset(&stats, 0, sizeof(stats));
+    latency_sum_us = 0;
+
+    // Fill the look-ahead before the first deadline
+    while (slot_fill < PLAYLIST_LOOKAHEAD && encodeNext()) {
+    }
+
+    next_deadline_us = esp_timer_get_time();
+    running = true;
+    Serial.println("PlaylistPlayer: Started");
+    return true;
+}
+
+void PlaylistPlayer::stop() {
+    if (running) {
+        running = false;
+        Serial.println("PlaylistPlayer: Stopped");
+    }
+}
+
+bool HOT_IRAM PlaylistPlayer::encodeNext() {
+    if (encode_done) {
+        return false;
+    }
+
+    if (encode_step >= step_count) {
+        if (!looping) {
+            encode_done = true;
+            return false;
+        }
+        encode_step = loop_start;
+        encode_offset = loop_offset;
+    }
+
+    const uint8_t* step = data + encode_offset;
+    uint8_t kind = step[0];
+    uint8_t text_len = step[5];
+
+    Slot& slot = slots[(slot_head + slot_fill) % PLAYLIST_LOOKAHEAD];
+    slot.step = encode_step;
+    slot.duration_ms = (uint32_t)step[6] | ((uint32_t)step[7] << 8) |
+                       ((uint32_t)step[8] << 16) | ((uint32_t)step[9] << 24);
+
+    // Every step restarts from a cancelled priority file, same as the old showAndWait()
+    size_t length = sign->EncodeCancelPriorityTextFile(slot.frame, sizeof(slot.frame));
+    if (kind == PLAYLIST_STEP_SHOW) {
+        char text[PLAYLIST_MAX_TEXT + 1];
+        memcpy(text, step + PLAYLIST_STEP_SIZE, text_len);
+        text[text_len] = '\0';
+        length += sign->EncodeTextFile(slot.frame + length, sizeof(slot.frame) - length,
+                                       BB_PRIORITY_FILE_LABEL, text,
+                                       (char)step[1], (char)step[2], (char)step[3], (char)step[4]);
+    }
+    slot.length = (uint16_t)length;
+
+    encode_offset += PLAYLIST_STEP_SIZE + text_len;
+    encode_step++;
+    slot_fill++;
+    return true;
+}
+
+void HOT_IRAM PlaylistPlayer::loop() {
+    if (!running) {
+        return;
+    }
+
+    if (esp_timer_get_time() >= next_deadline_us) {
+        if (slot_fill == 0) {
+            if (!encodeNext()) {
+                running = false;
+                Serial.print("PlaylistPlayer: Finished - ");
+                Serial.println(getStatus());
+                return;
+            }
+            stats.lookahead_misses++;
+        }
+
+        // Transition: one write of pre-encoded bytes
+        HOTPATH_PROFILE(HOTPATH_SIGN_WRITE);
+        Slot& slot = slots[slot_head];
+        sign->WriteRaw(slot.frame, slot.length);
+        int64_t sent_us = esp_timer_get_time();
+
+        uint32_t latency = (uint32_t)(sent_us - next_deadline_us);
+        if (stats.transitions == 0 || latency < stats.latency_min_us) stats.latency_min_us = latency;
+        if (latency > stats.latency_max_us) stats.latency_max_us = latency;
+        latency_sum_us += latency;
+
+        if (looping && slot.step == loop_start && stats.transitions > loop_start) {
+            stats.passes++;
+            Serial.print("PlaylistPlayer: Pass ");
+            Serial.print(stats.passes);
+            Serial.print(" complete - ");
+            Serial.println(getStatus());
+        }
+        stats.transitions++;
+
+        // Schedule from the deadline, not from now, so lateness never accumulates
+        next_deadline_us += (int64_t)slot.duration_ms * 1000;
+        slot_head = (slot_head + 1) % PLAYLIST_LOOKAHEAD;
+        slot_fill--;
+    }
+
+    // Encode ahead while the current step is on screen
+    while (slot_fill < PLAYLIST_LOOKAHEAD && encodeNext()) {
+    }
+}
+
+PlaylistPlayer::Stats PlaylistPlayer::getStats() const {
+    Stats snapshot = stats;
+    snapshot.latency_avg_us = stats.transitions ? (uint32_t)(latency_sum_us / stats.transitions) : 0;
+    return snapshot;
+}
+
+String PlaylistPlayer::getStatus() const {
+    Stats s = getStats();
+    String status = String(s.transitions) + " transitions";
+    status += ", latency us min/avg/max=" + String(s.latency_min_us) + "/" +
+              String(s.latency_avg_us) + "/" + String(s.latency_max_us);
+    status += ", lookahead misses=" + String(s.lookahead_misses);
+    return status;
+}
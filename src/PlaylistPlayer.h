@@ -0,0 +1,169 @@
+/**
+ * @file PlaylistPlayer.h
+ * @brief Binary playlist sequencer with look-ahead frame encoding
+ *
+ * Plays playlists compiled by tools/playlist_compiler.py (demo mode, showcase
+ * loops) instead of hardcoded C++ phases:
+ * - Playlist loaded from LittleFS, or used in place from a built-in byte array
+ * - The next PLAYLIST_LOOKAHEAD steps are encoded into a ring of ready-to-send
+ *   protocol frames while the current step is on screen, so a step transition
+ *   is a single UART write with no parsing, String building or allocation
+ * - Deadlines advance by step duration from the previous deadline (no drift)
+ * - Transition latency (deadline to frame handed to the UART) is measured
+ *
+ * Non-blocking: call loop() frequently from the owning loop.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef PLAYLIST_PLAYER_H
+#define PLAYLIST_PLAYER_H
+
+#include <Arduino.h>
+#include "BETABRITE.h"
+
+// Playlist configuration constants (from defines.h)
+#ifndef PLAYLIST_LOOKAHEAD
+#define PLAYLIST_LOOKAHEAD        4       // Steps encoded ahead of the current one
+#endif
+#ifndef PLAYLIST_MAX_FILE_SIZE
+#define PLAYLIST_MAX_FILE_SIZE    16384   // Largest playlist accepted from LittleFS
+#endif
+
+// Binary format (must match tools/playlist_compiler.py)
+#define PLAYLIST_MAGIC            "LSPL"
+#define PLAYLIST_VERSION          1
+#define PLAYLIST_FLAG_LOOP        0x01
+#define PLAYLIST_HEADER_SIZE      10      // magic(4) version flags step_count(2) loop_start(2)
+#define PLAYLIST_STEP_SIZE        10      // kind color position mode special text_len duration(4)
+#define PLAYLIST_MAX_TEXT         200
+#define PLAYLIST_STEP_SHOW        0
+#define PLAYLIST_STEP_BLANK       1
+
+// Cancel frame (13) + text frame (19 + text)
+#define PLAYLIST_SLOT_SIZE        (13 + 19 + PLAYLIST_MAX_TEXT)
+
+/**
+ * @brief Sequencer for compiled binary playlists
+ */
+class PlaylistPlayer {
+public:
+    /**
+     * @brief Step transition latency statistics
+     */
+    struct Stats {
+        uint32_t transitions;     ///< Steps transmitted
+        uint32_t passes;          ///< Completed passes through the loop section
+        uint32_t latency_min_us;  ///< Best deadline-to-UART latency
+        uint32_t latency_max_us;  ///< Worst deadline-to-UART latency
+        uint32_t latency_avg_us;  ///< Mean deadline-to-UART latency
+        uint32_t lookahead_misses;///< Transitions whose frame was not pre-encoded
+    };
+
+    /**
+     * @brief Constructor
+     * @param sign BETABRITE instance used for encoding and transmission
+     */
+    PlaylistPlayer(BETABRITE* sign);
+
+    /**
+     * @brief Destructor - frees a playlist loaded from file
+     */
+    ~PlaylistPlayer();
+
+    /**
+     * @brief Load a compiled playlist from LittleFS
+     * @param path File path (e.g. "/demo.lspl")
+     * @return true if the file exists and is a valid playlist
+     */
+    bool loadFile(const char* path);
+
+    /**
+     * @brief Use a compiled playlist in place (e.g. a built-in const array)
+     * @param data Playlist bytes (must outlive the player)
+     * @param length Size in bytes
+     * @return true if the data is a valid playlist
+     */
+    bool loadBuffer(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Start playback from the first step
+     * @return false if no playlist is loaded
+     */
+    bool start();
+
+    /**
+     * @brief Stop playback (the sign keeps the current frame)
+     */
+    void stop();
+
+    /**
+     * @brief Advance playback - call frequently
+     */
+    void loop();
+
+    /**
+     * @brief Check whether playback is in progress
+     * @return false once a non-looping playlist finishes
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Get number of steps in the loaded playlist
+     * @return Step count
+     */
+    uint16_t getStepCount() const { return step_count; }
+
+    /**
+     * @brief Get transition latency statistics
+     * @return Stats snapshot
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    /**
+     * @brief Encoded step waiting in the look-ahead ring
+     */
+    struct Slot {
+        char frame[PLAYLIST_SLOT_SIZE];   ///< Protocol bytes ready for the UART
+        uint16_t length;                  ///< Encoded bytes
+        uint16_t step;                    ///< Step index (for logging)
+        uint32_t duration_ms;             ///< Time on screen before the next step
+    };
+
+    BETABRITE* sign;
+    const uint8_t* data;
+    size_t data_length;
+    uint8_t* owned;                       ///< Heap copy when loaded from file
+
+    uint16_t step_count;
+    uint16_t loop_start;
+    bool looping;
+    size_t loop_offset;                   ///< Byte offset of the loop_start step
+
+    Slot slots[PLAYLIST_LOOKAHEAD];
+    uint8_t slot_head;                    ///< Next slot to transmit
+    uint8_t slot_fill;                    ///< Encoded slots waiting
+    size_t encode_offset;                 ///< Byte offset of the next step to encode
+    uint16_t encode_step;                 ///< Index of the next step to encode
+    bool encode_done;                     ///< Non-looping playlist fully encoded
+
+    bool running;
+    int64_t next_deadline_us;
+
+    Stats stats;
+    uint64_t latency_sum_us;
+
+    bool validate(const uint8_t* buffer, size_t length);
+    bool encodeNext();
+};
+
+#endif // PLAYLIST_PLAYER_H
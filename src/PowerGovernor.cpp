@@ -0,0 +1,282 @@
+/**
+ * @file PowerGovernor.cpp
+ * @brief Implementation of CPU frequency scaling and modem sleep policy
+ */
+
+#include "defines.h"
+#include "PowerGovernor.h"
+#include "Metrics.h"
+#include <WiFi.h>
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+namespace {
+MetricGauge metric_avg_ma("ledsign_power_avg_milliamps", "Estimated average current since boot (time in state)");
+MetricGauge metric_added_latency("ledsign_power_added_latency_us", "Estimated alert latency added by the power policy");
+MetricGauge metric_full_speed("ledsign_power_full_speed_percent", "Share of time at full CPU clock since boot");
+MetricCounter metric_wakes("ledsign_power_wakes_total", "Clock raises from idle for alert, sign or network work");
+
+const char* const LOCK_NAMES[] = {"alert", "sign", "network"};
+}
+
+PowerGovernor::PowerGovernor(BETABRITE* sign)
+    : sign(sign), started(false), use_pm(false), enabled(false), scaling(false), modem_sleep(false),
+      light_sleep(false), radio_listener(false), high(true), budget_ms(0), held_total(0), idle_since_ms(0), last_us(0), high_us(0), low_us(0),
+      radio_us(0), wakes(0), wake_max_us(0), wake_total_us(0) {
+    for (uint8_t i = 0; i < POWER_LOCK_COUNT; i++) {
+        held[i] = 0;
+        pm_locks[i] = nullptr;
+    }
+}
+
+bool PowerGovernor::begin(uint32_t budget) {
+#if CONFIG_PM_ENABLE
+    // Sign frames only need the APB clock (UART baud); the rest needs the CPU
+    use_pm = true;
+    for (uint8_t i = 0; i < POWER_LOCK_COUNT && use_pm; i++) {
+        esp_pm_lock_type_t type = (i == POWER_LOCK_SIGN) ? ESP_PM_APB_FREQ_MAX : ESP_PM_CPU_FREQ_MAX;
+        use_pm = esp_pm_lock_create(type, 0, LOCK_NAMES[i], (esp_pm_lock_handle_t*)&pm_locks[i]) == ESP_OK;
+    }
+#endif
+
+    started = true;
+    high = true;
+    last_us = micros();
+    idle_since_ms = millis();
+    budget_ms = budget;
+    applyPolicy();
+
+    Serial.print("PowerGovernor: ");
+    Serial.print(use_pm ? "esp_pm" : "manual clock switch");
+    Serial.print(", ");
+    Serial.println(getStatus());
+    return use_pm;
+}
+
+void PowerGovernor::setLatencyBudget(uint32_t budget) {
+    if (budget == budget_ms) {
+        return;
+    }
+    budget_ms = budget;
+    if (!started) {
+        return;
+    }
+    account();
+    applyPolicy();
+    Serial.print("PowerGovernor: Budget changed - ");
+    Serial.println(getStatus());
+}
+
+void PowerGovernor::setRadioListener(bool active) {
+    if (active == radio_listener) {
+        return;
+    }
+    radio_listener = active;
+    if (!started) {
+        return;
+    }
+    account();
+    applyPolicy();
+    Serial.print("PowerGovernor: Radio listener ");
+    Serial.print(active ? "on - " : "off - ");
+    Serial.println(getStatus());
+}
+
+void PowerGovernor::applyPolicy() {
+    enabled = budget_ms > 0;
+
+    // A clock raise that alone breaks the budget means no scaling at all
+    uint32_t wake_ms = (wake_max_us + 999) / 1000;
+    scaling = enabled && wake_ms <= budget_ms;
+    modem_sleep = scaling && !radio_listener && budget_ms >= POWER_MODEM_SLEEP_LATENCY_MS + wake_ms;
+    light_sleep = false;
+
+    // Governor off leaves the radio as the WiFi library sets it (modem sleep),
+    // unless ESP-NOW is listening: its frames are lost while the radio dozes
+    WiFi.setSleep(radio_listener ? false : (enabled ? modem_sleep : true));
+
+#if CONFIG_PM_ENABLE
+    if (use_pm) {
+        esp_pm_config_esp32_t pm = {};
+        pm.max_freq_mhz = POWER_MAX_FREQ_MHZ;
+        pm.min_freq_mhz = scaling ? POWER_MIN_FREQ_MHZ : POWER_MAX_FREQ_MHZ;
+        pm.light_sleep_enable = POWER_LIGHT_SLEEP && modem_sleep;
+        esp_err_t err = esp_pm_configure(&pm);
+        if (err != ESP_OK && pm.light_sleep_enable) {
+            // SDK built without tickless idle
+            pm.light_sleep_enable = false;
+            err = esp_pm_configure(&pm);
+        }
+        if (err != ESP_OK) {
+            Serial.println("PowerGovernor: esp_pm_configure failed - switching the clock manually");
+            use_pm = false;
+        } else {
+            light_sleep = pm.light_sleep_enable;
+            high = held_total > 0 || !scaling;
+            return;
+        }
+    }
+#endif
+
+    setHigh(held_total > 0 || !scaling);
+}
+
+void PowerGovernor::setHigh(bool on) {
+    if (on == high) {
+        return;
+    }
+    account();
+    high = on;
+    if (!use_pm) {
+        setCpuFrequencyMhz(on ? POWER_MAX_FREQ_MHZ : POWER_MIN_FREQ_MHZ);
+    }
+}
+
+void PowerGovernor::acquire(PowerLock lock) {
+    if (!started || lock >= POWER_LOCK_COUNT) {
+        return;
+    }
+    held[lock]++;
+    bool from_idle = held_total++ == 0;
+
+    // The first hold from idle is the wake an alert pays for
+    uint32_t start_us = micros();
+#if CONFIG_PM_ENABLE
+    if (use_pm) {
+        esp_pm_lock_acquire((esp_pm_lock_handle_t)pm_locks[lock]);
+        if (!from_idle) {
+            return;
+        }
+        account();
+        high = true;
+    }
+#endif
+    if (!use_pm) {
+        if (!from_idle || high) {
+            return;  // Already up (another hold, or within POWER_IDLE_AFTER_MS of the last)
+        }
+        setHigh(true);
+    }
+    if (!enabled) {
+        return;
+    }
+    uint32_t took_us = micros() - start_us;
+    wakes++;
+    wake_total_us += took_us;
+    metric_wakes.inc();
+    if (took_us > wake_max_us) {
+        wake_max_us = took_us;
+        if ((wake_max_us + 999) / 1000 > budget_ms) {
+            applyPolicy();  // A wake alone breaks the budget: stop scaling
+        }
+    }
+}
+
+void PowerGovernor::release(PowerLock lock) {
+    if (!started || lock >= POWER_LOCK_COUNT || held[lock] == 0) {
+        return;
+    }
+    held[lock]--;
+    held_total--;
+#if CONFIG_PM_ENABLE
+    if (use_pm) {
+        esp_pm_lock_release((esp_pm_lock_handle_t)pm_locks[lock]);
+        if (held_total == 0 && scaling) {
+            account();
+            high = false;
+        }
+    }
+#endif
+    if (held_total == 0) {
+        idle_since_ms = millis();
+    }
+}
+
+void PowerGovernor::account() {
+    uint32_t now_us = micros();
+    uint32_t elapsed = now_us - last_us;
+    last_us = now_us;
+    if (high) {
+        high_us += elapsed;
+    } else {
+        low_us += elapsed;
+    }
+    if ((enabled || radio_listener) && !modem_sleep) {
+        radio_us += elapsed;
+    }
+}
+
+void PowerGovernor::loop() {
+    if (!started) {
+        return;
+    }
+
+    // The frame a handler queued keeps going after the handler returns
+    bool sending = sign && !sign->TxIdle();
+    if (sending && held[POWER_LOCK_SIGN] == 0) {
+        acquire(POWER_LOCK_SIGN);
+    } else if (!sending && held[POWER_LOCK_SIGN] > 0) {
+        release(POWER_LOCK_SIGN);
+    }
+
+    // Manual mode: stay up briefly so back-to-back work does not bounce the clock
+    if (!use_pm && scaling && high && held_total == 0 && millis() - idle_since_ms >= POWER_IDLE_AFTER_MS) {
+        setHigh(false);
+    }
+
+    static uint32_t last_report_ms = 0;
+    if (millis() - last_report_ms >= 1000) {
+        last_report_ms = millis();
+        account();
+        metric_avg_ma.set(averageMilliamps());
+        metric_added_latency.set(addedLatencyUs());
+        metric_full_speed.set(fullSpeedPercent());
+    }
+}
+
+uint32_t PowerGovernor::averageMilliamps() const {
+    uint64_t total = high_us + low_us;
+    if (total == 0) {
+        return POWER_EST_MA_MAX_FREQ;
+    }
+    uint64_t ma_us = high_us * POWER_EST_MA_MAX_FREQ + low_us * POWER_EST_MA_MIN_FREQ +
+                     radio_us * POWER_EST_MA_RADIO_LISTEN;
+    return (uint32_t)(ma_us / total);
+}
+
+uint32_t PowerGovernor::addedLatencyUs() const {
+    if (!enabled) {
+        return 0;
+    }
+    uint32_t latency = wakes ? wake_total_us / wakes : 0;
+    if (modem_sleep) {
+        latency += POWER_MODEM_SLEEP_LATENCY_MS * 1000UL / 2;  // Mean wait for the next beacon
+    }
+    return latency;
+}
+
+uint8_t PowerGovernor::fullSpeedPercent() const {
+    uint64_t total = high_us + low_us;
+    return total ? (uint8_t)(high_us * 100 / total) : 100;
+}
+
+String PowerGovernor::getStatus() const {
+    if (!enabled) {
+        return "off (budget 0), ~" + String(averageMilliamps()) + " mA";
+    }
+    String status = "budget " + String(budget_ms) + " ms, ";
+    status += light_sleep ? "light sleep" : (modem_sleep ? "modem sleep" : (radio_listener ? "radio awake (ESP-NOW)" : "radio awake"));
+    status += ", ~" + String(averageMilliamps()) + " mA, +" + String(addedLatencyUs()) + " us/alert, ";
+    status += String(fullSpeedPercent()) + "% at " + String(POWER_MAX_FREQ_MHZ) + " MHz, " + String(wakes) + " wakes";
+    if (held_total) {
+        status += ", held:";
+        for (uint8_t i = 0; i < POWER_LOCK_COUNT; i++) {
+            if (held[i]) {
+                status += " ";
+                status += LOCK_NAMES[i];
+            }
+        }
+    }
+    return status;
+}
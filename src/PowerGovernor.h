@@ -0,0 +1,195 @@
+/**
+ * @file PowerGovernor.h
+ * @brief CPU frequency scaling and WiFi modem sleep between alerts
+ *
+ * Between alerts the main loop only polls, yet it used to do so at 240 MHz
+ * with the radio listening. The governor lets the CPU drop to
+ * POWER_MIN_FREQ_MHZ and the radio doze between beacons, and holds full
+ * speed only while there is real work:
+ * - POWER_LOCK_ALERT: parsing and encoding an alert (handleMQTTMessage())
+ * - POWER_LOCK_SIGN: a frame is still leaving the sign UART (polled in loop())
+ * - POWER_LOCK_NETWORK: broker connect / TLS handshake
+ *
+ * With ESP-IDF power management in the SDK (CONFIG_PM_ENABLE) the locks are
+ * esp_pm locks and the IDF scales the clock (and, if the SDK has tickless
+ * idle, light-sleeps the idle task). Otherwise the governor switches the
+ * clock itself: up on the first lock, down after POWER_IDLE_AFTER_MS with
+ * none held.
+ *
+ * Sleeping costs alert latency: modem sleep delays delivery by up to one
+ * DTIM beacon interval (POWER_MODEM_SLEEP_LATENCY_MS) and every wake pays
+ * the clock switch. Both are held against a latency budget (config key
+ * "power_budget_ms"): modem sleep is used only if it fits, and 0 turns the
+ * governor off (full clock, radio as WiFi left it).
+ *
+ * Modem and light sleep rely on the access point buffering unicast traffic
+ * until the next DTIM beacon. Nothing buffers ESP-NOW frames: the handheld
+ * remote sends once, so a dozing radio loses its commands. While a radio
+ * listener is registered (setRadioListener()), the radio stays awake
+ * (WIFI_PS_NONE) and light sleep is skipped whatever the budget; only the
+ * clock still scales. That costs roughly POWER_EST_MA_RADIO_LISTEN mA for
+ * as long as the remote channel is up.
+ *
+ * Average current is an estimate from time spent in each state and the
+ * POWER_EST_MA_* figures (datasheet typicals), not a measurement; light
+ * sleep is not counted, so with it the real figure is lower.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <Arduino.h>
+#include "BETABRITE.h"
+
+// Power governor constants (from defines.h)
+#ifndef POWER_MAX_FREQ_MHZ
+#define POWER_MAX_FREQ_MHZ        240
+#endif
+#ifndef POWER_MIN_FREQ_MHZ
+#define POWER_MIN_FREQ_MHZ        80
+#endif
+#ifndef POWER_LIGHT_SLEEP
+#define POWER_LIGHT_SLEEP         true
+#endif
+#ifndef POWER_IDLE_AFTER_MS
+#define POWER_IDLE_AFTER_MS       200
+#endif
+#ifndef POWER_LATENCY_BUDGET_MS
+#define POWER_LATENCY_BUDGET_MS   0
+#endif
+#ifndef POWER_MODEM_SLEEP_LATENCY_MS
+#define POWER_MODEM_SLEEP_LATENCY_MS 103
+#endif
+#ifndef POWER_EST_MA_MAX_FREQ
+#define POWER_EST_MA_MAX_FREQ     68
+#endif
+#ifndef POWER_EST_MA_MIN_FREQ
+#define POWER_EST_MA_MIN_FREQ     31
+#endif
+#ifndef POWER_EST_MA_RADIO_LISTEN
+#define POWER_EST_MA_RADIO_LISTEN 65
+#endif
+
+/**
+ * @brief Why full speed is held
+ */
+enum PowerLock : uint8_t {
+    POWER_LOCK_ALERT,
+    POWER_LOCK_SIGN,
+    POWER_LOCK_NETWORK,
+    POWER_LOCK_COUNT
+};
+
+/**
+ * @brief Clock and radio sleep policy with time-in-state accounting
+ */
+class PowerGovernor {
+public:
+    /**
+     * @brief Holds a lock for the life of a scope
+     */
+    class Hold {
+    public:
+        Hold(PowerGovernor& governor, PowerLock lock) : governor(governor), lock(lock) { governor.acquire(lock); }
+        ~Hold() { governor.release(lock); }
+        Hold(const Hold&) = delete;
+        Hold& operator=(const Hold&) = delete;
+
+    private:
+        PowerGovernor& governor;
+        PowerLock lock;
+    };
+
+    /**
+     * @param sign Sign interface polled for POWER_LOCK_SIGN
+     */
+    explicit PowerGovernor(BETABRITE* sign);
+
+    /**
+     * @brief Set up power management (after WiFi has started)
+     * @param budget_ms Added alert latency allowed (0 = governor off)
+     * @return true if esp_pm is in use, false for the manual clock switch
+     */
+    bool begin(uint32_t budget_ms);
+
+    /**
+     * @brief Change the latency budget and re-apply the policy
+     */
+    void setLatencyBudget(uint32_t budget_ms);
+
+    /**
+     * @brief Keep the radio awake for traffic the access point cannot buffer (ESP-NOW)
+     * @param active true while such a listener is running
+     */
+    void setRadioListener(bool active);
+
+    /**
+     * @brief Hold full speed for a reason (nests per reason)
+     */
+    void acquire(PowerLock lock);
+
+    /**
+     * @brief Drop one hold taken by acquire()
+     */
+    void release(PowerLock lock);
+
+    /**
+     * @brief Sign lock, idle clock drop and accounting - call every loop pass
+     */
+    void loop();
+
+    /**
+     * @brief Estimated average current since boot, in mA
+     */
+    uint32_t averageMilliamps() const;
+
+    /**
+     * @brief Estimated alert latency the current policy adds, in microseconds
+     */
+    uint32_t addedLatencyUs() const;
+
+    /**
+     * @brief Share of time at full clock since boot (percent)
+     */
+    uint8_t fullSpeedPercent() const;
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    BETABRITE* sign;
+    bool started;
+    bool use_pm;                        ///< esp_pm locks rather than setCpuFrequencyMhz()
+    bool enabled;                       ///< Budget > 0
+    bool scaling;                       ///< Clock may drop to POWER_MIN_FREQ_MHZ
+    bool modem_sleep;
+    bool light_sleep;
+    bool radio_listener;                ///< Unbuffered receiver running: no modem or light sleep
+    bool high;                          ///< Clock at POWER_MAX_FREQ_MHZ (or held there)
+    uint32_t budget_ms;
+    uint8_t held[POWER_LOCK_COUNT];
+    uint8_t held_total;
+    void* pm_locks[POWER_LOCK_COUNT];   ///< esp_pm_lock_handle_t
+    uint32_t idle_since_ms;             ///< millis() the last lock was released
+
+    uint32_t last_us;                   ///< micros() of the last accounting step
+    uint64_t high_us;                   ///< Time at full clock
+    uint64_t low_us;                    ///< Time at POWER_MIN_FREQ_MHZ
+    uint64_t radio_us;                  ///< Time with the radio listening (no modem sleep)
+    uint32_t wakes;
+    uint32_t wake_max_us;               ///< Slowest clock raise seen
+    uint32_t wake_total_us;
+
+    void account();
+    void applyPolicy();
+    void setHigh(bool on);
+};
+
+#endif // POWER_GOVERNOR_H
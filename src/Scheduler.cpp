@@ -0,0 +1,185 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Implementation of the main-loop component scheduler
+ */
+
+#include "defines.h"
+#include "Scheduler.h"
+#include "Metrics.h"
+#include "SimClock.h"
+#include <HotPath.h>
+#include <algorithm>
+
+namespace {
+MetricCounter metric_overruns("ledsign_scheduler_overruns_total", "Component runs that exceeded their time budget");
+
+// Deadlines wrap with millis(): compare through a signed difference
+inline bool isDue(uint32_t deadline_ms, uint32_t now_ms) {
+    return (int32_t)(deadline_ms - now_ms) <= 0;
+}
+}
+
+Scheduler::Scheduler()
+    : component_count(0), window_start_ms(0), total_overruns(0) {
+}
+
+bool Scheduler::add(const char* name, RunFunction run, uint32_t budget_us, SetupFunction setup) {
+    if (!run || component_count >= SCHEDULER_MAX_COMPONENTS) {
+        Serial.print("Scheduler: Cannot register ");
+        Serial.println(name);
+        return false;
+    }
+
+    Component& c = components[component_count++];
+    c.name = name;
+    c.run = run;
+    c.setup = setup;
+    c.budget_us = budget_us;
+    c.deadline_ms = 0;
+    c.enabled = true;
+    c.runs = 0;
+    c.cpu_us = 0;
+    c.max_us = 0;
+    c.overruns = 0;
+    c.worst_us = 0;
+    return true;
+}
+
+void Scheduler::begin() {
+    uint32_t now = SimClock::millis();
+    for (uint8_t i = 0; i < component_count; i++) {
+        Component& c = components[i];
+        if (c.setup && !c.setup()) {
+            c.enabled = false;
+            Serial.print("Scheduler: Setup failed, disabled ");
+            Serial.println(c.name);
+        }
+        c.deadline_ms = now;
+    }
+    window_start_ms = now;
+
+    Serial.print("Scheduler: ");
+    Serial.print(component_count);
+    Serial.println(" components registered");
+}
+
+uint8_t HOT_IRAM Scheduler::loop() {
+    uint32_t now = SimClock::millis();
+
+    // Collect due components, ordered by deadline (stable: ties keep registration order)
+    uint8_t due[SCHEDULER_MAX_COMPONENTS];
+    uint8_t due_count = 0;
+    for (uint8_t i = 0; i < component_count; i++) {
+        if (!components[i].enabled || !isDue(components[i].deadline_ms, now)) {
+            continue;
+        }
+        uint8_t pos = due_count++;
+        while (pos > 0 && (int32_t)(components[due[pos - 1]].deadline_ms - components[i].deadline_ms) > 0) {
+            due[pos] = due[pos - 1];
+            pos--;
+        }
+        due[pos] = i;
+    }
+
+    for (uint8_t n = 0; n < due_count; n++) {
+        Component& c = components[due[n]];
+
+        uint32_t start_us = micros();
+        uint32_t next = c.run(now);
+        uint32_t elapsed_us = micros() - start_us;
+
+        // Polled components come back at now; keep that so ties stay in registration order
+        c.deadline_ms = isDue(next, now) ? now : next;
+        c.runs++;
+        c.cpu_us += elapsed_us;
+        if (elapsed_us > c.max_us) {
+            c.max_us = elapsed_us;
+        }
+        if (elapsed_us > c.worst_us) {
+            c.worst_us = elapsed_us;
+        }
+        if (elapsed_us > c.budget_us) {
+            c.overruns++;
+            total_overruns++;
+            metric_overruns.inc();
+        }
+    }
+
+    // Earliest future deadline for the virtual clock (no-op in normal builds)
+    for (uint8_t i = 0; i < component_count; i++) {
+        if (components[i].enabled && !isDue(components[i].deadline_ms, now)) {
+            SimClock::wakeAt(components[i].deadline_ms);
+        }
+    }
+
+    return due_count;
+}
+
+uint32_t Scheduler::idleMs(uint32_t max_ms) const {
+    uint32_t now = SimClock::millis();
+    uint32_t idle = max_ms;
+    for (uint8_t i = 0; i < component_count; i++) {
+        const Component& c = components[i];
+        if (!c.enabled) {
+            continue;
+        }
+        if (isDue(c.deadline_ms, now)) {
+            return 0;
+        }
+        idle = std::min(idle, c.deadline_ms - now);
+    }
+    return idle;
+}
+
+String Scheduler::report() {
+    uint32_t now = SimClock::millis();
+    uint32_t busy_us = 0;
+
+    String json;
+    json.reserve(64 + component_count * 96);
+    json += "{\"window_ms\":";
+    json += String(now - window_start_ms);
+    json += ",\"c\":[";
+
+    for (uint8_t i = 0; i < component_count; i++) {
+        Component& c = components[i];
+        busy_us += c.cpu_us;
+        if (i) {
+            json += ',';
+        }
+        json += "{\"name\":\"";
+        json += c.name;
+        json += "\",\"runs\":" + String(c.runs);
+        json += ",\"cpu_us\":" + String(c.cpu_us);
+        json += ",\"max_us\":" + String(c.max_us);
+        json += ",\"budget_us\":" + String(c.budget_us);
+        json += ",\"overruns\":" + String(c.overruns);
+        json += '}';
+
+        c.runs = 0;
+        c.cpu_us = 0;
+        c.max_us = 0;
+    }
+
+    json += "],\"busy_us\":" + String(busy_us) + "}";
+    window_start_ms = now;
+    return json;
+}
+
+String Scheduler::getStatus() const {
+    String status = String(component_count) + " components, " + String(total_overruns) + " overruns";
+
+    // Name the component that has run longest past its budget
+    const Component* worst = nullptr;
+    for (uint8_t i = 0; i < component_count; i++) {
+        const Component& c = components[i];
+        if (c.overruns && (!worst || c.worst_us - c.budget_us > worst->worst_us - worst->budget_us)) {
+            worst = &c;
+        }
+    }
+    if (worst) {
+        status += " (worst: " + String(worst->name) + " " + String(worst->worst_us) + "us, budget " +
+                  String(worst->budget_us) + "us)";
+    }
+    return status;
+}
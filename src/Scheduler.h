@@ -0,0 +1,128 @@
+/**
+ * @file Scheduler.h
+ * @brief Component registry and deadline scheduler for the main loop
+ *
+ * Each piece of main-loop work is a component: a name, an optional setup
+ * step, a run step and a time budget. The run step does its work and returns
+ * its next deadline, so interval bookkeeping lives with the component and
+ * loop() no longer grows with each feature:
+ *
+ *     scheduler.add("health", [](uint32_t now) -> uint32_t {
+ *         if (now - last_health_check > HEALTH_CHECK_INTERVAL) { ... }
+ *         return last_health_check + HEALTH_CHECK_INTERVAL + 1;
+ *     }, 20000);
+ *
+ * - Due components run in deadline order; ties keep registration order
+ * - A run step that returns a deadline at or before now is polled on every
+ *   pass; socket and queue polls return their poll interval instead, so
+ *   there is always a next deadline to wait for
+ * - loop() sleeps until the earliest deadline (idleMs()), which is what lets
+ *   the power governor's light sleep and idle clock take effect
+ * - Future deadlines are reported to SimClock::wakeAt(), so the virtual-clock
+ *   build jumps straight to the next one
+ * - Runs longer than the budget count as overruns; per-component CPU time
+ *   is reported over MQTT (see report())
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Scheduler configuration constants (from defines.h)
+#ifndef SCHEDULER_MAX_COMPONENTS
+#define SCHEDULER_MAX_COMPONENTS  32
+#endif
+
+/**
+ * @brief Deadline-ordered runner for registered components
+ */
+class Scheduler {
+public:
+    /**
+     * @brief Run step: do the work that is due, return the next deadline
+     * @param now_ms SimClock::millis() when the pass started
+     * @return Next deadline in ms (at or before now_ms = poll every pass)
+     */
+    typedef uint32_t (*RunFunction)(uint32_t now_ms);
+
+    /**
+     * @brief Optional one-time setup, called from begin()
+     * @return false to leave the component disabled
+     */
+    typedef bool (*SetupFunction)();
+
+    Scheduler();
+
+    /**
+     * @brief Register a component (before begin())
+     * @param name Short name used in reports (string literal)
+     * @param run Run step
+     * @param budget_us Longest expected run; longer runs count as overruns
+     * @param setup Optional setup step
+     * @return false if the table is full
+     */
+    bool add(const char* name, RunFunction run, uint32_t budget_us, SetupFunction setup = nullptr);
+
+    /**
+     * @brief Run every component's setup step; all components start due
+     */
+    void begin();
+
+    /**
+     * @brief Run the components that are due - call from loop()
+     * @return Number of components run
+     */
+    uint8_t loop();
+
+    /**
+     * @brief Time until the earliest deadline, for sleeping between passes
+     * @param max_ms Cap (also returned when nothing is registered)
+     * @return 0 if a component is already due
+     */
+    uint32_t idleMs(uint32_t max_ms) const;
+
+    /**
+     * @brief CPU time report since the previous report, then start a new window
+     *
+     * {"window_ms":..,"c":[{"name":..,"runs":..,"cpu_us":..,"max_us":..,
+     *  "budget_us":..,"overruns":..},...],"busy_us":..} - overruns are since boot
+     *
+     * @return Report JSON
+     */
+    String report();
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    struct Component {
+        const char* name;
+        RunFunction run;
+        SetupFunction setup;
+        uint32_t budget_us;
+        uint32_t deadline_ms;
+        bool enabled;
+        // Current report window
+        uint32_t runs;
+        uint32_t cpu_us;
+        uint32_t max_us;
+        // Since boot
+        uint32_t overruns;
+        uint32_t worst_us;
+    };
+
+    Component components[SCHEDULER_MAX_COMPONENTS];
+    uint8_t component_count;
+    uint32_t window_start_ms;
+    uint32_t total_overruns;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,266 @@
+/**
+ * @file SequenceEngine.cpp
+ * @brief Implementation of the timed sequence engine
+ */
+
+#include "defines.h"
+#include "SequenceEngine.h"
+#include <HotPath.h>
+#include <esp_timer.h>
+
+SequenceEngine::SequenceEngine(BETABRITE* sign)
+    : sign(sign), task(nullptr), arena_used(0), frame_count(0), loaded_countdown(0),
+      running(false), abort_requested(false), report_ready(false), start_us(0), total_runs(0) {
+    memset(&last_report, 0, sizeof(last_report));
+}
+
+bool SequenceEngine::begin() {
+    if (task) {
+        return true;
+    }
+
+    // Same core as loopTask so SignController and the engine never write concurrently
+    // on different cores; higher priority so deadlines preempt the main loop
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "sequence", 4096, this,
+                                                SEQ_TASK_PRIORITY, &task, 1);
+    if (result != pdPASS) {
+        Serial.println("SequenceEngine: Error - Failed to create task");
+        task = nullptr;
+        return false;
+    }
+
+    Serial.println("SequenceEngine: Initialized");
+    return true;
+}
+
+bool SequenceEngine::clear() {
+    if (running) {
+        return false;
+    }
+    arena_used = 0;
+    frame_count = 0;
+    loaded_countdown = 0;
+    return true;
+}
+
+bool SequenceEngine::appendFrame(uint32_t at_ms, size_t length) {
+    if (length == 0) {
+        Serial.println("SequenceEngine: Error - Timeline arena full");
+        return false;
+    }
+
+    Frame& frame = frames[frame_count++];
+    frame.offset = (uint16_t)arena_used;
+    frame.length = (uint16_t)length;
+    frame.at_ms = at_ms;
+    arena_used += length;
+    return true;
+}
+
+bool SequenceEngine::addFrame(uint32_t at_ms, const char* text, char color, char mode,
+                              char special, char charset, char position) {
+    if (running || !text || frame_count >= SEQ_MAX_FRAMES) {
+        return false;
+    }
+    if (frame_count > 0 && at_ms < frames[frame_count - 1].at_ms) {
+        Serial.println("SequenceEngine: Error - Frame deadlines must not decrease");
+        return false;
+    }
+
+    // Charset select prefix, same as DemoMode::showAndWait
+    char contents[128];
+    int n = snprintf(contents, sizeof(contents), "%c%c%s", BB_FC_SELECTCHARSET, charset, text);
+    if (n < 0 || n >= (int)sizeof(contents)) {
+        Serial.println("SequenceEngine: Error - Frame text too long");
+        return false;
+    }
+
+    size_t length = sign->EncodeTextFile(arena + arena_used, SEQ_ARENA_SIZE - arena_used,
+                                         BB_PRIORITY_FILE_LABEL, contents, color, position, mode, special);
+    loaded_countdown = 0;
+    return appendFrame(at_ms, length);
+}
+
+bool SequenceEngine::addCancel(uint32_t at_ms) {
+    if (running || frame_count >= SEQ_MAX_FRAMES) {
+        return false;
+    }
+    if (frame_count > 0 && at_ms < frames[frame_count - 1].at_ms) {
+        return false;
+    }
+
+    size_t length = sign->EncodeCancelPriorityTextFile(arena + arena_used, SEQ_ARENA_SIZE - arena_used);
+    return appendFrame(at_ms, length);
+}
+
+bool SequenceEngine::loadCountdown(uint8_t seconds, uint32_t go_hold_ms) {
+    if (seconds < 1 || seconds > 9 || !clear()) {
+        return false;
+    }
+
+    bool ok = true;
+    char digit[2] = {0, 0};
+    for (uint8_t i = 0; i < seconds; i++) {
+        uint8_t value = seconds - i;
+        digit[0] = '0' + value;
+        // Last second before GO! is amber, the rest red (racing lights)
+        ok &= addFrame(i * 1000UL, digit, value == 1 ? BB_COL_AMBER : BB_COL_RED);
+    }
+    ok &= addFrame(seconds * 1000UL, "GO!", BB_COL_GREEN, BB_DM_FLASH);
+    ok &= addCancel(seconds * 1000UL + go_hold_ms);
+
+    if (!ok) {
+        clear();
+        return false;
+    }
+
+    loaded_countdown = seconds;
+    Serial.print("SequenceEngine: Loaded ");
+    Serial.print(seconds);
+    Serial.print("s countdown (");
+    Serial.print(frame_count);
+    Serial.print(" frames, ");
+    Serial.print(arena_used);
+    Serial.println(" bytes)");
+    return true;
+}
+
+bool SequenceEngine::start() {
+    if (!task || running || frame_count == 0) {
+        return false;
+    }
+
+    // Lead time so every frame can finish by its deadline: frame i cannot be out before all
+    // frames up to it have crossed the wire back to back. The margin covers the task wake-up.
+    const int64_t margin_us = 2000;
+    int64_t lead_us = margin_us;
+    int64_t wire_us = 0;
+    for (uint16_t i = 0; i < frame_count; i++) {
+        wire_us += wireTimeUs(frames[i].length);
+        int64_t need = wire_us - (int64_t)frames[i].at_ms * 1000;
+        if (need + margin_us > lead_us) lead_us = need + margin_us;
+    }
+
+    if (!sign->Claim(task)) {
+        return false;
+    }
+
+    abort_requested = false;
+    start_us = esp_timer_get_time() + lead_us;
+    running = true;
+    xTaskNotifyGive(task);
+    return true;
+}
+
+void SequenceEngine::stop() {
+    if (running) {
+        abort_requested = true;
+    }
+}
+
+bool SequenceEngine::takeRunReport(RunReport& report) {
+    if (!report_ready) {
+        return false;
+    }
+    report = last_report;
+    report_ready = false;
+    return true;
+}
+
+void SequenceEngine::taskEntry(void* arg) {
+    static_cast<SequenceEngine*>(arg)->taskLoop();
+}
+
+void SequenceEngine::taskLoop() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        runTimeline();
+    }
+}
+
+void HOT_IRAM SequenceEngine::runTimeline() {
+    RunReport report;
+    memset(&report, 0, sizeof(report));
+    report.jitter_min_us = INT32_MAX;
+    report.jitter_max_us = INT32_MIN;
+    uint64_t jitter_abs_sum = 0;
+    int64_t done_us = start_us;
+
+    for (uint16_t i = 0; i < frame_count; i++) {
+        if (abort_requested) {
+            report.aborted = true;
+            break;
+        }
+
+        const Frame& frame = frames[i];
+        int64_t deadline_us = start_us + (int64_t)frame.at_ms * 1000;
+        int64_t target_us = deadline_us - wireTimeUs(frame.length);
+
+        waitUntil(target_us);
+
+        int64_t tx_us = esp_timer_get_time();
+        sign->WriteRaw(arena + frame.offset, frame.length);
+        sign->flush();  // Returns once the last byte has left the UART
+        done_us = esp_timer_get_time();
+
+        int32_t jitter = (int32_t)(tx_us - target_us);
+        int32_t glass = (int32_t)(done_us - deadline_us);
+        if (jitter < report.jitter_min_us) report.jitter_min_us = jitter;
+        if (jitter > report.jitter_max_us) report.jitter_max_us = jitter;
+        jitter_abs_sum += jitter < 0 ? -jitter : jitter;
+        if (glass > report.glass_max_us) report.glass_max_us = glass;
+        report.frames++;
+    }
+
+    if (report.frames > 0) {
+        report.jitter_avg_us = (uint32_t)(jitter_abs_sum / report.frames);
+        report.duration_ms = (uint32_t)((done_us - start_us) / 1000);
+    } else {
+        report.jitter_min_us = 0;
+        report.jitter_max_us = 0;
+    }
+
+    sign->Release(task);
+    last_report = report;
+    total_runs++;
+    report_ready = true;
+    running = false;
+}
+
+uint32_t HOT_IRAM SequenceEngine::wireTimeUs(size_t bytes) {
+    return (uint32_t)(((uint64_t)bytes * SEQ_WIRE_NS_PER_BYTE) / 1000ULL);
+}
+
+void HOT_IRAM SequenceEngine::waitUntil(int64_t target_us) {
+    for (;;) {
+        int64_t remaining = target_us - esp_timer_get_time();
+        if (remaining <= 0) {
+            return;
+        }
+        if (remaining > 3000) {
+            // Sleep in ticks, leaving ~2 ms to spin so tick granularity does not add jitter
+            vTaskDelay(pdMS_TO_TICKS((remaining - 2000) / 1000));
+        }
+        // else: spin on esp_timer for the final stretch
+    }
+}
+
+String SequenceEngine::getStatus() const {
+    String status = running ? "Running" : "Idle";
+    status += ", " + String(frame_count) + " frames";
+    if (loaded_countdown > 0) {
+        status += " (" + String(loaded_countdown) + "s countdown)";
+    }
+    status += ", runs=" + String(total_runs);
+    if (total_runs > 0) {
+        status += ", last jitter us min/avg/max=";
+        status += String(last_report.jitter_min_us) + "/";
+        status += String(last_report.jitter_avg_us) + "/";
+        status += String(last_report.jitter_max_us);
+        status += " glass_max=" + String(last_report.glass_max_us);
+    }
+    if (sign->GetBytesRefused() > 0) {
+        status += ", other writers refused " + String(sign->GetBytesRefused()) + " bytes";
+    }
+    return status;
+}
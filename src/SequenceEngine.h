@@ -0,0 +1,183 @@
+/**
+ * @file SequenceEngine.h
+ * @brief Frame-accurate timed sequence engine for countdowns and choreographed effects
+ *
+ * Replaces hand-timed delay() chains with a timeline of pre-encoded frames:
+ * - Frames are encoded once into a static arena when the timeline is loaded,
+ *   so triggering a run costs only a start notification
+ * - A dedicated high-priority task transmits each frame so that its last byte
+ *   (EOT, when the sign acts on it) lands on the frame's deadline; known wire
+ *   time at 9600 baud 7E1 is subtracted from the transmit start
+ * - Coarse waits sleep, the final ~2 ms spin on esp_timer for sub-tick accuracy
+ * - Per-run jitter (transmit start vs target) and on-glass error (last byte out
+ *   vs deadline) are recorded and reported
+ *
+ * While a run is in progress the engine's task holds the sign (BETABRITE::Claim),
+ * so bytes from every other writer (SignController, OTA status, playlist, demo,
+ * model and diagnostic reads) are refused until the run ends. SignController is
+ * still suspended by the caller so it holds its messages instead of losing them.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef SEQUENCE_ENGINE_H
+#define SEQUENCE_ENGINE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "BETABRITE.h"
+
+// Sequence configuration constants (from defines.h)
+#ifndef SEQ_MAX_FRAMES
+#define SEQ_MAX_FRAMES            32
+#endif
+#ifndef SEQ_ARENA_SIZE
+#define SEQ_ARENA_SIZE            2048
+#endif
+#ifndef SEQ_TASK_PRIORITY
+#define SEQ_TASK_PRIORITY         5       // Above loopTask (1), below WiFi/LwIP
+#endif
+#ifndef SEQ_WIRE_NS_PER_BYTE
+#define SEQ_WIRE_NS_PER_BYTE      1041667 // 10 bits per byte (7E1 + start/stop) at 9600 baud
+#endif
+
+/**
+ * @brief Timeline of pre-encoded sign frames executed against absolute deadlines
+ */
+class SequenceEngine {
+public:
+    /**
+     * @brief Timing results of one completed run
+     */
+    struct RunReport {
+        uint16_t frames;            ///< Frames transmitted
+        bool aborted;               ///< Run stopped before the last frame
+        int32_t jitter_min_us;      ///< Earliest transmit start relative to target
+        int32_t jitter_max_us;      ///< Latest transmit start relative to target
+        uint32_t jitter_avg_us;     ///< Mean absolute transmit start error
+        int32_t glass_max_us;       ///< Worst last-byte-out error vs deadline
+        uint32_t duration_ms;       ///< First deadline to last frame complete
+    };
+
+    /**
+     * @brief Constructor
+     * @param sign BETABRITE instance used for encoding and transmission
+     */
+    SequenceEngine(BETABRITE* sign);
+
+    /**
+     * @brief Create the transmit task
+     * @return true if the task was created
+     */
+    bool begin();
+
+    /**
+     * @brief Remove all frames from the timeline
+     * @return false if a run is in progress
+     */
+    bool clear();
+
+    /**
+     * @brief Append a priority-file text frame
+     * @param at_ms Deadline relative to run start (must not decrease)
+     * @param text Frame text
+     * @param color Initial color
+     * @param mode Display mode
+     * @param special Special effect (used with BB_DM_SPECIAL)
+     * @param charset Character set
+     * @param position Display position
+     * @return true if the frame fit in the timeline
+     */
+    bool addFrame(uint32_t at_ms, const char* text, char color, char mode = BB_DM_HOLD,
+                  char special = BB_SDM_TWINKLE, char charset = BB_CS_10HIGH,
+                  char position = BB_DP_TOPLINE);
+
+    /**
+     * @brief Append a frame that cancels the priority file (returns sign to normal rotation)
+     * @param at_ms Deadline relative to run start
+     * @return true if the frame fit in the timeline
+     */
+    bool addCancel(uint32_t at_ms);
+
+    /**
+     * @brief Load the standard racing countdown (N..1 then GO!)
+     * @param seconds Countdown length (1-9)
+     * @param go_hold_ms How long GO! stays up before the priority file is cancelled
+     * @return true if the timeline was loaded
+     */
+    bool loadCountdown(uint8_t seconds, uint32_t go_hold_ms = 3000);
+
+    /**
+     * @brief Get the countdown length currently loaded (0 if a custom timeline)
+     * @return Seconds
+     */
+    uint8_t getLoadedCountdown() const { return loaded_countdown; }
+
+    /**
+     * @brief Trigger the loaded timeline
+     * @return false if empty, already running, the task is not started, or
+     *         another task holds the sign
+     */
+    bool start();
+
+    /**
+     * @brief Abort a run in progress after the current frame
+     */
+    void stop();
+
+    /**
+     * @brief Check whether a run is in progress
+     * @return true while the engine owns the sign UART
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Collect the report of the last completed run (once)
+     * @param report Output report
+     * @return true if a new report was available
+     */
+    bool takeRunReport(RunReport& report);
+
+    /**
+     * @brief Get human-readable status for health logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    /**
+     * @brief Pre-encoded frame reference into the arena
+     */
+    struct Frame {
+        uint16_t offset;      ///< Start within arena
+        uint16_t length;      ///< Encoded bytes
+        uint32_t at_ms;       ///< Deadline relative to run start
+    };
+
+    BETABRITE* sign;
+    TaskHandle_t task;
+    char arena[SEQ_ARENA_SIZE];
+    size_t arena_used;
+    Frame frames[SEQ_MAX_FRAMES];
+    uint16_t frame_count;
+    uint8_t loaded_countdown;
+
+    volatile bool running;
+    volatile bool abort_requested;
+    volatile bool report_ready;
+    int64_t start_us;                 ///< Absolute esp_timer time of deadline 0
+    RunReport last_report;
+    uint32_t total_runs;
+
+    static void taskEntry(void* arg);
+    void taskLoop();
+    void runTimeline();
+    bool appendFrame(uint32_t at_ms, size_t length);
+    static uint32_t wireTimeUs(size_t bytes);
+    static void waitUntil(int64_t target_us);
+};
+
+#endif // SEQUENCE_ENGINE_H
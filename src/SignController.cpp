@@ -8,10 +8,13 @@
 
 #include "defines.h"
 #include "SignController.h"
+#include "SimClock.h"
+#include <HotPath.h>
 #include <time.h>
 
 SignController::SignController(BETABRITE* sign_instance, const String& device_id, int max_files)
-    : sign(sign_instance), device_id(device_id), max_files(max_files) {
+    : sign(sign_instance), device_id(device_id), max_files(max_files), reserved_files(0),
+      last_write_us(0), load_governor(nullptr), caps(nullptr) {
 
     // Initialize state variables
     current_file = 'A';
@@ -26,6 +29,8 @@ SignController::SignController(BETABRITE* sign_instance, const String& device_id
     clock_enabled = true;
     clock_start_time = 0;
     clock_display_duration = CLOCK_DISPLAY_DURATION;
+    priority_warning_duration = PRIORITY_WARNING_DURATION;
+    output_suspended = false;
 
     Serial.println("SignController: Initialized");
 }
@@ -71,10 +76,32 @@ bool SignController::begin() {
     return true;
 }
 
+void SignController::setCapabilities(const SignCapabilities* capabilities) {
+    caps = capabilities;
+    if (sign && caps) {
+        sign->SetCommandDelay(caps->command_gap_ms);
+    }
+}
+
 bool SignController::configureMemory(char start_file, int num_files) {
     if (!sign) {
         return false;
     }
+
+    // No more files than the sign has memory for
+    if (caps) {
+        int planned = SignModel::planFiles(*caps, num_files, FILE_SIZE);
+        if (planned < num_files) {
+            Serial.print("SignController: ");
+            Serial.print(caps->name);
+            Serial.print(" holds ");
+            Serial.print(planned);
+            Serial.print(" of ");
+            Serial.print(num_files);
+            Serial.println(" files");
+            num_files = planned;
+        }
+    }
     
     current_file = start_file;
     max_files = num_files;
@@ -91,20 +118,33 @@ bool SignController::configureMemory(char start_file, int num_files) {
 }
 
 bool SignController::displayMessage(const char* message, char color, char position, char mode, char special,
-                                   char charset, const char* speed) {
+                                   char charset, const char* speed, char file) {
+    HOTPATH_PROFILE(HOTPATH_SIGN_WRITE);
     if (!sign || !message) {
         Serial.println("SignController: Invalid parameters for displayMessage");
         return false;
     }
 
+    if (output_suspended) {
+        Serial.println("SignController: Ignoring message - sequence in progress");
+        return false;
+    }
+
     // Don't allow normal messages during priority mode
     if (in_priority_mode) {
         Serial.println("SignController: Ignoring message - in priority mode");
         return false;
     }
 
+    char target_file = file ? file : current_file;
+
+    // Colour and charset the sign can show (a red-only sign, a 7-row panel)
+    if (caps) {
+        SignModel::adapt(*caps, color, charset);
+    }
+
     Serial.print("SignController: Displaying message on file ");
-    Serial.print(current_file);
+    Serial.print(target_file);
     Serial.print(": ");
     Serial.println(message);
 
@@ -134,8 +174,19 @@ bool SignController::displayMessage(const char* message, char color, char positi
     formatted_message += speed;   // Speed code string
     formatted_message += message;
 
+    // Within the sign draw budget (may swap in a lower-draw mode/colour)
+    if (load_governor) {
+        load_governor->govern(message, color, mode, charset);
+    }
+
     // Send message to sign
-    sign->WriteTextFile(current_file, formatted_message.c_str(), color, position, mode, special);
+    last_write_us = micros();
+    sign->WriteTextFile(target_file, formatted_message.c_str(), color, position, mode, special);
+
+    // Pinned files don't move the rotation
+    if (file) {
+        return true;
+    }
 
     // Advance to next file
     current_file++;
@@ -145,16 +196,63 @@ bool SignController::displayMessage(const char* message, char color, char positi
         current_file = 'A';
         Serial.println("SignController: File counter wrapped to A");
     }
+    skipReservedFiles();
+
+    return true;
+}
+
+void SignController::writePriorityFrame(const char* text, char color, char position, char mode, char special) {
+    HOTPATH_PROFILE(HOTPATH_SIGN_WRITE);
+    if (caps) {
+        char charset = BB_CS_7HIGH;
+        SignModel::adapt(*caps, color, charset);
+    }
+    if (load_governor) {
+        load_governor->govern(text, color, mode);
+    }
+    sign->CancelPriorityTextFile();
+    sign->WritePriorityTextFile(text, color, position, mode, special);
+}
+
+bool SignController::reserveFile(char file) {
+    if (file < 'A' || file > 'A' + max_files - 1) {
+        Serial.print("SignController: Cannot reserve file ");
+        Serial.print(file);
+        Serial.println(" - outside configured files");
+        return false;
+    }
 
+    uint32_t mask = reserved_files | (1UL << (file - 'A'));
+    if (mask == (1UL << max_files) - 1) {
+        Serial.println("SignController: Cannot reserve every file - rotation needs one");
+        return false;
+    }
+    reserved_files = mask;
+    skipReservedFiles();
     return true;
 }
 
-bool SignController::displayPriorityMessage(const char* message, unsigned int duration) {
+void SignController::skipReservedFiles() {
+    // reserveFile() always leaves one file free, so this terminates
+    while (reserved_files & (1UL << (current_file - 'A'))) {
+        current_file++;
+        if (current_file > 'A' + max_files - 1) {
+            current_file = 'A';
+        }
+    }
+}
+
+bool SignController::displayPriorityMessage(const char* message, unsigned int duration, bool show_warning) {
     if (!sign || !message) {
         Serial.println("SignController: Invalid parameters for displayPriorityMessage");
         return false;
     }
 
+    if (output_suspended) {
+        Serial.println("SignController: Ignoring priority message - sequence in progress");
+        return false;
+    }
+
     Serial.println("SignController: ### PRIORITY MESSAGE ###");
     Serial.print("SignController: Content: ");
     Serial.println(message);
@@ -162,22 +260,41 @@ bool SignController::displayPriorityMessage(const char* message, unsigned int du
     Serial.print(duration);
     Serial.println(" seconds");
 
+    SIM_EVENT("sign", "priority " + String(duration) + "s " + message);
+
     // Store message for later display stages
     priority_message_content = String(message);
 
     // Initialize priority mode
     in_priority_mode = true;
-    priority_start_time = millis();
+    priority_start_time = SimClock::millis();
     priority_duration = duration;
+
+    if (!show_warning) {
+        // Latency-sensitive sources (e.g. handheld remote) skip the warning stage
+        priority_stage = PRIORITY_MESSAGE;
+        priority_end_time = priority_start_time + (duration * 1000UL);
+
+        last_write_us = micros();
+        writePriorityFrame(
+            priority_message_content.c_str(),
+            BB_COL_AUTOCOLOR,
+            BB_DP_TOPLINE,
+            BB_DM_ROTATE,
+            BB_SDM_TWINKLE
+        );
+        return true;
+    }
+
     priority_stage = PRIORITY_WARNING;
 
     // Calculate when priority should end: warning duration + message duration
-    priority_end_time = priority_start_time + PRIORITY_WARNING_DURATION + (duration * 1000UL);
+    priority_end_time = priority_start_time + priority_warning_duration + (duration * 1000UL);
 
     // Display priority warning (stage 1)
     Serial.println("SignController: Displaying priority warning (non-blocking)");
-    sign->CancelPriorityTextFile();
-    sign->WritePriorityTextFile(
+    last_write_us = micros();
+    writePriorityFrame(
         "ALERT",
         BB_COL_RED,
         BB_DP_TOPLINE,
@@ -194,6 +311,10 @@ void SignController::clearAllFiles() {
         Serial.println("SignController: Cannot clear files - no sign instance");
         return;
     }
+
+    if (output_suspended) {
+        return;
+    }
     
     Serial.println("SignController: Clearing all text files");
     
@@ -214,11 +335,12 @@ void SignController::clearAllFiles() {
     
     // Reset file counter
     current_file = 'A';
+    skipReservedFiles();
     Serial.println("SignController: All files cleared, file counter reset");
 }
 
 String SignController::getFormattedDateTime(bool military_time) {
-    time_t now = time(nullptr);
+    time_t now = SimClock::now();
     struct tm *timeinfo = localtime(&now);
     
     if (!timeinfo) {
@@ -236,7 +358,7 @@ String SignController::getFormattedDateTime(bool military_time) {
 }
 
 void SignController::displayClock(bool military_time) {
-    if (!sign) {
+    if (!sign || output_suspended) {
         return;
     }
     
@@ -246,15 +368,15 @@ void SignController::displayClock(bool military_time) {
     
     // Only display clock if not in priority mode
     if (!in_priority_mode) {
-        sign->CancelPriorityTextFile();
-        sign->WritePriorityTextFile(
+        SIM_EVENT("sign", "clock " + time_str);
+        writePriorityFrame(
             time_str.c_str(), 
             SIGN_CLOCK_COLOUR, 
             SIGN_CLOCK_POSITION, 
             SIGN_CLOCK_MODE, 
             SIGN_CLOCK_SPECIAL
         );
-        clock_start_time = millis();
+        clock_start_time = SimClock::millis();
     }
 }
 
@@ -275,20 +397,20 @@ void SignController::checkPriorityTimeout() {
         return;
     }
 
-    unsigned long current_time = millis();
+    unsigned long current_time = SimClock::millis();
 
     // Handle stage transitions
     switch (priority_stage) {
         case PRIORITY_WARNING:
             // Check if warning duration has elapsed
-            if (current_time - priority_start_time >= PRIORITY_WARNING_DURATION) {
+            if (current_time - priority_start_time >= priority_warning_duration) {
                 // Transition to message stage
                 Serial.println("SignController: Transitioning to priority message display");
+                SIM_EVENT("sign", "priority message stage");
                 priority_stage = PRIORITY_MESSAGE;
 
                 // Display the actual priority message
-                sign->CancelPriorityTextFile();
-                sign->WritePriorityTextFile(
+                writePriorityFrame(
                     priority_message_content.c_str(),
                     BB_COL_AUTOCOLOR,
                     BB_DP_TOPLINE,
@@ -303,6 +425,7 @@ void SignController::checkPriorityTimeout() {
             if (current_time >= priority_end_time) {
                 // Priority message duration complete - return to normal operation
                 Serial.println("SignController: Priority message duration complete, returning to normal operation");
+                SIM_EVENT("sign", "priority complete");
                 cancelPriorityMessage();
             }
             break;
@@ -336,26 +459,27 @@ bool SignController::handleSystemCommand(char command) {
 }
 
 void SignController::showOfflineMode() {
-    if (!sign) {
+    if (!sign || output_suspended) {
         return;
     }
 
     // Start non-blocking offline mode sequence if not already running
     if (!in_offline_mode) {
         Serial.println("SignController: Starting offline mode sequence (non-blocking)");
+        SIM_EVENT("sign", "offline start");
         in_offline_mode = true;
         offline_sequence_stage = 0;
-        offline_stage_start = millis();
+        offline_stage_start = SimClock::millis();
 
         // Display first stage immediately
-        sign->CancelPriorityTextFile();
-        sign->WritePriorityTextFile("*Offline*", BB_COL_RED, BB_DP_TOPLINE, BB_DM_EXPLODE, BB_SDM_TWINKLE);
+        writePriorityFrame("*Offline*", BB_COL_RED, BB_DP_TOPLINE, BB_DM_EXPLODE, BB_SDM_TWINKLE);
     }
 }
 
 void SignController::cancelOfflineMode() {
     if (in_offline_mode) {
         Serial.println("SignController: Canceling offline mode sequence");
+        SIM_EVENT("sign", "offline cancel");
         in_offline_mode = false;
         offline_sequence_stage = 0;
         offline_stage_start = 0;
@@ -368,23 +492,23 @@ void SignController::cancelOfflineMode() {
 }
 
 void SignController::displayError(const char* error_message, unsigned int duration_seconds) {
-    if (!sign || !error_message) {
+    if (!sign || !error_message || output_suspended) {
         return;
     }
 
     Serial.print("SignController: Displaying error message: ");
     Serial.println(error_message);
+    SIM_EVENT("sign", "error " + String(duration_seconds) + "s " + error_message);
 
     // Show error directly on the sign (red, flash) without the "# # # #" warning stage
     in_priority_mode = true;
     priority_stage = PRIORITY_MESSAGE;
-    priority_start_time = millis();
+    priority_start_time = SimClock::millis();
     priority_end_time = priority_start_time + (duration_seconds * 1000UL);
     priority_duration = duration_seconds;
     priority_message_content = String(error_message);
 
-    sign->CancelPriorityTextFile();
-    sign->WritePriorityTextFile(
+    writePriorityFrame(
         error_message,
         BB_COL_RED,
         BB_DP_TOPLINE,
@@ -398,7 +522,7 @@ void SignController::checkOfflineTimeout() {
         return;
     }
 
-    unsigned long current_time = millis();
+    unsigned long current_time = SimClock::millis();
 
     // Define offline message sequence
     struct OfflineStage {
@@ -432,16 +556,18 @@ void SignController::checkOfflineTimeout() {
 
         // Display current stage
         const OfflineStage& stage = stages[offline_sequence_stage];
-        sign->CancelPriorityTextFile();
-        sign->WritePriorityTextFile(stage.text, stage.color, BB_DP_TOPLINE, stage.mode, stage.special);
+        writePriorityFrame(stage.text, stage.color, BB_DP_TOPLINE, stage.mode, stage.special);
 
         offline_stage_start = current_time;
+        SIM_EVENT("sign", "offline stage " + String(offline_sequence_stage));
 
         Serial.print("SignController: Offline mode stage ");
         Serial.print(offline_sequence_stage);
         Serial.print(": ");
         Serial.println(stage.text);
     }
+
+    SimClock::wakeAt(offline_stage_start + stages[offline_sequence_stage].duration);
 }
 
 String SignController::generateRandomString(int length) {
@@ -496,11 +622,11 @@ void SignController::runDemo() {
 }
 
 void SignController::loop() {
-    if (!sign) {
+    if (!sign || output_suspended) {
         return;
     }
 
-    unsigned long current_time = millis();
+    unsigned long current_time = SimClock::millis();
 
     // Handle priority message stage transitions and timeout
     checkPriorityTimeout();
@@ -511,16 +637,34 @@ void SignController::loop() {
     // Handle clock display timeout (only when not in priority mode)
     if (clock_start_time > 0 && !in_priority_mode) {
         if (current_time - clock_start_time > clock_display_duration) {
+            SIM_EVENT("sign", "clock end");
             sign->CancelPriorityTextFile();
             clock_start_time = 0;
+        } else {
+            SimClock::wakeAt(clock_start_time + clock_display_duration + 1);
         }
     }
+
+    // Next stage deadlines, so the virtual clock can jump straight to them
+    if (in_priority_mode) {
+        SimClock::wakeAt(priority_stage == PRIORITY_WARNING
+                             ? priority_start_time + priority_warning_duration
+                             : priority_end_time);
+    }
 }
 
 bool SignController::isInPriorityMode() const {
     return in_priority_mode;
 }
 
+void SignController::setOutputSuspended(bool suspended) {
+    if (suspended == output_suspended) {
+        return;
+    }
+    output_suspended = suspended;
+    Serial.println(suspended ? "SignController: Output suspended" : "SignController: Output resumed");
+}
+
 char SignController::getCurrentFile() const {
     return current_file;
 }
@@ -544,12 +688,27 @@ void SignController::setClockEnabled(bool enabled, unsigned long duration) {
     }
 }
 
+void SignController::setClockDuration(unsigned long duration) {
+    clock_display_duration = duration;
+}
+
+void SignController::setPriorityWarningDuration(unsigned long duration) {
+    priority_warning_duration = duration;
+}
+
 bool SignController::runDiagnostic() {
     if (!sign) {
         Serial.println("DIAG: No sign instance");
         return false;
     }
 
+    if (caps && !caps->read_back) {
+        Serial.print("DIAG: ");
+        Serial.print(caps->name);
+        Serial.println(" does not answer reads - skipping ping");
+        return false;
+    }
+
     Serial.println("DIAG: Pinging sign (read time-of-day)...");
 
     if (sign->PingSign(2000)) {
@@ -581,11 +740,14 @@ String SignController::getStatus() const {
     String status = "SignController Status:\n";
     status += "  Current File: " + String(current_file) + "\n";
     status += "  Max Files: " + String(max_files) + "\n";
+    if (caps) {
+        status += "  Model: " + String(caps->name) + "\n";
+    }
     status += "  Priority Mode: " + String(in_priority_mode ? "Yes" : "No") + "\n";
     status += "  Clock Enabled: " + String(clock_enabled ? "Yes" : "No") + "\n";
     
     if (clock_start_time > 0) {
-        unsigned long remaining = clock_display_duration - (millis() - clock_start_time);
+        unsigned long remaining = clock_display_duration - (SimClock::millis() - clock_start_time);
         status += "  Clock Remaining: " + String(remaining / 1000) + "s\n";
     }
     
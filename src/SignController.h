@@ -20,6 +20,8 @@
 
 #include <Arduino.h>
 #include "BETABRITE.h"
+#include "SignLoad.h"
+#include "SignModel.h"
 
 // Sign configuration constants (from defines.h)
 #ifndef SIGN_DEFAULT_COLOUR
@@ -76,6 +78,8 @@ private:
     // File management
     char current_file;                  ///< Current text file letter (A-E)
     int max_files;                      ///< Maximum number of files on sign
+    uint32_t reserved_files;            ///< Files pinned by alert routes (bit n = 'A' + n), skipped by rotation
+    uint32_t last_write_us;             ///< micros() as the last alert frame started (display receipts)
     
     // Priority message management
     bool in_priority_mode;              ///< Whether priority message is active
@@ -102,10 +106,20 @@ private:
     unsigned long clock_start_time;     ///< When clock was last displayed
     unsigned long clock_display_duration; ///< How long to show clock (ms)
 
+    // Priority "ALERT" warning before the message (ConfigStore prio_warn_ms)
+    unsigned long priority_warning_duration; ///< Priority warning display time (ms)
+
+    // External UART ownership (e.g. SequenceEngine run in progress)
+    bool output_suspended;              ///< Whether sign writes are currently refused
+
+    SignLoadGovernor* load_governor;    ///< Draw estimate / substitution per frame (optional)
+    const SignCapabilities* caps;       ///< Attached sign model (nullptr = assume it can do everything)
+
     // Timing constants
-    static const unsigned long PRIORITY_WARNING_DURATION = 2500;  ///< Priority warning display time (ms)
+    static const unsigned long PRIORITY_WARNING_DURATION = 2500;  ///< Default priority warning display time (ms)
     static const unsigned long DEFAULT_PRIORITY_DURATION = 25;    ///< Default priority message duration (seconds)
     static const unsigned long CLOCK_DISPLAY_DURATION = 4000;     ///< Default clock display time (ms) - 4 seconds
+    static const unsigned int FILE_SIZE = 256;                     ///< Bytes per text file (SetMemoryConfiguration)
     
     /**
      * @brief Display connection details when offline
@@ -119,6 +133,16 @@ private:
      * @return Random alphanumeric string
      */
     String generateRandomString(int length);
+
+    /**
+     * @brief Move current_file forward past files reserved by reserveFile()
+     */
+    void skipReservedFiles();
+
+    /**
+     * @brief Replace the priority file with a frame, within the sign draw budget
+     */
+    void writePriorityFrame(const char* text, char color, char position, char mode, char special);
     
 public:
     /**
@@ -145,19 +169,29 @@ public:
      * @param special Special effect code
      * @param charset Character set code (default: 7high)
      * @param speed Speed code string (default: medium)
+     * @param file Text file to write (default 0: next file in the rotation)
      * @return true if message sent successfully, false otherwise
      */
     bool displayMessage(const char* message, char color, char position, char mode, char special,
-                       char charset = '3', const char* speed = "\027");
+                       char charset = '3', const char* speed = "\027", char file = 0);
+
+    /**
+     * @brief Keep a file out of the normal rotation (alert route target)
+     * @param file File letter within the configured range
+     * @return false if out of range or it would leave no file to rotate through
+     */
+    bool reserveFile(char file);
     
     /**
      * @brief Display a priority message that interrupts normal operation
      * Priority messages show a warning, then the message, then resume normal operation
      * @param message Priority message content
      * @param duration Duration in seconds to display message (default: 25 seconds)
+     * @param show_warning Show the "ALERT" stage first (false writes the message immediately)
      * @return true if priority message initiated, false otherwise
      */
-    bool displayPriorityMessage(const char* message, unsigned int duration = DEFAULT_PRIORITY_DURATION);
+    bool displayPriorityMessage(const char* message, unsigned int duration = DEFAULT_PRIORITY_DURATION,
+                                bool show_warning = true);
     
     /**
      * @brief Clear all text files on the sign
@@ -234,6 +268,38 @@ public:
      * @return true if in priority mode, false otherwise
      */
     bool isInPriorityMode() const;
+
+    /**
+     * @brief Refuse all sign writes while another component owns the UART
+     * Messages arriving while suspended are dropped; timers resume on release
+     * @param suspended true to suspend output, false to resume
+     */
+    void setOutputSuspended(bool suspended);
+
+    /**
+     * @brief Estimate each frame's draw, substituting lower-draw variants over budget
+     * @param governor Governor to consult before every write (nullptr to stop)
+     */
+    void setLoadGovernor(SignLoadGovernor* governor) { load_governor = governor; }
+
+    /**
+     * @brief Pace, size memory and adapt frames to the attached sign model
+     * Call before begin() so the memory configuration fits the sign
+     * @param capabilities Sign capabilities (see SignModel)
+     */
+    void setCapabilities(const SignCapabilities* capabilities);
+
+    /**
+     * @brief Check whether sign output is suspended
+     * @return true if writes are currently refused
+     */
+    bool isOutputSuspended() const { return output_suspended; }
+
+    /**
+     * @brief When the last displayMessage()/displayPriorityMessage() frame started
+     * @return micros() just before the first byte went to the sign
+     */
+    uint32_t getLastWriteMicros() const { return last_write_us; }
     
     /**
      * @brief Get current file letter being used
@@ -253,6 +319,18 @@ public:
      * @param duration How long to show clock in milliseconds
      */
     void setClockEnabled(bool enabled, unsigned long duration = CLOCK_DISPLAY_DURATION);
+
+    /**
+     * @brief Change how long the clock is shown, leaving it enabled or disabled
+     * @param duration Clock display time in milliseconds
+     */
+    void setClockDuration(unsigned long duration);
+
+    /**
+     * @brief Change how long the "ALERT" warning shows before a priority message
+     * @param duration Warning display time in milliseconds
+     */
+    void setPriorityWarningDuration(unsigned long duration);
     
     /**
      * @brief Get formatted date/time string
@@ -0,0 +1,348 @@
+/**
+ * @file SignLoad.cpp
+ * @brief Implementation of the sign power-draw estimate and governor
+ */
+
+#include "defines.h"
+#include "SignLoad.h"
+#include "BBDEFS.h"
+#include "Metrics.h"
+#include "SimClock.h"
+#include <HotPath.h>
+#include <ArduinoJson.h>
+#include <time.h>
+#include <algorithm>
+
+namespace {
+// Lit pixels per glyph of the 5x7 base font (FONT_5X7 in tools/sign_emulator.py), ASCII 0x20-0x7E
+HOT_DRAM const uint8_t GLYPH_PIXELS[95] = {
+     0,  6,  6, 20, 17, 13, 15,  4,  7,  7, 11,  9,  4,  5,  4,  5,
+    19, 10, 14, 14, 14, 17, 15, 11, 17, 15,  8,  8,  7, 10,  7,  9,
+    18, 18, 20, 13, 16, 18, 13, 15, 17, 11, 11, 14, 11, 17, 17, 16,
+    15, 17, 18, 15, 11, 15, 13, 18, 13, 10, 15, 11,  5, 11,  5,  5,
+     3, 14, 16, 10, 16, 14, 11, 13, 14,  9,  9, 12, 10, 13, 12, 12,
+    12, 12,  9, 12, 11, 12,  9, 12,  9, 12, 13,  7,  7,  7,  9,
+};
+
+// Window of glyphs currently on the glass (narrowest glyph is 6 columns)
+const uint8_t WINDOW_SLOTS = SIGNLOAD_MAX_COLUMNS / 6 + 1;
+static_assert(SIGNLOAD_MAX_COLUMNS / 6 + 1 <= 255, "SignLoad: SIGNLOAD_MAX_COLUMNS too wide for the window");
+
+// Panel size (setGeometry() once the sign model is known)
+uint16_t sign_columns = SIGNLOAD_COLUMNS;
+uint8_t sign_rows = SIGNLOAD_ROWS;
+uint8_t sign_lines = 1;
+
+HOT_DRAM const uint32_t LOAD_BOUNDS_MA[] = {250, 500, 750, 1000, 1250, 1500, 2000, 2500};
+
+MetricHistogram metric_load("ledsign_sign_load_milliamps", "Estimated sign draw per frame sent",
+                            LOAD_BOUNDS_MA, sizeof(LOAD_BOUNDS_MA) / sizeof(LOAD_BOUNDS_MA[0]));
+MetricCounter metric_substituted("ledsign_sign_load_substituted_total", "Frames sent as a lower-draw variant");
+MetricCounter metric_over_budget("ledsign_sign_load_over_budget_total", "Frames over the sign draw budget after substitution");
+MetricGauge metric_last("ledsign_sign_load_last_milliamps", "Estimated sign draw of the last frame sent");
+
+/**
+ * @brief LED dies lit per pixel, in halves (dim colours are driven at about half)
+ */
+uint8_t colorHalves(char color) {
+    switch (color) {
+        case BB_COL_RED:
+        case BB_COL_GREEN:
+        case BB_COL_BROWN:      // Dim amber
+            return 2;
+        case BB_COL_AMBER:
+        case BB_COL_YELLOW:
+            return 4;           // Red and green die
+        case BB_COL_DIMRED:
+        case BB_COL_DIMGREEN:
+            return 1;
+        default:
+            return 3;           // Orange, rainbow, mix, auto: between one and two dies
+    }
+}
+
+/**
+ * @brief Glyph height and horizontal scale of a charset (as sign_emulator.py CHARSETS)
+ */
+void charsetShape(char charset, uint8_t& rows, uint8_t& xscale) {
+    rows = 7;
+    xscale = 1;
+    switch (charset) {
+        case '1': case '2': rows = 5; break;
+        case '6': rows = 10; break;
+        case '8': case '9': rows = sign_rows; break;
+        case ';': case '>': rows = 5; xscale = 2; break;
+        case '<': case '=': xscale = 2; break;
+    }
+    if (rows > sign_rows) {
+        rows = sign_rows;
+    }
+}
+
+/**
+ * @brief Busiest sign-width window of a text, in lit half-dies
+ */
+class Window {
+public:
+    Window() : head(0), count(0), columns(0), units(0), peak(0) {}
+
+    void add(char ch, char color, char charset) {
+        uint8_t rows, xscale;
+        charsetShape(charset, rows, xscale);
+        uint8_t code = (uint8_t)ch;
+        uint16_t pixels = (code >= 0x20 && code <= 0x7E) ? GLYPH_PIXELS[code - 0x20] : GLYPH_PIXELS['?' - 0x20];
+        uint32_t glyph_units = (uint32_t)pixels * rows / 7 * xscale * colorHalves(color);
+        uint8_t width = 5 * xscale + (rows >= 10 ? 1 : 0) + 1;
+
+        if (count == WINDOW_SLOTS) {
+            drop();
+        }
+        uint8_t slot = (head + count) % WINDOW_SLOTS;
+        widths[slot] = width;
+        glyphs[slot] = glyph_units;
+        count++;
+        columns += width;
+        units += glyph_units;
+        while (columns > sign_columns) {
+            drop();
+        }
+        if (units > peak) {
+            peak = units;
+        }
+    }
+
+    // New page or line: the next window starts empty (peak included)
+    void clear() {
+        head = 0;
+        count = 0;
+        columns = 0;
+        units = 0;
+        peak = 0;
+    }
+
+    uint32_t getPeak() const { return peak; }
+
+private:
+    uint8_t widths[WINDOW_SLOTS];
+    uint32_t glyphs[WINDOW_SLOTS];
+    uint8_t head;
+    uint8_t count;
+    uint16_t columns;
+    uint32_t units;
+    uint32_t peak;
+
+    void drop() {
+        columns -= widths[head];
+        units -= glyphs[head];
+        head = (head + 1) % WINDOW_SLOTS;
+        count--;
+    }
+};
+}
+
+SignLoadGovernor::SignLoadGovernor()
+    : budget_ma(SIGNLOAD_BUDGET_MA), day(0), frames(0), peak_ma(0), substituted(0), over_budget(0), last_ma(0) {
+    static_assert(sizeof(LOAD_BOUNDS_MA) / sizeof(LOAD_BOUNDS_MA[0]) == BUCKETS, "SignLoad: BUCKETS mismatch");
+    for (uint8_t i = 0; i <= BUCKETS; i++) {
+        counts[i] = 0;
+    }
+}
+
+void SignLoadGovernor::setGeometry(uint16_t columns, uint8_t rows, uint8_t lines) {
+    sign_columns = columns < SIGNLOAD_MAX_COLUMNS ? columns : SIGNLOAD_MAX_COLUMNS;
+    sign_rows = rows;
+    sign_lines = lines ? lines : 1;
+}
+
+uint8_t SignLoadGovernor::surgePercent(char mode) {
+    switch (mode) {
+        case BB_DM_FLASH:   return 130;     // Whole frame switched on and off twice a second
+        case BB_DM_EXPLODE: return 120;
+        case BB_DM_SPECIAL: return 115;     // Graphic effects light much of the panel at once
+        default:            return 100;
+    }
+}
+
+char SignLoadGovernor::dimVariant(char color) {
+    switch (color) {
+        case BB_COL_RED:    return BB_COL_DIMRED;
+        case BB_COL_GREEN:  return BB_COL_DIMGREEN;
+        case BB_COL_DIMRED:
+        case BB_COL_DIMGREEN:
+            return color;
+        default:            return BB_COL_BROWN;    // Amber family and mixes: dim amber
+    }
+}
+
+uint32_t SignLoadGovernor::estimate(const char* text, char color, char mode, char charset) {
+    // Lines of one screen are lit together: their windows add up, and the
+    // busiest screen (a page, or sign_lines lines of it) sets the peak
+    Window window;
+    uint32_t screen_units = 0;      // Finished lines of the current screen
+    uint8_t screen_line = 0;
+    uint32_t peak_units = 0;
+    char current_color = color;
+    char current_charset = charset;
+
+    for (const char* p = text; p && *p; p++) {
+        char c = *p;
+        if ((uint8_t)c >= 0x20) {
+            window.add(c, current_color, current_charset);
+            continue;
+        }
+        switch (c) {
+            case BB_FC_SELECTCHARSET:
+                if (p[1]) current_charset = *++p;
+                break;
+            case BB_FC_SELECTCHARCOLOR:
+                if (p[1]) current_color = *++p;
+                break;
+            case BB_FC_SELECTCHARATTR:      // Attribute and on/off
+                if (p[1]) p++;
+                if (p[1]) p++;
+                break;
+            case BB_FC_SELECTCHARSPACE:
+            case BB_FC_CALLSTRING:
+            case BB_FC_CALLPICTURE:
+            case BB_FC_CALLDATE:
+            case BB_FC_EXTENDEDCHARSET:
+            case BB_FC_SPEEDCONTROL:
+                if (p[1]) p++;
+                break;
+            case BB_FC_CALLTIME:
+                for (const char* t = "00:00"; *t; t++) {
+                    window.add(*t, current_color, current_charset);
+                }
+                break;
+            case BB_FC_NEWLINE:
+                screen_units += window.getPeak();
+                window.clear();
+                if (++screen_line < sign_lines) {
+                    break;
+                }
+                // Past the last line the sign shows the next screen
+                // fall through
+            case BB_FC_NEWPAGE:
+                peak_units = std::max(peak_units, screen_units + window.getPeak());
+                screen_units = 0;
+                screen_line = 0;
+                window.clear();
+                break;
+            default:
+                break;                      // Speed and other single-byte codes
+        }
+    }
+
+    peak_units = std::max(peak_units, screen_units + window.getPeak());
+    uint32_t led_ma = peak_units * SIGNLOAD_UA_PER_LED / 2 * surgePercent(mode) / 100 / 1000;
+    return SIGNLOAD_BASE_MA + led_ma;
+}
+
+uint32_t SignLoadGovernor::govern(const char* text, char& color, char& mode, char charset) {
+    uint32_t estimate_ma = estimate(text, color, mode, charset);
+    uint32_t original_ma = estimate_ma;
+    char original_color = color;
+    char original_mode = mode;
+
+    if (budget_ma && estimate_ma > budget_ma && surgePercent(mode) > 100) {
+        mode = BB_DM_ROTATE;
+        estimate_ma = estimate(text, color, mode, charset);
+    }
+    if (budget_ma && estimate_ma > budget_ma && dimVariant(color) != color) {
+        color = dimVariant(color);
+        estimate_ma = estimate(text, color, mode, charset);
+    }
+
+    if (color != original_color || mode != original_mode) {
+        substituted++;
+        metric_substituted.inc();
+        Serial.print("SignLoad: ");
+        Serial.print(original_ma);
+        Serial.print(" mA over budget, sending mode '");
+        Serial.print(mode);
+        Serial.print("' colour '");
+        Serial.print(color);
+        Serial.print("' (");
+        Serial.print(estimate_ma);
+        Serial.println(" mA)");
+        SIM_EVENT("signload", "substituted " + String(original_ma) + "->" + String(estimate_ma) + " mA");
+    }
+    if (budget_ma && estimate_ma > budget_ma) {
+        over_budget++;
+        metric_over_budget.inc();
+    }
+
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS && estimate_ma > LOAD_BOUNDS_MA[bucket]) {
+        bucket++;
+    }
+    counts[bucket]++;
+    frames++;
+    if (estimate_ma > peak_ma) {
+        peak_ma = estimate_ma;
+    }
+    last_ma = estimate_ma;
+    metric_load.observe(estimate_ma);
+    metric_last.set(estimate_ma);
+    return estimate_ma;
+}
+
+bool SignLoadGovernor::rollDay(time_t now, String& report) {
+    if (now < 1609459200) {  // Same "not synced yet" threshold as MQTTManager
+        return false;
+    }
+    struct tm local;
+    localtime_r(&now, &local);
+    uint32_t today = (local.tm_year + 1900) * 10000UL + (local.tm_mon + 1) * 100UL + local.tm_mday;
+    if (day == 0) {
+        day = today;  // Frames since boot belong to the first dated day
+        return false;
+    }
+    if (today == day) {
+        return false;
+    }
+
+    StaticJsonDocument<512> doc;
+    char date[11];
+    snprintf(date, sizeof(date), "%04lu-%02lu-%02lu", (unsigned long)(day / 10000), (unsigned long)(day / 100 % 100),
+             (unsigned long)(day % 100));
+    doc["day"] = date;
+    doc["frames"] = frames;
+    doc["peak_ma"] = peak_ma;
+    doc["substituted"] = substituted;
+    doc["over_budget"] = over_budget;
+    doc["budget_ma"] = budget_ma;
+    JsonArray bounds = doc.createNestedArray("bounds_ma");
+    JsonArray buckets = doc.createNestedArray("counts");
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        bounds.add(LOAD_BOUNDS_MA[i]);
+    }
+    for (uint8_t i = 0; i <= BUCKETS; i++) {
+        buckets.add(counts[i]);
+    }
+    report = "";
+    serializeJson(doc, report);
+
+    resetDay(today);
+    return true;
+}
+
+void SignLoadGovernor::resetDay(uint32_t new_day) {
+    day = new_day;
+    frames = 0;
+    peak_ma = 0;
+    substituted = 0;
+    over_budget = 0;
+    for (uint8_t i = 0; i <= BUCKETS; i++) {
+        counts[i] = 0;
+    }
+}
+
+String SignLoadGovernor::getStatus() const {
+    String status = budget_ma ? "budget " + String(budget_ma) + " mA, " : String("estimate only, ");
+    status += String(frames) + " frames today, peak " + String(peak_ma) + " mA, last " + String(last_ma) + " mA";
+    if (substituted || over_budget) {
+        status += ", " + String(substituted) + " substituted, " + String(over_budget) + " over budget";
+    }
+    return status;
+}
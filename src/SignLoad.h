@@ -0,0 +1,139 @@
+/**
+ * @file SignLoad.h
+ * @brief Sign power-draw estimate per frame, with lower-draw substitution
+ *
+ * High-current frames (flash, a full line of bright text, all-red alerts)
+ * pull the shared supply down far enough to trip the ESP32 brownout
+ * detector, which used to be switched off at boot to ride through them.
+ * That hid real brownouts too. Instead, every frame SignController writes
+ * is estimated here first:
+ *
+ *   lit pixels  = busiest sign-width window of the text, each character
+ *                 counted from its glyph in the 5x7 base font (the font
+ *                 tools/sign_emulator.py renders), scaled to the charset;
+ *                 on multi-line models the lines shown together add up
+ *   LED load    = lit pixels x dies per pixel for the colour (amber,
+ *                 yellow = red + green; dim colours count half)
+ *   draw (mA)   = SIGNLOAD_BASE_MA + LED load x SIGNLOAD_UA_PER_LED,
+ *                 raised by the mode's switching surge (flash, explode,
+ *                 special effects)
+ *
+ * The panel size defaults to SIGNLOAD_COLUMNS x SIGNLOAD_ROWS and follows
+ * the detected sign model once setGeometry() is called (see SignModel.h).
+ *
+ * When a budget is set (config key "sign_budget_ma", 0 = estimate only)
+ * and a frame is over it, the governor swaps in lower-draw variants, in
+ * order, until it fits: a surging mode becomes rotate, then the colour
+ * becomes its dim variant (red -> dim red, amber -> brown). A frame still
+ * over budget is sent as is and counted.
+ *
+ * Each day's estimates are collected as a distribution (frames per
+ * draw bucket, peak, substitutions) and handed over once the
+ * local date changes, for sizing supplies.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef SIGN_LOAD_H
+#define SIGN_LOAD_H
+
+#include <Arduino.h>
+
+// Sign load constants (from defines.h)
+#ifndef SIGNLOAD_COLUMNS
+#define SIGNLOAD_COLUMNS          80
+#endif
+#ifndef SIGNLOAD_ROWS
+#define SIGNLOAD_ROWS             7
+#endif
+#ifndef SIGNLOAD_MAX_COLUMNS
+#define SIGNLOAD_MAX_COLUMNS      384
+#endif
+#ifndef SIGNLOAD_BASE_MA
+#define SIGNLOAD_BASE_MA          150
+#endif
+#ifndef SIGNLOAD_UA_PER_LED
+#define SIGNLOAD_UA_PER_LED       3000
+#endif
+#ifndef SIGNLOAD_BUDGET_MA
+#define SIGNLOAD_BUDGET_MA        0
+#endif
+
+/**
+ * @brief Estimates frame draw and substitutes lower-draw variants over budget
+ */
+class SignLoadGovernor {
+public:
+    SignLoadGovernor();
+
+    /**
+     * @brief Set the draw budget
+     * @param milliamps Highest estimated draw allowed per frame (0 = estimate only)
+     */
+    void setBudget(uint32_t milliamps) { budget_ma = milliamps; }
+    uint32_t getBudget() const { return budget_ma; }
+
+    /**
+     * @brief Estimated sign draw while a frame is shown
+     * @param text Frame text, including inline charset/colour codes
+     * @param color BB_COL_* of the frame
+     * @param mode BB_DM_* of the frame
+     * @param charset Charset in effect before any inline code ('3' = 7 high)
+     * @return Estimated milliamps
+     */
+    static uint32_t estimate(const char* text, char color, char mode, char charset = '3');
+
+    /**
+     * @brief Panel size the estimate uses
+     * @param columns Width in pixels (at most SIGNLOAD_MAX_COLUMNS)
+     * @param rows Height in pixels
+     * @param lines Text lines lit at once (NEWLINE adds to the screen up to this many)
+     */
+    static void setGeometry(uint16_t columns, uint8_t rows, uint8_t lines = 1);
+
+    /**
+     * @brief Estimate a frame, substitute if it is over budget, and record it
+     * @param text Frame text
+     * @param color In/out: BB_COL_* (may become its dim variant)
+     * @param mode In/out: BB_DM_* (a surging mode may become rotate)
+     * @param charset Charset in effect before any inline code
+     * @return Estimated milliamps of the frame as it will be sent
+     */
+    uint32_t govern(const char* text, char& color, char& mode, char charset = '3');
+
+    /**
+     * @brief Close the day's distribution once the local date has changed
+     * @param now Epoch seconds (ignored until the clock is set)
+     * @param report Output: the finished day as JSON
+     *        {"day":"2024-05-01","frames":N,"peak_ma":N,"substituted":N,"over_budget":N,
+     *         "budget_ma":N,"bounds_ma":[...],"counts":[...]}
+     * @return true if a day was closed (report is set)
+     */
+    bool rollDay(time_t now, String& report);
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    static const uint8_t BUCKETS = 8;   ///< Bounds in the distribution (250 mA ... 2500 mA)
+
+    uint32_t budget_ma;
+    uint32_t day;                       ///< Local date as YYYYMMDD (0 = clock not set yet)
+    uint32_t counts[BUCKETS + 1];       ///< Frames per bucket today (last = above the top bound)
+    uint32_t frames;
+    uint32_t peak_ma;
+    uint32_t substituted;               ///< Frames sent as a lower-draw variant today
+    uint32_t over_budget;               ///< Frames still over budget after substitution today
+    uint32_t last_ma;                   ///< Estimate of the last frame sent
+
+    static uint8_t surgePercent(char mode);
+    static char dimVariant(char color);
+    void resetDay(uint32_t new_day);
+};
+
+#endif // SIGN_LOAD_H
@@ -0,0 +1,231 @@
+/**
+ * @file SignModel.cpp
+ * @brief Implementation of the sign capability table and model detection
+ */
+
+#include "defines.h"
+#include "SignModel.h"
+#include "Metrics.h"
+#include <Preferences.h>
+
+namespace {
+// Probe order: the BetaBrite this firmware ships with first, then the rest of the
+// one-line family, then multi-line and full-matrix panels. Larger controllers
+// redraw the whole panel per command and get a longer gap.
+//   type, name, lines, columns, rows, memory, tricolor, read-back, command gap (ms)
+constexpr SignCapabilities SIGN_CAPS[] = {
+    {BB_ST_BETABRITE,             "BetaBrite",              1,  80,  7,  8192, true,  true,  110},
+    {BB_ST_215C,                  "Alpha 215C",             1,  90,  7,  8192, true,  true,  110},
+    {BB_ST_215R,                  "Alpha 215R",             1,  90,  7,  8192, false, true,  110},
+    {BB_ST_210C_220C,             "Alpha 210C/220C",        1,  60,  7,  8192, true,  true,  110},
+    {BB_ST_4080C,                 "Alpha 4080C",            1,  80,  7, 32768, true,  true,  110},
+    {BB_ST_4120C,                 "Alpha 4120C",            1, 120,  7, 32768, true,  true,  110},
+    {BB_ST_4160C,                 "Alpha 4160C",            1, 160,  7, 32768, true,  true,  110},
+    {BB_ST_4200C,                 "Alpha 4200C",            1, 200,  7, 32768, true,  true,  110},
+    {BB_ST_4240C,                 "Alpha 4240C",            1, 240,  7, 32768, true,  true,  110},
+    {BB_ST_4120R,                 "Alpha 4120R",            1, 120,  7, 32768, false, true,  110},
+    {BB_ST_4160R,                 "Alpha 4160R",            1, 160,  7, 32768, false, true,  110},
+    {BB_ST_4200R,                 "Alpha 4200R",            1, 200,  7, 32768, false, true,  110},
+    {BB_ST_4240R,                 "Alpha 4240R",            1, 240,  7, 32768, false, true,  110},
+    {BB_ST_430I,                  "Alpha 430i",             1, 180,  7, 32768, true,  true,  110},
+    {BB_ST_440I,                  "Alpha 440i",             1, 240,  7, 32768, true,  true,  110},
+    {BB_ST_460I,                  "Alpha 460i",             1, 360,  7, 32768, true,  true,  110},
+    {BB_ST_790I,                  "Alpha 790i",             1,  90,  7, 32768, true,  true,  110},
+    {BB_ST_300S,                  "Alpha 300S",             1,  60,  7,  4096, false, false, 110},
+    {BB_ST_7000S,                 "Alpha 7000S",            1,  80,  7,  4096, false, false, 110},
+    {BB_ST_1005DC,                "Alpha 1005DC",           1,  30,  7,  1024, false, false, 110},
+    {BB_ST_9616MS,                "Alpha 9616MS",           2,  96, 16, 32768, true,  true,  150},
+    {BB_ST_12816MS,               "Alpha 12816MS",          2, 128, 16, 32768, true,  true,  150},
+    {BB_ST_16016MS,               "Alpha 16016MS",          2, 160, 16, 32768, true,  true,  150},
+    {BB_ST_19216MS,               "Alpha 19216MS",          2, 192, 16, 32768, true,  true,  150},
+    {BB_ST_ALPHAVISION,           "AlphaVision",            2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAVISIONFM,         "AlphaVision FM",         2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAVISIONCM,         "AlphaVision CM",         2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAVISIONLM,         "AlphaVision LM",         2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAPREMIERE,         "AlphaPremiere",          2, 160, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAPREMIERE9000,     "AlphaPremiere 9000",     2, 160, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAECLIPSE3500,      "AlphaEclipse 3500",      2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAECLIPSE3600,      "AlphaEclipse 3600",      2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAECLIPSE3600DDB,   "AlphaEclipse DDB",       2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAECLIPSE3600TAB,   "AlphaEclipse TAB",       2,  96, 16, 65536, true,  true,  150},
+    {BB_ST_ALPHAECLIPSETIMETEMP,  "AlphaEclipse Time/Temp", 1,  32,  7,  1024, true,  true,  110},
+    {BB_ST_ALPHAECLIPSETT,        "AlphaEclipse TT",        1,  32,  7,  1024, true,  true,  110},
+    {BB_ST_PPD,                   "Alpha PPD",              2,  96, 16, 32768, true,  true,  150},
+    {BB_ST_DIRECTOR,              "Alpha Director",         2,  96, 16, 32768, true,  true,  150},
+};
+
+constexpr size_t SIGN_CAPS_COUNT = sizeof(SIGN_CAPS) / sizeof(SIGN_CAPS[0]);
+
+constexpr bool typeUnusedAfter(size_t i, size_t j) {
+    return j >= SIGN_CAPS_COUNT || (SIGN_CAPS[i].type != SIGN_CAPS[j].type && typeUnusedAfter(i, j + 1));
+}
+
+constexpr bool typesUnique(size_t i) {
+    return i >= SIGN_CAPS_COUNT || (typeUnusedAfter(i, i + 1) && typesUnique(i + 1));
+}
+
+// Index of a type code's entry (SIGN_CAPS_COUNT if it has none)
+constexpr size_t capsIndex(char type, size_t i = 0) {
+    return i >= SIGN_CAPS_COUNT || SIGN_CAPS[i].type == type ? i : capsIndex(type, i + 1);
+}
+
+static_assert(typesUnique(0), "SignModel: duplicate type code in SIGN_CAPS");
+static_assert(capsIndex(SIGNCAPS_DEFAULT_TYPE) < SIGN_CAPS_COUNT, "SignModel: SIGNCAPS_DEFAULT_TYPE has no entry");
+static_assert(SIGNCAPS_MODEL == 0 || capsIndex(SIGNCAPS_MODEL) < SIGN_CAPS_COUNT, "SignModel: SIGNCAPS_MODEL has no entry");
+
+MetricCounter metric_probes("ledsign_sign_model_probes_total", "Type-code reads sent to identify the sign");
+MetricCounter metric_adapted("ledsign_sign_adapted_total", "Frames with a colour or charset the sign cannot show replaced");
+
+/**
+ * @brief Glyph height of a charset in pixels
+ */
+uint8_t charsetRows(char charset) {
+    switch (charset) {
+        case BB_CS_10HIGH:
+        case BB_CS_10HIGHCUSTOM:
+            return 10;
+        case BB_CS_15HIGHCUSTOM:
+            return 15;
+        default:
+            return 7;   // 5 and 7 high; "full height" sets scale to the panel
+    }
+}
+
+const char* const SOURCE_NAMES[] = {"default", "configured", "cached, sign silent", "probed"};
+}
+
+SignModel::SignModel() : caps(&SIGN_CAPS[capsIndex(SIGNCAPS_DEFAULT_TYPE)]), source(SIGNMODEL_DEFAULT), probes(0) {}
+
+bool SignModel::begin(BETABRITE* sign, bool probe_sign) {
+    char cached = loadCached();
+    char type = 0;
+
+    if (SIGNCAPS_MODEL) {
+        type = SIGNCAPS_MODEL;
+        source = SIGNMODEL_CONFIGURED;
+    } else if (sign && probe_sign) {
+        Serial.println("SignModel: Probing sign type");
+        type = detect(sign, cached);
+        if (type) {
+            source = SIGNMODEL_PROBED;
+            if (type != cached) {
+                saveCached(type);
+            }
+        }
+    }
+    if (!type && lookup(cached)) {
+        type = cached;
+        source = SIGNMODEL_CACHED;
+    }
+    if (!lookup(type)) {
+        type = SIGNCAPS_DEFAULT_TYPE;
+        source = SIGNMODEL_DEFAULT;
+    }
+    caps = lookup(type);
+
+    Serial.print("SignModel: ");
+    Serial.println(getStatus());
+    return source == SIGNMODEL_CONFIGURED || source == SIGNMODEL_PROBED;
+}
+
+char SignModel::detect(BETABRITE* sign, char cached) {
+    char original = sign->GetType();
+    char found = 0;
+    probes = 0;
+
+    // Nothing answers the wildcard: write-only wiring or no sign, no point asking each model
+    if (probe(sign, BB_ST_ALL)) {
+        if (lookup(cached) && probe(sign, cached)) {
+            found = cached;
+        } else {
+            uint8_t lines = probe(sign, BB_ST_1LINE) ? 1 : probe(sign, BB_ST_2LINE) ? 2 : 0;
+
+            // Models with the answering line count first, then the rest (one code can cover both)
+            for (uint8_t pass = 0; pass < 2 && !found; pass++) {
+                for (size_t i = 0; i < SIGN_CAPS_COUNT && !found; i++) {
+                    const SignCapabilities& entry = SIGN_CAPS[i];
+                    bool same_lines = !lines || entry.lines == lines;
+                    if (!entry.read_back || entry.type == cached || same_lines != (pass == 0)) {
+                        continue;
+                    }
+                    if (probe(sign, entry.type)) {
+                        found = entry.type;
+                    }
+                }
+            }
+        }
+    }
+
+    sign->SetType(original);
+    return found;
+}
+
+bool SignModel::probe(BETABRITE* sign, char type) {
+    char buffer[32];
+    sign->SetType(type);
+    probes++;
+    metric_probes.inc();
+    return sign->ReadSpecialFunction(' ', buffer, sizeof(buffer), SIGNCAPS_PROBE_TIMEOUT_MS) > 0;  // Time of day
+}
+
+const SignCapabilities* SignModel::lookup(char type) {
+    size_t index = capsIndex(type);
+    return type && index < SIGN_CAPS_COUNT ? &SIGN_CAPS[index] : nullptr;
+}
+
+bool SignModel::adapt(const SignCapabilities& caps, char& color, char& charset) {
+    bool adapted = false;
+    if (!caps.tricolor && color != BB_COL_RED && color != BB_COL_DIMRED) {
+        color = BB_COL_RED;
+        adapted = true;
+    }
+    if (charsetRows(charset) > caps.rows) {
+        charset = BB_CS_7HIGH;
+        adapted = true;
+    }
+    if (adapted) {
+        metric_adapted.inc();
+    }
+    return adapted;
+}
+
+int SignModel::planFiles(const SignCapabilities& caps, int requested, unsigned int file_size) {
+    uint32_t fit = file_size ? caps.memory_bytes / file_size : requested;
+    if ((uint32_t)requested > fit) {
+        requested = (int)fit;
+    }
+    return requested < 1 ? 1 : requested;
+}
+
+char SignModel::loadCached() {
+    Preferences prefs;
+    if (!prefs.begin(SIGNCAPS_NVS_NAMESPACE, true)) {
+        return 0;
+    }
+    char type = (char)prefs.getUChar("type", 0);
+    prefs.end();
+    return type;
+}
+
+void SignModel::saveCached(char type) {
+    Preferences prefs;
+    if (prefs.begin(SIGNCAPS_NVS_NAMESPACE, false)) {
+        prefs.putUChar("type", (uint8_t)type);
+        prefs.end();
+    }
+}
+
+String SignModel::getStatus() const {
+    String status = String(caps->name) + " (" + SOURCE_NAMES[source];
+    if (source == SIGNMODEL_PROBED) {
+        status += ", " + String(probes) + " reads";
+    }
+    status += "): " + String(caps->lines) + (caps->lines == 1 ? " line " : " lines ") + String(caps->columns) +
+              "x" + String(caps->rows) + ", " + (caps->tricolor ? "tricolor" : "red only") + ", " +
+              String(caps->memory_bytes / 1024) + " KB";
+    status += caps->read_back ? ", read-back" : ", write-only";
+    if (metric_adapted.get()) {
+        status += ", " + String(metric_adapted.get()) + " frames adapted";
+    }
+    return status;
+}
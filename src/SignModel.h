@@ -0,0 +1,149 @@
+/**
+ * @file SignModel.h
+ * @brief Sign capability table and boot-time model detection
+ *
+ * The BETABRITE library addresses every sign as BB_ST_ALL, but the models
+ * behind the BB_ST_* type codes differ in lines, pixel width, text memory,
+ * colour and whether they answer read commands. SignModel keeps a
+ * capability entry per model and works out which one is attached:
+ *
+ *   1. SIGNCAPS_MODEL set in defines.h: that model, no probe
+ *   2. Probe: a sign only answers a command carrying its own type code or a
+ *      wildcard, so a time-of-day read (ReadSpecialFunction ' ') is sent
+ *      under BB_ST_ALL, then the cached model, then BB_ST_1LINE/BB_ST_2LINE
+ *      to narrow the candidates, then each candidate in turn until one
+ *      answers. The answer is cached in NVS, so later boots take two reads.
+ *   3. The sign is silent (write-only or not connected): the cached model
+ *   4. Nothing cached: SIGNCAPS_DEFAULT_TYPE (BetaBrite 1036)
+ *
+ * The result drives the rest of the firmware: the inter-command delay,
+ * how many files configureMemory() allocates, the panel size the load
+ * estimate uses, and adapt(), which replaces a colour a red-only sign
+ * cannot show and a character set taller than the panel before the frame
+ * is sent. A sign without read-back skips the boot diagnostic ping.
+ *
+ * Wildcard and accessory type codes (BB_ST_ALL, BB_ST_LIGHTSENSOR, ...)
+ * have no entry. Geometry is the nominal panel of each model family; where
+ * one type code covers several sizes the smallest is listed.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef SIGN_MODEL_H
+#define SIGN_MODEL_H
+
+#include <Arduino.h>
+#include "BETABRITE.h"
+
+// Sign model constants (from defines.h)
+#ifndef SIGNCAPS_MODEL
+#define SIGNCAPS_MODEL            0         // BB_ST_* to skip detection (0 = detect)
+#endif
+#ifndef SIGNCAPS_DEFAULT_TYPE
+#define SIGNCAPS_DEFAULT_TYPE     BB_ST_BETABRITE
+#endif
+#ifndef SIGNCAPS_PROBE
+#define SIGNCAPS_PROBE            true
+#endif
+#ifndef SIGNCAPS_PROBE_TIMEOUT_MS
+#define SIGNCAPS_PROBE_TIMEOUT_MS 300
+#endif
+#ifndef SIGNCAPS_NVS_NAMESPACE
+#define SIGNCAPS_NVS_NAMESPACE    "signmodel"
+#endif
+
+/**
+ * @brief What one sign model can do
+ */
+struct SignCapabilities {
+    char type;                          ///< BB_ST_* type code
+    const char* name;
+    uint8_t lines;                      ///< Text lines (1, or 2 for multi-line/full-matrix panels)
+    uint16_t columns;                   ///< Panel width in pixels
+    uint8_t rows;                       ///< Panel height in pixels
+    uint32_t memory_bytes;              ///< Text file memory
+    bool tricolor;                      ///< Red/green/amber (false = red only)
+    bool read_back;                     ///< Answers read commands
+    uint16_t command_gap_ms;            ///< Delay after each command
+};
+
+/**
+ * @brief Where the model in use came from
+ */
+enum SignModelSource : uint8_t {
+    SIGNMODEL_DEFAULT,                  ///< Nothing known: SIGNCAPS_DEFAULT_TYPE
+    SIGNMODEL_CONFIGURED,               ///< SIGNCAPS_MODEL
+    SIGNMODEL_CACHED,                   ///< Sign silent, last probed model from NVS
+    SIGNMODEL_PROBED                    ///< Sign answered its type code this boot
+};
+
+/**
+ * @brief Identifies the attached sign and hands out its capabilities
+ */
+class SignModel {
+public:
+    SignModel();
+
+    /**
+     * @brief Work out the attached model (see file comment for the order)
+     * @param sign Sign to probe; its type code is restored afterwards
+     * @param probe_sign false to go straight to the cached/default model
+     * @return true if the model was configured or answered a probe
+     */
+    bool begin(BETABRITE* sign, bool probe_sign = SIGNCAPS_PROBE);
+
+    /**
+     * @brief Capabilities of the model in use (the default model before begin())
+     */
+    const SignCapabilities& get() const { return *caps; }
+    SignModelSource getSource() const { return source; }
+
+    /**
+     * @brief Capability entry for a type code
+     * @return nullptr for wildcards, accessories and unknown codes
+     */
+    static const SignCapabilities* lookup(char type);
+
+    /**
+     * @brief Replace frame attributes the sign cannot show
+     *
+     * A red-only sign gets BB_COL_RED (BB_COL_DIMRED stays), so the load
+     * estimate counts one die per pixel; a character set taller than the
+     * panel becomes 7 high.
+     *
+     * @param caps Sign capabilities
+     * @param color In/out: BB_COL_*
+     * @param charset In/out: BB_CS_*
+     * @return true if anything was replaced
+     */
+    static bool adapt(const SignCapabilities& caps, char& color, char& charset);
+
+    /**
+     * @brief Text files of file_size bytes that fit the sign's memory
+     * @param caps Sign capabilities
+     * @param requested Files wanted
+     * @param file_size Bytes per file
+     * @return requested, or fewer if they do not fit (at least 1)
+     */
+    static int planFiles(const SignCapabilities& caps, int requested, unsigned int file_size);
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    const SignCapabilities* caps;
+    SignModelSource source;
+    uint8_t probes;                     ///< Reads sent by the last detection
+
+    char detect(BETABRITE* sign, char cached);
+    bool probe(BETABRITE* sign, char type);
+    static char loadCached();
+    static void saveCached(char type);
+};
+
+#endif // SIGN_MODEL_H
@@ -0,0 +1,335 @@
+/**
+ * @file Simulation.cpp
+ * @brief Implementation of the virtual clock and scenario runner
+ */
+
+#ifdef SIM_CLOCK
+
+#include "defines.h"
+#include "Simulation.h"
+#include "TimeSync.h"
+#include <LittleFS.h>
+#include <algorithm>
+
+/////////////////////////////////////////////
+// Virtual clock
+/////////////////////////////////////////////
+
+namespace {
+uint32_t virtual_ms = 0;          // Virtual milliseconds since boot
+time_t epoch_base = 0;            // Wall clock at epoch_set_ms (0 = never set)
+uint32_t epoch_set_ms = 0;
+uint32_t wake_ms = 0;             // Earliest deadline reported this loop
+bool wake_pending = false;
+}
+
+namespace SimClock {
+
+uint32_t millis() {
+    return virtual_ms;
+}
+
+void delay(uint32_t ms) {
+    virtual_ms += ms;
+    yield();
+}
+
+time_t now() {
+    // Before the first NTP command behave like an unsynced ESP32: seconds since boot
+    if (epoch_base == 0) {
+        return (time_t)(virtual_ms / 1000);
+    }
+    return epoch_base + (time_t)((virtual_ms - epoch_set_ms) / 1000);
+}
+
+void wakeAt(uint32_t deadline_ms) {
+    // Already due (e.g. blocked by priority mode): poll again shortly instead of spinning
+    if ((int32_t)(deadline_ms - virtual_ms) <= 0) {
+        deadline_ms = virtual_ms + SIM_MIN_STEP_MS;
+    }
+    if (!wake_pending || (int32_t)(deadline_ms - wake_ms) < 0) {
+        wake_ms = deadline_ms;
+        wake_pending = true;
+    }
+}
+
+void event(const char* source, const String& detail) {
+    uint32_t ms = virtual_ms;
+    Serial.printf("SIM %lud %02lu:%02lu:%02lu.%03lu %s %s\n",
+                  (unsigned long)(ms / 86400000UL),
+                  (unsigned long)(ms / 3600000UL % 24),
+                  (unsigned long)(ms / 60000UL % 60),
+                  (unsigned long)(ms / 1000UL % 60),
+                  (unsigned long)(ms % 1000UL),
+                  source, detail.c_str());
+}
+
+void setEpoch(time_t epoch) {
+    epoch_base = epoch;
+    epoch_set_ms = virtual_ms;
+}
+
+uint32_t advance() {
+    uint32_t target = virtual_ms + SIM_MAX_STEP_MS;
+    if (wake_pending && (int32_t)(wake_ms - target) < 0) {
+        target = wake_ms;
+    }
+    wake_pending = false;
+
+    uint32_t step = target - virtual_ms;
+    virtual_ms = target;
+    return step;
+}
+
+} // namespace SimClock
+
+/////////////////////////////////////////////
+// Scenario runner
+/////////////////////////////////////////////
+
+bool Simulation::wifi_up = true;
+bool Simulation::broker_up = true;
+
+Simulation::Simulation()
+    : next_step(0), start_ms(0), loop_count(0), running(false), finished(false) {
+}
+
+bool Simulation::loadFile(const char* path) {
+    if (!LittleFS.begin(false)) {
+        Serial.println("Simulation: LittleFS not available");
+        return false;
+    }
+
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.print("Simulation: No scenario at ");
+        Serial.println(path);
+        return false;
+    }
+
+    String script = file.readString();
+    file.close();
+
+    Serial.print("Simulation: Loading ");
+    Serial.println(path);
+    return loadString(script);
+}
+
+bool Simulation::loadString(const String& script) {
+    steps.clear();
+    next_step = 0;
+
+    int line_number = 0;
+    int start = 0;
+    while (start < (int)script.length()) {
+        int end = script.indexOf('\n', start);
+        if (end < 0) {
+            end = script.length();
+        }
+        line_number++;
+        if (!parseLine(script.substring(start, end), line_number)) {
+            steps.clear();
+            return false;
+        }
+        start = end + 1;
+    }
+
+    // repeat expands out of order; run strictly by time, file order within a tie
+    std::stable_sort(steps.begin(), steps.end(),
+                     [](const Step& a, const Step& b) { return a.at_ms < b.at_ms; });
+
+    Serial.print("Simulation: Scenario has ");
+    Serial.print(steps.size());
+    Serial.println(" steps");
+    return !steps.empty();
+}
+
+bool Simulation::parseTime(const String& token, uint32_t* ms) {
+    // [Nd]HH:MM:SS[.mmm]
+    unsigned long days = 0, hours = 0, minutes = 0, seconds = 0, millis_part = 0;
+    String rest = token;
+
+    int d = rest.indexOf('d');
+    if (d >= 0) {
+        days = strtoul(rest.substring(0, d).c_str(), nullptr, 10);
+        rest = rest.substring(d + 1);
+    }
+
+    int dot = rest.indexOf('.');
+    if (dot >= 0) {
+        String frac = rest.substring(dot + 1);
+        while (frac.length() < 3) frac += '0';
+        millis_part = strtoul(frac.substring(0, 3).c_str(), nullptr, 10);
+        rest = rest.substring(0, dot);
+    }
+
+    if (sscanf(rest.c_str(), "%lu:%lu:%lu", &hours, &minutes, &seconds) != 3 ||
+        minutes > 59 || seconds > 59) {
+        return false;
+    }
+
+    uint64_t total = (((uint64_t)days * 24 + hours) * 60 + minutes) * 60000ULL +
+                     seconds * 1000ULL + millis_part;
+    if (total > 0x7FFFFFFFULL) {
+        return false;  // Keep every deadline comparable with signed 32-bit differences
+    }
+    *ms = (uint32_t)total;
+    return true;
+}
+
+bool Simulation::parseLine(const String& raw, int line_number) {
+    // Whole-line comments only: alert JSON and priority text may contain '#'
+    String line = raw;
+    line.trim();
+    if (line.length() == 0 || line.startsWith("#")) {
+        return true;
+    }
+
+    int sp1 = line.indexOf(' ');
+    uint32_t at_ms = 0;
+    if (sp1 < 0 || !parseTime(line.substring(0, sp1), &at_ms)) {
+        Serial.printf("Simulation: Error - line %d: bad time\n", line_number);
+        return false;
+    }
+
+    String rest = line.substring(sp1 + 1);
+    rest.trim();
+    int sp2 = rest.indexOf(' ');
+    String command = sp2 < 0 ? rest : rest.substring(0, sp2);
+    String args = sp2 < 0 ? "" : rest.substring(sp2 + 1);
+    args.trim();
+
+    if (command != "repeat") {
+        if (!addStep(at_ms, command, args)) {
+            Serial.printf("Simulation: Error - line %d: bad command '%s'\n", line_number, command.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // repeat <count> <interval> <command ...>
+    int a = args.indexOf(' ');
+    int b = a < 0 ? -1 : args.indexOf(' ', a + 1);
+    uint32_t interval_ms = 0;
+    long count = a < 0 ? 0 : args.substring(0, a).toInt();
+    if (b < 0 || count <= 0 || !parseTime(args.substring(a + 1, b), &interval_ms)) {
+        Serial.printf("Simulation: Error - line %d: usage: repeat <count> <interval> <command>\n", line_number);
+        return false;
+    }
+
+    String inner = args.substring(b + 1);
+    inner.trim();
+    int sp3 = inner.indexOf(' ');
+    String inner_command = sp3 < 0 ? inner : inner.substring(0, sp3);
+    String inner_args = sp3 < 0 ? "" : inner.substring(sp3 + 1);
+
+    for (long i = 0; i < count; i++) {
+        if (!addStep(at_ms + (uint32_t)i * interval_ms, inner_command, inner_args)) {
+            Serial.printf("Simulation: Error - line %d: bad repeat\n", line_number);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Simulation::addStep(uint32_t at_ms, const String& command, const String& args) {
+    static const char* const known[] = {
+        "wifi", "broker", "ntp", "alert", "mqtt", "priority", "sequence", "espnow", "end"
+    };
+
+    bool valid = false;
+    for (const char* name : known) {
+        if (command == name) {
+            valid = true;
+            break;
+        }
+    }
+    if (!valid || steps.size() >= SIM_MAX_STEPS) {
+        return false;
+    }
+    if ((command == "wifi" || command == "broker") && args != "up" && args != "down") {
+        return false;
+    }
+    if ((command == "mqtt" || command == "espnow") && args.indexOf(' ') <= 0) {
+        return false;
+    }
+
+    steps.push_back({at_ms, command, args});
+    return true;
+}
+
+void Simulation::begin() {
+    start_ms = SimClock::millis();
+    next_step = 0;
+    loop_count = 0;
+    running = true;
+    finished = false;
+    SIM_EVENT("sim", "start " + String(steps.size()) + " steps");
+}
+
+void Simulation::setCommandCallback(CommandCallback callback) {
+    command_callback = callback;
+}
+
+void Simulation::loop() {
+    if (!running) {
+        return;
+    }
+
+    uint32_t elapsed = SimClock::millis() - start_ms;
+    while (next_step < steps.size() && steps[next_step].at_ms <= elapsed && !finished) {
+        execute(steps[next_step++]);
+    }
+
+    if (next_step >= steps.size() && !finished) {
+        SIM_EVENT("sim", "scenario exhausted");
+        finished = true;
+    }
+
+    if (finished) {
+        running = false;
+        SIM_EVENT("sim", "end after " + String(loop_count) + " loops");
+        Serial.print("Simulation: Finished - ");
+        Serial.println(getStatus());
+    }
+}
+
+void Simulation::execute(const Step& step) {
+    SIM_EVENT("scenario", step.command + (step.args.length() ? " " + step.args : ""));
+
+    if (step.command == "wifi") {
+        wifi_up = (step.args == "up");
+    } else if (step.command == "broker") {
+        broker_up = (step.args == "up");
+    } else if (step.command == "ntp") {
+        SimClock::setEpoch((time_t)strtoul(step.args.c_str(), nullptr, 10));
+        TimeSync::reportSync();
+    } else if (step.command == "end") {
+        finished = true;
+    } else if (command_callback) {
+        command_callback(step.command, step.args);
+    }
+}
+
+void Simulation::advance() {
+    if (!running) {
+        return;
+    }
+
+    if (next_step < steps.size()) {
+        SimClock::wakeAt(start_ms + steps[next_step].at_ms);
+    }
+    SimClock::advance();
+    loop_count++;
+}
+
+String Simulation::getStatus() const {
+    uint32_t elapsed = SimClock::millis() - start_ms;
+    String status = String(next_step) + "/" + String(steps.size()) + " steps";
+    status += ", " + String(elapsed / 1000) + " s virtual";
+    status += ", " + String(loop_count) + " loops";
+    status += ", wall " + String(::millis() / 1000) + " s";
+    return status;
+}
+
+#endif // SIM_CLOCK
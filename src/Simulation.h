@@ -0,0 +1,151 @@
+/**
+ * @file Simulation.h
+ * @brief Discrete-event scenario runner for the virtual-clock build
+ *
+ * Only compiled with -D SIM_CLOCK (pio run -e esp32dev_sim). Replays a
+ * timed scenario against the real firmware logic while SimClock jumps
+ * straight from one deadline to the next, so a day of priority stages,
+ * MQTT backoff, NTP resyncs and OTA checks runs in seconds:
+ * - Scenario loaded from LittleFS (SIM_SCENARIO_PATH)
+ * - Link state (WiFi, broker) is simulated; no radio traffic is generated
+ * - Alerts, raw MQTT messages, priority messages, sequence triggers and
+ *   handheld remote frames go to a callback that feeds the normal ingestion
+ *   paths in main.cpp
+ * - Every state change is logged as "SIM <day>d HH:MM:SS.mmm <source> <detail>"
+ *   on Serial; capture and diff those lines between runs
+ *
+ * Scenario syntax (one command per line, lines starting with '#' are comments):
+ *   <time> wifi up|down
+ *   <time> broker up|down
+ *   <time> ntp <unix_seconds>
+ *   <time> alert <json>
+ *   <time> mqtt <topic> <payload>
+ *   <time> priority <seconds> <text>
+ *   <time> sequence start|stop
+ *   <time> espnow pair <seconds>
+ *   <time> espnow <mac> <hex frame>      (EspNowReceiver frame layout)
+ *   <time> repeat <count> <interval> <command ...>
+ *   <time> end
+ * where <time> and <interval> are [Nd]HH:MM:SS[.mmm] from the start of the run.
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#ifdef SIM_CLOCK
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+#include "SimClock.h"
+
+// Simulation configuration constants (from defines.h)
+#ifndef SIM_MAX_STEPS
+#define SIM_MAX_STEPS             512     // Scenario commands after repeat expansion
+#endif
+
+/**
+ * @brief Scenario runner and simulated link state
+ */
+class Simulation {
+public:
+    /**
+     * @brief Callback for commands that drive application logic
+     * @param command Command name ("alert", "mqtt", "priority", "sequence")
+     * @param args Remainder of the scenario line
+     */
+    typedef std::function<void(const String& command, const String& args)> CommandCallback;
+
+    Simulation();
+
+    /**
+     * @brief Load and parse a scenario from LittleFS
+     * @param path File path (e.g. "/sim.scn")
+     * @return true if the scenario parsed without errors
+     */
+    bool loadFile(const char* path);
+
+    /**
+     * @brief Parse a scenario from memory
+     * @param script Scenario text
+     * @return true if the scenario parsed without errors
+     */
+    bool loadString(const String& script);
+
+    /**
+     * @brief Start the run (scenario times are relative to this call)
+     */
+    void begin();
+
+    /**
+     * @brief Dispatch scenario commands that are due - call at the top of loop()
+     */
+    void loop();
+
+    /**
+     * @brief Jump the virtual clock to the next deadline - call at the end of loop()
+     */
+    void advance();
+
+    /**
+     * @brief Set callback for application commands
+     * @param callback Function receiving alert/mqtt/priority/sequence commands
+     */
+    void setCommandCallback(CommandCallback callback);
+
+    /**
+     * @brief Check whether the scenario has reached its end
+     * @return true after an "end" command or the last command
+     */
+    bool isFinished() const { return finished; }
+
+    /**
+     * @brief Simulated WiFi association (read by main.cpp instead of WiFi.status())
+     */
+    static bool isWiFiUp() { return wifi_up; }
+
+    /**
+     * @brief Simulated broker reachability (read by MQTTManager instead of connecting)
+     */
+    static bool isBrokerUp() { return broker_up; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    /**
+     * @brief Scenario command at a point in virtual time
+     */
+    struct Step {
+        uint32_t at_ms;                   ///< Offset from begin()
+        String command;                   ///< Command name
+        String args;                      ///< Remainder of the line
+    };
+
+    std::vector<Step> steps;
+    size_t next_step;
+    uint32_t start_ms;
+    uint32_t loop_count;
+    bool running;
+    bool finished;
+    CommandCallback command_callback;
+
+    static bool wifi_up;
+    static bool broker_up;
+
+    bool parseLine(const String& line, int line_number);
+    bool addStep(uint32_t at_ms, const String& command, const String& args);
+    void execute(const Step& step);
+    static bool parseTime(const String& token, uint32_t* ms);
+};
+
+#endif // SIM_CLOCK
+
+#endif // SIMULATION_H
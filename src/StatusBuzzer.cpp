@@ -4,7 +4,7 @@ StatusBuzzer::StatusBuzzer(uint8_t pin, uint8_t channel)
     : _pin(pin), _channel(channel), _muted(false),
       _currentPattern(BuzzerPattern::SILENT),
       _patternStartTime(0), _stepIndex(0), _stepStartTime(0),
-      _patternComplete(true) {}
+      _stepStarted(false), _patternComplete(true) {}
 
 void StatusBuzzer::begin() {
     ledcSetup(_channel, 2000, 8);
@@ -39,6 +39,7 @@ void StatusBuzzer::setPattern(BuzzerPattern pattern) {
     _patternStartTime = millis();
     _stepIndex = 0;
     _stepStartTime = millis();
+    _stepStarted = false;
     _patternComplete = false;
 }
 
@@ -52,9 +53,11 @@ void StatusBuzzer::runSequence(const ToneStep* steps, uint8_t count) {
 
     unsigned long now = millis();
 
-    // Start current step
-    if (now - _stepStartTime == 0 || _stepIndex == 0 && now == _patternStartTime) {
+    // Start the first step on the first loop() after setPattern(), which may be a tick later
+    if (!_stepStarted) {
         playTone(steps[_stepIndex].frequency);
+        _stepStartTime = now;
+        _stepStarted = true;
     }
 
     // Check if current step is done
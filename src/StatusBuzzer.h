@@ -24,6 +24,7 @@ public:
     void setMuted(bool muted) { _muted = muted; }
     bool isMuted() const { return _muted; }
     bool isPatternComplete() const { return _patternComplete; }
+    bool isPlaying() const { return !_patternComplete; }
 
 private:
     uint8_t _pin, _channel;
@@ -33,6 +34,7 @@ private:
     unsigned long _patternStartTime;
     uint8_t _stepIndex;
     unsigned long _stepStartTime;
+    bool _stepStarted;       // First step's tone is on (set by the first loop() after setPattern)
     bool _patternComplete;
 
     struct ToneStep {
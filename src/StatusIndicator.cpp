@@ -1,10 +1,12 @@
 #include "StatusIndicator.h"
 #include "defines.h"
+#include <HotPath.h>
 
 StatusIndicator::StatusIndicator()
     : _led(RGB_RED_PIN, RGB_GREEN_PIN, RGB_BLUE_PIN,
            LEDC_CH_RED, LEDC_CH_GREEN, LEDC_CH_BLUE),
       _buzzer(BUZZER_PIN, LEDC_CH_BUZZER),
+      _portalOpen(false),
       _basePattern(LEDPattern::OFF),
       _basePriority(PRI_IDLE),
       _transientPriority(PRI_IDLE),
@@ -13,10 +15,52 @@ StatusIndicator::StatusIndicator()
 void StatusIndicator::begin() {
     _led.begin();
     _buzzer.begin();
+
+    EventBus::subscribe(EVENT_MASK(EVT_WIFI_CONNECTED) | EVENT_MASK(EVT_WIFI_DISCONNECTED) |
+                        EVENT_MASK(EVT_MQTT_CONNECTED) | EVENT_MASK(EVT_MQTT_DISCONNECTED) |
+                        EVENT_MASK(EVT_ALERT_RECEIVED) | EVENT_MASK(EVT_ERROR) |
+                        EVENT_MASK(EVT_OTA_STARTED) | EVENT_MASK(EVT_OTA_COMPLETE) |
+                        EVENT_MASK(EVT_OTA_FAILED) | EVENT_MASK(EVT_PORTAL_OPENED) |
+                        EVENT_MASK(EVT_PORTAL_CLOSED),
+                        &StatusIndicator::handleEvent, this);
+
     Serial.println("StatusIndicator: Initialized (RGB LED + Buzzer)");
 }
 
+void StatusIndicator::handleEvent(const Event& event, void* context) {
+    HOTPATH_PROFILE(HOTPATH_INDICATOR);
+    StatusIndicator* self = static_cast<StatusIndicator*>(context);
+    switch (event.type) {
+        case EVT_WIFI_CONNECTED:    self->onWiFiConnected(); break;
+        case EVT_WIFI_DISCONNECTED: self->onWiFiDisconnected(); break;
+        case EVT_PORTAL_OPENED:     self->onPortalOpened(); break;
+        case EVT_PORTAL_CLOSED:     self->onPortalClosed(event.value != 0); break;
+        case EVT_MQTT_CONNECTED:    self->onMQTTConnected(); break;
+        case EVT_MQTT_DISCONNECTED: self->onMQTTDisconnected(); break;
+        case EVT_ALERT_RECEIVED:
+            if (event.value == ALERT_SEVERITY_PRIORITY) {
+                self->onPriorityAlert();
+            } else if (event.value == ALERT_SEVERITY_WARNING) {
+                self->onWarningAlert();
+            } else {
+                self->onMessageReceived();
+            }
+            break;
+        case EVT_ERROR:             self->onError(); break;
+        case EVT_OTA_STARTED:       self->onOTAStarted(); break;
+        case EVT_OTA_COMPLETE:      self->onOTAComplete(); break;
+        case EVT_OTA_FAILED:
+            // Drop the OTA-in-progress base pattern, then flag the failure
+            self->setBase(LEDPattern::OFF, PRI_IDLE);
+            self->onError();
+            break;
+        default:
+            break;
+    }
+}
+
 void StatusIndicator::loop() {
+    HOTPATH_PROFILE(HOTPATH_INDICATOR);
     // Check if transient pattern expired -> restore base
     if (_transientPriority > PRI_IDLE && millis() >= _transientExpiry) {
         _transientPriority = PRI_IDLE;
@@ -27,6 +71,10 @@ void StatusIndicator::loop() {
     _buzzer.loop();
 }
 
+bool StatusIndicator::isAnimating() const {
+    return _transientPriority > PRI_IDLE || _led.isAnimating() || _buzzer.isPlaying();
+}
+
 void StatusIndicator::setBase(LEDPattern led, Priority pri) {
     _basePattern = led;
     _basePriority = pri;
@@ -67,7 +115,20 @@ void StatusIndicator::onWiFiConnected() {
 }
 
 void StatusIndicator::onWiFiDisconnected() {
-    setBase(LEDPattern::BREATHE_RED, PRI_SUSTAINED);
+    setBase(_portalOpen ? LEDPattern::BREATHE_BLUE : LEDPattern::BREATHE_RED, PRI_SUSTAINED);
+}
+
+void StatusIndicator::onPortalOpened() {
+    // Waiting for setup, not a fault: blue instead of the WiFi-down red
+    _portalOpen = true;
+    setBase(LEDPattern::BREATHE_BLUE, PRI_SUSTAINED);
+}
+
+void StatusIndicator::onPortalClosed(bool online) {
+    _portalOpen = false;
+    if (_basePattern == LEDPattern::BREATHE_BLUE) {
+        setBase(online ? LEDPattern::OFF : LEDPattern::BREATHE_RED, online ? PRI_IDLE : PRI_SUSTAINED);
+    }
 }
 
 void StatusIndicator::onMQTTConnected() {
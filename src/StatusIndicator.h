@@ -2,6 +2,7 @@
 #define STATUS_INDICATOR_H
 
 #include <Arduino.h>
+#include <EventBus.h>
 #include "StatusLED.h"
 #include "StatusBuzzer.h"
 
@@ -10,11 +11,14 @@ public:
     StatusIndicator();
     void begin();
     void loop();
+    bool isAnimating() const;   // loop() needs the animation tick (pattern, tone or transient running)
 
     // System event methods
     void onBoot();
     void onWiFiConnected();
     void onWiFiDisconnected();
+    void onPortalOpened();
+    void onPortalClosed(bool online);
     void onMQTTConnected();
     void onMQTTDisconnected();
     void onMessageReceived();
@@ -25,6 +29,9 @@ public:
     void onError();
     void onIdle();
 
+    // Event bus consumer (subscribed in begin())
+    static void handleEvent(const Event& event, void* context);
+
     // HA control
     void setLEDPattern(const String& patternName);
     void triggerBuzzer(const String& patternName);
@@ -46,6 +53,8 @@ private:
         PRI_BOOT = 6
     };
 
+    bool _portalOpen;        // WiFi down shows the portal pattern instead
+
     LEDPattern _basePattern;
     Priority _basePriority;
     Priority _transientPriority;
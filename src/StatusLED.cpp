@@ -40,6 +40,10 @@ void StatusLED::setPattern(LEDPattern pattern) {
     runPattern();
 }
 
+bool StatusLED::isAnimating() const {
+    return !_patternComplete && _currentPattern > LEDPattern::SOLID_AMBER;
+}
+
 uint8_t StatusLED::breathe(unsigned long elapsed, unsigned long periodMs) {
     // Triangle wave: ramp up then down
     unsigned long phase = elapsed % periodMs;
@@ -32,6 +32,7 @@ public:
     void off();
     LEDPattern getCurrentPattern() const { return _currentPattern; }
     bool isPatternComplete() const { return _patternComplete; }
+    bool isAnimating() const;   // Changes over time (flash, breathe, timed); solid colours are set once
 
 private:
     uint8_t _pinR, _pinG, _pinB;
@@ -0,0 +1,97 @@
+/**
+ * @file TimeSync.cpp
+ * @brief Implementation of background SNTP time sync
+ */
+
+#include "defines.h"
+#include "TimeSync.h"
+#include "Metrics.h"
+#include "SimClock.h"
+#include <EventBus.h>
+#include <atomic>
+#ifndef SIM_CLOCK
+#include <esp_sntp.h>
+#endif
+
+namespace {
+MetricCounter metric_syncs("ledsign_time_syncs_total", "Completed SNTP time syncs");
+
+// Written from the lwIP task, read on the main task
+std::atomic<uint32_t> sync_count(0);
+std::atomic<uint32_t> last_sync_epoch(0);
+
+#ifndef SIM_CLOCK
+void onSntpSync(struct timeval*) {
+    TimeSync::reportSync();
+}
+#endif
+}
+
+TimeSync::TimeSync()
+    : started(false), start_ms(0) {
+}
+
+bool TimeSync::start(const char* server, const char* timezone) {
+    if (started) {
+        return true;
+    }
+    start_ms = SimClock::millis();
+    started = true;
+
+#ifdef SIM_CLOCK
+    // Scenario "ntp" steps stand in for the server
+    setenv("TZ", timezone, 1);
+    tzset();
+    (void)server;
+#else
+    // Must be set before configTzTime() (re)starts the client
+    sntp_set_time_sync_notification_cb(onSntpSync);
+    sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+    sntp_set_sync_interval(TIMESYNC_INTERVAL_MS);
+    configTzTime(timezone, server);
+#endif
+
+    Serial.print("TimeSync: SNTP started (");
+    Serial.print(server);
+    Serial.println(")");
+    return true;
+}
+
+void TimeSync::reportSync() {
+    sync_count.fetch_add(1, std::memory_order_relaxed);
+    last_sync_epoch.store((uint32_t)SimClock::now(), std::memory_order_relaxed);
+    metric_syncs.inc();
+    EventBus::publish(EVT_TIME_SYNCED);
+}
+
+bool TimeSync::isSynced() const {
+    return sync_count.load(std::memory_order_relaxed) > 0;
+}
+
+bool TimeSync::isOverdue() const {
+    return started && !isSynced() && SimClock::millis() - start_ms > TIMESYNC_TIMEOUT_MS;
+}
+
+String TimeSync::getStatus() const {
+    if (!started) {
+        return "stopped";
+    }
+    uint32_t count = sync_count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return "waiting for first sync (" + String((SimClock::millis() - start_ms) / 1000) + "s)";
+    }
+
+    time_t last = (time_t)last_sync_epoch.load(std::memory_order_relaxed);
+    char stamp[24];
+    struct tm utc;
+    gmtime_r(&last, &utc);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &utc);
+
+    String status = String(count) + " syncs, last " + stamp + " UTC";
+#ifndef SIM_CLOCK
+    if (sntp_get_sync_status() == SNTP_SYNC_STATUS_IN_PROGRESS) {
+        status += " (slewing)";
+    }
+#endif
+    return status;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file TimeSync.h
+ * @brief Background SNTP with sync notifications and smooth slewing
+ *
+ * start() configures the ESP-IDF SNTP client and returns immediately; the
+ * lwIP task then syncs every TIMESYNC_INTERVAL_MS on its own. Nothing on the
+ * main loop waits for a server:
+ * - Each completed sync publishes EVT_TIME_SYNCED on the event bus; modules
+ *   that need wall-clock time (clock display, TLS) subscribe to it
+ * - The first sync steps the clock; later corrections are slewed with
+ *   adjtime() so the displayed clock never jumps back or skips a minute
+ *   (IDF falls back to a step when the error is too large to slew)
+ * - A missing first sync is only reported (isOverdue()); it no longer
+ *   blocks the loop or puts an error on the sign
+ *
+ * In the SIM_CLOCK build there is no SNTP client: the scenario's "ntp" steps
+ * set the virtual clock and call reportSync().
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Time sync configuration constants (from defines.h)
+#ifndef TIMESYNC_INTERVAL_MS
+#define TIMESYNC_INTERVAL_MS      3600000
+#endif
+#ifndef TIMESYNC_TIMEOUT_MS
+#define TIMESYNC_TIMEOUT_MS       60000
+#endif
+
+/**
+ * @brief Owns SNTP configuration and sync bookkeeping
+ */
+class TimeSync {
+public:
+    TimeSync();
+
+    /**
+     * @brief Start background SNTP (call once WiFi is up; later calls are no-ops)
+     * @param server NTP server host name (must outlive the client)
+     * @param timezone POSIX TZ string for local time
+     * @return true if SNTP is running
+     */
+    bool start(const char* server, const char* timezone);
+
+    /**
+     * @brief Record a completed sync and publish EVT_TIME_SYNCED
+     *
+     * Called from the lwIP task by the SNTP notification; safe from any task.
+     */
+    static void reportSync();
+
+    /**
+     * @brief Check whether at least one sync has completed
+     */
+    bool isSynced() const;
+
+    /**
+     * @brief Check whether the first sync is more than TIMESYNC_TIMEOUT_MS late
+     */
+    bool isOverdue() const;
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    bool started;
+    uint32_t start_ms;                 ///< SimClock::millis() at start()
+};
+
+#endif // TIME_SYNC_H
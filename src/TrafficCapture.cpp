@@ -0,0 +1,384 @@
+/**
+ * @file TrafficCapture.cpp
+ * @brief Implementation of the MQTT/sign traffic capture ring
+ */
+
+#include "defines.h"
+#include "TrafficCapture.h"
+#include "SimClock.h"
+#include "Metrics.h"
+#include <LittleFS.h>
+#include <mbedtls/base64.h>
+
+namespace {
+// One capture per device; records may arrive from the sequence engine task
+portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const uint8_t SEGMENT_MAGIC[4] = {'L', 'S', 'C', 'P'};
+
+MetricCounter metric_records("ledsign_capture_records_total", "Records staged by the traffic capture");
+MetricCounter metric_dropped("ledsign_capture_dropped_records_total",
+                             "Capture records lost to a full staging buffer");
+
+void putU32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+}
+}
+
+TrafficCapture::TrafficCapture(BETABRITE* sign_instance)
+    : sign(sign_instance), enabled(false), staging_used(0), staging_index(0),
+      dropped_pending(0), last_flush_ms(0), frame_used(0), frame_start_ms(0),
+      active_segment(0), segment_sequence(0), records(0), dropped(0),
+      dumping(false), dump_index(0), dump_offset(0), dump_seq(0), dump_total(0) {
+    segment_size[0] = segment_size[1] = 0;
+    dump_sizes[0] = dump_sizes[1] = 0;
+    dump_order[0] = 0;
+    dump_order[1] = 1;
+}
+
+String TrafficCapture::segmentPath(uint8_t index) {
+    char path[32];
+    snprintf(path, sizeof(path), CAPTURE_SEGMENT_PATH, (unsigned)index);
+    return String(path);
+}
+
+bool TrafficCapture::readSegmentHeader(uint8_t index, uint32_t* sequence, size_t* size) {
+    File file = LittleFS.open(segmentPath(index), "r");
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[SEGMENT_HEADER_SIZE];
+    bool valid = file.read(header, sizeof(header)) == sizeof(header) &&
+                 memcmp(header, SEGMENT_MAGIC, 4) == 0 && header[4] == FORMAT_VERSION;
+    if (valid) {
+        *sequence = header[5] | (header[6] << 8) | (header[7] << 16) | ((uint32_t)header[8] << 24);
+        *size = file.size();
+    }
+    file.close();
+    return valid;
+}
+
+bool TrafficCapture::begin() {
+    if (!LittleFS.begin(false)) {
+        Serial.println("TrafficCapture: LittleFS not available");
+        return false;
+    }
+
+    uint32_t sequence[2] = {0, 0};
+    for (uint8_t i = 0; i < 2; i++) {
+        if (!readSegmentHeader(i, &sequence[i], &segment_size[i])) {
+            segment_size[i] = 0;
+        }
+    }
+
+    // Newest segment continues to receive records
+    active_segment = (segment_size[1] && (!segment_size[0] || sequence[1] > sequence[0])) ? 1 : 0;
+    segment_sequence = sequence[active_segment];
+
+    bool resume = LittleFS.exists(CAPTURE_FLAG_PATH);
+    Serial.print("TrafficCapture: ");
+    Serial.print(segment_size[0] + segment_size[1]);
+    Serial.print(" bytes recorded");
+    Serial.println(resume ? ", resuming capture" : "");
+    return resume;
+}
+
+bool TrafficCapture::start(const String& session_json) {
+    if (!enabled) {
+        File flag = LittleFS.open(CAPTURE_FLAG_PATH, "w");
+        if (flag) {
+            flag.close();
+        }
+        enabled = true;
+    }
+
+    appendRecord('S', SimClock::millis(), (const uint8_t*)session_json.c_str(), session_json.length(),
+                 nullptr, 0);
+    frame_used = 0;
+    sign->SetTap(signTap, this);
+
+    Serial.println("TrafficCapture: Capture started");
+    return true;
+}
+
+void TrafficCapture::stop() {
+    if (!enabled) {
+        return;
+    }
+
+    sign->SetTap(nullptr, nullptr);
+    enabled = false;
+    LittleFS.remove(CAPTURE_FLAG_PATH);
+    flushStaging();
+
+    Serial.println("TrafficCapture: Capture stopped");
+}
+
+bool TrafficCapture::clear() {
+    if (dumping) {
+        Serial.println("TrafficCapture: Dump in progress - not cleared");
+        return false;
+    }
+
+    portENTER_CRITICAL(&capture_lock);
+    staging_used = 0;
+    dropped_pending = 0;
+    portEXIT_CRITICAL(&capture_lock);
+
+    bool ok = true;
+    for (uint8_t i = 0; i < 2; i++) {
+        if (LittleFS.exists(segmentPath(i))) {
+            ok &= LittleFS.remove(segmentPath(i));
+        }
+        segment_size[i] = 0;
+    }
+    records = 0;
+    dropped = 0;
+
+    Serial.println("TrafficCapture: Cleared");
+    return ok;
+}
+
+void TrafficCapture::recordMessage(const char* topic, const uint8_t* payload, unsigned int length) {
+    if (!enabled) {
+        return;
+    }
+    // Topic and its NUL go in as the record's head, the payload follows unchanged
+    appendRecord('M', SimClock::millis(), (const uint8_t*)topic, strlen(topic) + 1, payload, length);
+}
+
+void TrafficCapture::recordTimeSync(time_t epoch) {
+    if (!enabled) {
+        return;
+    }
+    uint8_t body[4];
+    putU32(body, (uint32_t)epoch);
+    appendRecord('T', SimClock::millis(), body, sizeof(body), nullptr, 0);
+}
+
+void TrafficCapture::signTap(const uint8_t* buffer, size_t size, void* context) {
+    static_cast<TrafficCapture*>(context)->onSignBytes(buffer, size);
+}
+
+void TrafficCapture::onSignBytes(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (frame_used == 0) {
+            frame_start_ms = SimClock::millis();
+        }
+        frame[frame_used++] = buffer[i];
+
+        if (buffer[i] == BB_EOT || frame_used == CAPTURE_MAX_FRAME) {
+            appendRecord('F', frame_start_ms, frame, frame_used, nullptr, 0);
+            frame_used = 0;
+        }
+    }
+}
+
+void TrafficCapture::appendRecord(uint8_t type, uint32_t time_ms, const uint8_t* head, size_t head_len,
+                                  const uint8_t* body, size_t body_len) {
+    size_t length = head_len + body_len;  // Staging is smaller than the 16-bit length limit
+
+    portENTER_CRITICAL(&capture_lock);
+    uint8_t* buffer = staging[staging_index];
+
+    // Report earlier losses first so the replay tool knows the stream has a gap
+    if (dropped_pending && staging_used + RECORD_HEADER_SIZE + 4 <= CAPTURE_STAGING_SIZE) {
+        uint8_t* p = buffer + staging_used;
+        p[0] = 'D';
+        putU32(p + 1, time_ms);
+        p[5] = 4;
+        p[6] = 0;
+        putU32(p + 7, dropped_pending);
+        staging_used += RECORD_HEADER_SIZE + 4;
+        dropped_pending = 0;
+    }
+
+    if (staging_used + RECORD_HEADER_SIZE + length > CAPTURE_STAGING_SIZE) {
+        dropped_pending++;
+        dropped++;
+        metric_dropped.inc();
+    } else {
+        uint8_t* p = buffer + staging_used;
+        p[0] = type;
+        putU32(p + 1, time_ms);
+        p[5] = length & 0xFF;
+        p[6] = (length >> 8) & 0xFF;
+        if (head_len) {
+            memcpy(p + RECORD_HEADER_SIZE, head, head_len);
+        }
+        if (body_len) {
+            memcpy(p + RECORD_HEADER_SIZE + head_len, body, body_len);
+        }
+        staging_used += RECORD_HEADER_SIZE + length;
+        records++;
+        metric_records.inc();
+    }
+    portEXIT_CRITICAL(&capture_lock);
+}
+
+void TrafficCapture::flushStaging() {
+    // Swap buffers so writers keep appending while this one goes to flash
+    portENTER_CRITICAL(&capture_lock);
+    uint8_t full_index = staging_index;
+    size_t length = staging_used;
+    if (length) {
+        staging_index ^= 1;
+        staging_used = 0;
+    }
+    portEXIT_CRITICAL(&capture_lock);
+
+    last_flush_ms = SimClock::millis();
+    if (length && !writeBlock(staging[full_index], length)) {
+        Serial.println("TrafficCapture: Error - flash write failed");
+    }
+}
+
+bool TrafficCapture::writeBlock(const uint8_t* block, size_t length) {
+    // Records never straddle segments: start the other one when this block would overflow
+    bool fresh = segment_size[active_segment] == 0;
+    if (!fresh && segment_size[active_segment] + length > CAPTURE_SEGMENT_SIZE) {
+        active_segment ^= 1;
+        fresh = true;
+    }
+
+    String path = segmentPath(active_segment);
+    if (fresh) {
+        File file = LittleFS.open(path, "w");
+        if (!file) {
+            return false;
+        }
+        uint8_t header[SEGMENT_HEADER_SIZE];
+        memcpy(header, SEGMENT_MAGIC, 4);
+        header[4] = FORMAT_VERSION;
+        putU32(header + 5, ++segment_sequence);
+        file.write(header, sizeof(header));
+        file.close();
+        segment_size[active_segment] = SEGMENT_HEADER_SIZE;
+    }
+
+    File file = LittleFS.open(path, "a");
+    if (!file) {
+        return false;
+    }
+    size_t written = file.write(block, length);
+    file.close();
+    segment_size[active_segment] += written;
+    return written == length;
+}
+
+bool TrafficCapture::startDump(DumpCallback callback) {
+    if (dumping) {
+        return false;
+    }
+
+    flushStaging();
+
+    // Oldest segment first
+    dump_order[0] = active_segment ^ 1;
+    dump_order[1] = active_segment;
+    dump_total = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        dump_sizes[i] = segment_size[dump_order[i]];
+        dump_total += (dump_sizes[i] + CAPTURE_CHUNK_SIZE - 1) / CAPTURE_CHUNK_SIZE;
+    }
+    if (dump_total == 0) {
+        Serial.println("TrafficCapture: Nothing recorded");
+        return false;
+    }
+
+    dump_callback = callback;
+    dump_index = 0;
+    dump_offset = 0;
+    dump_seq = 0;
+    dumping = true;
+
+    Serial.print("TrafficCapture: Dumping ");
+    Serial.print(dump_sizes[0] + dump_sizes[1]);
+    Serial.print(" bytes in ");
+    Serial.print(dump_total);
+    Serial.println(" chunks");
+    return true;
+}
+
+bool TrafficCapture::sendDumpChunk() {
+    while (dump_index < 2 && dump_offset >= dump_sizes[dump_index]) {
+        dump_index++;
+        dump_offset = 0;
+    }
+    if (dump_index >= 2) {
+        return false;
+    }
+
+    static uint8_t raw[CAPTURE_CHUNK_SIZE];
+    static unsigned char encoded[(CAPTURE_CHUNK_SIZE + 2) / 3 * 4 + 1];
+
+    File file = LittleFS.open(segmentPath(dump_order[dump_index]), "r");
+    if (!file || !file.seek(dump_offset)) {
+        return false;
+    }
+    size_t wanted = dump_sizes[dump_index] - dump_offset;
+    size_t length = file.read(raw, wanted < CAPTURE_CHUNK_SIZE ? wanted : CAPTURE_CHUNK_SIZE);
+    file.close();
+    if (length == 0) {
+        return false;
+    }
+
+    size_t encoded_length = 0;
+    if (mbedtls_base64_encode(encoded, sizeof(encoded), &encoded_length, raw, length) != 0) {
+        return false;
+    }
+    encoded[encoded_length] = '\0';
+
+    String chunk;
+    chunk.reserve(encoded_length + 48);
+    chunk = "{\"seq\":" + String(dump_seq) + ",\"total\":" + String(dump_total) + ",\"data\":\"";
+    chunk += (const char*)encoded;
+    chunk += "\"}";
+
+    if (!dump_callback(chunk)) {
+        return false;
+    }
+
+    dump_offset += length;
+    dump_seq++;
+    return dump_seq < dump_total;
+}
+
+void TrafficCapture::loop() {
+    if (dumping) {
+        // One chunk per pass keeps the main loop responsive; the ring is frozen meanwhile
+        if (!sendDumpChunk()) {
+            Serial.print("TrafficCapture: Dump ");
+            Serial.println(dump_seq == dump_total ? "complete" : "aborted");
+            dumping = false;
+            dump_callback = nullptr;
+        }
+        return;
+    }
+
+    if (staging_used == 0) {
+        return;
+    }
+    if (staging_used >= CAPTURE_STAGING_SIZE / 2 ||
+        SimClock::millis() - last_flush_ms >= CAPTURE_FLUSH_INTERVAL_MS) {
+        flushStaging();
+    }
+    SimClock::wakeAt(last_flush_ms + CAPTURE_FLUSH_INTERVAL_MS);
+}
+
+String TrafficCapture::getStatus() const {
+    String status = enabled ? "on" : "off";
+    status += ", " + String((unsigned long)(segment_size[0] + segment_size[1])) + " bytes";
+    status += ", " + String(records) + " records";
+    if (dropped) {
+        status += ", " + String(dropped) + " dropped";
+    }
+    if (dumping) {
+        status += ", dumping " + String(dump_seq) + "/" + String(dump_total);
+    }
+    return status;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file TrafficCapture.h
+ * @brief Field capture of inbound MQTT traffic and emitted sign frames
+ *
+ * Records what a sign received and what it sent to the display so a field
+ * misbehavior can be replayed exactly (tools/capture_replay.py):
+ * - Inbound MQTT messages with arrival time (handleMQTTMessage entry)
+ * - Every byte written to the sign, grouped into frames ending at EOT, via
+ *   the BETABRITE output tap
+ * - Records are staged in RAM and flushed to a two-segment ring in LittleFS
+ *   in batches, so the display path never waits on flash
+ * - Retrieved over MQTT in base64 chunks (or Serial in the SIM_CLOCK build)
+ *
+ * Segment layout: "LSCP" magic, version (1), segment sequence (uint32), then
+ * records. Record layout (integers little-endian):
+ * | Offset | Size | Field                                              |
+ * |--------|------|----------------------------------------------------|
+ * | 0      | 1    | Type: 'S' session, 'M' message, 'F' frame,         |
+ * |        |      | 'T' time sync, 'D' drop                            |
+ * | 1      | 4    | Time (SimClock::millis() at arrival / first byte)  |
+ * | 5      | 2    | Body length N                                      |
+ * | 7      | N    | Body                                               |
+ * Bodies: 'S' session JSON; 'M' topic, NUL, payload; 'F' frame bytes (a frame
+ * longer than CAPTURE_MAX_FRAME continues in the next 'F' record); 'T' wall
+ * clock after an NTP sync (uint32 Unix seconds); 'D' count of records lost
+ * to a full staging buffer (uint32).
+ *
+ * @author LED Sign Controller Project
+ * @version 0.6.0
+ * @date 2024
+ */
+
+#ifndef TRAFFIC_CAPTURE_H
+#define TRAFFIC_CAPTURE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "BETABRITE.h"
+
+// Capture configuration constants (from defines.h)
+#ifndef CAPTURE_SEGMENT_PATH
+#define CAPTURE_SEGMENT_PATH      "/capture%u.bin"
+#endif
+#ifndef CAPTURE_FLAG_PATH
+#define CAPTURE_FLAG_PATH         "/capture.on"
+#endif
+#ifndef CAPTURE_SEGMENT_SIZE
+#define CAPTURE_SEGMENT_SIZE      16384
+#endif
+#ifndef CAPTURE_STAGING_SIZE
+#define CAPTURE_STAGING_SIZE      4096
+#endif
+#ifndef CAPTURE_MAX_FRAME
+#define CAPTURE_MAX_FRAME         512
+#endif
+#ifndef CAPTURE_FLUSH_INTERVAL_MS
+#define CAPTURE_FLUSH_INTERVAL_MS 2000
+#endif
+#ifndef CAPTURE_CHUNK_SIZE
+#define CAPTURE_CHUNK_SIZE        768
+#endif
+
+/**
+ * @brief Ring capture of MQTT ingress and sign egress in LittleFS
+ *
+ * recordMessage() and the sign tap only copy into RAM (the tap may run on
+ * the sequence engine task); loop() does all flash I/O on the main task.
+ */
+class TrafficCapture {
+public:
+    /**
+     * @brief Sink for one dump chunk (JSON text); return false to abort the dump
+     */
+    typedef std::function<bool(const String& chunk)> DumpCallback;
+
+    /**
+     * @brief Constructor
+     * @param sign_instance Sign whose output is tapped while capturing
+     */
+    explicit TrafficCapture(BETABRITE* sign_instance);
+
+    /**
+     * @brief Find the ring segments and restore the enabled flag
+     * @return true if capture was left enabled (call start() to resume)
+     */
+    bool begin();
+
+    /**
+     * @brief Enable capture and write a session record
+     * @param session_json Context for the replay tool (version, zone, epoch, ...)
+     * @return true if capture is running
+     */
+    bool start(const String& session_json);
+
+    /**
+     * @brief Disable capture (recorded data is kept)
+     */
+    void stop();
+
+    /**
+     * @brief Delete all recorded data (capture state is unchanged)
+     * @return true if the segments were removed
+     */
+    bool clear();
+
+    /**
+     * @brief Record an inbound MQTT message
+     * @param topic Topic it arrived on
+     * @param payload Message payload
+     * @param length Payload length in bytes
+     */
+    void recordMessage(const char* topic, const uint8_t* payload, unsigned int length);
+
+    /**
+     * @brief Record a wall clock sync so replays show the same clock
+     * @param epoch Unix time just set by NTP
+     */
+    void recordTimeSync(time_t epoch);
+
+    /**
+     * @brief Begin streaming the ring (oldest first) through a callback
+     * @param callback Receives {"seq":n,"total":N,"data":"<base64>"} chunks
+     * @return true if there is data to send
+     */
+    bool startDump(DumpCallback callback);
+
+    /**
+     * @brief Flush staged records and send pending dump chunks - call from the main loop
+     */
+    void loop();
+
+    /**
+     * @brief Check whether capture is enabled
+     */
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * @brief Check whether a dump is in progress
+     */
+    bool isDumping() const { return dumping; }
+
+    /**
+     * @brief Get human-readable status for logging
+     * @return Status string
+     */
+    String getStatus() const;
+
+private:
+    static const uint8_t FORMAT_VERSION = 1;
+    static const size_t SEGMENT_HEADER_SIZE = 9;   ///< Magic + version + sequence
+    static const size_t RECORD_HEADER_SIZE = 7;    ///< Type + time + length
+
+    BETABRITE* sign;
+    bool enabled;
+
+    // Staging (written under a spinlock from any task, drained by loop())
+    uint8_t staging[2][CAPTURE_STAGING_SIZE];
+    size_t staging_used;
+    uint8_t staging_index;
+    uint32_t dropped_pending;                      ///< Lost records not yet reported
+    uint32_t last_flush_ms;
+
+    // Frame assembly (single writer: the sign has one owner at a time)
+    uint8_t frame[CAPTURE_MAX_FRAME];
+    size_t frame_used;
+    uint32_t frame_start_ms;
+
+    // Ring state
+    uint8_t active_segment;
+    uint32_t segment_sequence;
+    size_t segment_size[2];
+    uint32_t records;
+    uint32_t dropped;
+
+    // Dump state
+    bool dumping;
+    DumpCallback dump_callback;
+    size_t dump_sizes[2];
+    uint8_t dump_order[2];
+    uint8_t dump_index;                            ///< Position in dump_order
+    size_t dump_offset;                            ///< Byte offset in the current segment
+    uint16_t dump_seq;
+    uint16_t dump_total;
+
+    static void signTap(const uint8_t* buffer, size_t size, void* context);
+    void onSignBytes(const uint8_t* buffer, size_t size);
+    void appendRecord(uint8_t type, uint32_t time_ms, const uint8_t* head, size_t head_len,
+                      const uint8_t* body, size_t body_len);
+    void flushStaging();
+    bool writeBlock(const uint8_t* block, size_t length);
+    bool sendDumpChunk();
+    static String segmentPath(uint8_t index);
+    static bool readSegmentHeader(uint8_t index, uint32_t* sequence, size_t* size);
+};
+
+#endif // TRAFFIC_CAPTURE_H
@@ -43,6 +43,7 @@
 // Demo mode button (ESP32 boot button)
 #define DEMO_BUTTON_PIN      0      // GPIO 0 (active LOW, internal pull-up)
 #define DEMO_HOLD_MS         3000   // 3 second hold to trigger demo
+#define DEMO_PLAYLIST_PATH   "/demo.lspl"   // Compiled playlist in LittleFS (built-in used if absent)
 
 // LEDC PWM Channel Assignments (ESP32 has 16 channels, 0-15)
 #define LEDC_CH_RED      0
@@ -151,4 +152,243 @@
 // HA Topic prefix (differentiates from primary broker topics)
 #define HA_TOPIC_PREFIX           "ha/"
 
+/////////////////////////////////////////////
+/////// MULTICAST ALERT INGRESS /////////////
+/////////////////////////////////////////////
+
+// Site-wide UDP multicast (one datagram reaches every sign on the LAN)
+// MQTT delivery remains active as the fallback; an alert seen on both paths is shown once
+#define MULTICAST_GROUP           "239.255.76.83"   // Site-local administratively scoped group
+#define MULTICAST_PORT            42691
+#define MULTICAST_MAX_SKEW_S      300               // Reject datagrams older/newer than 5 minutes
+
+// Shared HMAC-SHA256 site key (64 hex chars, stored in LittleFS)
+// Listener stays disabled when the file is absent
+#define MULTICAST_KEY_PATH        "/multicast_key.txt"
+
+// Recently displayed alerts remembered for multicast/MQTT de-duplication (by ID; without one,
+// only the copy from the other path is dropped)
+#define ALERT_DEDUP_SLOTS         16
+
+/////////////////////////////////////////////
+/////// ESP-NOW HANDHELD REMOTE /////////////
+/////////////////////////////////////////////
+
+// Direct radio link from the handheld remote (see handheld-remote/PROJECT_PLAN.md)
+#define ESPNOW_MAX_PEERS          4         // Paired remotes remembered in NVS
+#define ESPNOW_QUEUE_DEPTH        8         // Commands buffered between radio and main loop
+#define ESPNOW_PAIR_WINDOW_MS     60000     // Pairing window (HA button or pair button)
+#define ESPNOW_PAIR_BUTTON_PIN    DEMO_BUTTON_PIN  // Hold to open the pairing window
+#define ESPNOW_PAIR_BUTTON_HOLD_MS 3000     // Press length that opens it
+
+// Encryption keys (exactly 16 characters each, must match the remote firmware): there
+// are no defaults. Define ESPNOW_PMK/ESPNOW_LMK in Credentials.h, or provision 16-byte
+// "pmk"/"lmk" entries in the "espnow" NVS namespace. Without keys ESP-NOW stays off.
+
+/////////////////////////////////////////////
+/////// TIMED SEQUENCE ENGINE ///////////////
+/////////////////////////////////////////////
+
+// Pre-encoded frame timelines (countdowns, choreographed effects)
+// Triggered via ledSign/{zone}/sequence, the HA button, or the handheld remote
+#define SEQ_MAX_FRAMES            32        // Frames per timeline
+#define SEQ_ARENA_SIZE            2048      // Bytes of pre-encoded protocol frames
+#define SEQ_TASK_PRIORITY         5         // Transmit task priority (loopTask is 1)
+#define SEQ_WIRE_NS_PER_BYTE      1041667   // 9600 baud 7E1 = 10 bits per byte on the wire
+#define SEQ_DEFAULT_COUNTDOWN     3         // Countdown preloaded at boot (seconds)
+
+// Playlist sequencer (demo mode; scripts compiled by tools/playlist_compiler.py)
+#define PLAYLIST_LOOKAHEAD        4         // Steps encoded ahead of the one on screen
+#define PLAYLIST_MAX_FILE_SIZE    16384     // Largest playlist accepted from LittleFS
+
+/////////////////////////////////////////////
+/////// TRAFFIC CAPTURE /////////////////////
+/////////////////////////////////////////////
+
+// Field capture of inbound MQTT messages and outbound sign frames (see src/TrafficCapture.h)
+// Controlled via ledSign/{zone}/capture: start | stop | clear | dump
+#define CAPTURE_SEGMENT_PATH      "/capture%u.bin"  // Two ring segments in LittleFS
+#define CAPTURE_FLAG_PATH         "/capture.on"     // Present while capture is enabled (survives reboot)
+#define CAPTURE_SEGMENT_SIZE      16384     // Bytes per segment (ring holds up to 2x this)
+#define CAPTURE_STAGING_SIZE      4096      // RAM staging buffer (x2, swapped on flush; fits a max-size MQTT message)
+#define CAPTURE_MAX_FRAME         512       // Longer sign frames are split across records
+#define CAPTURE_FLUSH_INTERVAL_MS 2000      // Batch flash writes
+#define CAPTURE_CHUNK_SIZE        768       // Raw bytes per dump message (base64 -> 1024)
+
+/////////////////////////////////////////////
+/////// EVENT BUS ///////////////////////////
+/////////////////////////////////////////////
+
+// Module-to-module events (see include/EventBus.h)
+#define EVENTBUS_QUEUE_SIZE       32        // Pending events (power of two; full queue drops new events)
+#define EVENTBUS_MAX_SUBSCRIBERS  16        // Static subscriber table
+#define EVENTBUS_DISPATCH_BUDGET  16        // Events delivered per main loop pass
+
+/////////////////////////////////////////////
+/////// METRICS /////////////////////////////
+/////////////////////////////////////////////
+
+// Registry of counters/gauges/histograms (see src/Metrics.h)
+// Scrape: http://<sign>:METRICS_HTTP_PORT/metrics   Snapshot: ledSign/{device_id}/metrics
+#define METRICS_MAX_BUCKETS       8         // Upper bounds per histogram (+Inf is implicit)
+#define METRICS_HTTP_PORT         9100      // Prometheus scrape port (0 = endpoint disabled)
+#define METRICS_HTTP_TIMEOUT_MS   250       // Time allowed for a scraper to send its request
+#define METRICS_PUBLISH_INTERVAL  60000     // MQTT snapshot period in ms (0 = disabled)
+
+/////////////////////////////////////////////
+/////// SCHEDULER ///////////////////////////
+/////////////////////////////////////////////
+
+// Main-loop components and their budgets are registered in main.cpp registerComponents()
+#define SCHEDULER_MAX_COMPONENTS  32        // Static component table
+#define SCHEDULER_REPORT_INTERVAL 300000    // CPU report to ledSign/{device_id}/scheduler in ms (0 = disabled)
+#define SCHEDULER_NET_POLL_MS     20        // MQTT, multicast, ESP-NOW and event queue polls (adds up to this to an alert)
+#define SCHEDULER_LOCAL_POLL_MS   50        // Sign stage timing, sequence, capture, power and link-state polls
+#define SCHEDULER_ANIMATION_TICK_MS 10      // Status LED/buzzer while a pattern or tone is running
+#define SCHEDULER_MAX_IDLE_MS     1000      // Longest sleep between main-loop passes
+
+/////////////////////////////////////////////
+/////// TIME SYNC ///////////////////////////
+/////////////////////////////////////////////
+
+// Background SNTP with smooth slewing (see src/TimeSync.h)
+#define TIMESYNC_INTERVAL_MS      3600000   // SNTP resync period
+#define TIMESYNC_TIMEOUT_MS       60000     // First sync later than this raises EVT_ERROR (once)
+
+/////////////////////////////////////////////
+/////// DNS CACHE ///////////////////////////
+/////////////////////////////////////////////
+
+// Host name cache shared by the MQTT, HA and OTA clients (see include/DnsCache.h)
+#define DNSCACHE_ENTRIES          8         // Cached host names (least recently used is evicted)
+#define DNSCACHE_HOST_LEN         64        // Longest cached host name + 1
+#define DNSCACHE_TTL_MS           300000    // Entry lifetime (lwIP does not expose record TTLs)
+#define DNSCACHE_MAX_STALE_MS     3600000   // Serve an expired entry this long while it refreshes
+#define DNSCACHE_RETRY_MS         30000     // Refresh retry after a failed lookup
+
+/////////////////////////////////////////////
+/////// ALERT ROUTING ///////////////////////
+/////////////////////////////////////////////
+
+// Topic filters -> style/priority offset/sign file (see src/AlertRouter.h)
+#define ALERTROUTER_CONFIG_PATH   "/routes.json"  // Routing table in LittleFS (own zone only if absent)
+#define ALERTROUTER_MAX_ROUTES    8         // Routes in the table
+#define ALERTROUTER_MAX_LEVELS    8         // Topic levels per filter
+#define ALERTROUTER_ARENA_SIZE    512       // Bytes for filter and style strings
+#define ALERTROUTER_OVERLAP_WINDOW_MS 2000  // Same topic+payload again this soon = overlapping filter copy
+
+/////////////////////////////////////////////
+/////// ALERT DECODER ///////////////////////
+/////////////////////////////////////////////
+
+// Single-pass alert decoder, no JSON document (see src/AlertDecoder.h); keys and display_config
+// code sets are generated by tools/gen_alert_schema.py
+#define ALERTDEC_SCHEMA_DECODER   true      // false = decode every alert through ArduinoJson
+#define ALERTDEC_NESTING_LIMIT    10        // Deepest nesting accepted (ArduinoJson's default)
+
+/////////////////////////////////////////////
+/////// DISPLAY RECEIPTS ////////////////////
+/////////////////////////////////////////////
+
+// Per-alert outcome/timing sent to ledSign/{device_id}/receipts (see src/DisplayReceipts.h)
+#define RECEIPTS_RING_SIZE        32        // Receipts held while waiting to be sent
+#define RECEIPTS_BATCH_SIZE       16        // Receipts per batch message
+#define RECEIPTS_FLUSH_INTERVAL   10000     // Longest a receipt waits for a full batch (ms)
+#define RECEIPTS_GLASS_TIMEOUT_MS 5000      // Give up waiting for the UART to drain (ms)
+#define RECEIPTS_ID_LEN           40        // Longest alert id kept + 1
+
+/////////////////////////////////////////////
+/////// OUTBOUND SPOOL //////////////////////
+/////////////////////////////////////////////
+
+// Publishes held through broker outages, drained after reconnect (see src/OutboundSpool.h)
+#define SPOOL_RAM_SLOTS           16        // Newest messages kept in RAM
+#define SPOOL_RAM_BYTES           8192      // RAM budget for topic + payload text
+#define SPOOL_SEGMENT_PATH        "/spool%u.bin"  // Overflow segments in LittleFS
+#define SPOOL_SEGMENTS            4         // Flash ring holds up to this many segments
+#define SPOOL_SEGMENT_BYTES       16384     // Bytes per segment
+#define SPOOL_DRAIN_RATE          10        // Catch-up messages per second after reconnect
+#define SPOOL_DRAIN_BATCH         2         // Catch-up messages per MQTT loop pass
+
+/////////////////////////////////////////////
+/////// CONFIG STORE ////////////////////////
+/////////////////////////////////////////////
+
+// Runtime settings in NVS, changed over ledSign/{device_id}/config/set (see src/ConfigStore.h)
+#define CONFIG_NVS_NAMESPACE      "config"  // Preferences namespace
+#define CONFIG_SNAPSHOTS          4         // Versions kept for {"rollback":N}
+#define CONFIG_DEFAULT_MQTT_SERVER "alert.d-t.pw"
+#define CONFIG_DEFAULT_ZONE       "CHANGEME"
+#define CONFIG_APPLY_TIMEOUT_MS   60000     // New broker must answer within this, else roll back
+
+/////////////////////////////////////////////
+/////// POWER GOVERNOR //////////////////////
+/////////////////////////////////////////////
+
+// CPU clock scaling and modem sleep between alerts (see src/PowerGovernor.h)
+#define POWER_LATENCY_BUDGET_MS   0         // Default "power_budget_ms": added alert latency allowed (0 = off)
+#define POWER_MAX_FREQ_MHZ        240       // While alert, sign or network work is held
+#define POWER_MIN_FREQ_MHZ        80        // Idle clock (lowest that keeps WiFi and a fixed APB/UART clock)
+#define POWER_LIGHT_SLEEP         true      // Let esp_pm light-sleep when idle (needs tickless idle in the SDK)
+#define POWER_IDLE_AFTER_MS       200       // Manual clock switch: idle time before dropping the clock
+#define POWER_MODEM_SLEEP_LATENCY_MS 103    // One DTIM beacon interval (DTIM 1): worst-case delivery delay
+#define POWER_EST_MA_MAX_FREQ     68        // Estimated draw at full clock, radio dozing (datasheet typ.)
+#define POWER_EST_MA_MIN_FREQ     31        // Estimated draw at the idle clock, radio dozing
+#define POWER_EST_MA_RADIO_LISTEN 65        // Added by keeping the radio listening (no modem sleep)
+
+/////////////////////////////////////////////
+/////// SIGN LOAD GOVERNOR //////////////////
+/////////////////////////////////////////////
+
+// Estimated sign draw per frame, lower-draw substitution over budget (see src/SignLoad.h)
+#define SIGNLOAD_BUDGET_MA        0         // Default "sign_budget_ma" (0 = estimate and report only)
+#define SIGNLOAD_COLUMNS          80        // Sign width in pixels until the model is known (BetaBrite 1036: 80x7)
+#define SIGNLOAD_ROWS             7         // Sign height in pixels until the model is known
+#define SIGNLOAD_BASE_MA          150       // Sign logic with nothing lit
+#define SIGNLOAD_UA_PER_LED       3000      // Average per lit LED die, multiplexing included (uA)
+#define SIGNLOAD_REPORT_CHECK_MS  60000     // How often to look for a date change to close the day
+// #define SIGNLOAD_DISABLE_BROWNOUT        // Old behaviour: brownout detector off (supplies that still dip)
+#define SIGNLOAD_MAX_COLUMNS      384       // Widest panel the estimate window holds (Alpha 460i: 360)
+
+/////////////////////////////////////////////
+/////// SIGN MODEL //////////////////////////
+/////////////////////////////////////////////
+
+// Sign capabilities by model, detected at boot by type-code probe (see src/SignModel.h)
+#define SIGNCAPS_MODEL            0         // BB_ST_* to skip detection, e.g. BB_ST_4120C (0 = detect)
+#define SIGNCAPS_DEFAULT_TYPE     BB_ST_BETABRITE  // Silent sign, nothing cached
+#define SIGNCAPS_PROBE            true      // Probe at boot (false = cached or default model)
+#define SIGNCAPS_PROBE_TIMEOUT_MS 300       // Wait for an answer per type code
+#define SIGNCAPS_NVS_NAMESPACE    "signmodel"  // Preferences namespace for the detected model
+
+/////////////////////////////////////////////
+/////// MEMORY POLICY ///////////////////////
+/////////////////////////////////////////////
+
+// Bulk buffers in PSRAM on WROVER-class boards, hot-path buffers internal (see include/MemoryPolicy.h)
+#define MEMPOLICY_PSRAM_MIN_BYTES 256       // Smaller bulk blocks stay internal (PSRAM is slower per access)
+#define MEMPOLICY_ALERT_DOC_PSRAM false     // Alert JSON document in PSRAM too (compare alert latency)
+
+/////////////////////////////////////////////
+/////// HOT PATH PLACEMENT / PROFILE ////////
+/////////////////////////////////////////////
+
+// Encoder, UART TX pump and scheduler in IRAM, per-frame tables in DRAM (see include/HotPath.h);
+// build with -D HOTPATH_IRAM=0 to leave them in flash (a build flag: lib/BETABRITE uses it too)
+#define HOTPATH_MAX_SITES         16        // Profiled sites (SIGN_PROFILE builds)
+#define HOTPATH_REPORT_INTERVAL   300000    // Profile to ledSign/{device_id}/profile in ms (SIGN_PROFILE builds)
+
+/////////////////////////////////////////////
+/////// VIRTUAL CLOCK SIMULATION ////////////
+/////////////////////////////////////////////
+
+// Only used by the SIM_CLOCK build (pio run -e esp32dev_sim); see src/Simulation.h
+#define SIM_SCENARIO_PATH         "/sim.scn"  // Scenario in LittleFS
+#define SIM_DEFAULT_SCENARIO      "00:00:00 ntp 1704067200\n1d00:00:00 end\n"  // Idle day if no file
+#define SIM_MAX_STEPS             512       // Scenario commands after repeat expansion
+#define SIM_MAX_STEP_MS           60000     // Longest clock jump (bounds modules with no wakeAt)
+#define SIM_MIN_STEP_MS           10        // Re-poll interval for deadlines already due
+#define SIM_RANDOM_SEED           0x51C10CC // Fixed seed so backoff jitter repeats run to run
+#define SIM_MQTT_SERVER           "sim.invalid"  // Placeholder broker (never contacted)
+
 #endif // defines_h
@@ -40,6 +40,31 @@
 #include "HAMQTTClient.h"
 #include "StatusIndicator.h"
 #include "DemoMode.h"
+#include "MulticastListener.h"
+#include "EspNowReceiver.h"
+#include "SequenceEngine.h"
+#include "TrafficCapture.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "Scheduler.h"
+#include "TimeSync.h"
+#include "AlertRouter.h"
+#include "DisplayReceipts.h"
+#include "OutboundSpool.h"
+#include "ConfigStore.h"
+#include "PowerGovernor.h"
+#include "SignLoad.h"
+#include "SignModel.h"
+#include "DisplayPreset.h"
+#include "AlertDecoder.h"
+#include "SimClock.h"
+#include <EventBus.h>
+#include <DnsCache.h>
+#include <MemoryPolicy.h>
+#include <HotPath.h>
+#ifdef SIM_CLOCK
+#include "Simulation.h"
+#endif
 
 // Third-party libraries
 #include <ArduinoJson.h>
@@ -77,7 +102,7 @@ const char* ntp_server = "pool.ntp.org";
 /**
  * @brief Global object instances
  */
-WiFiClient wifi_client;                          ///< WiFi client for network operations
+DnsCachedClient wifi_client;                     ///< WiFi client for network operations (cached DNS)
 WiFiManager wifiManager;                         ///< WiFi configuration manager (tzapu/WiFiManager)
 BETABRITE led_sign(1, 17, 16);                  ///< BetaBrite sign interface (ID=1, RX=17, TX=16)
 MQTTManager* mqtt_manager = nullptr;             ///< MQTT connection manager
@@ -87,8 +112,26 @@ HADiscovery* ha_discovery = nullptr;             ///< Home Assistant MQTT Discov
 
 HAMQTTClient* ha_mqtt_client = nullptr;          ///< Secondary MQTT for Home Assistant
 StatusIndicator* status_indicator = nullptr;     ///< RGB LED + Buzzer status feedback
-
-// Storage for dynamic parameters (declared extern in dynamicParams.h)
+MulticastListener* multicast_listener = nullptr; ///< Site-wide UDP multicast alert ingress
+EspNowReceiver* espnow_receiver = nullptr;       ///< Handheld remote ESP-NOW command channel
+SequenceEngine* sequence_engine = nullptr;       ///< Frame-accurate countdown/effect timelines
+TrafficCapture traffic_capture(&led_sign);       ///< MQTT-in / sign-out capture ring for replay
+MetricsServer metrics_server;                    ///< Prometheus scrape endpoint (GET /metrics)
+Scheduler scheduler;                             ///< Runs the main-loop components (registerComponents())
+TimeSync time_sync;                              ///< Background SNTP, announces EVT_TIME_SYNCED
+AlertRouter alert_router;                        ///< Alert topic filters -> style, priority offset, sign file
+DisplayReceipts display_receipts(&led_sign);     ///< Per-alert outcome and timing, sent in batches
+OutboundSpool outbound_spool;                    ///< Outbound MQTT messages held through broker outages
+ConfigStore config_store;                        ///< Runtime settings in NVS (ledSign/{device_id}/config/set)
+PowerGovernor power_governor(&led_sign);         ///< CPU clock / modem sleep between alerts
+SignLoadGovernor sign_load;                      ///< Sign draw estimate per frame, lower-draw substitution
+SignModel sign_model;                            ///< Attached sign model and what it can do
+#ifdef SIM_CLOCK
+Simulation simulation;                           ///< Scenario runner for the virtual-clock build
+#endif
+
+// Storage for dynamic parameters (declared extern in dynamicParams.h); loaded from
+// config_store by loadConfigGlobals(), the initializers only show the sizes
 char MQTT_Server[MAX_MQTT_SERVER_LEN + 1] = "alert.d-t.pw";
 char MQTT_Port[MAX_MQTT_PORT_LEN + 1] = "42690";
 char MQTT_User[MAX_MQTT_USER_LEN + 1] = "";
@@ -114,20 +157,70 @@ WiFiManagerParameter custom_ha_mqtt_port("ha_port", "HA MQTT Port", HA_MQTT_Port
  */
 String device_id;                               ///< Unique device identifier (from MAC)
 bool services_initialized = false;             ///< Whether network services are ready
-bool time_synced = false;                      ///< Whether NTP time has been successfully synced
+bool time_synced = false;                      ///< Whether NTP time has been successfully synced (EVT_TIME_SYNCED)
 unsigned long last_health_check = 0;           ///< Last system health check timestamp
-unsigned long last_time_sync = 0;              ///< Last NTP time synchronization
 unsigned long last_offline_log = 0;            ///< Last offline status log message timestamp
 
 /**
- * @brief System health monitoring interval (30 seconds)
+ * @brief Recently displayed alert keys (multicast and MQTT deliver the same alert)
  */
-const unsigned long HEALTH_CHECK_INTERVAL = 30000;
+uint32_t recent_alert_keys[ALERT_DEDUP_SLOTS] = {0};
+uint8_t recent_alert_paths[ALERT_DEDUP_SLOTS] = {0};  ///< ALERT_PATH_* the key arrived on
+uint8_t recent_alert_next = 0;
+
+#define ALERT_PATH_MQTT           0x01
+#define ALERT_PATH_MULTICAST      0x02
+
+/**
+ * @brief Live re-apply of the last config change (handleConfigChanged())
+ */
+struct ConfigApply {
+    uint32_t version;                   ///< Config version being applied (0 = none since boot)
+    uint32_t groups;                    ///< CONFIG_GROUP_* re-applied
+    uint32_t started_ms;                ///< SimClock::millis() when the apply began
+    uint32_t downtime_ms;               ///< Alert topics unsubscribed or broker away
+    uint32_t rolled_back_from;          ///< Version whose broker never answered (0 = none)
+    bool awaiting_mqtt;                 ///< Waiting for EVT_MQTT_CONNECTED on the new broker
+    bool restart_required;              ///< Some of it only takes effect after a reboot
+};
+ConfigApply config_apply = {};
+String config_result = "none";                 ///< Outcome of the last config/set command
+uint32_t config_rollback_from = 0;             ///< Set while the apply timeout rolls a broker back
+
+/**
+ * @brief Non-blocking config portal (serviced by the "portal" component)
+ */
+bool portal_open = false;                      ///< WiFiManager portal AP is up
+uint32_t portal_opened_ms = 0;                 ///< millis() the portal first opened (0 = not since online)
 
 /**
- * @brief Time synchronization interval (1 hour)
+ * @brief Alert pipeline and system metrics (see Metrics.h)
  */
-const unsigned long TIME_SYNC_INTERVAL = 3600000;
+HOT_DRAM static const uint32_t ALERT_HANDLE_BOUNDS_US[] = {500, 1000, 2000, 5000, 10000, 20000, 50000, 100000};
+static MetricCounter metric_alerts_displayed("ledsign_alerts_displayed_total", "Alerts accepted by the sign controller");
+static MetricCounter metric_alerts_rejected("ledsign_alerts_rejected_total", "Alerts the sign controller refused");
+static MetricCounter metric_alerts_duplicate("ledsign_alerts_duplicate_total", "Alerts skipped as already displayed");
+static MetricCounter metric_alerts_invalid("ledsign_alerts_invalid_total", "Alert messages that were not valid JSON");
+static MetricCounter metric_alerts_expired("ledsign_alerts_expired_total", "Alerts whose expires time had passed on arrival");
+static MetricHistogram metric_alert_handle_us("ledsign_alert_handle_microseconds",
+                                              "Time from alert receipt to display call returning",
+                                              ALERT_HANDLE_BOUNDS_US,
+                                              sizeof(ALERT_HANDLE_BOUNDS_US) / sizeof(ALERT_HANDLE_BOUNDS_US[0]));
+static MetricGauge metric_heap_free("ledsign_heap_free_bytes", "Free heap");
+static MetricGauge metric_heap_min("ledsign_heap_min_free_bytes", "Lowest free heap since boot");
+static MetricGauge metric_wifi_rssi("ledsign_wifi_rssi_dbm", "WiFi signal strength (0 when disconnected)");
+static MetricGauge metric_uptime("ledsign_uptime_seconds", "Time since boot");
+static MetricGauge metric_ota_available("ledsign_ota_update_available", "1 when a newer firmware release was found");
+static MetricGauge metric_brownout_reset("ledsign_brownout_reset", "1 when the last reset was a brownout");
+static MetricGauge metric_portal_boot_ms("ledsign_portal_boot_to_open_ms", "Boot to config portal up (last time it opened)");
+static MetricGauge metric_portal_online_ms("ledsign_portal_to_online_ms", "Config portal up to WiFi connected");
+static MetricGauge metric_config_downtime("ledsign_config_apply_downtime_ms",
+                                          "Alert delivery gap while the last config change was applied");
+
+/**
+ * @brief System health monitoring interval (30 seconds)
+ */
+const unsigned long HEALTH_CHECK_INTERVAL = 30000;
 
 /**
  * @brief Clock display interval (1 minute)
@@ -148,9 +241,31 @@ const unsigned long MEMORY_REPORT_INTERVAL = 60000;
 void initializeDevice();
 void initializeNetworkServices();
 void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length);
+void publishLoadEcho(const AlertFields& alert, const char* status, unsigned long rx_us);
+String captureSessionInfo();
+void handleCaptureCommand(const uint8_t* payload, unsigned int length);
+void handlePortalOpened();
+void closePortal(bool online);
+void savePortalParams();
+void loadConfigGlobals();
+void handleConfigCommand(const uint8_t* payload, unsigned int length);
+void handleConfigChanged(const Event& event, void* context);
+void finishConfigApply();
+void publishConfigState();
+bool handleRemoteCommand(const EspNowReceiver::Command& cmd);
+void handleSequenceCommand(const char* command, uint8_t countdown);
+bool startSequence();
+void serviceSequence();
 void performHealthCheck();
-void syncTime();
-void smartDelay(unsigned long delay_ms);
+void updateSystemMetrics();
+void publishMetricsSnapshot();
+void handleTimeSynced(const Event& event, void* context);
+void registerComponents();
+bool wifiConnected();
+bool readLocalTime(struct tm* timeinfo);
+#ifdef SIM_CLOCK
+void initializeSimulation();
+#endif
 void printSystemInfo();
 void handleSystemReset();
 /**
@@ -178,9 +293,11 @@ void enterDemoMode() {
  * - Device identification
  */
 void setup() {
-    // Lower brownout detection threshold to ride through brief voltage dips
-    // caused by high-current sign draw (e.g. flash/scroll modes)
-    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);  // Disable brownout detector during init
+    // The brownout detector stays on so real supply faults reset the board; high-draw
+    // frames are kept within the supply by the sign load governor (SignLoad.h) instead
+#ifdef SIGNLOAD_DISABLE_BROWNOUT
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+#endif
 
     // Initialize serial communication
     Serial.begin(115200);
@@ -197,13 +314,30 @@ void setup() {
     Serial.println(APP_VERSION);
     Serial.print("Build: ");
     Serial.println(BUILD_DATE);
+    if (esp_reset_reason() == ESP_RST_BROWNOUT) {
+        Serial.println("Warning: Last reset was a brownout - check the supply against the sign load report");
+        metric_brownout_reset.set(1);
+    }
     Serial.println();
+
+    // Before anything allocates bulk buffers: decides internal RAM vs PSRAM placement
+    MemoryPolicy::begin();
     
     // Initialize device and hardware
     initializeDevice();
     
     // Print system information
     printSystemInfo();
+
+    // Clock display follows SNTP (subscribe before the first dispatch)
+    EventBus::subscribe(EVENT_MASK(EVT_TIME_SYNCED), handleTimeSynced);
+
+    // Config changes are re-applied live; a broker change completes on reconnect
+    EventBus::subscribe(EVENT_MASK(EVT_CONFIG_CHANGED) | EVENT_MASK(EVT_MQTT_CONNECTED), handleConfigChanged);
+
+    // Main-loop work runs through the scheduler from here on
+    registerComponents();
+    scheduler.begin();
     
     Serial.println("System initialization complete");
     Serial.println("Entering main loop...");
@@ -213,31 +347,101 @@ void setup() {
 /**
  * @brief Arduino main loop - runs continuously
  * 
- * Handles the main application logic:
- * - WiFi connection management
- * - Network service initialization
- * - System health monitoring
- * - Service orchestration
+ * Runs the components registered in registerComponents() that are due (see
+ * Scheduler.h), then sleeps until the next deadline; the virtual-clock build
+ * jumps its clock there instead.
  */
 void loop() {
-    static unsigned long last_wifi_check = 0;
-    static unsigned long last_memory_report = 0;
-    static unsigned long last_clock_display = 0;
-    unsigned long current_time = millis();
-
-    // WiFiManager handles reconnection automatically - no run() needed
-    // Check if WiFi disconnected and attempt reconnection
-    if (WiFi.status() != WL_CONNECTED) {
-        static unsigned long last_reconnect_attempt = 0;
-        if (current_time - last_reconnect_attempt > 30000) {
-            Serial.println("WiFi disconnected, attempting reconnection...");
-            WiFi.reconnect();
-            last_reconnect_attempt = current_time;
+#ifdef SIM_CLOCK
+    // Scenario over: stop advancing so the event log ends cleanly, then print the
+    // capture for tools/capture_replay.py diff
+    if (simulation.isFinished()) {
+        static bool capture_dumped = false;
+        if (!capture_dumped) {
+            capture_dumped = true;
+            traffic_capture.startDump([](const String& chunk) {
+                Serial.print("CAPTURE ");
+                Serial.println(chunk);
+                return true;
+            });
+        }
+        traffic_capture.loop();
+        if (!traffic_capture.isDumping()) {
+            delay(1000);
         }
+        return;
     }
-    
-    // Periodic WiFi status monitoring
-    if (current_time - last_wifi_check > WIFI_CHECK_INTERVAL) {
+    simulation.loop();
+#endif
+
+    scheduler.loop();
+
+#ifdef SIM_CLOCK
+    simulation.advance();
+#else
+    // Sleep until the next deadline; the idle task then gets the CPU, which is where the
+    // power governor's light sleep and idle clock happen. At least one tick, so a
+    // component polling every pass still yields to the WiFi and idle tasks.
+    delay(std::max<uint32_t>(scheduler.idleMs(SCHEDULER_MAX_IDLE_MS), 1));
+#endif
+}
+
+/**
+ * @brief Next deadline for a socket or queue poll
+ *
+ * The virtual-clock build has no traffic arriving between scenario steps, so
+ * polls run every pass there and do not hold its clock to the poll interval.
+ */
+static inline uint32_t pollAfter(uint32_t now, uint32_t interval_ms) {
+#ifdef SIM_CLOCK
+    return now;
+#else
+    return now + interval_ms;
+#endif
+}
+
+/**
+ * @brief Register the main-loop components with the scheduler
+ *
+ * Order matters only between components due at the same time: connectivity
+ * first, then network services, then local output, then event delivery and
+ * the status LED so they see this pass's events. Budgets are the longest
+ * expected run; sign writes are bounded by the 9600 baud UART. Each run step
+ * returns when it next needs to run: sockets and queues at their poll
+ * interval (pollAfter()), timers at their deadline, and only work in progress
+ * (a dump, frames draining to the sign) on every pass.
+ */
+void registerComponents() {
+#ifndef SIM_CLOCK
+    // WiFiManager handles reconnection automatically - nudge it if it stays down
+    scheduler.add("wifi_reconnect", [](uint32_t now) -> uint32_t {
+        if (WiFi.status() == WL_CONNECTED) {
+            return now + 1001;
+        }
+        Serial.println("WiFi disconnected, attempting reconnection...");
+        WiFi.reconnect();
+        return now + 30001;
+    }, 5000);
+
+    // Config portal web/DNS server while it is open; the reconnect above keeps trying in parallel
+    scheduler.add("portal", [](uint32_t now) -> uint32_t {
+        if (!portal_open) {
+            return now + 1001;
+        }
+        wifiManager.process();
+
+        bool online = WiFi.status() == WL_CONNECTED;
+        if (online && wifiManager.getConfigPortalActive()) {
+            wifiManager.stopConfigPortal();  // Saved network came back on its own
+        }
+        if (!wifiManager.getConfigPortalActive()) {
+            closePortal(online);
+        }
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+#endif
+
+    scheduler.add("wifi_status", [](uint32_t now) -> uint32_t {
         Serial.print("WiFi Status: ");
         Serial.print(WiFi.status());
         if (WiFi.status() == WL_CONNECTED) {
@@ -251,149 +455,330 @@ void loop() {
         } else {
             Serial.println(" (Disconnected)");
         }
-        last_wifi_check = current_time;
-    }
-    
-    // Periodic memory usage reporting
-    if (current_time - last_memory_report > MEMORY_REPORT_INTERVAL) {
+        return now + WIFI_CHECK_INTERVAL + 1;
+    }, 5000);
+
+    scheduler.add("memory_report", [](uint32_t now) -> uint32_t {
         Serial.print("Memory - Free: ");
         Serial.print(ESP.getFreeHeap());
         Serial.print(" bytes, Min Free: ");
         Serial.print(ESP.getMinFreeHeap());
         Serial.print(" bytes, Heap Size: ");
         Serial.println(ESP.getHeapSize());
-        last_memory_report = current_time;
-    }
-    
-    // Handle WiFi connection state
-    if (WiFi.status() == WL_CONNECTED) {
-        // Initialize network services on first connection
-        if (!services_initialized) {
-            Serial.println("WiFi connected - initializing network services");
-
-            if (status_indicator) status_indicator->onWiFiConnected();
-
-            // Cancel offline mode if it was running
-            if (sign_controller) {
-                sign_controller->cancelOfflineMode();
-            }
-
-            initializeNetworkServices();
+        return now + MEMORY_REPORT_INTERVAL + 1;
+    }, 5000);
+
+    // Connection state: start services on connect, offline display while down
+    scheduler.add("wifi", [](uint32_t now) -> uint32_t {
+        // Announce WiFi edges; unknown at boot so the first state is always published
+        static int8_t wifi_was_connected = -1;
+        bool wifi_now_connected = wifiConnected();
+        if (wifi_now_connected != wifi_was_connected) {
+            EventBus::publish(wifi_now_connected ? EVT_WIFI_CONNECTED : EVT_WIFI_DISCONNECTED);
+            wifi_was_connected = wifi_now_connected;
         }
-        
-        // Run network services if initialized
-        if (services_initialized) {
-            // Handle primary MQTT communication (Alert Manager)
-            if (mqtt_manager) {
-                mqtt_manager->loop();
 
-                // Track MQTT connection state for status indicator
-                static bool mqtt_was_connected = false;
-                bool mqtt_now_connected = mqtt_manager->isConnected();
-                if (mqtt_now_connected && !mqtt_was_connected) {
-                    if (status_indicator) status_indicator->onMQTTConnected();
-                } else if (!mqtt_now_connected && mqtt_was_connected) {
-                    if (status_indicator) status_indicator->onMQTTDisconnected();
-                }
-                mqtt_was_connected = mqtt_now_connected;
-            }
+        if (wifi_now_connected) {
+            // Initialize network services on first connection
+            if (!services_initialized) {
+                Serial.println("WiFi connected - initializing network services");
 
-            // Handle secondary MQTT communication (Home Assistant)
-            if (ha_mqtt_client) {
-                ha_mqtt_client->loop();
-
-                // Home Assistant Discovery - publish when HA MQTT connects
-                static bool ha_discovery_published = false;
-                static unsigned long last_ha_sensor_update = 0;
-
-                if (ha_mqtt_client->isConnected()) {
-                    // Publish discovery on first connection
-                    if (!ha_discovery_published && ha_discovery) {
-                        Serial.println("HA MQTT connected - publishing HA Discovery...");
-
-                        // Update availability to online
-                        ha_discovery->updateAvailability(true);
-
-                        // Publish discovery messages
-                        if (ha_discovery->publishDiscovery()) {
-                            // Subscribe to command topics
-                            ha_discovery->subscribeToCommands();
-                            ha_discovery_published = true;
-                            Serial.println("HA Discovery published successfully");
-                        }
-                    }
-
-                    // Update HA sensors periodically (every 60 seconds)
-                    if (ha_discovery && (current_time - last_ha_sensor_update > 60000)) {
-                        ha_discovery->updateSensors(
-                            WiFi.RSSI(),
-                            millis() / 1000,
-                            WiFi.localIP().toString(),
-                            ESP.getFreeHeap()
-                        );
-                        last_ha_sensor_update = current_time;
-                    }
-                } else {
-                    // Reset discovery flag when disconnected so it republishes on reconnect
-                    ha_discovery_published = false;
+                // Cancel offline mode if it was running
+                if (sign_controller) {
+                    sign_controller->cancelOfflineMode();
                 }
-            }
-
-            // Handle OTA updates (periodic checks for new firmware)
-            if (ota_manager) {
-                ota_manager->loop();
-            }
-
-            // Perform periodic health checks
-            if (current_time - last_health_check > HEALTH_CHECK_INTERVAL) {
-                performHealthCheck();
-                last_health_check = current_time;
-            }
 
-            // Periodic time synchronization
-            if (current_time - last_time_sync > TIME_SYNC_INTERVAL) {
-                syncTime();
-                last_time_sync = current_time;
-            }
-
-            // Periodic clock display (every 60 seconds, unless priority message active or time not synced)
-            if (time_synced && current_time - last_clock_display > CLOCK_DISPLAY_INTERVAL) {
-                if (sign_controller && !sign_controller->isInPriorityMode()) {
-                    sign_controller->displayClock();
-                    last_clock_display = current_time;
-                }
+                initializeNetworkServices();
             }
+            return pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
         }
 
-        // Short delay for online operation
-        smartDelay(100);
-    } else {
         // WiFi disconnected - show offline information
         services_initialized = false;
 
-        if (status_indicator) status_indicator->onWiFiDisconnected();
+        // Multicast group membership does not survive the disconnect; rejoin on reconnect
+        if (multicast_listener) {
+            multicast_listener->stop();
+        }
 
         if (sign_controller) {
             sign_controller->showOfflineMode();
         }
 
         // Throttle log message to once every 10 seconds
-        unsigned long current_time = millis();
-        if (current_time - last_offline_log > 10000) {
+        if (now - last_offline_log > 10000) {
             Serial.println("WiFi disconnected - displaying offline information");
-            last_offline_log = current_time;
+            last_offline_log = now;
+        }
+        return pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
+    }, 20000);
+
+    // Primary MQTT communication (Alert Manager); alerts are handled inside, so the
+    // budget covers JSON parsing and the sign write
+    scheduler.add("mqtt", [](uint32_t now) -> uint32_t {
+        if (services_initialized && mqtt_manager) {
+            if (mqtt_manager->isConnected()) {
+                mqtt_manager->loop();
+            } else {
+                // Reconnect attempt: DNS, TCP and the TLS handshake at full clock
+                PowerGovernor::Hold power_hold(power_governor, POWER_LOCK_NETWORK);
+                mqtt_manager->loop();
+            }
+        }
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+
+    // Site-wide multicast alerts (fast path, MQTT is the fallback)
+    scheduler.add("multicast", [](uint32_t now) -> uint32_t {
+        if (services_initialized && multicast_listener) {
+            multicast_listener->loop();
+        }
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+
+    // Secondary MQTT communication (Home Assistant)
+    scheduler.add("ha", [](uint32_t now) -> uint32_t {
+        static bool ha_discovery_published = false;
+        if (!services_initialized || !ha_mqtt_client) {
+            return now + 1001;
+        }
+
+        ha_mqtt_client->loop();
+
+        if (ha_mqtt_client->isConnected()) {
+            // Home Assistant Discovery - publish on first connection
+            if (!ha_discovery_published && ha_discovery) {
+                Serial.println("HA MQTT connected - publishing HA Discovery...");
+
+                // Update availability to online
+                ha_discovery->updateAvailability(true);
+
+                // Publish discovery messages
+                if (ha_discovery->publishDiscovery()) {
+                    // Subscribe to command topics
+                    ha_discovery->subscribeToCommands();
+                    ha_discovery_published = true;
+                    Serial.println("HA Discovery published successfully");
+                }
+            }
+        } else {
+            // Reset discovery flag when disconnected so it republishes on reconnect
+            ha_discovery_published = false;
+        }
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+
+    scheduler.add("ha_sensors", [](uint32_t now) -> uint32_t {
+        if (services_initialized && ha_discovery && ha_mqtt_client && ha_mqtt_client->isConnected()) {
+            ha_discovery->updateSensors(
+                WiFi.RSSI(),
+                millis() / 1000,
+                WiFi.localIP().toString(),
+                ESP.getFreeHeap()
+            );
+            return now + 60001;
+        }
+        return now + 1001;
+    }, 20000);
+
+    // OTA updates (periodic checks for new firmware; a download runs far over budget)
+    scheduler.add("ota", [](uint32_t now) -> uint32_t {
+        if (services_initialized && ota_manager) {
+            ota_manager->loop();
         }
+        return now + 1001;  // Periodic check interval is in hours
+    }, 5000);
+
+    // Answer Prometheus scrapes
+    scheduler.add("metrics_http", [](uint32_t now) -> uint32_t {
+        metrics_server.loop();
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+
+    // Compact metrics snapshot and scheduler CPU report over MQTT
+    if (METRICS_PUBLISH_INTERVAL > 0) {
+        scheduler.add("metrics_publish", [](uint32_t now) -> uint32_t {
+            if (!services_initialized) {
+                return now + 1001;
+            }
+            publishMetricsSnapshot();
+            return now + METRICS_PUBLISH_INTERVAL + 1;
+        }, 20000);
     }
-    
-    // Always run sign controller loop for timing management
-    if (sign_controller) {
-        sign_controller->loop();
+    if (SCHEDULER_REPORT_INTERVAL > 0) {
+        scheduler.add("scheduler_report", [](uint32_t now) -> uint32_t {
+            if (!services_initialized || !mqtt_manager) {
+                return now + 1001;
+            }
+            String topic = "ledSign/" + device_id + "/scheduler";
+            String payload = scheduler.report();
+            mqtt_manager->publish(topic.c_str(), payload.c_str());
+            return now + SCHEDULER_REPORT_INTERVAL + 1;
+        }, 20000);
     }
+#ifdef SIGN_PROFILE
+    // Cycle and stall profile of the hot paths (profile build only)
+    scheduler.add("hotpath_report", [](uint32_t now) -> uint32_t {
+        if (!services_initialized || !mqtt_manager) {
+            return now + 1001;
+        }
+        String topic = "ledSign/" + device_id + "/profile";
+        String payload = HotPath::report();
+        mqtt_manager->publish(topic.c_str(), payload.c_str());
+        return now + HOTPATH_REPORT_INTERVAL + 1;
+    }, 20000);
+#endif
+
+    scheduler.add("health", [](uint32_t now) -> uint32_t {
+        if (!services_initialized) {
+            // Offline or config portal: a past deadline would poll every pass
+            return now + HEALTH_CHECK_INTERVAL;
+        }
+        if (now - last_health_check > HEALTH_CHECK_INTERVAL) {
+            performHealthCheck();
+            last_health_check = now;
+        }
+        return last_health_check + HEALTH_CHECK_INTERVAL + 1;
+    }, 200000);
+
+    // SNTP runs in the background; only flag a first sync that never arrives
+    scheduler.add("time_watch", [](uint32_t now) -> uint32_t {
+        static bool warned = false;
+        if (!warned && time_sync.isOverdue()) {
+            Serial.println("Warning: NTP synchronization overdue - clock display waits for it");
+            SIM_EVENT("ntp", "overdue");
+            EventBus::publish(EVT_ERROR);
+            warned = true;
+        }
+        return now + 1001;
+    }, 2000);
+
+    // Periodic clock display (unless priority message active or time not synced)
+    scheduler.add("clock", [](uint32_t now) -> uint32_t {
+        static uint32_t last_clock_display = 0;
+        if (!services_initialized || !time_synced) {
+            return now + 1001;
+        }
+        if (now - last_clock_display <= CLOCK_DISPLAY_INTERVAL) {
+            return last_clock_display + CLOCK_DISPLAY_INTERVAL + 1;
+        }
+        if (!sign_controller || sign_controller->isInPriorityMode()) {
+            return now + 1001;  // Overdue but blocked: check again once a second
+        }
+        sign_controller->displayClock();
+        last_clock_display = now;
+        return now + CLOCK_DISPLAY_INTERVAL + 1;
+    }, 200000);
+
+    // Handheld remote works with or without the access point
+    scheduler.add("espnow", [](uint32_t now) -> uint32_t {
+        if (espnow_receiver) {
+            espnow_receiver->loop();
+        }
+        return pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 50000);
+
+    // Pair button: a long press opens the pairing window (never opened automatically)
+    scheduler.add("pair_button", [](uint32_t now) -> uint32_t {
+        static uint32_t pressed_since = 0;
+        static bool opened = false;
+        if (digitalRead(ESPNOW_PAIR_BUTTON_PIN) != LOW) {
+            pressed_since = 0;
+            opened = false;
+        } else if (pressed_since == 0) {
+            pressed_since = now ? now : 1;
+        } else if (!opened && now - pressed_since >= ESPNOW_PAIR_BUTTON_HOLD_MS && espnow_receiver) {
+            opened = true;
+            Serial.println("Button: Pair remote requested");
+            espnow_receiver->openPairingWindow(ESPNOW_PAIR_WINDOW_MS);
+        }
+        return now + 50;
+    }, 1000);
+
+    // Release the sign and report timing once a sequence run completes
+    scheduler.add("sequence", [](uint32_t now) -> uint32_t {
+        serviceSequence();
+        return pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
+    }, 5000);
 
-    // Always run status indicator for LED/buzzer timing
-    if (status_indicator) {
+    // Sign controller timing (priority stages, offline sequence, clock mode)
+    scheduler.add("sign", [](uint32_t now) -> uint32_t {
+        if (sign_controller) {
+            sign_controller->loop();
+        }
+        return pollAfter(now, SCHEDULER_LOCAL_POLL_MS);  // Stage timers are in seconds
+    }, 200000);
+
+    // Deliver this pass's events, then animate the status LED / buzzer
+    scheduler.add("events", [](uint32_t now) -> uint32_t {
+        EventBus::dispatch();
+        // Events from other tasks (ESP-NOW, sequence) arrive between passes; a backlog
+        // past the dispatch budget goes out on the next pass
+        return EventBus::depth() ? now : pollAfter(now, SCHEDULER_NET_POLL_MS);
+    }, 2000);
+
+    scheduler.add("status", [](uint32_t now) -> uint32_t {
+        if (!status_indicator) {
+            return now + 1001;
+        }
         status_indicator->loop();
-    }
+        return pollAfter(now, status_indicator->isAnimating() ? SCHEDULER_ANIMATION_TICK_MS : SCHEDULER_NET_POLL_MS);
+    }, 2000);
+
+    // Flush captured traffic to flash / send dump chunks (one chunk per pass while dumping)
+    scheduler.add("capture", [](uint32_t now) -> uint32_t {
+        traffic_capture.loop();
+        return traffic_capture.isDumping() ? now : pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
+    }, 20000);
+
+    // Roll back a broker change whose new broker never answered
+    scheduler.add("config", [](uint32_t now) -> uint32_t {
+        if (!config_apply.awaiting_mqtt) {
+            return now + 1001;
+        }
+        if (now - config_apply.started_ms < CONFIG_APPLY_TIMEOUT_MS) {
+            return config_apply.started_ms + CONFIG_APPLY_TIMEOUT_MS;
+        }
+
+        Serial.println("Config: New broker did not answer - rolling back");
+        String error;
+        config_rollback_from = config_apply.version;
+        if (config_store.rollback(config_apply.version - 1, error)) {
+            config_result = "broker unreachable, rolled back";
+        } else {
+            config_rollback_from = 0;
+            config_result = "broker unreachable, rollback failed: " + error;
+            finishConfigApply();
+        }
+        return now + 1001;
+    }, 5000);
+
+    // Display receipts: watch for frames reaching the glass, send full/due batches
+    scheduler.add("receipts", [](uint32_t now) -> uint32_t {
+        display_receipts.loop();
+        if (display_receipts.batchReady(now) && mqtt_manager) {
+            String topic = "ledSign/" + device_id + "/receipts";
+            mqtt_manager->publish(topic.c_str(), display_receipts.takeBatch().c_str());
+        }
+        // Pending frames are timed to the glass: watch the UART every pass until they drain
+        return display_receipts.hasPending() ? now : pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
+    }, 20000);
+
+    // Close the day's sign load distribution after local midnight (retained, for supply sizing)
+    scheduler.add("sign_load", [](uint32_t now) -> uint32_t {
+        String report;
+        if (sign_load.rollDay(SimClock::now(), report) && mqtt_manager) {
+            String topic = "ledSign/" + device_id + "/sign_load";
+            mqtt_manager->publish(topic.c_str(), report.c_str(), true);
+        }
+        return now + SIGNLOAD_REPORT_CHECK_MS;
+    }, 5000);
+
+    // Power governor: sign lock while a frame drains, idle clock drop, time in state
+    scheduler.add("power", [](uint32_t now) -> uint32_t {
+        power_governor.loop();
+        return pollAfter(now, SCHEDULER_LOCAL_POLL_MS);
+    }, 2000);
 }
 
 /**
@@ -434,24 +819,80 @@ void initializeDevice() {
     device_id = mac;
     Serial.print("Device ID: ");
     Serial.println(device_id);
+
+    // Resume a field capture across reboots before the sign sees its first byte.
+    // The virtual-clock build always captures, from a clean ring, for replay diffs.
+#ifdef SIM_CLOCK
+    traffic_capture.begin();
+    traffic_capture.clear();
+    traffic_capture.start(captureSessionInfo());
+#else
+    if (traffic_capture.begin()) {
+        traffic_capture.start(captureSessionInfo());
+    }
+#endif
+
+    // Outbound messages spooled before a reset go out after the first connect
+    outbound_spool.begin();
+#ifdef SIM_CLOCK
+    outbound_spool.clear();
+#endif
+
+    // Broker, zone and timing settings (defaults until the first config change)
+    config_store.begin();
+    loadConfigGlobals();
     
+    // Identify the sign before its memory is configured (cached in NVS after the first boot)
+#ifdef SIM_CLOCK
+    sign_model.begin(&led_sign, false);  // Nothing answers reads here; keep runs repeatable
+#else
+    sign_model.begin(&led_sign);
+#endif
+    SignLoadGovernor::setGeometry(sign_model.get().columns, sign_model.get().rows, sign_model.get().lines);
+
     // Initialize LED sign controller
     sign_controller = new SignController(&led_sign, device_id);
+    sign_controller->setCapabilities(&sign_model.get());
     if (!sign_controller->begin()) {
         Serial.println("Warning: LED sign initialization failed");
         // Continue anyway - sign might be temporarily disconnected
     }
+    sign_controller->setPriorityWarningDuration(config_store.getInt("prio_warn_ms"));
+    sign_controller->setClockDuration(config_store.getInt("clock_ms"));
+    sign_load.setBudget(config_store.getInt("sign_budget_ma"));
+    sign_controller->setLoadGovernor(&sign_load);
 
     // Clear stale content from sign immediately
     sign_controller->clearAllFiles();
 
+    // Preload the default countdown so a trigger only has to start it
+    sequence_engine = new SequenceEngine(&led_sign);
+    if (sequence_engine->begin()) {
+        sequence_engine->loadCountdown(SEQ_DEFAULT_COUNTDOWN);
+    }
+
     // Run hardware diagnostic to verify sign communication path
     Serial.println("Running sign hardware diagnostic...");
     sign_controller->runDiagnostic();
 
+#ifdef SIM_CLOCK
+    // Virtual-clock build: no radio; links and traffic come from the scenario
+    initializeSimulation();
+    return;
+#endif
+
     // Initialize WiFi manager (tzapu/WiFiManager)
     Serial.println("Initializing WiFi manager...");
 
+    // Portal fields show the stored values
+    custom_mqtt_server.setValue(MQTT_Server, MAX_MQTT_SERVER_LEN);
+    custom_mqtt_port.setValue(MQTT_Port, MAX_MQTT_PORT_LEN);
+    custom_mqtt_user.setValue(MQTT_User, MAX_MQTT_USER_LEN);
+    custom_mqtt_pass.setValue(MQTT_Pass, MAX_MQTT_PASS_LEN);
+    custom_zone_name.setValue(Zone_Name, MAX_ZONE_NAME_LEN);
+    custom_ha_mqtt_server.setValue(HA_MQTT_Server, MAX_HA_MQTT_SERVER_LEN);
+    custom_ha_mqtt_port.setValue(HA_MQTT_Port, MAX_HA_MQTT_PORT_LEN);
+
     // Add custom parameters - Primary MQTT (Cloud/Alert Manager)
     wifiManager.addParameter(&custom_mqtt_server);
     wifiManager.addParameter(&custom_mqtt_port);
@@ -463,42 +904,29 @@ void initializeDevice() {
     wifiManager.addParameter(&custom_ha_mqtt_server);
     wifiManager.addParameter(&custom_ha_mqtt_port);
 
-    // Configure WiFi manager
+    // Configure WiFi manager; the portal runs alongside the firmware (non-blocking) and
+    // is serviced by the "portal" component, so the sign, status LED and reconnects keep going
+    wifiManager.setConfigPortalBlocking(false);
     wifiManager.setConfigPortalTimeout(CONFIG_PORTAL_TIMEOUT);
     wifiManager.setConnectTimeout(WIFI_CONNECT_TIMEOUT);
     wifiManager.setDebugOutput(true);
+    wifiManager.setAPCallback([](WiFiManager*) {
+        handlePortalOpened();
+    });
+    wifiManager.setSaveParamsCallback(savePortalParams);
 
     // Set hostname
     WiFi.setHostname(HOST_NAME);
 
-    // Auto-connect - will start config portal if no saved credentials
-    // This blocks until WiFi is connected or portal times out
-    // Set static red LED during portal (LEDC hardware keeps it lit while WiFiManager blocks)
-    if (status_indicator) status_indicator->setLEDPattern("red");
+    // Auto-connect - tries the saved network, else opens the config portal and returns
     Serial.println("Connecting to WiFi (or starting config portal)...");
-    if (!wifiManager.autoConnect(SIGN_DEFAULT_SSID, SIGN_DEFAULT_PASS)) {
-        Serial.println("WiFi connection failed - restarting in 3 seconds...");
-        if (sign_controller) sign_controller->displayError("WiFi Failed - Rebooting", 3);
-        if (status_indicator) status_indicator->onError();
-        delay(3000);
-        ESP.restart();
-    }
-
-    // Copy parameter values after portal (user may have updated them)
-    // Primary MQTT
-    strcpy(MQTT_Server, custom_mqtt_server.getValue());
-    strcpy(MQTT_Port, custom_mqtt_port.getValue());
-    strcpy(MQTT_User, custom_mqtt_user.getValue());
-    strcpy(MQTT_Pass, custom_mqtt_pass.getValue());
-    strcpy(Zone_Name, custom_zone_name.getValue());
-
-    // Secondary MQTT (Home Assistant)
-    strcpy(HA_MQTT_Server, custom_ha_mqtt_server.getValue());
-    strcpy(HA_MQTT_Port, custom_ha_mqtt_port.getValue());
-
-    Serial.println("WiFi connected successfully!");
-    Serial.print("IP Address: ");
-    Serial.println(WiFi.localIP());
+    if (wifiManager.autoConnect(SIGN_DEFAULT_SSID, SIGN_DEFAULT_PASS)) {
+        Serial.println("WiFi connected successfully!");
+        Serial.print("IP Address: ");
+        Serial.println(WiFi.localIP());
+    } else {
+        Serial.println("WiFi: Config portal open (" SIGN_DEFAULT_SSID ") - continuing offline");
+    }
     
     // Initialize random number generator
     // Note: Cannot use analogRead(0) - GPIO0 is on ADC2 which conflicts with WiFi
@@ -510,6 +938,23 @@ void initializeDevice() {
         seed ^= (mac_bytes[i] << (i * 4));
     }
     randomSeed(seed ^ millis());
+
+    // Start ESP-NOW for the handheld remote (needs STA mode, which WiFiManager left us in)
+    espnow_receiver = new EspNowReceiver();
+    bool espnow_ok = espnow_receiver->begin();
+    if (espnow_ok) {
+        espnow_receiver->setCommandCallback(handleRemoteCommand);
+        if (espnow_receiver->getPeerCount() == 0) {
+            Serial.println("ESP-NOW: No remote paired - hold the pair button or use Pair Remote in HA");
+        }
+    } else {
+        Serial.println("Warning: ESP-NOW initialization failed - handheld remote disabled");
+    }
+
+    // Clock scaling and modem sleep (WiFi is started, so its sleep mode can be set);
+    // ESP-NOW frames are not buffered by the AP, so the remote keeps the radio awake
+    power_governor.setRadioListener(espnow_ok);
+    power_governor.begin(config_store.getInt("power_budget_ms"));
     
     Serial.println("Device hardware initialization complete");
 }
@@ -522,31 +967,18 @@ void initializeDevice() {
  */
 void initializeNetworkServices() {
     Serial.println("Initializing network services...");
+
+    // Services start from the current config; earlier changes need no re-apply
+    config_store.takeChanges();
     
     try {
-        // Initialize time synchronization first
-        Serial.println("Configuring NTP time synchronization...");
-        configTzTime(timezone_posix, ntp_server);
-        delay(2000); // Give NTP time to sync
-        
-        struct tm timeinfo;
-        if (getLocalTime(&timeinfo)) {
-            Serial.print("Current time: ");
-            Serial.print(asctime(&timeinfo));
-            last_time_sync = millis();
-            time_synced = true;
-
-            // Show clock on sign now that time is valid (replaces boot hello message)
-            if (sign_controller) {
-                sign_controller->displayClock();
-            }
-        } else {
-            Serial.println("Warning: NTP synchronization failed");
-            if (sign_controller) {
-                sign_controller->displayError("NTP Sync Failed", 5);
-            }
-            if (status_indicator) status_indicator->onError();
-        }
+        // Start time synchronization first; the clock appears on EVT_TIME_SYNCED
+        time_sync.start(ntp_server, timezone_posix);
+
+#ifndef SIM_CLOCK
+        // Background DNS refresh for the broker and OTA hosts (clients prefetch in begin())
+        DnsCache::begin();
+#endif
         
         // Initialize MQTT manager with zone name (per ESP32_BETABRITE_IMPLEMENTATION.md)
         Serial.println("Initializing MQTT manager...");
@@ -561,6 +993,17 @@ void initializeNetworkServices() {
         }
         Serial.println(zone_name);
 
+        // Alert routing table, compiled once; MQTT subscribes to its filters
+        if (alert_router.count() == 0) {
+            LittleFS.begin(true);
+            alert_router.load(ALERTROUTER_CONFIG_PATH, zone_name);
+            for (uint8_t i = 0; i < alert_router.count(); i++) {
+                if (alert_router.route(i).file && sign_controller) {
+                    sign_controller->reserveFile(alert_router.route(i).file);
+                }
+            }
+        }
+
         mqtt_manager = new MQTTManager(&wifi_client, device_id, zone_name);
 
         if (mqtt_manager) {
@@ -587,24 +1030,53 @@ void initializeNetworkServices() {
                 // Configure MQTT manager with TLS option
                 if (mqtt_manager->configure(mqtt_server, mqtt_port, mqtt_user, mqtt_pass, use_tls)) {
                     mqtt_manager->setMessageCallback(handleMQTTMessage);
+                    mqtt_manager->setRouter(&alert_router);
+                    mqtt_manager->setSpool(&outbound_spool);
 
                     if (mqtt_manager->begin()) {
                         Serial.println("MQTT manager initialized successfully");
                     } else {
                         Serial.println("Warning: MQTT manager initialization failed");
                         if (sign_controller) sign_controller->displayError("MQTT Init Failed", 5);
-                        if (status_indicator) status_indicator->onError();
+                        EventBus::publish(EVT_ERROR);
                     }
                 } else {
                     Serial.println("Warning: MQTT configuration invalid");
                     if (sign_controller) sign_controller->displayError("MQTT Config Invalid", 5);
-                    if (status_indicator) status_indicator->onError();
+                    EventBus::publish(EVT_ERROR);
                 }
             } else {
                 Serial.println("Info: MQTT not configured - check WiFi portal");
             }
         }
 
+#ifndef SIM_CLOCK
+        // Initialize multicast alert ingress (requires shared site key in LittleFS)
+        if (!multicast_listener && LittleFS.begin(true)) {
+            File keyFile = LittleFS.open(MULTICAST_KEY_PATH, "r");
+            if (keyFile) {
+                String site_key = keyFile.readStringUntil('\n');
+                site_key.trim();
+                keyFile.close();
+
+                multicast_listener = new MulticastListener(MULTICAST_GROUP, MULTICAST_PORT);
+                if (multicast_listener->setKeyHex(site_key.c_str())) {
+                    multicast_listener->setMessageCallback(handleMQTTMessage);
+                    multicast_listener->setClockValid(time_synced);
+                } else {
+                    Serial.println("Multicast: Warning - Invalid site key in " MULTICAST_KEY_PATH);
+                    delete multicast_listener;
+                    multicast_listener = nullptr;
+                }
+            } else {
+                Serial.println("Multicast: Info - No site key found, multicast ingress disabled");
+            }
+        }
+        if (multicast_listener && !multicast_listener->isActive()) {
+            multicast_listener->begin();
+        }
+#endif
+
         // Initialize GitHub OTA manager
         Serial.println("Initializing OTA update manager...");
         ota_manager = new GitHubOTA(GITHUB_REPO_OWNER, GITHUB_REPO_NAME, &led_sign);
@@ -636,10 +1108,11 @@ void initializeNetworkServices() {
                 Serial.println("OTA: Warning - LittleFS mount failed, cannot load GitHub token");
             }
 
-            // Configure OTA settings from defines.h
-            ota_manager->setCheckInterval(OTA_CHECK_INTERVAL_MS);
-            ota_manager->setAutoUpdate(OTA_AUTO_UPDATE_ENABLED);
+            // Configure OTA settings from the config store (defaults in defines.h)
+            ota_manager->setCheckInterval(config_store.getInt("ota_check_min") * 60000UL);
+            ota_manager->setAutoUpdate(config_store.getBool("ota_auto"));
 
+#ifndef SIM_CLOCK
             // Optionally perform boot-time update check
             if (OTA_BOOT_CHECK_ENABLED) {
                 Serial.println("OTA: Performing boot-time update check...");
@@ -652,6 +1125,7 @@ void initializeNetworkServices() {
                     }
                 }
             }
+#endif
 
             Serial.println("OTA: Manager initialized successfully");
         } else {
@@ -741,6 +1215,16 @@ void initializeNetworkServices() {
                             if (status_indicator) status_indicator->triggerBuzzer("chime");
                         });
 
+                        ha_discovery->setPairRemoteCallback([]() {
+                            Serial.println("HA: Pair remote requested");
+                            if (espnow_receiver) espnow_receiver->openPairingWindow(ESPNOW_PAIR_WINDOW_MS);
+                        });
+
+                        ha_discovery->setSequenceCallback([]() {
+                            Serial.println("HA: Start sequence");
+                            startSequence();
+                        });
+
                         Serial.println("Home Assistant Discovery initialized on secondary broker");
                     }
                 } else {
@@ -754,6 +1238,14 @@ void initializeNetworkServices() {
             ha_discovery = nullptr;
         }
 
+#ifndef SIM_CLOCK
+        // Prometheus endpoint (the listening socket survives WiFi reconnects)
+        if (METRICS_HTTP_PORT > 0) {
+            metrics_server.setCollectCallback(updateSystemMetrics);
+            metrics_server.begin();
+        }
+#endif
+
         services_initialized = true;
         Serial.println("All network services initialized successfully");
         
@@ -768,103 +1260,149 @@ void initializeNetworkServices() {
 }
 
 /**
- * @brief Structure for display configuration presets
+ * @brief Check whether an alert was already displayed, remembering it if not
+ *
+ * The same alert can arrive via multicast and again via MQTT. An alert with an
+ * "id" is a duplicate if that id was seen recently on either path. Without an
+ * id, producers legitimately send the same text again (timestamp 0 or absent),
+ * so the FNV-1a hash of timestamp + title + message only suppresses the copy
+ * from the other path, once.
  *
- * Contains all display parameters for an alert level/category combination
+ * @param alert Decoded alert
+ * @param via_multicast Alert arrived as a multicast datagram (else MQTT)
+ * @return true if this alert was seen recently and should be skipped
  */
-struct DisplayPreset {
-    char color_code;
-    char mode_code;
-    char charset_code;
-    char position_code;
-    const char* speed_code;
-    char effect_code;
-    bool priority;
-    unsigned int duration;
-};
+bool isDuplicateAlert(const AlertFields& alert, bool via_multicast) {
+    uint32_t key = 2166136261u;
+    auto mix = [&key](const char* s, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            key ^= (uint8_t)s[i];
+            key *= 16777619u;
+        }
+        key ^= 0xFF;  // Field separator
+        key *= 16777619u;
+    };
+
+    bool has_id = strlen(alert.id) > 0;
+    uint8_t path = via_multicast ? ALERT_PATH_MULTICAST : ALERT_PATH_MQTT;
+    if (has_id) {
+        mix(alert.id, strlen(alert.id));
+    } else {
+        String ts = String((unsigned long)alert.timestamp);
+        mix(ts.c_str(), ts.length());
+        mix(alert.text, alert.has_title ? alert.title_length : 0);  // Absent title keys as ""
+        mix(alert.message(), strlen(alert.message()));
+    }
+    if (key == 0) key = 1;  // 0 marks an empty slot
+
+    for (int i = 0; i < ALERT_DEDUP_SLOTS; i++) {
+        if (recent_alert_keys[i] != key) {
+            continue;
+        }
+        if (has_id) {
+            return true;
+        }
+        if (recent_alert_paths[i] & ~path) {
+            recent_alert_keys[i] = 0;  // Pair complete: a later resend is shown again
+            recent_alert_paths[i] = 0;
+            return true;
+        }
+        return false;  // Same path again: the producer resent it
+    }
+
+    recent_alert_keys[recent_alert_next] = key;
+    recent_alert_paths[recent_alert_next] = path;
+    recent_alert_next = (recent_alert_next + 1) % ALERT_DEDUP_SLOTS;
+    return false;
+}
 
 /**
- * @brief Get display preset based on alert level and category
+ * @brief Report the outcome of a load-test alert (see tools/load_generator.py)
  *
- * Returns appropriate display configuration based on alert severity and type.
- * Falls back to safe defaults if level/category not recognized.
+ * Only alerts carrying "echo": true and an "id" are reported, so normal
+ * traffic pays nothing. Publishes to ledSign/{device_id}/echo:
+ * {"id":"..","status":"displayed|rejected|duplicate","handle_us":..,
+ *  "heap_free":..,"heap_min":..,"sign_bytes":..}
  *
- * Alert Levels (by severity):
- * - critical: Red, flash/newsflash, large text, priority, 60s
- * - warning:  Amber, scroll, normal text, 30s
- * - notice:   Green, wipein, normal text, 20s
- * - info:     Green, rotate, normal text, 15s
+ * @param alert Decoded alert
+ * @param status Outcome
+ * @param rx_us micros() when the handler was entered
+ */
+void publishLoadEcho(const AlertFields& alert, const char* status, unsigned long rx_us) {
+    if (!alert.echo || !mqtt_manager || !mqtt_manager->isConnected()) {
+        return;
+    }
+    if (strlen(alert.id) == 0) {
+        return;
+    }
+
+    StaticJsonDocument<256> echo;
+    echo["id"] = alert.id;
+    echo["status"] = status;
+    echo["handle_us"] = micros() - rx_us;
+    echo["heap_free"] = ESP.getFreeHeap();
+    echo["heap_min"] = ESP.getMinFreeHeap();
+    echo["sign_bytes"] = led_sign.GetBytesWritten();
+
+    String payload;
+    serializeJson(echo, payload);
+    // Whole payload in the event log: tools/load_generator.py --sim-log scores the run from it
+    SIM_EVENT("echo", payload);
+    String topic = "ledSign/" + device_id + "/echo";
+    mqtt_manager->publish(topic.c_str(), payload.c_str());
+}
+
+/**
+ * @brief Context written at the start of each capture session
+ * @return JSON with firmware version, device, zone, wall clock and uptime
+ */
+String captureSessionInfo() {
+    StaticJsonDocument<256> doc;
+    doc["version"] = APP_VERSION;
+    doc["device"] = device_id;
+    doc["zone"] = Zone_Name;
+    doc["epoch"] = (uint32_t)SimClock::now();
+    doc["uptime_ms"] = SimClock::millis();
+
+    String info;
+    serializeJson(doc, info);
+    return info;
+}
+
+/**
+ * @brief Handle a traffic capture command from ledSign/{zone}/capture
  *
- * Categories influence special effects:
- * - security: Bomb effect for visual urgency
- * - weather:  Snow/weather-appropriate effects
- * - automation: Welcome/completion effects
- * - system/network: Subtle twinkle effects
+ * start | stop | clear | dump. A dump is published in base64 chunks to
+ * ledSign/{device_id}/capture/data; tools/capture_replay.py fetch collects it.
  *
- * @param level Alert severity level ("critical", "warning", "notice", "info")
- * @param category Alert category ("security", "weather", "automation", "system", etc.)
- * @return DisplayPreset struct with appropriate display parameters
+ * @param payload Command text
+ * @param length Payload length in bytes
  */
-DisplayPreset getDisplayPreset(const char* level, const char* category) {
-    DisplayPreset preset;
-
-    // Default safe values
-    preset.color_code = '2';        // Green
-    preset.mode_code = 'a';         // Rotate
-    preset.charset_code = '3';      // 7high
-    preset.position_code = ' ';     // Midline
-    preset.speed_code = "\027";     // Medium (3)
-    preset.effect_code = '0';       // Twinkle
-    preset.priority = false;
-    preset.duration = 15;
-
-    // Determine base preset by level
-    if (strcmp(level, "critical") == 0) {
-        preset.color_code = '1';     // Red
-        preset.mode_code = 'c';      // Flash
-        preset.charset_code = '6';   // 10high (large)
-        preset.position_code = '0';  // Fill
-        preset.speed_code = "\031";  // Fast (5)
-        preset.effect_code = 'Z';    // Bomb (urgent)
-        preset.priority = true;
-        preset.duration = 60;
-    } else if (strcmp(level, "warning") == 0) {
-        preset.color_code = '3';     // Amber
-        preset.mode_code = 'm';      // Scroll
-        preset.charset_code = '3';   // 7high
-        preset.position_code = '\"'; // Topline
-        preset.speed_code = "\027";  // Medium (3)
-        preset.effect_code = '0';    // Twinkle
-        preset.priority = false;
-        preset.duration = 30;
-    } else if (strcmp(level, "notice") == 0) {
-        preset.color_code = '2';     // Green
-        preset.mode_code = 'r';      // Wipein
-        preset.charset_code = '3';   // 7high
-        preset.position_code = ' ';  // Midline
-        preset.speed_code = "\027";  // Medium (3)
-        preset.effect_code = '8';    // Welcome
-        preset.priority = false;
-        preset.duration = 20;
-    }
-    // else: info or unknown - use defaults set above
-
-    // Modify effect based on category (overrides level-based effect for non-critical)
-    if (strcmp(level, "critical") != 0) {  // Don't override critical bomb effect
-        if (strcmp(category, "security") == 0) {
-            preset.effect_code = 'B';    // Trumpet (attention-getting)
-        } else if (strcmp(category, "weather") == 0) {
-            preset.effect_code = '2';    // Snow
-        } else if (strcmp(category, "automation") == 0) {
-            preset.effect_code = '8';    // Welcome/completion
-        } else if (strcmp(category, "system") == 0 || strcmp(category, "network") == 0) {
-            preset.effect_code = '0';    // Twinkle (subtle)
-        } else if (strcmp(category, "personal") == 0) {
-            preset.effect_code = '1';    // Sparkle (friendly)
-        }
-    }
-
-    return preset;
+void handleCaptureCommand(const uint8_t* payload, unsigned int length) {
+    String command;
+    for (unsigned int i = 0; i < length; i++) {
+        command += (char)payload[i];
+    }
+    command.trim();
+
+    Serial.print("Capture: Command ");
+    Serial.println(command);
+
+    if (command == "start") {
+        traffic_capture.start(captureSessionInfo());
+    } else if (command == "stop") {
+        traffic_capture.stop();
+    } else if (command == "clear") {
+        traffic_capture.clear();
+    } else if (command == "dump") {
+        static String data_topic;
+        data_topic = "ledSign/" + device_id + "/capture/data";
+        traffic_capture.startDump([](const String& chunk) {
+            return mqtt_manager && mqtt_manager->publish(data_topic.c_str(), chunk.c_str(), false, false);
+        });
+    } else {
+        Serial.println("Capture: Unknown command (start|stop|clear|dump)");
+    }
 }
 
 /**
@@ -886,9 +1424,70 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
         return;
     }
 
+    HOTPATH_PROFILE(HOTPATH_INGEST);
+    unsigned long rx_us = micros();  // Handler entry, for load-test echo timing
+
+    // Full clock from parse to the sign write; the frame itself is covered by the sign lock
+    PowerGovernor::Hold power_hold(power_governor, POWER_LOCK_ALERT);
+
     // Note: HADiscovery is on secondary broker (ha_mqtt_client) with its own callback
     // This handler is for primary broker (Alert Manager) messages only
 
+    const char* suffix = strrchr(topic, '/');
+
+    // Runtime configuration carries credentials, so it is never captured
+    if (suffix && strcmp(suffix, "/set") == 0 && String(topic) == "ledSign/" + device_id + "/config/set") {
+        handleConfigCommand(payload, length);
+        return;
+    }
+
+    // Capture control is not itself captured
+    if (suffix && strcmp(suffix, "/capture") == 0) {
+        handleCaptureCommand(payload, length);
+        return;
+    }
+    traffic_capture.recordMessage(topic, payload, length);
+
+    // Sequence triggers: plain "start"/"stop" (no parsing on the hot path) or JSON to load
+    if (suffix && strcmp(suffix, "/sequence") == 0) {
+        if (length == 5 && memcmp(payload, "start", 5) == 0) {
+            handleSequenceCommand("start", 0);
+            return;
+        }
+        if (length == 4 && memcmp(payload, "stop", 4) == 0) {
+            handleSequenceCommand("stop", 0);
+            return;
+        }
+
+        StaticJsonDocument<128> seq_doc;
+        if (deserializeJson(seq_doc, payload, length)) {
+            Serial.println("MQTT: Invalid sequence command");
+            return;
+        }
+        handleSequenceCommand(seq_doc["action"] | "", seq_doc["countdown"] | 0);
+        return;
+    }
+
+    // Route by topic; multicast has no subscription and keeps the alert's own style
+    const AlertRoute* route = nullptr;
+    bool via_multicast = strcmp(topic, "ledSign/multicast") == 0;
+    if (!via_multicast) {
+        // Overlapping filters: the broker may send the same message once per matching subscription
+        if (alert_router.isOverlapCopy(topic, payload, length, SimClock::millis())) {
+            Serial.println("MQTT: Copy via overlapping route filter - ignored");
+            metric_alerts_duplicate.inc();
+            return;
+        }
+        route = alert_router.match(topic);
+        if (!route) {
+            Serial.print("MQTT: No route for topic ");
+            Serial.print(topic);
+            Serial.println(" - ignored");
+            return;
+        }
+    }
+    char route_file = route ? route->file : 0;
+
     // Log received message
     Serial.print("MQTT Message [");
     Serial.print(topic);
@@ -902,23 +1501,53 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
     }
     Serial.println(message);
 
-    // Try to parse as JSON (Alert Manager format)
-    // Use MQTT_MAX_PACKET_SIZE from defines.h for JSON parsing buffer
-    DynamicJsonDocument doc(MQTT_MAX_PACKET_SIZE);
-    DeserializationError error = deserializeJson(doc, payload, length);
+    // Decode the alert (Alert Manager JSON format) in one pass: the display text is
+    // unescaped straight into alert_text, no JSON document (see src/AlertDecoder.h)
+    static char alert_text[ALERTDEC_BUFFER_SIZE(MQTT_MAX_PACKET_SIZE)];
+    AlertFields alert;
+    AlertDecodeResult result = AlertDecoder::decodeAlert(payload, length, alert, alert_text, sizeof(alert_text));
 
-    if (!error) {
+    if (result == ALERTDEC_OK) {
         // Successfully parsed as JSON - Extract alert fields
         Serial.println("MQTT: Parsing JSON alert message");
 
-        // Extract core fields
-        const char* title = doc["title"] | "Alert";
-        const char* msg = doc["message"] | "";
-        const char* level = doc["level"] | "info";
-        const char* category = doc["category"] | "application";
+        // Multicast reaches every zone; honour the alert's zone field if present
+        if (via_multicast) {
+            const char* zone = alert.zone;
+            if (strlen(zone) > 0 && strcmp(zone, "all") != 0 && strcmp(zone, Zone_Name) != 0) {
+                Serial.println("MQTT: Multicast alert for another zone - ignored");
+                return;
+            }
+        }
+
+        const char* alert_id = alert.id;
+        uint32_t alert_ts = alert.timestamp;
+
+        // Alerts that outlived their "expires" time in transit are not shown
+        uint32_t expires = alert.expires;
+        time_t now = SimClock::now();
+        if (expires && now >= 1609459200 && (uint32_t)now > expires) {
+            Serial.println("MQTT: Alert expired before arrival - ignored");
+            metric_alerts_expired.inc();
+            display_receipts.record(alert_id, alert_ts, RECEIPT_EXPIRED, rx_us);
+            return;
+        }
+
+        // Skip alerts already shown via the other delivery path
+        if (isDuplicateAlert(alert, via_multicast)) {
+            Serial.println("MQTT: Duplicate alert (already displayed) - ignored");
+            metric_alerts_duplicate.inc();
+            display_receipts.record(alert_id, alert_ts, RECEIPT_COALESCED, rx_us);
+            publishLoadEcho(alert, "duplicate", rx_us);
+            return;
+        }
+
+        bool shown = false;
 
-        // Build display text: "Title: Message"
-        String display_text = String(title) + ": " + String(msg);
+        // Core fields; the display text "Title: Message" is already composed
+        const char* level = alert.level;
+        const char* category = alert.category;
+        const char* display_text = alert.text;
 
         Serial.print("  Level: ");
         Serial.println(level);
@@ -927,58 +1556,56 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
         Serial.print("  Display Text: ");
         Serial.println(display_text);
 
-        // Extract display_config object
-        JsonObject displayConfig = doc["display_config"];
-
-        if (displayConfig && !displayConfig.isNull()) {
-            // Extract protocol codes from display_config
-            const char* mode_code = displayConfig["mode_code"] | "a";       // Default: rotate
-            const char* color_code = displayConfig["color_code"] | "2";     // Default: green
-            const char* charset_code = displayConfig["charset_code"] | "3"; // Default: 7high
-            const char* position_code = displayConfig["position_code"] | " "; // Default: midline
-            const char* speed_code = displayConfig["speed_code"] | "\027";  // Default: medium (3)
-            const char* effect_code = displayConfig["effect_code"] | "";     // Default: no effect (empty string)
-            bool priority = displayConfig["priority"] | false;
-            unsigned int duration = displayConfig["duration"] | 15;
+        if (alert.has_display_config) {
+            // Protocol codes from display_config, already checked against BBDEFS.h
+            // (defaults: rotate, green, 7high, midline, medium speed, no effect)
+            const char* speed_code = alert.speed;
+            bool priority = alert.priority;
+            unsigned int duration = alert.duration;
 
             Serial.println("  Display Config:");
             Serial.print("    Mode: ");
-            Serial.println(mode_code);
+            Serial.println(alert.mode);
             Serial.print("    Color: ");
-            Serial.println(color_code);
+            Serial.println(alert.color);
+            if (alert.invalid_codes) {
+                Serial.print("    Unknown codes replaced by default: ");
+                Serial.println(alert.invalid_codes);
+            }
             Serial.print("    Priority: ");
             Serial.println(priority ? "YES" : "NO");
             Serial.print("    Duration: ");
             Serial.print(duration);
             Serial.println(" seconds");
 
-            // Convert JSON codes to BetaBrite constants
-            char mode = mode_code[0];
-            char color = color_code[0];
-            char charset = charset_code[0];
-            char position = position_code[0];
-            char special = (effect_code && strlen(effect_code) > 0) ? effect_code[0] : 0;
+            char mode = alert.mode;
+            char color = alert.color;
+            char charset = alert.charset;
+            char position = alert.position;
+            char special = alert.special;
 
             // Display message based on priority
             if (sign_controller) {
                 if (priority) {
-                    sign_controller->displayPriorityMessage(display_text.c_str(), duration);
-                    if (status_indicator) status_indicator->onPriorityAlert();
+                    shown = sign_controller->displayPriorityMessage(display_text, duration);
+                    EventBus::publish(EVT_ALERT_RECEIVED, ALERT_SEVERITY_PRIORITY);
                 } else {
-                    sign_controller->displayMessage(display_text.c_str(), color, position, mode, special,
-                                                   charset, speed_code);
-                    if (status_indicator) status_indicator->onMessageReceived();
+                    shown = sign_controller->displayMessage(display_text, color, position, mode, special,
+                                                            charset, speed_code, route_file);
+                    EventBus::publish(EVT_ALERT_RECEIVED, ALERT_SEVERITY_INFO);
                 }
             }
         } else {
             // No display_config - apply intelligent preset based on level/category
             Serial.println("  No display_config found - applying preset based on level/category");
 
-            DisplayPreset preset = getDisplayPreset(level, category);
+            // Route style and priority offset pick the preset level
+            const char* preset_level = AlertRouter::effectiveLevel(route, level);
+            DisplayPreset preset = getDisplayPreset(preset_level, category);
 
             Serial.println("  Applied Preset:");
             Serial.print("    Level: ");
-            Serial.println(level);
+            Serial.println(preset_level);
             Serial.print("    Category: ");
             Serial.println(category);
             Serial.print("    Color: ");
@@ -995,35 +1622,42 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
 
             if (sign_controller) {
                 if (preset.priority) {
-                    sign_controller->displayPriorityMessage(display_text.c_str(), preset.duration);
-                    if (status_indicator) status_indicator->onPriorityAlert();
+                    shown = sign_controller->displayPriorityMessage(display_text, preset.duration);
+                    EventBus::publish(EVT_ALERT_RECEIVED, ALERT_SEVERITY_PRIORITY);
                 } else {
-                    sign_controller->displayMessage(
-                        display_text.c_str(),
+                    shown = sign_controller->displayMessage(
+                        display_text,
                         preset.color_code,
                         preset.position_code,
                         preset.mode_code,
                         preset.effect_code,
                         preset.charset_code,
-                        preset.speed_code
+                        preset.speed_code,
+                        route_file
                     );
                     // Warning level gets amber flash, others get green flash
-                    if (status_indicator) {
-                        if (strcmp(level, "warning") == 0) {
-                            status_indicator->onWarningAlert();
-                        } else {
-                            status_indicator->onMessageReceived();
-                        }
-                    }
+                    EventBus::publish(EVT_ALERT_RECEIVED, strcmp(preset_level, "warning") == 0 ? ALERT_SEVERITY_WARNING
+                                                                                               : ALERT_SEVERITY_INFO);
                 }
             }
         }
+        metric_alert_handle_us.observe(micros() - rx_us);
+        if (shown) {
+            metric_alerts_displayed.inc();
+            display_receipts.record(alert_id, alert_ts, RECEIPT_DISPLAYED, rx_us,
+                                    sign_controller->getLastWriteMicros());
+        } else {
+            metric_alerts_rejected.inc();
+            display_receipts.record(alert_id, alert_ts, RECEIPT_DROPPED, rx_us);
+        }
+        publishLoadEcho(alert, shown ? "displayed" : "rejected", rx_us);
         return;
     }
 
     // JSON parsing failed - message might be legacy format or invalid
     Serial.print("MQTT: JSON parse failed - ");
-    Serial.println(error.c_str());
+    Serial.println(AlertDecoder::resultName(result));
+    metric_alerts_invalid.inc();
     Serial.println("MQTT: Treating as invalid message (bracket notation no longer supported)");
 
     // Log the rejection
@@ -1031,6 +1665,170 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
     Serial.println("MQTT: Expected format: {\"title\":\"...\", \"message\":\"...\", \"display_config\":{...}}");
 }
 
+/**
+ * @brief Execute a command from the handheld remote
+ *
+ * Called from EspNowReceiver::loop() on the main task. Writes go straight to
+ * the sign (priority text skips the "ALERT" warning stage) so button-to-glass
+ * latency is bounded by the serial write, not by the display pipeline.
+ *
+ * @param cmd Decoded remote command
+ * @return true if the sign accepted the command
+ */
+bool handleRemoteCommand(const EspNowReceiver::Command& cmd) {
+    if (!sign_controller) {
+        return false;
+    }
+
+    static const char* preset_levels[] = {"info", "notice", "warning", "critical"};
+
+    switch (cmd.type) {
+        case ESPNOW_CMD_TEXT: {
+            if (strlen(cmd.text) == 0) {
+                return false;
+            }
+            const char* level = preset_levels[cmd.preset < 4 ? cmd.preset : 0];
+            DisplayPreset preset = getDisplayPreset(level, "personal");
+            bool priority = (cmd.flags & EspNowReceiver::FLAG_PRIORITY) || preset.priority;
+
+            Serial.print("Remote: ");
+            Serial.print(level);
+            Serial.print(priority ? " (priority): " : ": ");
+            Serial.println(cmd.text);
+
+            bool ok;
+            if (priority) {
+                unsigned int duration = cmd.arg > 0 ? cmd.arg : preset.duration;
+                ok = sign_controller->displayPriorityMessage(cmd.text, duration, false);
+                EventBus::publish(EVT_ALERT_RECEIVED, ALERT_SEVERITY_PRIORITY);
+            } else {
+                ok = sign_controller->displayMessage(cmd.text, preset.color_code, preset.position_code,
+                                                     preset.mode_code, preset.effect_code,
+                                                     preset.charset_code, preset.speed_code);
+                EventBus::publish(EVT_ALERT_RECEIVED, ALERT_SEVERITY_INFO);
+            }
+            return ok;
+        }
+
+        case ESPNOW_CMD_CLEAR:
+            Serial.println("Remote: Clear display");
+            if (sequence_engine && sequence_engine->isRunning()) {
+                // The sequence owns the sign; stop it and let serviceSequence() release
+                sequence_engine->stop();
+                return true;
+            }
+            if (sign_controller->isInPriorityMode()) {
+                sign_controller->cancelPriorityMessage();
+            }
+            sign_controller->clearAllFiles();
+            return true;
+
+        case ESPNOW_CMD_COUNTDOWN:
+            if (!sequence_engine || cmd.arg == 0) {
+                return false;
+            }
+            Serial.print("Remote: Countdown ");
+            Serial.print(cmd.arg);
+            Serial.println(" seconds");
+            // Re-encode only when the remote asks for a different length than is preloaded
+            if (sequence_engine->getLoadedCountdown() != cmd.arg &&
+                !sequence_engine->loadCountdown(cmd.arg)) {
+                return false;
+            }
+            return startSequence();
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Start the preloaded sequence, handing the sign UART to the engine
+ * @return true if the run started
+ */
+bool startSequence() {
+    if (!sequence_engine || !sign_controller || sequence_engine->isRunning()) {
+        return false;
+    }
+
+    sign_controller->setOutputSuspended(true);
+    if (!sequence_engine->start()) {
+        sign_controller->setOutputSuspended(false);
+        Serial.println("Sequence: Start failed (no timeline loaded)");
+        return false;
+    }
+
+    Serial.println("Sequence: Started");
+    return true;
+}
+
+/**
+ * @brief Apply a sequence command from MQTT
+ * @param command "start", "stop" or "load"
+ * @param countdown Countdown length for "load" (1-9 seconds)
+ */
+void handleSequenceCommand(const char* command, uint8_t countdown) {
+    if (!sequence_engine) {
+        return;
+    }
+
+    if (strcmp(command, "start") == 0) {
+        startSequence();
+    } else if (strcmp(command, "stop") == 0) {
+        sequence_engine->stop();
+    } else if (strcmp(command, "load") == 0) {
+        if (!sequence_engine->loadCountdown(countdown)) {
+            Serial.println("Sequence: Load failed (busy or countdown out of range 1-9)");
+        }
+    } else {
+        Serial.print("Sequence: Unknown command: ");
+        Serial.println(command);
+    }
+}
+
+/**
+ * @brief Release the sign after a run and publish its timing report
+ *
+ * Publishes to ledSign/{device_id}/sequence/stats:
+ * {"frames":5,"aborted":false,"jitter_min_us":..,"jitter_avg_us":..,
+ *  "jitter_max_us":..,"glass_max_us":..,"duration_ms":..}
+ */
+void serviceSequence() {
+    if (!sequence_engine) {
+        return;
+    }
+
+    SequenceEngine::RunReport report;
+    if (!sequence_engine->takeRunReport(report)) {
+        return;
+    }
+
+    if (sign_controller) {
+        sign_controller->setOutputSuspended(false);
+    }
+
+    Serial.printf("Sequence: %s - %u frames, jitter us min/avg/max %ld/%lu/%ld, glass max %ld us\n",
+                  report.aborted ? "Aborted" : "Complete", report.frames,
+                  (long)report.jitter_min_us, (unsigned long)report.jitter_avg_us,
+                  (long)report.jitter_max_us, (long)report.glass_max_us);
+
+    if (mqtt_manager) {
+        StaticJsonDocument<256> doc;
+        doc["frames"] = report.frames;
+        doc["aborted"] = report.aborted;
+        doc["jitter_min_us"] = report.jitter_min_us;
+        doc["jitter_avg_us"] = report.jitter_avg_us;
+        doc["jitter_max_us"] = report.jitter_max_us;
+        doc["glass_max_us"] = report.glass_max_us;
+        doc["duration_ms"] = report.duration_ms;
+
+        String payload;
+        serializeJson(doc, payload);
+        String topic = "ledSign/" + device_id + "/sequence/stats";
+        mqtt_manager->publish(topic.c_str(), payload.c_str());
+    }
+}
+
 /**
  * @brief Perform system health checks
  * 
@@ -1040,6 +1838,8 @@ void handleMQTTMessage(char* topic, uint8_t* payload, unsigned int length) {
  */
 void performHealthCheck() {
     Serial.println("Performing system health check...");
+    SIM_EVENT("health", mqtt_manager && mqtt_manager->isConnected() ? "mqtt up" : "mqtt down");
+    updateSystemMetrics();
     
     // Check memory health
     size_t free_heap = ESP.getFreeHeap();
@@ -1058,7 +1858,7 @@ void performHealthCheck() {
     }
     
     // Check WiFi signal strength
-    if (WiFi.status() == WL_CONNECTED) {
+    if (wifiConnected()) {
         int rssi = WiFi.RSSI();
         if (rssi < -80) {
             Serial.print("Warning: Weak WiFi signal - RSSI: ");
@@ -1079,7 +1879,7 @@ void performHealthCheck() {
                 String status = mqtt_manager->getConnectionStatus();
                 String error_msg = "MQTT: " + status;
                 sign_controller->displayError(error_msg.c_str(), 10);
-                if (status_indicator) status_indicator->onError();
+                EventBus::publish(EVT_ERROR);
                 mqtt_fail_count = 0; // Reset counter after displaying error
             }
         } else {
@@ -1087,6 +1887,75 @@ void performHealthCheck() {
         }
     }
     
+    // Report handheld remote link and receive-to-sign latency
+    if (espnow_receiver) {
+        Serial.print("ESP-NOW: ");
+        Serial.println(espnow_receiver->getStatus());
+    }
+
+    if (sequence_engine) {
+        Serial.print("Sequence: ");
+        Serial.println(sequence_engine->getStatus());
+    }
+
+    if (traffic_capture.isEnabled()) {
+        Serial.print("Capture: ");
+        Serial.println(traffic_capture.getStatus());
+    }
+
+    if (metrics_server.isRunning()) {
+        Serial.print("Metrics: ");
+        Serial.println(metrics_server.getStatus());
+    }
+
+    Serial.print("Events: ");
+    Serial.println(EventBus::getStatus());
+
+    Serial.print("Scheduler: ");
+    Serial.println(scheduler.getStatus());
+
+    Serial.print("Time: ");
+    Serial.println(time_sync.getStatus());
+
+    Serial.print("DNS: ");
+    Serial.println(DnsCache::getStatus());
+
+    Serial.print("Routes: ");
+    Serial.println(alert_router.getStatus());
+
+    Serial.print("Receipts: ");
+    Serial.println(display_receipts.getStatus());
+
+    Serial.print("Spool: ");
+    Serial.println(outbound_spool.getStatus());
+
+    Serial.print("Config: ");
+    Serial.println(config_store.getStatus());
+
+    // Estimated current against the alert latency it costs
+    Serial.print("Power: ");
+    Serial.println(power_governor.getStatus());
+    Serial.print("Sign load: ");
+    Serial.println(sign_load.getStatus());
+    Serial.print("Sign model: ");
+    Serial.println(sign_model.getStatus());
+
+    // Internal heap headroom is what DMA, ISRs and WiFi/TLS buffers draw on
+    Serial.print("Memory: ");
+    Serial.println(MemoryPolicy::getStatus());
+    Serial.print("Alert decoder: ");
+    Serial.println(AlertDecoder::getStatus());
+#ifdef SIGN_PROFILE
+    Serial.print("Hot path: ");
+    Serial.println(HotPath::getStatus());
+#endif
+
+    // Report multicast ingress counters (auth failures/replays point at misconfigured or hostile senders)
+    if (multicast_listener) {
+        Serial.print("Multicast: ");
+        Serial.println(multicast_listener->getStatus());
+    }
+
     // Check sign controller status
     if (sign_controller) {
         String sign_status = sign_controller->getStatus();
@@ -1114,35 +1983,331 @@ void performHealthCheck() {
 }
 
 /**
- * @brief Synchronize system time with NTP servers
- * 
- * Performs NTP time synchronization and updates the system clock.
- * Called periodically to maintain accurate time for clock display
- * and logging timestamps.
+ * @brief Refresh the sampled system gauges
+ *
+ * Event counters are updated where the events happen; heap, RSSI, uptime and
+ * OTA state are sampled here, from the health check and before each scrape.
  */
-void syncTime() {
-    Serial.println("Synchronizing time with NTP server...");
+void updateSystemMetrics() {
+    metric_heap_free.set(ESP.getFreeHeap());
+    metric_heap_min.set(ESP.getMinFreeHeap());
+    MemoryPolicy::updateMetrics();
+    metric_wifi_rssi.set(wifiConnected() ? WiFi.RSSI() : 0);
+    metric_uptime.set(SimClock::millis() / 1000);
+    metric_ota_available.set(ota_manager && ota_manager->isUpdateAvailable() ? 1 : 0);
+}
 
-    configTzTime(timezone_posix, ntp_server);
-    delay(1000); // Give NTP time to sync
+/**
+ * @brief Publish the metrics snapshot to ledSign/{device_id}/metrics
+ */
+void publishMetricsSnapshot() {
+    if (!mqtt_manager) {
+        return;
+    }
+    updateSystemMetrics();
+    String topic = "ledSign/" + device_id + "/metrics";
+    String payload = Metrics::snapshotJson();
+    mqtt_manager->publish(topic.c_str(), payload.c_str());
+}
 
+/**
+ * @brief React to a completed time sync (EVT_TIME_SYNCED)
+ * 
+ * SNTP resyncs in the background every TIMESYNC_INTERVAL_MS; this runs on
+ * the main task for each one. Shows the clock on the first sync (replaces
+ * the boot hello message) and after each resync, unless a priority message
+ * is up.
+ */
+void handleTimeSynced(const Event& event, void* context) {
     struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-        Serial.print("Time synchronized: ");
-        Serial.print(asctime(&timeinfo));
-        time_synced = true;
+    if (!readLocalTime(&timeinfo)) {
+        return;
+    }
 
-        // Display current time on sign
-        if (sign_controller && !sign_controller->isInPriorityMode()) {
-            sign_controller->displayClock();
-        }
+    Serial.print("Time synchronized: ");
+    Serial.print(asctime(&timeinfo));
+    SIM_EVENT("ntp", "synced");
+    time_synced = true;
+    traffic_capture.recordTimeSync(SimClock::now());
+    if (multicast_listener) {
+        multicast_listener->setClockValid(true);
+    }
+
+    // Display current time on sign
+    if (services_initialized && sign_controller && !sign_controller->isInPriorityMode()) {
+        sign_controller->displayClock();
+    }
+}
+
+/**
+ * @brief WiFiManager opened the config portal AP (from autoConnect() or a reopen)
+ */
+void handlePortalOpened() {
+    portal_open = true;
+    if (portal_opened_ms == 0) {
+        portal_opened_ms = millis();
+    }
+    metric_portal_boot_ms.set(millis());
+
+    Serial.print("WiFi: Config portal up ");
+    Serial.print(millis());
+    Serial.println(" ms after boot");
+    EventBus::publish(EVT_PORTAL_OPENED);
+}
+
+/**
+ * @brief The config portal closed: record portal-to-online, or reopen it if still offline
+ *
+ * The portal times out after CONFIG_PORTAL_TIMEOUT without a visit; it used
+ * to reboot the sign at that point, now it just starts over.
+ *
+ * @param online Whether WiFi is connected
+ */
+void closePortal(bool online) {
+    portal_open = false;
+    EventBus::publish(EVT_PORTAL_CLOSED, online ? 1 : 0);
+
+    if (online) {
+        uint32_t open_ms = millis() - portal_opened_ms;
+        metric_portal_online_ms.set(open_ms);
+        portal_opened_ms = 0;
+        Serial.print("WiFi: Connected ");
+        Serial.print(open_ms);
+        Serial.println(" ms after the config portal opened");
+        return;
+    }
+
+    Serial.println("WiFi: Config portal timed out - reopening");
+    wifiManager.startConfigPortal(SIGN_DEFAULT_SSID, SIGN_DEFAULT_PASS);
+}
+
+/**
+ * @brief Save the portal's MQTT/zone/HA fields as one config change (WiFiManager save callback)
+ */
+void savePortalParams() {
+    BulkJsonDocument portal_doc(512);
+    portal_doc["mqtt_server"] = custom_mqtt_server.getValue();
+    portal_doc["mqtt_port"] = custom_mqtt_port.getValue();
+    portal_doc["mqtt_user"] = custom_mqtt_user.getValue();
+    portal_doc["mqtt_pass"] = custom_mqtt_pass.getValue();
+    portal_doc["zone"] = custom_zone_name.getValue();
+    portal_doc["ha_server"] = custom_ha_mqtt_server.getValue();
+    portal_doc["ha_port"] = custom_ha_mqtt_port.getValue();
+
+    String portal_error;
+    config_store.apply(portal_doc.as<JsonObjectConst>(), portal_error);
+    if (portal_error.length() > 0) {
+        Serial.print("Config: Portal values not saved - ");
+        Serial.println(portal_error);
+    }
+    loadConfigGlobals();
+}
+
+/**
+ * @brief Copy the config store into the portal parameter globals (dynamicParams.h)
+ */
+void loadConfigGlobals() {
+    strlcpy(MQTT_Server, config_store.getString("mqtt_server"), sizeof(MQTT_Server));
+    strlcpy(MQTT_Port, config_store.getString("mqtt_port"), sizeof(MQTT_Port));
+    strlcpy(MQTT_User, config_store.getString("mqtt_user"), sizeof(MQTT_User));
+    strlcpy(MQTT_Pass, config_store.getString("mqtt_pass"), sizeof(MQTT_Pass));
+    strlcpy(Zone_Name, config_store.getString("zone"), sizeof(Zone_Name));
+    strlcpy(HA_MQTT_Server, config_store.getString("ha_server"), sizeof(HA_MQTT_Server));
+    strlcpy(HA_MQTT_Port, config_store.getString("ha_port"), sizeof(HA_MQTT_Port));
+}
+
+/**
+ * @brief Handle a command on ledSign/{device_id}/config/set
+ *
+ * {"set":{...}} commits a change set, {"rollback":N} restores version N, and
+ * anything else (e.g. {"get":true}) only republishes the state. With
+ * "if_version", set and rollback are refused unless the store is still at
+ * that version. The outcome goes to ledSign/{device_id}/config at once;
+ * handleConfigChanged() republishes it with the apply timing when done.
+ *
+ * @param payload JSON command
+ * @param length Payload length
+ */
+void handleConfigCommand(const uint8_t* payload, unsigned int length) {
+    BulkJsonDocument doc(1024);
+    String error;
+    uint32_t groups = 0;
+    bool change = false;
+
+    if (deserializeJson(doc, payload, length)) {
+        error = "invalid JSON";
+    } else if (!doc["if_version"].isNull() && (doc["if_version"] | 0UL) != config_store.getVersion()) {
+        error = "version is " + String(config_store.getVersion());
+    } else if (!doc["rollback"].isNull()) {
+        change = true;
+        groups = config_store.rollback(doc["rollback"] | 0UL, error);
+    } else if (doc["set"].is<JsonObject>()) {
+        change = true;
+        groups = config_store.apply(doc["set"].as<JsonObjectConst>(), error);
+    }
+
+    if (error.length() > 0) {
+        config_result = error;
     } else {
-        Serial.println("Warning: NTP synchronization failed");
-        if (sign_controller) {
-            sign_controller->displayError("NTP Sync Failed", 5);
+        config_result = change && groups == 0 ? "unchanged" : "ok";
+    }
+    Serial.print("Config: Command ");
+    Serial.println(config_result);
+    publishConfigState();
+}
+
+/**
+ * @brief Re-apply changed settings live (EVT_CONFIG_CHANGED, EVT_MQTT_CONNECTED)
+ *
+ * Each changed group goes to the module that owns it: sign timing and OTA
+ * settings are set in place; a zone change reloads the routing table and
+ * resubscribes (new topics before old ones are dropped); an HA broker
+ * change reconnects the secondary client; a primary broker change
+ * reconnects MQTT. The apply is finished, and its downtime recorded, once
+ * alerts can flow again. If the new broker has not answered within
+ * CONFIG_APPLY_TIMEOUT_MS the "config" component rolls the change back.
+ */
+void handleConfigChanged(const Event& event, void* context) {
+    if (event.type == EVT_MQTT_CONNECTED) {
+        // Retained state goes out once per boot, then after each command/apply
+        static bool state_published = false;
+        if (config_apply.awaiting_mqtt) {
+            finishConfigApply();
+        } else if (!state_published) {
+            publishConfigState();
+        }
+        state_published = true;
+        return;
+    }
+
+    uint32_t groups = config_store.takeChanges();
+    if (groups == 0) {
+        return;  // Already applied with an earlier event, or services started after it
+    }
+    loadConfigGlobals();
+
+    config_apply.version = config_store.getVersion();
+    config_apply.groups = groups;
+    config_apply.started_ms = SimClock::millis();
+    config_apply.downtime_ms = 0;
+    config_apply.rolled_back_from = config_rollback_from;
+    config_apply.awaiting_mqtt = false;
+    config_apply.restart_required = false;
+    config_rollback_from = 0;
+
+    Serial.print("Config: Applying version ");
+    Serial.println(config_apply.version);
+    SIM_EVENT("config", "apply");
+
+    if ((groups & CONFIG_GROUP_SIGN) && sign_controller) {
+        sign_controller->setPriorityWarningDuration(config_store.getInt("prio_warn_ms"));
+        sign_controller->setClockDuration(config_store.getInt("clock_ms"));
+        sign_load.setBudget(config_store.getInt("sign_budget_ma"));
+    }
+
+    if (groups & CONFIG_GROUP_POWER) {
+        power_governor.setLatencyBudget(config_store.getInt("power_budget_ms"));
+    }
+
+    if ((groups & CONFIG_GROUP_OTA) && ota_manager) {
+        ota_manager->setCheckInterval(config_store.getInt("ota_check_min") * 60000UL);
+        ota_manager->setAutoUpdate(config_store.getBool("ota_auto"));
+    }
+
+    if (groups & CONFIG_GROUP_HA) {
+        if (ha_mqtt_client) {
+            // An empty server leaves the client disconnected and unconfigured
+            ha_mqtt_client->forceReconnect();
+            if (ha_mqtt_client->configure(HA_MQTT_Server, atoi(HA_MQTT_Port))) {
+                ha_mqtt_client->begin();
+            }
+        } else if (strlen(HA_MQTT_Server) > 0) {
+            // HA was off at boot; discovery is wired up in initializeNetworkServices()
+            config_apply.restart_required = true;
         }
-        if (status_indicator) status_indicator->onError();
     }
+
+    if ((groups & CONFIG_GROUP_ZONE) && mqtt_manager) {
+        alert_router.load(ALERTROUTER_CONFIG_PATH, String(Zone_Name));
+        for (uint8_t i = 0; i < alert_router.count(); i++) {
+            if (alert_router.route(i).file && sign_controller) {
+                sign_controller->reserveFile(alert_router.route(i).file);
+            }
+        }
+        mqtt_manager->setZone(Zone_Name);
+        if (!(groups & CONFIG_GROUP_MQTT) && mqtt_manager->isConnected()) {
+            mqtt_manager->subscribeToTopics();
+        }
+    }
+
+    if ((groups & CONFIG_GROUP_MQTT) && mqtt_manager) {
+        strlcpy(mqtt_server, MQTT_Server, sizeof(mqtt_server));
+        mqtt_port = atoi(MQTT_Port);
+        strlcpy(mqtt_user, MQTT_User, sizeof(mqtt_user));
+        strlcpy(mqtt_pass, MQTT_Pass, sizeof(mqtt_pass));
+        bool use_tls = (mqtt_port != MQTT_BASIC_PORT);
+
+        // Leave the old broker before its client is replaced
+        mqtt_manager->forceReconnect();
+        if (mqtt_manager->configure(mqtt_server, mqtt_port, mqtt_user, mqtt_pass, use_tls)) {
+            config_apply.awaiting_mqtt = true;
+        }
+    }
+
+    if (!config_apply.awaiting_mqtt) {
+        finishConfigApply();
+    }
+}
+
+/**
+ * @brief Record how long the apply kept alerts away and report it
+ */
+void finishConfigApply() {
+    config_apply.awaiting_mqtt = false;
+    if (config_apply.groups & (CONFIG_GROUP_MQTT | CONFIG_GROUP_ZONE)) {
+        config_apply.downtime_ms = SimClock::millis() - config_apply.started_ms;
+    }
+    metric_config_downtime.set(config_apply.downtime_ms);
+
+    Serial.print("Config: Version ");
+    Serial.print(config_apply.version);
+    Serial.print(" applied, downtime ");
+    Serial.print(config_apply.downtime_ms);
+    Serial.println(" ms");
+    SIM_EVENT("config", "applied");
+    publishConfigState();
+}
+
+/**
+ * @brief Publish the config version, values (secrets masked) and last apply, retained
+ */
+void publishConfigState() {
+    if (!mqtt_manager) {
+        return;
+    }
+
+    BulkJsonDocument doc(1024);
+    doc["version"] = config_store.getVersion();
+    doc["result"] = config_result;
+    config_store.snapshot(doc.createNestedObject("values"));
+    if (config_apply.version > 0) {
+        JsonObject apply = doc.createNestedObject("apply");
+        apply["version"] = config_apply.version;
+        ConfigStore::groupNames(config_apply.groups, apply.createNestedArray("groups"));
+        apply["pending"] = config_apply.awaiting_mqtt;
+        apply["downtime_ms"] = config_apply.downtime_ms;
+        if (config_apply.rolled_back_from > 0) {
+            apply["rolled_back_from"] = config_apply.rolled_back_from;
+        }
+        if (config_apply.restart_required) {
+            apply["restart_required"] = true;
+        }
+    }
+
+    String payload;
+    serializeJson(doc, payload);
+    String topic = "ledSign/" + device_id + "/config";
+    mqtt_manager->publish(topic.c_str(), payload.c_str(), true);
 }
 
 /**
@@ -1161,6 +2326,9 @@ void handleSystemReset() {
     // Clear WiFi configuration (tzapu/WiFiManager)
     wifiManager.resetSettings();
 
+    // Broker, zone and timing settings back to defaults
+    config_store.reset();
+
     // Display reset message on sign
     if (sign_controller) {
         sign_controller->displayPriorityMessage("Factory Reset");
@@ -1173,36 +2341,123 @@ void handleSystemReset() {
 }
 
 /**
- * @brief Smart delay function that maintains background operations
- * 
- * Provides a non-blocking delay that continues to service WiFi management,
- * MQTT communication, and other background tasks during the delay period.
- * 
- * @param delay_ms Delay duration in milliseconds
+ * @brief Check WiFi association
+ *
+ * In the SIM_CLOCK build the scenario's "wifi up|down" state stands in for
+ * the radio, so offline mode and service start-up run without an access point.
+ *
+ * @return true if connected (or simulated as connected)
  */
-void smartDelay(unsigned long delay_ms) {
-    unsigned long start_time = millis();
+bool wifiConnected() {
+#ifdef SIM_CLOCK
+    return Simulation::isWiFiUp();
+#else
+    return WiFi.status() == WL_CONNECTED;
+#endif
+}
 
-    while (millis() - start_time < delay_ms) {
-        // tzapu/WiFiManager handles WiFi internally - no run() needed
+/**
+ * @brief Read local time once NTP has set the clock
+ * @param timeinfo Receives the broken-down local time
+ * @return true if the wall clock is valid
+ */
+bool readLocalTime(struct tm* timeinfo) {
+#ifdef SIM_CLOCK
+    time_t now = SimClock::now();
+    if (now < 1609459200) {  // Same "not synced yet" threshold as MQTTManager
+        return false;
+    }
+    localtime_r(&now, timeinfo);
+    return true;
+#else
+    return getLocalTime(timeinfo, 0);  // Never wait: callers run on the main loop
+#endif
+}
 
-        // Service MQTT if connected
-        if (mqtt_manager && services_initialized) {
-            mqtt_manager->loop();
-        }
+#ifdef SIM_CLOCK
+/**
+ * @brief Set up a virtual-clock run in place of WiFi provisioning
+ *
+ * Points MQTT at a placeholder broker (the scenario decides whether it
+ * answers), fixes the random seed so backoff jitter repeats run to run, and
+ * routes scenario traffic into the normal ingestion paths.
+ */
+void initializeSimulation() {
+    Serial.println("Simulation: Virtual-clock build - WiFi and multicast disabled, ESP-NOW simulated");
 
-        // Service sign controller
-        if (sign_controller) {
-            sign_controller->loop();
-        }
+    strcpy(MQTT_Server, SIM_MQTT_SERVER);
+    strcpy(MQTT_Port, "1883");
+    randomSeed(SIM_RANDOM_SEED);
+
+    // No SNTP client in this build: the scenario's ntp commands set the clock (TimeSync::reportSync)
+    setenv("TZ", timezone_posix, 1);
+    tzset();
 
-        // Small delay to prevent excessive CPU usage
-        delay(1);
+    // Remote frames come from the scenario's espnow lines (EspNowReceiver::injectFrame())
+    espnow_receiver = new EspNowReceiver();
+    if (espnow_receiver->begin()) {
+        espnow_receiver->setCommandCallback(handleRemoteCommand);
+    }
 
-        // Yield to other tasks
-        yield();
+    if (!simulation.loadFile(SIM_SCENARIO_PATH)) {
+        Serial.println("Simulation: Using built-in idle-day scenario");
+        simulation.loadString(SIM_DEFAULT_SCENARIO);
     }
+
+    simulation.setCommandCallback([](const String& command, const String& args) {
+        if (command == "alert") {
+            char topic[64];
+            snprintf(topic, sizeof(topic), "ledSign/%s/message", Zone_Name);
+            String payload = args;  // The handler parses in place
+            handleMQTTMessage(topic, (uint8_t*)payload.begin(), payload.length());
+        } else if (command == "mqtt") {
+            // Captured traffic (tools/capture_replay.py scenario): <topic> <payload>
+            int space = args.indexOf(' ');
+            String topic = args.substring(0, space);
+            String payload = args.substring(space + 1);
+            handleMQTTMessage((char*)topic.c_str(), (uint8_t*)payload.begin(), payload.length());
+        } else if (command == "priority") {
+            int space = args.indexOf(' ');
+            if (sign_controller && space > 0) {
+                sign_controller->displayPriorityMessage(args.substring(space + 1).c_str(), args.toInt());
+            }
+        } else if (command == "sequence") {
+            handleSequenceCommand(args.c_str(), 0);
+        } else if (command == "espnow" && espnow_receiver) {
+            // pair <seconds> | <mac> <hex frame>
+            int space = args.indexOf(' ');
+            String first = args.substring(0, space);
+            String rest = args.substring(space + 1);
+            rest.trim();
+            if (first == "pair") {
+                espnow_receiver->openPairingWindow(rest.toInt() * 1000UL);
+                return;
+            }
+            uint8_t mac[6];
+            uint8_t frame[EspNowReceiver::HEADER_SIZE + ESPNOW_MAX_TEXT + 1];
+            unsigned int m[6];
+            size_t len = 0;
+            if (sscanf(first.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x", &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != 6) {
+                SIM_EVENT("espnow", "bad scenario mac " + first);
+                return;
+            }
+            for (int i = 0; i < 6; i++) {
+                mac[i] = (uint8_t)m[i];
+            }
+            for (unsigned int i = 0; i + 1 < rest.length() && len < sizeof(frame); i += 2) {
+                unsigned int byte;
+                if (sscanf(rest.c_str() + i, "%2x", &byte) != 1) {
+                    break;
+                }
+                frame[len++] = (uint8_t)byte;
+            }
+            espnow_receiver->injectFrame(mac, frame, (int)len);
+        }
+    });
+
+    simulation.begin();
 }
+#endif
 
 /**
  * @brief Print comprehensive system information
@@ -1237,7 +2492,7 @@ void printSystemInfo() {
     Serial.println(" bytes");
     Serial.print("PSRAM Size: ");
     Serial.print(ESP.getPsramSize());
-    Serial.println(" bytes");
+    Serial.println(MemoryPolicy::hasPsram() ? " bytes (bulk buffers placed there)" : " bytes");
     
     // Network information
     Serial.print("MAC Address: ");
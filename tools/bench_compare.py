@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+Microbenchmark Results / Regression Gate for the LED Sign Controller
+
+Reads the output of the esp32dev_bench build (see bench/Bench.h) and compares
+it against the committed baseline, bench/baseline.json. The firmware prints
+one line per benchmark:
+
+    BENCH_BEGIN {"version":"0.6.0","cpu_mhz":240,...}
+    BENCH {"name":"BM_DisplayPreset_Critical","iterations":400000,"ns_per_op":118.4,...}
+    BENCH_END {"benchmarks":27}
+
+Input can be a captured serial log (anything else on the lines is ignored) or
+a results file previously written with -o. Results files use the Google
+Benchmark JSON layout ("context" + "benchmarks" with real_time/time_unit), so
+existing Google Benchmark tooling can read them.
+
+A benchmark regresses when its median time per iteration is more than
+--threshold percent above the baseline. Exit status: 0 = no regression,
+1 = regression, 2 = bad input or a run at another CPU clock than the
+baseline's. Until a reference board's baseline is committed, a run is printed
+and reported as "NO GATE" with status 0 (2 with --require-baseline, for CI
+once one exists). Stack growth over the
+baseline ("stack_bytes", the benchmark task's high-water mark) and heap lost
+during a benchmark are flagged but do not fail the gate.
+
+Requires: Python 3.6+ (standard library only)
+
+Usage:
+    # Capture from a board and gate against the baseline
+    pio run -e esp32dev_bench -t upload
+    pio device monitor -e esp32dev_bench | tee bench.log     # Ctrl-C after BENCH_END
+    python3 bench_compare.py bench.log
+
+    # Tighter gate, keep the parsed results
+    python3 bench_compare.py bench.log --threshold 5 -o bench-results.json
+
+    # Accept the current numbers as the new baseline (reference board only);
+    # the board name, CPU clock, build and git revision are kept in "context"
+    python3 bench_compare.py bench.log --update-baseline --board "esp32dev rev3 #1"
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "bench", "baseline.json")
+
+
+def parse_log(text):
+    """Parse BENCH lines from a serial log into a results document."""
+    context = {}
+    benchmarks = []
+    ended = False
+
+    for line in text.splitlines():
+        for tag in ("BENCH_BEGIN ", "BENCH_END ", "BENCH "):
+            pos = line.find(tag)
+            if pos < 0:
+                continue
+            try:
+                data = json.loads(line[pos + len(tag):].strip())
+            except ValueError:
+                print("bench_compare: skipping malformed line: %s" % line.strip(), file=sys.stderr)
+                break
+            if tag == "BENCH_BEGIN ":
+                # A reboot restarts the run: keep only the last complete one
+                context = data
+                benchmarks = []
+                ended = False
+            elif tag == "BENCH_END ":
+                ended = True
+            else:
+                benchmarks.append({
+                    "name": data["name"],
+                    "iterations": data["iterations"],
+                    "repetitions": data.get("repetitions", 1),
+                    "real_time": data["ns_per_op"],
+                    "min_time": data.get("min_ns", data["ns_per_op"]),
+                    "max_time": data.get("max_ns", data["ns_per_op"]),
+                    "time_unit": "ns",
+                    "heap_delta": data.get("heap_delta", 0),
+                    "stack_bytes": data.get("stack_bytes", 0),
+                })
+                if "label" in data:
+                    benchmarks[-1]["label"] = data["label"]
+            break
+
+    if benchmarks and not ended:
+        print("bench_compare: warning - no BENCH_END, run may be incomplete", file=sys.stderr)
+    return {"context": context, "benchmarks": benchmarks}
+
+
+def load_results(path):
+    """Load a results JSON file or parse a serial log."""
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+    stripped = text.lstrip()
+    if stripped.startswith("{"):
+        try:
+            doc = json.loads(stripped)
+            if "benchmarks" in doc:
+                return doc
+        except ValueError:
+            pass
+    return parse_log(text)
+
+
+def to_ns(bench):
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    return bench["real_time"] * scale.get(bench.get("time_unit", "ns"), 1.0)
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], cwd=os.path.dirname(DEFAULT_BASELINE),
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return ""
+
+
+def compare(results, baseline, threshold):
+    """Print a comparison table and return the number of regressions."""
+    base = {b["name"]: b for b in baseline["benchmarks"]}
+    seen = set()
+    regressions = 0
+
+    rc, bc = results.get("context", {}), baseline.get("context", {})
+    print("Baseline: %s, %s MHz, build %s (%s)" % (bc.get("board", "unknown board"), bc.get("cpu_mhz", "?"),
+                                                  bc.get("build", "?"), bc.get("git_revision", "?")))
+    if rc.get("psram_bytes", 0) != bc.get("psram_bytes", 0):
+        print("warning: PSRAM differs from baseline (%s vs %s bytes) - *Psram benchmarks are not comparable"
+              % (rc.get("psram_bytes", 0), bc.get("psram_bytes", 0)))
+
+    width = max([len(b["name"]) for b in results["benchmarks"]] + [9])
+    print("%-*s %12s %12s %9s" % (width, "benchmark", "baseline ns", "current ns", "change"))
+    for bench in results["benchmarks"]:
+        name = bench["name"]
+        seen.add(name)
+        current = to_ns(bench)
+        if name not in base:
+            print("%-*s %12s %12.1f %9s" % (width, name, "-", current, "new"))
+            continue
+
+        previous = to_ns(base[name])
+        change = (current - previous) / previous * 100.0 if previous else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        if bench.get("heap_delta", 0) < 0:
+            flag += "  heap %+d" % bench["heap_delta"]
+        stack, base_stack = bench.get("stack_bytes", 0), base[name].get("stack_bytes", 0)
+        if stack and base_stack and stack > base_stack:
+            flag += "  stack %+d" % (stack - base_stack)
+        if bench.get("label"):
+            flag += "  [%s]" % bench["label"]
+        print("%-*s %12.1f %12.1f %+8.1f%%%s" % (width, name, previous, current, change, flag))
+
+    for name in base:
+        if name not in seen:
+            print("%-*s %12.1f %12s %9s" % (width, name, to_ns(base[name]), "-", "missing"))
+
+    return regressions
+
+
+def print_results(results):
+    """Print the results alone (no baseline to compare with)."""
+    context = results.get("context", {})
+    print("Run: %s MHz, build %s" % (context.get("cpu_mhz", "?"), context.get("build", "?")))
+    width = max([len(b["name"]) for b in results["benchmarks"]] + [9])
+    print("%-*s %12s" % (width, "benchmark", "current ns"))
+    for bench in results["benchmarks"]:
+        print("%-*s %12.1f" % (width, bench["name"], to_ns(bench)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare esp32dev_bench results against the baseline")
+    parser.add_argument("input", help="serial log with BENCH lines, or a results JSON")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="baseline JSON (default bench/baseline.json)")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent before failing (default %(default)s)")
+    parser.add_argument("-o", "--output", help="write the parsed results as JSON")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write the results to the baseline instead of comparing")
+    parser.add_argument("--board", help="reference board the results came from (required with --update-baseline)")
+    parser.add_argument("--require-baseline", action="store_true",
+                        help="fail (exit 2) instead of reporting NO GATE when there is no baseline")
+    args = parser.parse_args()
+
+    results = load_results(args.input)
+    if not results["benchmarks"]:
+        print("bench_compare: no BENCH results in %s" % args.input, file=sys.stderr)
+        return 2
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2)
+            f.write("\n")
+
+    if args.update_baseline:
+        if not args.board:
+            print("bench_compare: --update-baseline needs --board (the reference board's name)", file=sys.stderr)
+            return 2
+        if not results["context"].get("cpu_mhz"):
+            print("bench_compare: no BENCH_BEGIN line in %s - capture the whole run" % args.input, file=sys.stderr)
+            return 2
+        results["context"]["board"] = args.board
+        results["context"]["git_revision"] = git_revision()
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=2)
+            f.write("\n")
+        print("Baseline updated: %d benchmarks -> %s" % (len(results["benchmarks"]), args.baseline))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        hint = ("no baseline at %s (capture one on the reference board and commit the output "
+                "of --update-baseline --board NAME)" % args.baseline)
+        if args.require_baseline:
+            print("bench_compare: " + hint, file=sys.stderr)
+            return 2
+        print_results(results)
+        print("NO GATE: %s - results not compared" % hint)
+        return 0
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    # Timings scale with the clock: a run at another speed says nothing about a regression
+    current_mhz = results.get("context", {}).get("cpu_mhz")
+    baseline_mhz = baseline.get("context", {}).get("cpu_mhz")
+    if current_mhz and baseline_mhz and current_mhz != baseline_mhz:
+        print("bench_compare: run at %s MHz, baseline at %s MHz - not comparable" % (current_mhz, baseline_mhz),
+              file=sys.stderr)
+        return 2
+
+    regressions = compare(results, baseline, args.threshold)
+    if regressions:
+        print("%d benchmark(s) regressed by more than %.1f%%" % (regressions, args.threshold))
+        return 1
+    print("No regressions (threshold %.1f%%)" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""
+Traffic Capture Replay Tool for the LED Sign Controller
+
+Works with the capture ring recorded by the firmware (src/TrafficCapture.h):
+inbound MQTT messages with arrival times, NTP syncs and every frame sent to
+the sign. A field capture is turned into a scenario for the virtual-clock
+build (esp32dev_sim), which re-feeds the messages through handleMQTTMessage()
+at the recorded times and prints its own capture when the scenario ends.
+Diffing the two frame streams shows whether the current firmware still does
+what the field unit did; diffing two replays (before/after a change) also
+compares message-to-frame latency in virtual time.
+
+Capture input for every command may be a binary file written by fetch, or a
+serial log containing the "CAPTURE {json}" lines of a SIM_CLOCK run.
+
+Requires: Python 3.7+ (standard library only; fetch reuses the MQTT client
+from load_generator.py)
+
+Usage:
+    # On the field unit: start capturing (survives reboots), later fetch it
+    mosquitto_pub -t ledSign/kitchen/capture -m start
+    python3 capture_replay.py fetch --broker 10.0.0.5 --zone kitchen -o field.cap
+
+    # Inspect it; write the raw sign stream for sign_emulator.py render
+    python3 capture_replay.py decode field.cap --frames-out field.uart
+
+    # Replay under the virtual clock
+    python3 capture_replay.py scenario field.cap -o ../data/sim.scn
+    pio run -e esp32dev_sim -t upload -t uploadfs
+    pio device monitor -e esp32dev_sim | tee replay.log   # until "TrafficCapture: Dump complete"
+
+    # Compare (exit 1 on any frame difference)
+    python3 capture_replay.py diff field.cap replay.log --ignore '\\d\\d:\\d\\d'
+    python3 capture_replay.py diff replay-old.log replay-new.log --tolerance-ms 50
+"""
+
+import argparse
+import base64
+import difflib
+import json
+import re
+import struct
+import sys
+import time
+
+SEGMENT_MAGIC = b"LSCP"
+FORMAT_VERSION = 1
+SEGMENT_HEADER = struct.Struct("<4sBI")
+RECORD_HEADER = struct.Struct("<BIH")
+EOT = 0x04
+
+CONTROL_NAMES = {0x00: "NUL", 0x01: "SOH", 0x02: "STX", 0x03: "ETX", 0x04: "EOT", 0x1B: "ESC"}
+
+
+# ---------------------------------------------------------------------------
+# Capture parsing
+# ---------------------------------------------------------------------------
+
+def assemble_chunks(chunks, source):
+    """Join {"seq","total","data"} dump chunks into the raw ring bytes."""
+    if not chunks:
+        sys.exit("%s: no capture data" % source)
+    total = max(c["total"] for c in chunks)
+    by_seq = {c["seq"]: c for c in chunks}
+    missing = [i for i in range(total) if i not in by_seq]
+    if missing:
+        sys.exit("%s: incomplete dump, missing chunks %s" % (source, missing[:10]))
+    return b"".join(base64.b64decode(by_seq[i]["data"]) for i in range(total))
+
+
+def load_raw(path):
+    """Read ring bytes from a binary capture or a serial log with CAPTURE lines."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(SEGMENT_MAGIC):
+        return data
+
+    chunks = []
+    for line in data.decode("utf-8", "replace").splitlines():
+        pos = line.find("CAPTURE {")
+        if pos < 0:
+            continue
+        try:
+            chunks.append(json.loads(line[pos + len("CAPTURE "):]))
+        except ValueError:
+            print("%s: skipping malformed CAPTURE line" % path, file=sys.stderr)
+    return assemble_chunks(chunks, path)
+
+
+def parse_ring(data):
+    """Split ring bytes into records (type, time_ms, body), oldest segment first."""
+    segments = []
+    pos = 0
+    while pos + SEGMENT_HEADER.size <= len(data):
+        magic, version, sequence = SEGMENT_HEADER.unpack_from(data, pos)
+        if magic != SEGMENT_MAGIC or version != FORMAT_VERSION:
+            raise ValueError("bad segment header at offset %d" % pos)
+        pos += SEGMENT_HEADER.size
+
+        records = []
+        while pos + RECORD_HEADER.size <= len(data) and data[pos:pos + 4] != SEGMENT_MAGIC:
+            kind, time_ms, length = RECORD_HEADER.unpack_from(data, pos)
+            pos += RECORD_HEADER.size
+            records.append((chr(kind), time_ms, data[pos:pos + length]))
+            pos += length
+        segments.append((sequence, records))
+
+    segments.sort(key=lambda s: s[0])
+    return [r for _, records in segments for r in records]
+
+
+def split_sessions(records):
+    """Group records by session ('S' record = capture start or reboot)."""
+    sessions = []
+    current = None
+    for kind, time_ms, body in records:
+        if kind == "S" or current is None:
+            info = {}
+            if kind == "S":
+                try:
+                    info = json.loads(body.decode("utf-8"))
+                except ValueError:
+                    pass
+            current = {"info": info, "start_ms": time_ms, "records": []}
+            sessions.append(current)
+            if kind == "S":
+                continue
+        current["records"].append((kind, time_ms, body))
+    return sessions
+
+
+def load_session(path, index):
+    sessions = split_sessions(parse_ring(load_raw(path)))
+    if not sessions:
+        sys.exit("%s: capture is empty" % path)
+    try:
+        return sessions[index]
+    except IndexError:
+        sys.exit("%s: no session %d (capture has %d)" % (path, index, len(sessions)))
+
+
+def frames_of(session):
+    """Join 'F' records into complete frames: list of (time_ms, bytes)."""
+    frames = []
+    pending, start = b"", None
+    for kind, time_ms, body in session["records"]:
+        if kind != "F":
+            continue
+        if not pending:
+            start = time_ms
+        pending += body
+        if pending and pending[-1] == EOT:
+            frames.append((start, pending))
+            pending = b""
+    if pending:
+        frames.append((start, pending))
+    return frames
+
+
+def messages_of(session):
+    """Inbound messages: list of (time_ms, topic, payload bytes)."""
+    messages = []
+    for kind, time_ms, body in session["records"]:
+        if kind == "M":
+            topic, _, payload = body.partition(b"\0")
+            messages.append((time_ms, topic.decode("utf-8", "replace"), payload))
+    return messages
+
+
+def frame_text(frame):
+    """Readable rendering of a sign frame: control bytes as <NAME>, others escaped."""
+    out = []
+    for b in frame.lstrip(b"\0"):
+        if b in CONTROL_NAMES:
+            out.append("<%s>" % CONTROL_NAMES[b])
+        elif 0x20 <= b < 0x7F:
+            out.append(chr(b))
+        else:
+            out.append("<%02X>" % b)
+    return "".join(out)
+
+
+# ---------------------------------------------------------------------------
+# Commands
+# ---------------------------------------------------------------------------
+
+def cmd_fetch(args):
+    from load_generator import MqttClient
+
+    chunks = {}
+    done = {"total": None}
+
+    def on_message(topic, payload):
+        try:
+            chunk = json.loads(payload.decode("utf-8"))
+        except ValueError:
+            return
+        chunks[chunk["seq"]] = chunk
+        done["total"] = chunk["total"]
+
+    client = MqttClient(args.broker, args.port, "capture-replay-%d" % int(time.time()),
+                        args.username, args.password, args.tls, args.cafile)
+    client.on_message = on_message
+    client.subscribe("ledSign/%s/capture/data" % args.device_id, qos=1)
+    time.sleep(0.5)
+    client.publish("ledSign/%s/capture" % args.zone, b"dump", qos=1)
+
+    deadline = time.monotonic() + args.timeout
+    while time.monotonic() < deadline:
+        if done["total"] is not None and len(chunks) >= done["total"]:
+            break
+        time.sleep(0.1)
+    client.close()
+
+    data = assemble_chunks(list(chunks.values()), "fetch")
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("Fetched %d bytes in %d chunks -> %s" % (len(data), len(chunks), args.output))
+    return 0
+
+
+def cmd_decode(args):
+    sessions = split_sessions(parse_ring(load_raw(args.capture)))
+    stream = b""
+    for index, session in enumerate(sessions):
+        print("session %d: %s" % (index, json.dumps(session["info"])))
+        base = session["start_ms"]
+        pending = b""
+        for kind, time_ms, body in session["records"]:
+            t = (time_ms - base) / 1000.0
+            if kind == "M":
+                topic, _, payload = body.partition(b"\0")
+                print("%10.3f  M  %s %s" % (t, topic.decode("utf-8", "replace"),
+                                             payload.decode("utf-8", "replace")))
+            elif kind == "F":
+                pending += body
+                if pending[-1] == EOT:
+                    print("%10.3f  F  %s" % (t, frame_text(pending)))
+                    stream += pending
+                    pending = b""
+            elif kind == "T":
+                print("%10.3f  T  ntp %d" % (t, struct.unpack("<I", body)[0]))
+            elif kind == "D":
+                print("%10.3f  D  %d records lost (staging full)" % (t, struct.unpack("<I", body)[0]))
+        print("  %d messages, %d frames" % (len(messages_of(session)), len(frames_of(session))))
+
+    if args.frames_out:
+        with open(args.frames_out, "wb") as f:
+            f.write(stream)
+        print("Sign stream (%d bytes) -> %s" % (len(stream), args.frames_out))
+    return 0
+
+
+def format_time(ms):
+    days, ms = divmod(int(ms), 86400000)
+    hours, ms = divmod(ms, 3600000)
+    minutes, ms = divmod(ms, 60000)
+    seconds, ms = divmod(ms, 1000)
+    return "%dd%02d:%02d:%02d.%03d" % (days, hours, minutes, seconds, ms)
+
+
+def cmd_scenario(args):
+    session = load_session(args.capture, args.session)
+    messages = messages_of(session)
+    if not messages:
+        sys.exit("%s: session %d has no messages" % (args.capture, args.session))
+
+    # First message lands --lead seconds into the run, after start-up has settled
+    base = messages[0][0] - int(args.lead * 1000)
+    steps = []
+
+    epoch = session["info"].get("epoch", 0)
+    if epoch > 1609459200:
+        steps.append((0, "ntp %d" % (epoch + max(0, base - session["start_ms"]) // 1000)))
+    for kind, time_ms, body in session["records"]:
+        if kind == "T":
+            # A sync before the scenario starts is carried forward to time 0
+            offset = max(0, base - time_ms) // 1000
+            steps.append((max(0, time_ms - base), "ntp %d" % (struct.unpack("<I", body)[0] + offset)))
+
+    skipped = 0
+    for time_ms, topic, payload in messages:
+        text = payload.decode("utf-8", "replace")
+        if "\n" in text or "\r" in text:
+            try:
+                text = json.dumps(json.loads(text), separators=(",", ":"), ensure_ascii=False)
+            except ValueError:
+                skipped += 1
+                continue
+        if " " in topic or not text.strip():
+            skipped += 1
+            continue
+        steps.append((time_ms - base, "mqtt %s %s" % (topic, text)))
+
+    last = max(t for t, _ in steps)
+    steps.sort(key=lambda s: s[0])
+
+    lines = ["# Replay of %s session %d (%s)" % (args.capture, args.session, json.dumps(session["info"])),
+             "# Generated by tools/capture_replay.py scenario"]
+    lines += ["%s %s" % (format_time(t), command) for t, command in steps]
+    lines.append("%s end" % format_time(last + int(args.tail * 1000)))
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print("%d messages -> %s (%d skipped)" % (len(messages) - skipped, args.output, skipped))
+    if len(steps) > 512:
+        print("warning: %d steps exceeds SIM_MAX_STEPS (512); raise it or split the capture" % len(steps))
+    return 0
+
+
+def latencies(session):
+    """Per frame: ms since the latest preceding inbound message (None before the first)."""
+    messages = [t for t, _, _ in messages_of(session)]
+    result = []
+    index = -1
+    for time_ms, frame in frames_of(session):
+        while index + 1 < len(messages) and messages[index + 1] <= time_ms:
+            index += 1
+        result.append((frame, time_ms - messages[index] if index >= 0 else None))
+    return [(frame, lat) for frame, lat in result if lat is not None]
+
+
+def cmd_diff(args):
+    sides = []
+    for path, index in ((args.recorded, args.session), (args.replayed, args.replay_session)):
+        session = load_session(path, index)
+        entries = latencies(session)
+        keys = []
+        for frame, _ in entries:
+            text = frame_text(frame)
+            for pattern in args.ignore:
+                text = re.sub(pattern, "*", text)
+            keys.append(text)
+        sides.append((path, entries, keys))
+
+    (path_a, entries_a, keys_a), (path_b, entries_b, keys_b) = sides
+    print("%s: %d frames after first message" % (path_a, len(keys_a)))
+    print("%s: %d frames after first message" % (path_b, len(keys_b)))
+
+    differences = 0
+    timing = []
+    matcher = difflib.SequenceMatcher(None, keys_a, keys_b, autojunk=False)
+    for op, a1, a2, b1, b2 in matcher.get_opcodes():
+        if op == "equal":
+            for i, j in zip(range(a1, a2), range(b1, b2)):
+                timing.append((keys_a[i], entries_a[i][1], entries_b[j][1]))
+            continue
+        differences += max(a2 - a1, b2 - b1)
+        if differences - max(a2 - a1, b2 - b1) < args.max_report:
+            for i in range(a1, a2):
+                print("- [%d] %s" % (i, keys_a[i]))
+            for j in range(b1, b2):
+                print("+ [%d] %s" % (j, keys_b[j]))
+
+    late = [t for t in timing if args.tolerance_ms >= 0 and abs(t[2] - t[1]) > args.tolerance_ms]
+    if timing:
+        deltas = [b - a for _, a, b in timing]
+        print("latency delta (replayed - recorded) ms: min %d, max %d, mean %.1f over %d frames" %
+              (min(deltas), max(deltas), sum(deltas) / len(deltas), len(deltas)))
+    for text, a, b in late[:args.max_report]:
+        print("timing: %d ms -> %d ms  %s" % (a, b, text))
+
+    if differences:
+        print("%d frame difference(s)" % differences)
+    if late:
+        print("%d frame(s) outside +/-%d ms" % (len(late), args.tolerance_ms))
+    if differences or late:
+        return 1
+    print("Frames match")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay and diff LED sign traffic captures")
+    sub = parser.add_subparsers(dest="command")
+
+    p = sub.add_parser("fetch", help="dump the capture ring from a sign over MQTT")
+    p.add_argument("--broker", default="127.0.0.1", help="MQTT broker host")
+    p.add_argument("--port", type=int, default=1883, help="MQTT broker port")
+    p.add_argument("--username", help="MQTT username")
+    p.add_argument("--password", help="MQTT password")
+    p.add_argument("--tls", action="store_true", help="connect with TLS")
+    p.add_argument("--cafile", help="CA certificate for --tls")
+    p.add_argument("--zone", required=True, help="sign zone (command topic ledSign/{zone}/capture)")
+    p.add_argument("--device-id", default="+", help="device ID for the data topic (default: any)")
+    p.add_argument("--timeout", type=float, default=60.0, help="seconds to wait for all chunks")
+    p.add_argument("-o", "--output", required=True, help="binary capture file to write")
+
+    p = sub.add_parser("decode", help="print a capture")
+    p.add_argument("capture", help="binary capture or serial log")
+    p.add_argument("--frames-out", help="write the raw sign byte stream (for sign_emulator.py render)")
+
+    p = sub.add_parser("scenario", help="convert a capture session into an esp32dev_sim scenario")
+    p.add_argument("capture", help="binary capture or serial log")
+    p.add_argument("--session", type=int, default=-1, help="session index (default: last)")
+    p.add_argument("--lead", type=float, default=10.0, help="seconds before the first message (default 10)")
+    p.add_argument("--tail", type=float, default=120.0, help="seconds after the last message (default 120)")
+    p.add_argument("-o", "--output", required=True, help="scenario file (copy to data/sim.scn)")
+
+    p = sub.add_parser("diff", help="compare the frames of two captures")
+    p.add_argument("recorded", help="reference capture (e.g. from the field)")
+    p.add_argument("replayed", help="capture to check (e.g. esp32dev_sim serial log)")
+    p.add_argument("--session", type=int, default=-1, help="session in the reference (default: last)")
+    p.add_argument("--replay-session", type=int, default=-1, help="session in the replay (default: last)")
+    p.add_argument("--ignore", action="append", default=[],
+                   help="regex masked in frame text before comparing (repeatable)")
+    p.add_argument("--tolerance-ms", type=int, default=-1,
+                   help="fail when message-to-frame latency differs by more (default: report only)")
+    p.add_argument("--max-report", type=int, default=20, help="differences to print")
+
+    args = parser.parse_args()
+    commands = {"fetch": cmd_fetch, "decode": cmd_decode, "scenario": cmd_scenario, "diff": cmd_diff}
+    if args.command not in commands:
+        parser.print_help()
+        return 2
+    return commands[args.command](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Alert Schema Generator for the LED Sign Controller
+
+Generates src/AlertSchema.h, the tables behind the single-pass alert decoder
+(src/AlertDecoder.h):
+
+  - a perfect hash of the alert keys (title, message, display_config.*, ...):
+    slot = (first * A + last * B + length * C) & (SLOTS - 1), with A, B, C
+    searched so that no two keys share a slot
+  - the valid protocol code sets for display_config, read from the BB_*
+    defines in lib/BETABRITE/BBDEFS.h, as 128-bit ASCII bitmaps
+
+Re-run after adding a key to ALERT_KEYS or changing BBDEFS.h.
+
+Requires: Python 3.7+ (standard library only)
+
+Usage:
+    python3 tools/gen_alert_schema.py                      # writes src/AlertSchema.h
+    python3 tools/gen_alert_schema.py --check              # exit 1 if the header is stale
+"""
+
+import argparse
+import itertools
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+BBDEFS = os.path.join(ROOT, "lib", "BETABRITE", "BBDEFS.h")
+OUTPUT = os.path.join(ROOT, "src", "AlertSchema.h")
+
+# (key, scope, enum name) - scope 0 = alert object, 1 = display_config object
+ALERT_KEYS = [
+    ("title", 0, "ALERTKEY_TITLE"),
+    ("message", 0, "ALERTKEY_MESSAGE"),
+    ("level", 0, "ALERTKEY_LEVEL"),
+    ("category", 0, "ALERTKEY_CATEGORY"),
+    ("id", 0, "ALERTKEY_ID"),
+    ("timestamp", 0, "ALERTKEY_TIMESTAMP"),
+    ("expires", 0, "ALERTKEY_EXPIRES"),
+    ("zone", 0, "ALERTKEY_ZONE"),
+    ("echo", 0, "ALERTKEY_ECHO"),
+    ("display_config", 0, "ALERTKEY_DISPLAY_CONFIG"),
+    ("mode_code", 1, "ALERTKEY_MODE_CODE"),
+    ("color_code", 1, "ALERTKEY_COLOR_CODE"),
+    ("charset_code", 1, "ALERTKEY_CHARSET_CODE"),
+    ("position_code", 1, "ALERTKEY_POSITION_CODE"),
+    ("speed_code", 1, "ALERTKEY_SPEED_CODE"),
+    ("effect_code", 1, "ALERTKEY_EFFECT_CODE"),
+    ("priority", 1, "ALERTKEY_PRIORITY"),
+    ("duration", 1, "ALERTKEY_DURATION"),
+]
+
+# Code set name -> BBDEFS.h define prefix (speed: the five speed codes only)
+CODE_SETS = [
+    ("ALERT_CODES_MODE", r"BB_DM_"),
+    ("ALERT_CODES_COLOR", r"BB_COL_"),
+    ("ALERT_CODES_CHARSET", r"BB_CS_"),
+    ("ALERT_CODES_POSITION", r"BB_DP_"),
+    ("ALERT_CODES_SPEED", r"BB_FC_SPEED[1-5]$"),
+    ("ALERT_CODES_EFFECT", r"BB_SDM_"),
+]
+
+
+def parse_char_literal(text):
+    """Value of a C character literal: 'a', '\\040', '\\x1c'."""
+    body = text[1:-1]
+    if body.startswith("\\x"):
+        return int(body[2:], 16)
+    if body.startswith("\\") and body[1:].isdigit():
+        return int(body[1:], 8)
+    if body.startswith("\\"):
+        return ord({"n": "\n", "r": "\r", "t": "\t", "\\": "\\", "'": "'"}.get(body[1], body[1]))
+    return ord(body)
+
+
+def read_code_sets(path):
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"\s*#define\s+(BB_\w+)\s+('(?:\\.|[^'])+')", line)
+            if m:
+                defines[m.group(1)] = parse_char_literal(m.group(2))
+
+    sets = []
+    for name, pattern in CODE_SETS:
+        values = sorted({v for k, v in defines.items() if re.match(pattern, k) and v < 128})
+        if not values:
+            sys.exit("gen_alert_schema: no %s defines in %s" % (pattern, path))
+        sets.append((name, pattern, values))
+    return sets
+
+
+def find_hash(keys):
+    """Smallest power-of-two table and multipliers with no collisions."""
+    for bits in range(5, 9):
+        slots = 1 << bits
+        for a, b, c in itertools.product(range(1, 32), repeat=3):
+            seen = set()
+            for key, _, _ in keys:
+                slot = (ord(key[0]) * a + ord(key[-1]) * b + len(key) * c) & (slots - 1)
+                if slot in seen:
+                    break
+                seen.add(slot)
+            else:
+                return slots, a, b, c
+    sys.exit("gen_alert_schema: no perfect hash found")
+
+
+def render(keys, sets, slots, a, b, c):
+    table = [None] * slots
+    for key, scope, enum in keys:
+        table[(ord(key[0]) * a + ord(key[-1]) * b + len(key) * c) & (slots - 1)] = (key, scope, enum)
+    longest = max(len(k) for k, _, _ in keys)
+
+    out = []
+    out.append("/**")
+    out.append(" * @file AlertSchema.h")
+    out.append(" * @brief Alert key perfect hash and display_config code sets")
+    out.append(" *")
+    out.append(" * Generated by tools/gen_alert_schema.py from its key list and")
+    out.append(" * lib/BETABRITE/BBDEFS.h - do not edit by hand.")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef ALERT_SCHEMA_H")
+    out.append("#define ALERT_SCHEMA_H")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("enum AlertKey : uint8_t {")
+    out.append("    ALERTKEY_NONE,")
+    for _, _, enum in keys:
+        out.append("    %s," % enum)
+    out.append("    ALERTKEY_COUNT")
+    out.append("};")
+    out.append("")
+    out.append("#define ALERT_KEY_SCOPE_ALERT     0         // Keys of the alert object")
+    out.append("#define ALERT_KEY_SCOPE_DISPLAY   1         // Keys of display_config")
+    out.append("#define ALERT_KEY_MAX_LEN         %d" % longest)
+    out.append("#define ALERT_KEY_SLOTS           %d" % slots)
+    out.append("#define ALERT_KEY_SLOT(first, last, length) \\")
+    out.append("    ((((uint32_t)(uint8_t)(first)) * %d + ((uint32_t)(uint8_t)(last)) * %d + (uint32_t)(length) * %d) & %d)"
+               % (a, b, c, slots - 1))
+    out.append("")
+    out.append("struct AlertKeySlot {")
+    out.append("    const char* name;                   ///< nullptr = empty slot")
+    out.append("    uint8_t length;")
+    out.append("    uint8_t scope;")
+    out.append("    AlertKey key;")
+    out.append("};")
+    out.append("")
+    out.append("static const AlertKeySlot ALERT_KEY_TABLE[ALERT_KEY_SLOTS] = {")
+    for entry in table:
+        if entry:
+            key, scope, enum = entry
+            out.append('    {"%s", %d, %d, %s},' % (key, len(key), scope, enum))
+        else:
+            out.append("    {nullptr, 0, 0, ALERTKEY_NONE},")
+    out.append("};")
+    out.append("")
+    out.append("// Valid first characters per display_config code, bit (c & 31) of word (c >> 5)")
+    for name, pattern, values in sets:
+        words = [0, 0, 0, 0]
+        for v in values:
+            words[v >> 5] |= 1 << (v & 31)
+        shown = "".join(chr(v) if 32 < v < 127 else "\\%03o" % v for v in values)
+        out.append("static const uint32_t %s[4] = {0x%08X, 0x%08X, 0x%08X, 0x%08X};  // %s: %s"
+                   % ((name,) + tuple(words) + (pattern.rstrip("$"), shown)))
+    out.append("")
+    out.append("#endif // ALERT_SCHEMA_H")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate src/AlertSchema.h")
+    parser.add_argument("--check", action="store_true", help="exit 1 if the header differs")
+    parser.add_argument("-o", "--output", default=OUTPUT)
+    args = parser.parse_args()
+
+    sets = read_code_sets(BBDEFS)
+    slots, a, b, c = find_hash(ALERT_KEYS)
+    text = render(ALERT_KEYS, sets, slots, a, b, c)
+
+    if args.check:
+        try:
+            with open(args.output) as f:
+                current = f.read()
+        except OSError:
+            current = ""
+        if current != text:
+            print("gen_alert_schema: %s is stale - re-run tools/gen_alert_schema.py" % args.output)
+            return 1
+        return 0
+
+    with open(args.output, "w") as f:
+        f.write(text)
+    print("gen_alert_schema: %d keys in %d slots (A=%d B=%d C=%d) -> %s"
+          % (len(ALERT_KEYS), slots, a, b, c, args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
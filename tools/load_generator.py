@@ -0,0 +1,603 @@
+#!/usr/bin/env python3
+"""
+Load Generator / Soak Harness for the LED Sign Controller
+
+Publishes configurable alert mixes to a local MQTT broker (e.g. mosquitto on
+a bench machine) and measures what the controller does with them. Every
+alert carries "echo": true and a unique id; the firmware answers each one on
+ledSign/{device_id}/echo with its outcome, handler time, free/minimum heap
+and total bytes written to the sign (see publishLoadEcho() in main.cpp).
+
+Reported per run:
+    - end-to-end latency (publish -> echo received) p50/p95/p99/max
+    - drops (no echo before the drain timeout), rejections, duplicates
+    - device handler time, heap low-water mark, sign bytes per alert
+
+Use the same arguments and --seed against two firmware revisions and compare
+the --json-out files.
+
+Without a bench sign and broker, the same load runs on the virtual-clock build
+(pio run -e esp32dev_sim, see src/Simulation.h): --sim-scenario writes the
+alert schedule as a scenario, and --sim-log scores the run from the "SIM ...
+echo" lines that build prints. Alert ids and timestamps then derive from the
+seed, so a run repeats exactly. The scenario feeds the MQTT handler directly at
+the alert's virtual time, so publish -> echo latency is always ~0 there; the
+latency figures of a simulated run are the device's measured handler time
+(handle_us) instead. QoS1 redelivery becomes a plain resend of the same
+payload, since the DUP flag is not modelled. The simulation holds at most
+SIM_MAX_STEPS scenario commands in RAM, so a longer schedule is cut to the
+first alerts that fit (and the output says so); soak longer runs live.
+
+Requires: Python 3.7+ (standard library only; includes a minimal MQTT 3.1.1
+client so that QoS1 redelivery storms can be generated with the DUP flag)
+
+Usage:
+    # Point a bench sign at the local broker (no TLS), zone "bench"
+    mosquitto -p 1883 -v
+
+    # 2 alerts/s for 60 s, default level mix
+    python3 load_generator.py --broker 127.0.0.1 --zone bench --rate 2 --duration 60
+
+    # Burst of 20 every 30 s on top of 1/s, 200-400 char messages, 1 h soak
+    python3 load_generator.py --zone bench --rate 1 --burst 20@30 --size 200-400 --duration 3600
+
+    # QoS1 redelivery storm: each alert re-sent 5 times with DUP set
+    python3 load_generator.py --zone bench --rate 5 --count 100 --redeliver 5 --json-out rev-a.json
+
+    # Same mix on the virtual-clock build, no device network or broker
+    python3 load_generator.py --rate 2 --count 200 --sim-scenario data/sim.scn
+    pio run -e esp32dev_sim -t uploadfs -t upload && pio device monitor -e esp32dev_sim | tee sim.log
+    python3 load_generator.py --rate 2 --count 200 --sim-log sim.log --json-out sim.json
+"""
+
+import argparse
+import json
+import random
+import re
+import socket
+import ssl
+import statistics
+import struct
+import sys
+import threading
+import time
+
+LEVELS = ["critical", "warning", "notice", "info"]
+CATEGORIES = ["security", "weather", "automation", "system", "network", "personal", "application"]
+SIM_EPOCH = 1704067200   # 2024-01-01 00:00:00 UTC, wall clock of a generated scenario
+SIM_SETTLE_S = 30        # Scenario time of the first alert, once the simulated broker session is up
+SIM_MAX_STEPS = 512      # Simulation.h: scenario commands after repeat expansion
+SIM_LINE = re.compile(r"^SIM (\d+)d (\d+):(\d+):(\d+)\.(\d+) (\S+) (.*)$")
+WORDS = ("sign controller alert load test message payload weather door garage "
+         "sensor motion network backup complete warning notice front back").split()
+
+
+# ---------------------------------------------------------------------------
+# Minimal MQTT 3.1.1 client
+# ---------------------------------------------------------------------------
+
+def encode_length(n):
+    out = bytearray()
+    while True:
+        byte = n % 128
+        n //= 128
+        out.append(byte | (0x80 if n else 0))
+        if not n:
+            return bytes(out)
+
+
+def encode_string(s):
+    data = s.encode("utf-8") if isinstance(s, str) else s
+    return struct.pack(">H", len(data)) + data
+
+
+class MqttClient:
+    """Just enough MQTT for publishing, QoS1 acks and one subscription."""
+
+    def __init__(self, host, port, client_id, username=None, password=None,
+                 tls=False, cafile=None, keepalive=60):
+        sock = socket.create_connection((host, port), timeout=10)
+        if tls:
+            context = ssl.create_default_context(cafile=cafile)
+            if not cafile:
+                context.check_hostname = False
+                context.verify_mode = ssl.CERT_NONE
+            sock = context.wrap_socket(sock, server_hostname=host)
+        sock.settimeout(None)
+        self.sock = sock
+        self.lock = threading.Lock()
+        self.next_pid = 1
+        self.inflight = {}
+        self.on_message = None
+        self.keepalive = keepalive
+        self.closed = False
+
+        flags = 0x02  # Clean session
+        payload = encode_string(client_id)
+        if username:
+            flags |= 0x80
+            payload += encode_string(username)
+        if password:
+            flags |= 0x40
+            payload += encode_string(password)
+        variable = encode_string("MQTT") + bytes([4, flags]) + struct.pack(">H", keepalive)
+        self._send(0x10, variable + payload)
+
+        kind, body = self._read_packet()
+        if kind >> 4 != 2 or len(body) < 2 or body[1] != 0:
+            raise ConnectionError("broker refused connection (CONNACK %s)" % body.hex())
+
+        threading.Thread(target=self._reader, daemon=True).start()
+        threading.Thread(target=self._pinger, daemon=True).start()
+
+    def _send(self, header, body):
+        with self.lock:
+            self.sock.sendall(bytes([header]) + encode_length(len(body)) + body)
+
+    def _read_exact(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.sock.recv(n - len(data))
+            if not chunk:
+                raise ConnectionError("broker closed connection")
+            data += chunk
+        return data
+
+    def _read_packet(self):
+        header = self._read_exact(1)[0]
+        length, shift = 0, 0
+        while True:
+            byte = self._read_exact(1)[0]
+            length |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        return header, self._read_exact(length) if length else b""
+
+    def _reader(self):
+        try:
+            while not self.closed:
+                header, body = self._read_packet()
+                kind = header >> 4
+                if kind == 3:  # PUBLISH
+                    qos = (header >> 1) & 0x03
+                    tlen = struct.unpack(">H", body[:2])[0]
+                    topic = body[2:2 + tlen].decode("utf-8", "replace")
+                    pos = 2 + tlen
+                    if qos:
+                        pid = body[pos:pos + 2]
+                        pos += 2
+                        self._send(0x40, pid)
+                    if self.on_message:
+                        self.on_message(topic, body[pos:])
+                elif kind == 4:  # PUBACK
+                    pid = struct.unpack(">H", body[:2])[0]
+                    self.inflight.pop(pid, None)
+        except (ConnectionError, OSError):
+            if not self.closed:
+                print("MQTT: connection lost", file=sys.stderr)
+
+    def _pinger(self):
+        while not self.closed:
+            time.sleep(self.keepalive / 2.0)
+            try:
+                self._send(0xC0, b"")
+            except OSError:
+                return
+
+    def subscribe(self, topic, qos=0):
+        pid = self._pid()
+        self._send(0x82, struct.pack(">H", pid) + encode_string(topic) + bytes([qos]))
+
+    def _pid(self):
+        with self.lock:
+            pid = self.next_pid
+            self.next_pid = pid % 65535 + 1
+        return pid
+
+    def publish(self, topic, payload, qos=0, redeliver=0):
+        """Publish; with QoS1 and redeliver>0 the same packet is re-sent with DUP set."""
+        body = encode_string(topic)
+        pid = None
+        if qos:
+            pid = self._pid()
+            body += struct.pack(">H", pid)
+            self.inflight[pid] = time.monotonic()
+        body += payload
+        self._send(0x30 | (qos << 1), body)
+        for _ in range(redeliver if qos else 0):
+            self._send(0x38 | (qos << 1), body)
+        return 1 + (redeliver if qos else 0)
+
+    def close(self):
+        self.closed = True
+        try:
+            self._send(0xE0, b"")
+            self.sock.close()
+        except OSError:
+            pass
+
+
+# ---------------------------------------------------------------------------
+# Load generation
+# ---------------------------------------------------------------------------
+
+def parse_mix(text):
+    weights = {}
+    for part in text.split(","):
+        level, _, weight = part.partition("=")
+        if level not in LEVELS:
+            raise ValueError("unknown level '%s'" % level)
+        weights[level] = float(weight or 1)
+    return weights
+
+
+def parse_range(text):
+    low, _, high = text.partition("-")
+    return int(low), int(high or low)
+
+
+def sim_time(seconds):
+    """Scenario time [Nd]HH:MM:SS.mmm (Simulation.h)"""
+    ms = int(round(seconds * 1000))
+    days, ms = divmod(ms, 86400000)
+    text = "%02d:%02d:%02d.%03d" % (ms // 3600000, ms // 60000 % 60, ms // 1000 % 60, ms % 1000)
+    return "%dd%s" % (days, text) if days else text
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+class LoadRun:
+    def __init__(self, args):
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.simulated = bool(args.sim_scenario or args.sim_log)
+        if self.simulated:
+            # The simulated device boots fresh each run, so the id only has to repeat
+            self.run_id = "sim%05d" % args.seed
+        else:
+            # Unique per run even with a fixed seed, so the device's duplicate filter never matches
+            self.run_id = "%08x" % random.SystemRandom().getrandbits(32)
+        self.mix = parse_mix(args.mix)
+        self.size = parse_range(args.size)
+        self.sent = {}          # id -> (send time, level)
+        self.echoed = {}        # id -> first echo dict (with latency)
+        self.duplicate_echoes = 0
+        self.publishes = 0
+        self.lock = threading.Lock()
+        self.last_echo = {}
+        self.scheduled = 0      # Alerts in the schedule before the simulation cap
+
+    def make_alert(self, seq, at=0.0):
+        level = self.rng.choices(list(self.mix), weights=list(self.mix.values()))[0]
+        length = self.rng.randint(*self.size)
+        words = []
+        while len(" ".join(words)) < length:
+            words.append(self.rng.choice(WORDS))
+        alert = {
+            "id": "lg-%s-%06d" % (self.run_id, seq),
+            "echo": True,
+            "level": level,
+            "category": self.rng.choice(CATEGORIES),
+            "title": "Load %d" % seq,
+            "message": " ".join(words)[:length],
+            "timestamp": SIM_EPOCH + SIM_SETTLE_S + int(at) if self.simulated else int(time.time()),
+            "zone": self.args.zone,
+        }
+        return alert
+
+    def on_echo(self, topic, payload, now=None, arrived=None):
+        if now is None:
+            now = time.monotonic()
+        try:
+            echo = json.loads(payload)
+        except ValueError:
+            return
+        alert_id = echo.get("id", "")
+        with self.lock:
+            if alert_id not in self.sent:
+                return
+            self.last_echo = echo
+            if alert_id in self.echoed:
+                self.duplicate_echoes += 1
+                return
+            start = arrived.get(alert_id, now) if arrived is not None else self.sent[alert_id][0]
+            echo["latency_ms"] = (now - start) * 1000.0
+            echo["level"] = self.sent[alert_id][1]
+            self.echoed[alert_id] = echo
+
+    def schedule(self):
+        """Yield send times (seconds from start) for steady rate plus bursts."""
+        args = self.args
+        burst_n, burst_every = 0, 0.0
+        if args.burst:
+            n, _, every = args.burst.partition("@")
+            burst_n, burst_every = int(n), float(every)
+
+        times = []
+        limit = args.duration if args.duration else float("inf")
+        t = 0.0
+        if args.rate > 0:
+            while t < limit and (not args.count or len(times) < args.count):
+                times.append(t)
+                t += self.rng.expovariate(args.rate) if args.poisson else 1.0 / args.rate
+        if burst_n and burst_every > 0 and args.duration:
+            b = burst_every
+            while b < limit:
+                times += [b] * burst_n
+                b += burst_every
+        return sorted(times)
+
+    def run(self, publisher, report_every):
+        args = self.args
+        topic = "ledSign/%s/message" % args.zone
+        times = self.schedule()
+        if not times:
+            raise ValueError("nothing to send (set --rate with --duration or --count, or --burst)")
+
+        start = time.monotonic()
+        next_report = report_every
+        for seq, at in enumerate(times):
+            delay = start + at - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            alert = self.make_alert(seq)
+            payload = json.dumps(alert, separators=(",", ":")).encode("utf-8")
+            with self.lock:
+                self.sent[alert["id"]] = (time.monotonic(), alert["level"])
+            self.publishes += publisher.publish(topic, payload, args.qos, args.redeliver)
+
+            elapsed = time.monotonic() - start
+            if report_every and elapsed >= next_report:
+                with self.lock:
+                    echoed = len(self.echoed)
+                    heap = self.last_echo.get("heap_free", "?")
+                print("[%6.0fs] sent=%d echoed=%d heap_free=%s" % (elapsed, seq + 1, echoed, heap))
+                next_report += report_every
+
+        self.send_duration = time.monotonic() - start
+        deadline = time.monotonic() + args.drain
+        while time.monotonic() < deadline:
+            with self.lock:
+                if len(self.echoed) >= len(self.sent):
+                    break
+            time.sleep(0.1)
+
+    def sim_schedule(self):
+        """Schedule cut to what fits in SIM_MAX_STEPS (ntp + end + each alert's copies)."""
+        times = self.schedule()
+        if not times:
+            raise ValueError("nothing to send (set --rate with --duration or --count, or --burst)")
+        copies = 1 + (self.args.redeliver if self.args.qos else 0)
+        fit = (SIM_MAX_STEPS - 2) // copies
+        if fit < 1:
+            raise ValueError("--redeliver %d leaves no room in SIM_MAX_STEPS (%d)"
+                             % (self.args.redeliver, SIM_MAX_STEPS))
+        self.scheduled = len(times)
+        return times[:fit], copies
+
+    def write_scenario(self, path):
+        """Write the schedule as a virtual-clock scenario instead of publishing it."""
+        times, copies = self.sim_schedule()
+        if len(times) < self.scheduled:
+            print("WARNING: the simulation holds %d scenario steps (SIM_MAX_STEPS); writing the first %d of "
+                  "%d alerts (%.0f s of the schedule). Run longer soaks live."
+                  % (SIM_MAX_STEPS, len(times), self.scheduled, times[-1]), file=sys.stderr)
+
+        lines = ["# tools/load_generator.py %s" % " ".join(sys.argv[1:]),
+                 "00:00:00 ntp %d" % SIM_EPOCH]
+        if len(times) < self.scheduled:
+            lines.insert(1, "# capped at %d of %d alerts by SIM_MAX_STEPS" % (len(times), self.scheduled))
+        for seq, at in enumerate(times):
+            payload = json.dumps(self.make_alert(seq, at), separators=(",", ":"))
+            lines += ["%s alert %s" % (sim_time(SIM_SETTLE_S + at), payload)] * copies
+        # Past the last alert by the drain time, so late echoes still land in the log
+        lines.append("%s end" % sim_time(SIM_SETTLE_S + times[-1] + self.args.drain))
+        with open(path, "w") as f:
+            f.write("\n".join(lines) + "\n")
+        return len(times)
+
+    def load_sim_log(self, path):
+        """Score a virtual-clock run of write_scenario()'s output from its event log."""
+        times, copies = self.sim_schedule()
+        for seq, at in enumerate(times):
+            alert = self.make_alert(seq, at)
+            self.sent[alert["id"]] = (None, alert["level"])
+        self.publishes = len(times) * copies
+        self.send_duration = times[-1]
+
+        arrived = {}
+        with open(path, errors="replace") as f:
+            for line in f:
+                match = SIM_LINE.match(line.strip())
+                if not match:
+                    continue
+                d, h, m, sec, ms, source, detail = match.groups()
+                at = int(d) * 86400 + int(h) * 3600 + int(m) * 60 + int(sec) + int(ms) / 1000.0
+                if source == "scenario" and detail.startswith("alert "):
+                    try:
+                        alert_id = json.loads(detail[6:]).get("id", "")
+                    except ValueError:
+                        continue
+                    arrived.setdefault(alert_id, at)
+                elif source == "echo":
+                    self.on_echo(None, detail.encode("utf-8"), at, arrived)
+        if not arrived:
+            raise ValueError("%s has no SIM scenario lines (capture the esp32dev_sim serial output)" % path)
+
+    def summary(self):
+        with self.lock:
+            echoes = list(self.echoed.values())
+            sent = len(self.sent)
+            last = dict(self.last_echo)
+        handle = [e.get("handle_us", 0) for e in echoes]
+        if self.simulated:
+            # Virtual publish -> echo time is ~0 by construction; the handler time is measured
+            for e in echoes:
+                e["latency_ms"] = e.get("handle_us", 0) / 1000.0
+        latencies = [e["latency_ms"] for e in echoes]
+        displayed = sum(1 for e in echoes if e.get("status") == "displayed")
+        heap_min = min((e.get("heap_min", 0) for e in echoes), default=0)
+        # Counter delta across the run (excludes the first alert's own frame)
+        counters = [e.get("sign_bytes", 0) for e in echoes]
+        sign_bytes = max(counters) - min(counters) if counters else 0
+
+        per_level = {}
+        for level in LEVELS:
+            values = [e["latency_ms"] for e in echoes if e["level"] == level]
+            if values:
+                per_level[level] = {"count": len(values), "p50_ms": percentile(values, 50),
+                                    "p95_ms": percentile(values, 95), "max_ms": max(values)}
+
+        return {
+            "label": self.args.label,
+            "run_id": self.run_id,
+            "config": {"rate": self.args.rate, "duration": self.args.duration, "count": self.args.count,
+                       "burst": self.args.burst, "mix": self.args.mix, "size": self.args.size,
+                       "qos": self.args.qos, "redeliver": self.args.redeliver, "seed": self.args.seed},
+            "latency_source": "handle_us" if self.simulated else "publish_to_echo",
+            "sim_capped": self.scheduled - sent if self.simulated else 0,
+            "sent": sent,
+            "publishes": self.publishes,
+            "achieved_rate": sent / self.send_duration if self.send_duration else 0.0,
+            "echoed": len(echoes),
+            "displayed": displayed,
+            "rejected": sum(1 for e in echoes if e.get("status") == "rejected"),
+            "duplicate_status": sum(1 for e in echoes if e.get("status") == "duplicate"),
+            "duplicate_echoes": self.duplicate_echoes,
+            "dropped": sent - len(echoes),
+            "latency_ms": {"p50": percentile(latencies, 50), "p95": percentile(latencies, 95),
+                           "p99": percentile(latencies, 99), "max": max(latencies, default=0.0),
+                           "mean": statistics.mean(latencies) if latencies else 0.0},
+            "handle_us": {"p50": percentile(handle, 50), "max": max(handle, default=0)},
+            "per_level": per_level,
+            "heap_min": heap_min,
+            "heap_free_last": last.get("heap_free", 0),
+            "sign_bytes": sign_bytes,
+            "sign_bytes_per_displayed": sign_bytes / displayed if displayed else 0.0,
+        }
+
+
+def print_summary(s):
+    rows = [
+        ("Sent / publishes", "%d / %d" % (s["sent"], s["publishes"])),
+        ("Achieved rate", "%.2f alerts/s" % s["achieved_rate"]),
+        ("Echoed", "%d" % s["echoed"]),
+        ("  displayed", "%d" % s["displayed"]),
+        ("  rejected", "%d" % s["rejected"]),
+        ("  duplicate", "%d (+%d repeat echoes)" % (s["duplicate_status"], s["duplicate_echoes"])),
+        ("Dropped", "%d" % s["dropped"]),
+        ("Latency p50/p95/p99", "%.1f / %.1f / %.1f ms" % (s["latency_ms"]["p50"], s["latency_ms"]["p95"],
+                                                          s["latency_ms"]["p99"])),
+        ("Latency max", "%.1f ms" % s["latency_ms"]["max"]),
+        ("Latency measured as", "device handler time (virtual clock)" if s["latency_source"] == "handle_us"
+         else "publish -> echo received"),
+        ("Device handler p50/max", "%d / %d us" % (s["handle_us"]["p50"], s["handle_us"]["max"])),
+        ("Heap low-water", "%d bytes" % s["heap_min"]),
+        ("Heap free (last)", "%d bytes" % s["heap_free_last"]),
+        ("Sign bytes", "%d (%.0f per displayed alert)" % (s["sign_bytes"], s["sign_bytes_per_displayed"])),
+    ]
+    if s["sim_capped"]:
+        rows.insert(0, ("Simulation cap", "%d alerts not run (SIM_MAX_STEPS %d)" % (s["sim_capped"], SIM_MAX_STEPS)))
+    width = max(len(name) for name, _ in rows)
+    print()
+    print("Load run %s%s" % (s["run_id"], " (%s)" % s["label"] if s["label"] else ""))
+    print("-" * (width + 30))
+    for name, value in rows:
+        print("%-*s  %s" % (width, name, value))
+    for level, v in s["per_level"].items():
+        print("%-*s  n=%d p50=%.1f p95=%.1f max=%.1f ms" % (width, "  " + level, v["count"],
+                                                          v["p50_ms"], v["p95_ms"], v["max_ms"]))
+
+
+def run_live(run, args):
+    """Publish to the broker and collect echoes until drained."""
+    suffix = "%d" % int(time.time())
+    subscriber = MqttClient(args.broker, args.port, "loadgen-sub-" + suffix, args.username,
+                            args.password, args.tls, args.cafile)
+    subscriber.on_message = run.on_echo
+    subscriber.subscribe("ledSign/%s/echo" % args.device_id)
+    publisher = MqttClient(args.broker, args.port, "loadgen-pub-" + suffix, args.username,
+                           args.password, args.tls, args.cafile)
+    time.sleep(0.5)  # Let the subscription settle
+
+    run.run(publisher, args.report_every)
+    publisher.close()
+    subscriber.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Alert load generator for the LED sign controller")
+    parser.add_argument("--broker", default="127.0.0.1", help="MQTT broker host")
+    parser.add_argument("--port", type=int, default=1883, help="MQTT broker port")
+    parser.add_argument("--username", help="MQTT username")
+    parser.add_argument("--password", help="MQTT password")
+    parser.add_argument("--tls", action="store_true", help="connect with TLS")
+    parser.add_argument("--cafile", help="CA certificate for --tls (verification off without it)")
+    parser.add_argument("--zone", default="default", help="sign zone (topic ledSign/{zone}/message)")
+    parser.add_argument("--device-id", default="+", help="device ID for echo topic (default: any)")
+    parser.add_argument("--rate", type=float, default=1.0, help="steady alerts per second")
+    parser.add_argument("--poisson", action="store_true", help="exponential inter-arrival times")
+    parser.add_argument("--duration", type=float, default=0, help="seconds to run")
+    parser.add_argument("--count", type=int, default=0, help="stop after N steady-rate alerts")
+    parser.add_argument("--burst", metavar="N@S", help="additionally send N alerts back-to-back every S seconds (needs --duration)")
+    parser.add_argument("--mix", default="critical=1,warning=2,notice=3,info=4",
+                        help="level weights (default %(default)s)")
+    parser.add_argument("--size", default="20-80", help="message length range in chars (default %(default)s)")
+    parser.add_argument("--qos", type=int, choices=(0, 1), default=1, help="publish QoS (default 1)")
+    parser.add_argument("--redeliver", type=int, default=0,
+                        help="re-send each QoS1 publish N extra times with DUP set")
+    parser.add_argument("--drain", type=float, default=10.0, help="seconds to wait for echoes after sending")
+    parser.add_argument("--report-every", type=float, default=30.0, help="progress line interval (0 = off)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed (same seed = same alert sequence)")
+    parser.add_argument("--label", default="", help="free-form label stored in the JSON (e.g. firmware rev)")
+    parser.add_argument("--json-out", help="write the summary as JSON")
+    sim = parser.add_mutually_exclusive_group()
+    sim.add_argument("--sim-scenario", metavar="FILE",
+                     help="write the run as an esp32dev_sim scenario instead of publishing")
+    sim.add_argument("--sim-log", metavar="FILE",
+                     help="score an esp32dev_sim run of --sim-scenario (same arguments) from its serial log")
+    args = parser.parse_args()
+
+    if not args.duration and not args.count:
+        args.count = 100
+
+    if args.sim_scenario:
+        try:
+            count = LoadRun(args).write_scenario(args.sim_scenario)
+        except (OSError, ValueError) as e:
+            print("ERROR: %s" % e, file=sys.stderr)
+            return 1
+        print("Wrote %s (%d alerts); upload it as /sim.scn" % (args.sim_scenario, count))
+        return 0
+
+    try:
+        run = LoadRun(args)
+        if args.sim_log:
+            run.load_sim_log(args.sim_log)
+        else:
+            run_live(run, args)
+    except (OSError, ConnectionError, ValueError) as e:
+        print("ERROR: %s" % e, file=sys.stderr)
+        return 1
+    except KeyboardInterrupt:
+        print("\nInterrupted - summarising what was sent")
+        run.send_duration = run.send_duration if hasattr(run, "send_duration") else 1.0
+
+    summary = run.summary()
+    print_summary(summary)
+    if args.json_out:
+        with open(args.json_out, "w") as f:
+            json.dump(summary, f, indent=2)
+        print("\nWrote %s" % args.json_out)
+    return 0 if summary["dropped"] == 0 else 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
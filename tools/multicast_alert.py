@@ -0,0 +1,366 @@
+#!/usr/bin/env python3
+"""
+Multicast Alert Sender / Fan-out Benchmark
+
+Signs and sends Alert Manager JSON alerts as authenticated UDP multicast
+datagrams, matching the firmware's MulticastListener. One datagram reaches
+every sign on the LAN; MQTT stays the fallback path.
+
+Datagram layout (big-endian):
+    "LS" | ver u8 | flags u8 | sender_id u32 | seq u32 | timestamp u32 |
+    payload_len u16 | payload | HMAC-SHA256(key, header+payload)[:16]
+
+The site key is 32 random bytes stored as 64 hex characters. Upload the same
+file to each sign's LittleFS as /multicast_key.txt (see MULTICAST_KEY_PATH).
+
+Signs keep a replay window per sender_id, so the sender must look the same
+from run to run: sender_id is derived from the key and this host's name, and
+the next seq is kept in <key file>.state. If that file is lost, seq restarts
+from the current Unix time, which is above any seq used before (signs count
+the jump once as lost datagrams instead of rejecting the sender as a replay).
+
+Requires: Python 3.7+ (standard library only)
+
+Usage:
+    # Generate a site key
+    python3 multicast_alert.py keygen > data/multicast_key.txt
+
+    # Send one alert to every sign
+    python3 multicast_alert.py --key-file data/multicast_key.txt send \\
+        --level warning --category weather --title "Snow" --message "Heavy snow tonight"
+
+    # Send a JSON file as-is (e.g. one entry from test/sample_alerts.json)
+    python3 multicast_alert.py --key-file key.txt send --json alert.json
+
+    # Measure fan-out with N simulated receivers on this host
+    python3 multicast_alert.py --key-file key.txt simulate 50 --count 200 --rate 20
+"""
+
+import argparse
+import hashlib
+import hmac
+import json
+import os
+import random
+import socket
+import statistics
+import struct
+import sys
+import threading
+import time
+
+# Must match defines.h
+DEFAULT_GROUP = "239.255.76.83"
+DEFAULT_PORT = 42691
+
+MAGIC = b"LS"
+VERSION = 1
+HEADER = struct.Struct(">2sBBIIIH")
+MAC_SIZE = 16
+MAX_DATAGRAM = 1472
+
+
+def load_key(path):
+    """Load a hex site key from file."""
+    with open(path, "r") as f:
+        text = f.read().strip()
+    key = bytes.fromhex(text)
+    if len(key) != 32:
+        raise ValueError("site key must be 32 bytes (64 hex characters)")
+    return key
+
+
+class SenderState:
+    """This host's sender_id and next seq, persisted next to the site key."""
+
+    def __init__(self, key, key_file):
+        self.path = key_file + ".state"
+        host = socket.gethostname().encode("utf-8")
+        derived = struct.unpack(">I", hmac.new(key, b"sender-id|" + host, hashlib.sha256).digest()[:4])[0]
+        self.sender_id = derived
+        self.seq = int(time.time())
+        try:
+            with open(self.path, "r") as f:
+                state = json.load(f)
+            if state.get("sender_id") == derived:
+                self.seq = int(state["seq"])
+        except (OSError, ValueError, KeyError):
+            pass
+
+    def reserve(self, count):
+        """Claim count sequence numbers; saved before any is sent. Returns the first."""
+        first = self.seq
+        self.seq += count
+        tmp = self.path + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump({"sender_id": self.sender_id, "seq": self.seq}, f)
+        os.replace(tmp, self.path)
+        return first
+
+
+def encode(key, sender_id, seq, payload, timestamp=None):
+    """Build an authenticated datagram."""
+    if timestamp is None:
+        timestamp = int(time.time())
+    header = HEADER.pack(MAGIC, VERSION, 0, sender_id, seq, timestamp, len(payload))
+    body = header + payload
+    if len(body) + MAC_SIZE > MAX_DATAGRAM:
+        raise ValueError("payload too large for a single datagram (%d bytes)" % len(payload))
+    mac = hmac.new(key, body, hashlib.sha256).digest()[:MAC_SIZE]
+    return body + mac
+
+
+def decode(key, data):
+    """Verify and unpack a datagram. Returns (sender_id, seq, timestamp, payload) or None."""
+    if len(data) < HEADER.size + MAC_SIZE:
+        return None
+    magic, ver, _flags, sender_id, seq, ts, plen = HEADER.unpack_from(data)
+    if magic != MAGIC or ver != VERSION or HEADER.size + plen + MAC_SIZE != len(data):
+        return None
+    body, mac = data[:-MAC_SIZE], data[-MAC_SIZE:]
+    expected = hmac.new(key, body, hashlib.sha256).digest()[:MAC_SIZE]
+    if not hmac.compare_digest(mac, expected):
+        return None
+    return sender_id, seq, ts, data[HEADER.size:HEADER.size + plen]
+
+
+def make_sender_socket(ttl, iface):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, ttl)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+    if iface:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton(iface))
+    return sock
+
+
+def make_receiver_socket(group, port, iface):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    if hasattr(socket, "SO_REUSEPORT"):
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+    sock.bind(("", port))
+    mreq = struct.pack("4s4s", socket.inet_aton(group), socket.inet_aton(iface or "0.0.0.0"))
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    sock.settimeout(0.2)
+    return sock
+
+
+def build_alert(args):
+    if args.json:
+        with open(args.json, "r") as f:
+            alert = json.load(f)
+    else:
+        alert = {
+            "timestamp": int(time.time()),
+            "level": args.level,
+            "category": args.category,
+            "title": args.title,
+            "message": args.message,
+        }
+        if args.zone:
+            alert["zone"] = args.zone
+    if args.id:
+        alert["id"] = args.id
+    elif "id" not in alert:
+        # Lets signs suppress the duplicate that arrives later over MQTT
+        alert["id"] = "mc-%08x" % random.getrandbits(32)
+    return json.dumps(alert, separators=(",", ":")).encode("utf-8")
+
+
+def cmd_keygen(_args):
+    print(os.urandom(32).hex())
+
+
+def cmd_send(args):
+    key = load_key(args.key_file)
+    payload = build_alert(args)
+    state = SenderState(key, args.key_file)
+    first = state.reserve(args.repeat)
+    sock = make_sender_socket(args.ttl, args.iface)
+    for seq in range(first, first + args.repeat):
+        datagram = encode(key, state.sender_id, seq, payload)
+        sock.sendto(datagram, (args.group, args.port))
+        if seq < first + args.repeat - 1:
+            time.sleep(args.repeat_gap)
+    print("Sent %d datagram(s), %d bytes each, to %s:%d" %
+          (args.repeat, len(datagram), args.group, args.port))
+
+
+class Receiver(threading.Thread):
+    """Simulated sign: joins the group, verifies, records arrival times."""
+
+    def __init__(self, index, key, group, port, iface, stop):
+        super().__init__(daemon=True)
+        self.index = index
+        self.key = key
+        self.sock = make_receiver_socket(group, port, iface)
+        self.stop = stop
+        self.arrivals = {}
+        self.rejected = 0
+
+    def run(self):
+        while not self.stop.is_set():
+            try:
+                data, _ = self.sock.recvfrom(2048)
+            except socket.timeout:
+                continue
+            now = time.perf_counter()
+            result = decode(self.key, data)
+            if result is None:
+                self.rejected += 1
+                continue
+            _sender, seq, _ts, _payload = result
+            self.arrivals.setdefault(seq, now)
+        self.sock.close()
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    k = max(0, min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1)))))
+    return ordered[k]
+
+
+def cmd_simulate(args):
+    key = load_key(args.key_file)
+    stop = threading.Event()
+    receivers = [Receiver(i, key, args.group, args.port, args.iface, stop)
+                 for i in range(args.receivers)]
+    for r in receivers:
+        r.start()
+    time.sleep(0.3)  # Let group joins settle
+
+    sock = make_sender_socket(args.ttl, args.iface)
+    state = SenderState(key, args.key_file)
+    first = state.reserve(args.count)
+    sent_at = {}
+    interval = 1.0 / args.rate if args.rate > 0 else 0
+    base = {"level": "info", "category": "system", "title": "Bench", "message": "x" * args.size}
+
+    print("Sending %d alerts at %.1f/s to %d simulated receivers..." %
+          (args.count, args.rate, args.receivers))
+    next_send = time.perf_counter()
+    for seq in range(first, first + args.count):
+        alert = dict(base, id="bench-%d" % seq, timestamp=int(time.time()))
+        datagram = encode(key, state.sender_id, seq, json.dumps(alert).encode("utf-8"))
+        sent_at[seq] = time.perf_counter()
+        sock.sendto(datagram, (args.group, args.port))
+        next_send += interval
+        delay = next_send - time.perf_counter()
+        if delay > 0:
+            time.sleep(delay)
+
+    time.sleep(args.drain)
+    stop.set()
+    for r in receivers:
+        r.join()
+
+    # Per-delivery latency and per-alert "last sign lit" latency
+    per_delivery = []
+    per_alert_last = []
+    lost = 0
+    for seq, t0 in sent_at.items():
+        arrivals = [r.arrivals[seq] - t0 for r in receivers if seq in r.arrivals]
+        lost += len(receivers) - len(arrivals)
+        per_delivery.extend(arrivals)
+        if len(arrivals) == len(receivers):
+            per_alert_last.append(max(arrivals))
+
+    expected = len(sent_at) * len(receivers)
+    rejected = sum(r.rejected for r in receivers)
+
+    def ms(v):
+        return "%.3f" % (v * 1000.0)
+
+    print()
+    print("Receivers:          %d" % len(receivers))
+    print("Alerts sent:        %d (%d datagrams on the wire)" % (len(sent_at), len(sent_at)))
+    print("Deliveries:         %d / %d (lost %d, %.2f%%)" %
+          (expected - lost, expected, lost, 100.0 * lost / expected if expected else 0))
+    print("Rejected (auth):    %d" % rejected)
+    print()
+    print("%-26s %10s %10s %10s" % ("Latency (ms)", "p50", "p95", "max"))
+    print("%-26s %10s %10s %10s" % ("per delivery",
+          ms(percentile(per_delivery, 50)), ms(percentile(per_delivery, 95)),
+          ms(max(per_delivery) if per_delivery else 0)))
+    print("%-26s %10s %10s %10s" % ("all receivers reached",
+          ms(percentile(per_alert_last, 50)), ms(percentile(per_alert_last, 95)),
+          ms(max(per_alert_last) if per_alert_last else 0)))
+    if per_delivery:
+        print()
+        print("Mean per delivery: %s ms" % ms(statistics.mean(per_delivery)))
+
+    if args.json_out:
+        with open(args.json_out, "w") as f:
+            json.dump({
+                "receivers": len(receivers),
+                "alerts": len(sent_at),
+                "deliveries": expected - lost,
+                "lost": lost,
+                "rejected": rejected,
+                "per_delivery_ms": {
+                    "p50": percentile(per_delivery, 50) * 1000,
+                    "p95": percentile(per_delivery, 95) * 1000,
+                    "max": (max(per_delivery) if per_delivery else 0) * 1000,
+                },
+                "all_reached_ms": {
+                    "p50": percentile(per_alert_last, 50) * 1000,
+                    "p95": percentile(per_alert_last, 95) * 1000,
+                    "max": (max(per_alert_last) if per_alert_last else 0) * 1000,
+                },
+            }, f, indent=2)
+        print("Results written to %s" % args.json_out)
+
+    return 0 if lost == 0 else 2
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Authenticated multicast alert sender / fan-out benchmark")
+    parser.add_argument("--key-file", help="Site key file (64 hex chars)")
+    parser.add_argument("--group", default=DEFAULT_GROUP, help="Multicast group (default: %(default)s)")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="UDP port (default: %(default)s)")
+    parser.add_argument("--iface", help="Local interface IP to send/join on")
+    parser.add_argument("--ttl", type=int, default=1, help="Multicast TTL (default: 1, LAN only)")
+    sub = parser.add_subparsers(dest="command")
+
+    sub.add_parser("keygen", help="Print a new random site key")
+
+    p_send = sub.add_parser("send", help="Send one alert")
+    p_send.add_argument("--json", help="Send this alert JSON file as the payload")
+    p_send.add_argument("--level", default="info")
+    p_send.add_argument("--category", default="system")
+    p_send.add_argument("--title", default="Alert")
+    p_send.add_argument("--message", default="")
+    p_send.add_argument("--zone", help="Target zone (omit or 'all' for every sign)")
+    p_send.add_argument("--id", help="Alert ID for MQTT de-duplication (default: random)")
+    p_send.add_argument("--repeat", type=int, default=1,
+                        help="Send N copies with increasing seq (loss insurance, default: 1)")
+    p_send.add_argument("--repeat-gap", type=float, default=0.05, help="Seconds between copies")
+
+    p_sim = sub.add_parser("simulate", help="Fan-out benchmark with N simulated receivers")
+    p_sim.add_argument("receivers", type=int, help="Number of simulated signs")
+    p_sim.add_argument("--count", type=int, default=100, help="Alerts to send (default: 100)")
+    p_sim.add_argument("--rate", type=float, default=10.0, help="Alerts per second (default: 10)")
+    p_sim.add_argument("--size", type=int, default=64, help="Message text length (default: 64)")
+    p_sim.add_argument("--drain", type=float, default=1.0, help="Seconds to wait for stragglers")
+    p_sim.add_argument("--json-out", help="Write results as JSON")
+
+    args = parser.parse_args()
+
+    if args.command is None:
+        parser.print_help()
+        return 1
+    if args.command == "keygen":
+        cmd_keygen(args)
+        return 0
+    if not args.key_file:
+        parser.error("--key-file is required")
+    if args.command == "send":
+        cmd_send(args)
+        return 0
+    return cmd_simulate(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
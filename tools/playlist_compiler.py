@@ -0,0 +1,304 @@
+#!/usr/bin/env python3
+"""
+Playlist Compiler for the LED Sign Controller
+
+Compiles a human-readable playlist script into the compact binary format
+played by the firmware's PlaylistPlayer (demo mode, showcase loops). The
+firmware loads /demo.lspl from LittleFS, falling back to the copy built into
+src/DemoPlaylist.h.
+
+Script syntax (one step per line, '#' starts a comment):
+
+    show <ms> [color=..] [mode=..] [effect=..] [charset=..] [position=..] "<text>"
+    blank <ms>          cancel the priority file, sign returns to normal content
+    loop                steps after this line repeat forever
+
+Text may contain inline color tags such as {red}R{green}G. Defaults are
+color=auto mode=hold effect=twinkle charset=7high position=topline.
+
+Binary layout (little-endian):
+    header: "LSPL" | version u8 | flags u8 (bit0 loop) | step_count u16 | loop_start u16
+    step:   kind u8 | color u8 | position u8 | mode u8 | special u8 | text_len u8 |
+            duration_ms u32 | text (charset prefix and color codes already applied)
+
+Requires: Python 3.7+ (standard library only)
+
+Usage:
+    # Compile for upload to LittleFS (pio run -t uploadfs)
+    python3 playlist_compiler.py tools/playlists/demo.playlist -o data/demo.lspl
+
+    # Regenerate the built-in fallback
+    python3 playlist_compiler.py tools/playlists/demo.playlist \\
+        --header src/DemoPlaylist.h --name DEMO_PLAYLIST
+
+    # Show what a compiled playlist contains
+    python3 playlist_compiler.py --dump data/demo.lspl
+"""
+
+import argparse
+import os
+import re
+import shlex
+import struct
+import sys
+
+# Must match PlaylistPlayer.h
+MAGIC = b"LSPL"
+VERSION = 1
+FLAG_LOOP = 0x01
+HEADER = struct.Struct("<4sBBHH")
+STEP = struct.Struct("<BBBBBBI")
+KIND_SHOW = 0
+KIND_BLANK = 1
+MAX_TEXT = 200
+MAX_STEPS = 1024
+
+# Alpha protocol codes (BBDEFS.h)
+FC_SELECTCHARSET = 0x1A
+FC_SELECTCHARCOLOR = 0x1C
+
+COLORS = {
+    "red": "1", "green": "2", "amber": "3", "dimred": "4", "dimgreen": "5",
+    "brown": "6", "orange": "7", "yellow": "8", "rainbow": "9", "rainbow1": "9",
+    "rainbow2": "A", "mix": "B", "auto": "C",
+}
+
+MODES = {
+    "rotate": "a", "hold": "b", "flash": "c", "rollup": "e", "rolldown": "f",
+    "rollleft": "g", "rollright": "h", "wipeup": "i", "wipedown": "j",
+    "wipeleft": "k", "wiperight": "l", "scroll": "m", "special": "n",
+    "auto": "o", "rollin": "p", "rollout": "q", "wipein": "r", "wipeout": "s",
+    "comprotate": "t", "explode": "u",
+}
+
+EFFECTS = {
+    "twinkle": "0", "sparkle": "1", "snow": "2", "interlock": "3", "switch": "4",
+    "slide": "5", "spray": "6", "starburst": "7", "welcome": "8", "slots": "9",
+    "newsflash": "A", "trumpet": "B", "cyclecolors": "C", "thankyou": "S",
+    "nosmoking": "U", "dontdrinkanddrive": "V", "fishimal": "W",
+    "fireworks": "X", "turballoon": "Y", "bomb": "Z",
+}
+
+CHARSETS = {
+    "5high": "1", "5stroke": "2", "7high": "3", "7stroke": "4", "7fancy": "5",
+    "10high": "6", "7shadow": "7", "fullfancy": "8", "full": "9",
+    "7shadowfancy": ":", "5wide": ";", "7wide": "<", "7widefancy": "=",
+    "5widestroke": ">",
+}
+
+POSITIONS = {"topline": '"', "midline": " ", "botline": "&", "fill": "0"}
+
+TAG_RE = re.compile(r"\{([a-z0-9]+)\}")
+
+
+class PlaylistError(Exception):
+    pass
+
+
+def lookup(table, value, what):
+    try:
+        return table[value.lower()]
+    except KeyError:
+        raise PlaylistError("unknown %s '%s' (expected one of: %s)"
+                            % (what, value, ", ".join(sorted(table))))
+
+
+def encode_text(text, charset):
+    """Apply the charset prefix and translate {color} tags into control codes."""
+    out = bytearray([FC_SELECTCHARSET, ord(charset)])
+    pos = 0
+    for m in TAG_RE.finditer(text):
+        out += text[pos:m.start()].encode("ascii")
+        out += bytes([FC_SELECTCHARCOLOR, ord(lookup(COLORS, m.group(1), "color tag"))])
+        pos = m.end()
+    out += text[pos:].encode("ascii")
+    if len(out) > MAX_TEXT:
+        raise PlaylistError("text too long (%d bytes encoded, max %d)" % (len(out), MAX_TEXT))
+    return bytes(out)
+
+
+def parse_duration(token):
+    try:
+        ms = int(token)
+    except ValueError:
+        raise PlaylistError("duration must be milliseconds, got '%s'" % token)
+    if ms < 0 or ms > 0xFFFFFFFF:
+        raise PlaylistError("duration out of range: %d" % ms)
+    return ms
+
+
+def parse_script(lines):
+    """Parse script lines into (steps, loop_start). loop_start is None without a loop line."""
+    steps = []
+    loop_start = None
+
+    for lineno, raw in enumerate(lines, 1):
+        try:
+            tokens = shlex.split(raw, comments=True)
+        except ValueError as e:
+            raise PlaylistError("line %d: %s" % (lineno, e))
+        if not tokens:
+            continue
+
+        try:
+            cmd = tokens[0].lower()
+            if cmd == "loop":
+                if loop_start is not None:
+                    raise PlaylistError("only one loop line allowed")
+                loop_start = len(steps)
+            elif cmd == "blank":
+                if len(tokens) != 2:
+                    raise PlaylistError("usage: blank <ms>")
+                steps.append((KIND_BLANK, "C", '"', "b", "0", b"", parse_duration(tokens[1])))
+            elif cmd == "show":
+                if len(tokens) < 3:
+                    raise PlaylistError('usage: show <ms> [key=value ...] "<text>"')
+                duration = parse_duration(tokens[1])
+                text = tokens[-1]
+                opts = {"color": "auto", "mode": "hold", "effect": "twinkle",
+                        "charset": "7high", "position": "topline"}
+                for opt in tokens[2:-1]:
+                    key, sep, value = opt.partition("=")
+                    if not sep or key not in opts:
+                        raise PlaylistError("bad option '%s'" % opt)
+                    opts[key] = value
+                steps.append((KIND_SHOW,
+                              lookup(COLORS, opts["color"], "color"),
+                              lookup(POSITIONS, opts["position"], "position"),
+                              lookup(MODES, opts["mode"], "mode"),
+                              lookup(EFFECTS, opts["effect"], "effect"),
+                              encode_text(text, lookup(CHARSETS, opts["charset"], "charset")),
+                              duration))
+            else:
+                raise PlaylistError("unknown command '%s'" % tokens[0])
+        except PlaylistError as e:
+            raise PlaylistError("line %d: %s" % (lineno, e))
+
+    if not steps:
+        raise PlaylistError("playlist has no steps")
+    if len(steps) > MAX_STEPS:
+        raise PlaylistError("too many steps (%d, max %d)" % (len(steps), MAX_STEPS))
+    if loop_start is not None and loop_start >= len(steps):
+        raise PlaylistError("loop line must be followed by at least one step")
+    return steps, loop_start
+
+
+def compile_steps(steps, loop_start):
+    flags = FLAG_LOOP if loop_start is not None else 0
+    out = bytearray(HEADER.pack(MAGIC, VERSION, flags, len(steps), loop_start or 0))
+    for kind, color, position, mode, special, text, duration in steps:
+        out += STEP.pack(kind, ord(color), ord(position), ord(mode), ord(special), len(text), duration)
+        out += text
+    return bytes(out)
+
+
+def decode(data):
+    """Unpack a compiled playlist. Returns (loop_start or None, [step tuples])."""
+    if len(data) < HEADER.size:
+        raise PlaylistError("file too short")
+    magic, version, flags, count, loop_start = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise PlaylistError("not a version %d playlist" % VERSION)
+    offset = HEADER.size
+    steps = []
+    for _ in range(count):
+        if offset + STEP.size > len(data):
+            raise PlaylistError("truncated step header at offset %d" % offset)
+        kind, color, position, mode, special, text_len, duration = STEP.unpack_from(data, offset)
+        offset += STEP.size
+        text = data[offset:offset + text_len]
+        if len(text) != text_len:
+            raise PlaylistError("truncated text at offset %d" % offset)
+        offset += text_len
+        steps.append((kind, chr(color), chr(position), chr(mode), chr(special), text, duration))
+    if offset != len(data):
+        raise PlaylistError("%d trailing bytes" % (len(data) - offset))
+    return (loop_start if flags & FLAG_LOOP else None), steps
+
+
+def printable(text):
+    out = ""
+    for b in text:
+        out += chr(b) if 0x20 <= b < 0x7F else "<%02X>" % b
+    return out
+
+
+def dump(data):
+    loop_start, steps = decode(data)
+    names = {v: k for k, v in MODES.items()}
+    total = 0
+    for i, (kind, color, position, mode, special, text, duration) in enumerate(steps):
+        if i == loop_start:
+            print("---- loop ----")
+        total += duration
+        if kind == KIND_BLANK:
+            print("%4d  %6d ms  blank" % (i, duration))
+        else:
+            print("%4d  %6d ms  color=%s mode=%s special=%s  %s"
+                  % (i, duration, color, names.get(mode, mode), special, printable(text)))
+    print("%d steps, %d bytes, %.1f s per pass" % (len(steps), len(data), total / 1000.0))
+
+
+def write_header(data, path, name, source):
+    guard = name.upper() + "_H"
+    lines = [
+        "/**",
+        " * @file %s" % os.path.basename(path),
+        " * @brief Built-in playlist compiled from %s" % source,
+        " *",
+        " * Generated by tools/playlist_compiler.py - do not edit by hand.",
+        " */",
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include <stdint.h>",
+        "",
+        "static const uint8_t %s[] = {" % name,
+    ]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    lines += ["};", "", "#endif // %s" % guard, ""]
+    with open(path, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile LED sign playlist scripts")
+    parser.add_argument("script", nargs="?", help="playlist script to compile")
+    parser.add_argument("-o", "--output", help="write binary playlist (.lspl)")
+    parser.add_argument("--header", help="write a C header with the playlist as a byte array")
+    parser.add_argument("--name", default="DEMO_PLAYLIST", help="array name for --header")
+    parser.add_argument("--dump", metavar="LSPL", help="decode and list a compiled playlist")
+    args = parser.parse_args()
+
+    try:
+        if args.dump:
+            with open(args.dump, "rb") as f:
+                dump(f.read())
+            return 0
+
+        if not args.script:
+            parser.error("script is required unless --dump is given")
+
+        with open(args.script, "r") as f:
+            steps, loop_start = parse_script(f.readlines())
+        data = compile_steps(steps, loop_start)
+
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(data)
+        if args.header:
+            write_header(data, args.header, args.name, args.script)
+        if not args.output and not args.header:
+            dump(data)
+        else:
+            print("Compiled %d steps (%d bytes)" % (len(steps), len(data)))
+    except (PlaylistError, OSError) as e:
+        print("ERROR: %s" % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
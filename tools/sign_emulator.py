@@ -0,0 +1,828 @@
+#!/usr/bin/env python3
+"""
+BetaBrite Sign Emulator - renders Alpha protocol traffic to images
+
+Interprets the frames the firmware sends (write text file, cancel priority,
+write string file), keeps the sign's file state, and renders what is on the
+glass at any point in virtual time - including rotate/scroll/wipe position and
+flash phase - as PNG images or ANSI truecolor terminal frames. Used to prove
+that protocol-level optimizations do not change what the sign shows.
+
+Each character set has its own font table: 5 high, 7 high (the 5x7 base
+font), 10 high, and full height (16-row tables; a 7-row sign uses the 7-high
+table). Wide sets double each column, shadow sets add a one-pixel shadow, and
+stroke and custom sets use the table of their height. The glyphs are
+deterministic stand-ins for the sign's ROM fonts, not copies of them. Special
+effects (fireworks, snow, ...) render their text only.
+
+The golden images are rendered from frames the firmware itself sent, taken from
+a TrafficCapture dump: the "CAPTURE" lines a virtual-clock (esp32dev_sim) run
+prints, or a capture fetched from a unit. Each inbound message starts a case,
+and its frames are rendered on a blank sign at fixed offsets after arrival, so
+a change to the firmware's presets or framing changes the images.
+
+Requires: Python 3.7+ (standard library only)
+
+Usage:
+    # Render a raw UART capture at a few instants (ANSI in the terminal)
+    python3 sign_emulator.py render capture.bin --at 0,0.5,2
+
+    # Hex dump input (e.g. copied from betabrite_sniffer.py --raw), to PNG
+    python3 sign_emulator.py render capture.txt --hex --fps 10 --duration 3 --png out/frame
+
+    # Every getDisplayPreset() level/category, as the firmware sent them
+    # (tools/scenarios/presets.scn on the esp32dev_sim build)
+    python3 sign_emulator.py capture presets.log --out build/emu
+
+    # Preview every step of a playlist (frames built here, not by the firmware)
+    python3 sign_emulator.py playlist tools/playlists/demo.playlist --out build/emu
+
+    # CI: compare against the golden images (exit 1 on any difference)
+    python3 sign_emulator.py capture presets.log --golden goldens/presets
+    python3 sign_emulator.py capture presets.log --golden goldens/presets --update
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import zlib
+
+# Protocol constants (BBDEFS.h)
+NUL, SOH, STX, ETX, EOT, ESC = 0x00, 0x01, 0x02, 0x03, 0x04, 0x1B
+CC_WTEXT, CC_WSTRING = ord("A"), ord("G")
+SIGN_TYPE_ALL = 0x3F
+PRIORITY_LABEL = ord("0")
+FC_SELECTCHARSET, FC_SELECTCHARCOLOR = 0x1A, 0x1C
+FC_NEWPAGE, FC_NEWLINE = 0x0C, 0x0D
+FC_CALLSTRING, FC_CALLTIME, FC_CALLDATE = 0x10, 0x13, 0x0B
+SPEED_CODES = {0x15: 1, 0x16: 2, 0x17: 3, 0x18: 4, 0x19: 5}
+
+DEFAULT_WIDTH = 80
+DEFAULT_HEIGHT = 16
+
+# Virtual timing (seconds, columns per second)
+TRANSITION_S = 0.8
+HOLD_S = 3.0
+FLASH_PERIOD_S = 0.5
+SPEED_CPS = {1: 10, 2: 15, 3: 22, 4: 30, 5: 40}
+
+OFF = (28, 28, 28)
+BACKGROUND = (0, 0, 0)
+COLORS = {
+    "1": (255, 0, 0),       # red
+    "2": (0, 255, 0),       # green
+    "3": (255, 160, 0),     # amber
+    "4": (128, 0, 0),       # dim red
+    "5": (0, 128, 0),       # dim green
+    "6": (128, 64, 0),      # brown
+    "7": (255, 100, 0),     # orange
+    "8": (255, 255, 0),     # yellow
+}
+RAINBOW = [COLORS["1"], COLORS["7"], COLORS["8"], COLORS["2"], COLORS["3"]]
+AUTO_CYCLE = [COLORS["1"], COLORS["2"], COLORS["3"]]
+
+# 5x7 base font, ASCII 0x20-0x7E, five column bytes per glyph (bit 0 = top row)
+FONT_5X7 = bytes.fromhex(
+    "0000000000" "00005f0000" "0007000700" "147f147f14" "242a7f2a12" "2313086462"
+    "3649552250" "0005030000" "001c224100" "0041221c00" "082a1c2a08" "08083e0808"
+    "0050300000" "0808080808" "0060600000" "2010080402" "3e5149453e" "00427f4000"
+    "4261514946" "2141454b31" "1814127f10" "2745454539" "3c4a494930" "0171090503"
+    "3649494936" "064949291e" "0036360000" "0056360000" "0814224100" "1414141414"
+    "4122140800" "0201510906" "324979413e" "7e1111117e" "7f49494936" "3e41414122"
+    "7f4141221c" "7f49494941" "7f09090101" "3e41415132" "7f0808087f" "00417f4100"
+    "2040413f01" "7f08142241" "7f40404040" "7f0204027f" "7f0408107f" "3e4141413e"
+    "7f09090906" "3e4151215e" "7f09192946" "4649494931" "01017f0101" "3f4040403f"
+    "1f2040201f" "7f2018207f" "6314081463" "0304780403" "6151494543" "00007f4141"
+    "0204081020" "41417f0000" "0402010204" "4040404040" "0001020400" "2054545478"
+    "7f48444438" "3844444420" "384444487f" "3854545418" "087e090102" "081454543c"
+    "7f08040478" "00447d4000" "2040443d00" "007f102844" "00417f4000" "7c04180478"
+    "7c08040478" "3844444438" "7c14141408" "081414187c" "7c08040408" "4854545420"
+    "043f444020" "3c4040207c" "1c2040201c" "3c4030403c" "4428102844" "0c5050503c"
+    "4464544c44" "0008364100" "00007f0000" "0041360800" "08082a1c08"
+)
+
+
+
+def _font(column_bytes, text):
+    """Glyph table from hex columns (bit 0 = top row), one space-separated glyph per character."""
+    step = column_bytes * 2
+    return [[int(g[i:i + step], 16) for i in range(0, len(g), step)] for g in text.split()]
+
+
+FONT_7HIGH = [list(FONT_5X7[i:i + 5]) for i in range(0, len(FONT_5X7), 5)]
+
+# 5-high set, ASCII 0x20-0x7E (capitals only: lower case repeats the capitals)
+FONT_5HIGH = _font(1, """
+    0000 17 030003 0a1f0a1f0a 121d1709 19040211 0a150a10 03 0e11 110e 050205 040e04 1008 040404 10
+    180403 0e110e 121f10 191512 11150a 07041f 171509 0e1509 011d03 0a150a 12150e 0a 100a 040a11
+    0a0a0a 110a04 011502 0e111506 1e051e 1f150a 0e1111 1f110e 1f1511 1f0501 0e111d 1f041f 111f11
+    08100f 1f041b 1f1010 1f0204021f 1f02041f 0e110e 1f0502 0e110e10 1f051a 121509 011f01 0f100f
+    071807 1f0804081f 1b041b 031c03 191513 1f11 030418 111f 020102 101010 0102 1e051e 1f150a
+    0e1111 1f110e 1f1511 1f0501 0e111d 1f041f 111f11 08100f 1f041b 1f1010 1f0204021f 1f02041f
+    0e110e 1f0502 0e110e10 1f051a 121509 011f01 0f100f 071807 1f0804081f 1b041b 031c03 191513
+    041b11 1f 111b04 04020402
+""")
+
+# 10-high set, ASCII 0x20-0x7E
+FONT_10HIGH = _font(2, """
+    0000000000000000 037f037f 00070003000000070003 004401ff0044004401ff0044
+    008c011203ff0112012200c4 00c20025001200c800040183 00e60119011900a6004001a0 00070003
+    00fc01020201 0201010200fc 00140008003e000800140000 00100010007c001000100000 02800180
+    001000100010001000100000 03000300 018000400030000800040003 01fe028102610219020501fe
+    0204020203ff020002000000 03020281024102210211020e 0102020102110211021101ee
+    007000480044004203ff0040 010f020902090209020901f1 01fc021202110211021101e0
+    0001000103c10031000d0003 01ee021102110211021101ee 001e022102210221012100fe 00cc00cc 02cc01cc
+    00100028004400820101 004800480048004800480048 01010082004400280010 00020001034100210011000e
+    01fe0201027902490249003e 03fc002200210021002203fc 03ff021102110211021101ee
+    01fe02010201020102010102 03ff020102010201010200fc 03ff02110211021102110201
+    03ff00110011001100110001 01fe020102010221022101e2 03ff001000100010001003ff 020103ff0201
+    01800200020101ff0001 03ff00300048008401020201 03ff02000200020002000200
+    03ff0002000400180004000203ff 03ff000600180060018003ff 01fe020102010201020101fe
+    03ff0021002100210021001e 01fe0201020102410181037e 03ff0011003100510091030e
+    010e021102110211021101e2 0001000103ff00010001 01ff020002000200020001ff
+    001f00e00300030000e0001f 03ff0100008000600080010003ff 030300cc0030003000cc0303
+    0007001803e000180007 030102c102210211020d0203 03ff02010201 000300040008003000400180
+    0201020103ff 00040002000100020004 020002000200020002000200 00010002 0180024802480248014803f0
+    03ff011002080208020801f0 01f002080208020802080110 01f0020802080208011003ff
+    01f002480248024802480170 000803fe000900090001 0070028802880288024801f0
+    03ff001000080008000803f0 020803fb0200 0100020801fb 03ff004000a001100208 020103ff0200
+    03f80008000803f00008000803f0 03f8001000080008000803f0 01f0020802080208020801f0
+    03f800880088008800880070 0070008800880088008803f8 03f800100008000800080010
+    013002480248024802480190 000801ff020802080100 01f8020002000200010003f8
+    003800c00300030000c00038 01f80200010000e00100020001f8 0208011000e000e001100208
+    0078028002800280024001f8 030802880248022802180208 001001ee02010201 03ff 0201020101ee0010
+    001000080008001000100008
+""")
+
+# Full-height set for 16-row signs, ASCII 0x20-0x7E (rasterized from DejaVu Sans Mono Bold)
+FONT_FULL = _font(2, """
+    00000000000000000000 1dfe1dfe 001e001e00000000001e001e 03101f3007f003fe1f360ff003fe033e0030
+    0c780cfc18cc7fff0dcc0f8c0700 0018013c00a600b6003c0f40094009200f20
+    07800fdc1c7e18fe19e20f860f061f80 001e001e 0ff83ffe780f4001 70073ffe0ff8
+    00640028003800fe003800280064 00c000c000c00ff80ff800c000c000c0 70007c001c00
+    01800180018001800180 1c001c000c00 200038001e00078000e0003c000e0002
+    07fc0ffe1c0618c61c060ffe07fc 08041c061c061ffe1ffe1c001c000800 1c061e061f061d861ce61c7e1c3c
+    0c061806186618661ce60ffe0f9c 038003c003700338030e1ffe1ffe0300 0c7e187e186618660ce60fc60780
+    00c007fc0ffe1c6618661c660fe607c6 000618061f060fc601fe007e000e 0f9c0ffe1ce6186618e60ffe0fbc
+    08fc18fe19c619861cc60ffe07fc 1c701c700c70 7c703c700c70 01c001c001c003600360063006300630
+    03600360036003600360036003600360 04100630063002200360036001c001c0 000400061dc61de60076003e001c
+    01000ff03838310c67c464646c24646c6ff8 1c001fc007fc03fe030e03fe0ff01f80
+    1ffe1ffe1866186618660cfe0fbe0798 07f80ffc0e0e1c06180618060c06 1ffe1ffe1c060c060c060ffe07fc03f0
+    1ffe1ffe1ce61c661c661c661c66 1ffe1ffe00660066006600660046 01f007fc0ffe1c06188618c60fc60fc6
+    1ffe1ffe0060006000601ffe1ffe 08061c061c061ffe1ffe1c061c06 0c000c00180618061c060ffe07fe
+    1ffe1ffe00e000f003f80f9e1e061c02 1ffe1ffe1c001c001c001c001c00 1ffe0ffe003e00f000f0003e0ffe1ffe
+    0ffe1ffe001e007803c00f001ffe1ffe 01f00ffc0ffe1c0618061c0e0ffe07fc 1ffe1ffe00c600c600c600fe007c
+    01f00ffc0ffe1c0618063c0e3ffe27fc 1ffe1ffe00c600c601c607fe1f7c1c18 0c3c1c7e186618e61cc60fc60f86
+    0006000600061ffe1ffe000600060006 03fe0ffe0ffe1c0018001c000ffe07fe
+    0006007e0ffc1f801e001fe003fe003e 01fe1ffe1f0003f000f00fe01f000ffe
+    18021e0e0f3e03f801f007fc0f1e1c06 0002000e003e00f81fe01ff0007c001e0006
+    1c061f061f861de61cf61c3e1c1e1c06 7fff7fff60036003 0006001c00f003c00f003c003000
+    600360037fff7fff 00100018001c000e0006000e001c0010 800080008000800080008000800080008000
+    000100030006 07000fb01fb0199018980cb01ff01fe0 1fff1fff0c3018301c300ff00fe0
+    07e00ff00c701830181818300c30 03c00ff01ff0183008300e701fff1fff 07c00ff00db01990199019b019f00de0
+    003000301ffe1ffe003300330033 03c04ff0cff0cc38cc10ee707ff03ff0 1fff1fff0030001000301ff00fe0
+    181018301c301ff31ff3180018000800 c010c030c030fff37ff3 1fff1fff01c001e007f00e301c10
+    0002000300030fff0fff1c0018001800 1ff00ff000100ff01ff000100ff01ff0 0ff01ff00070001000301ff01ff0
+    03c00fe00ff0183018181c300ff007e0 fff0fff00c3018101c300ff00fe0 01800ff01ff01c3018300c30fff0fff0
+    1ff01ff00030003000300030 08f019f0199019981f900f300600 003000300ffe0ffe1c3018301830
+    0ff01ff01c0018000c001ff01ff0 001000f007f01f001c000fc003f00070 01f01ff01e000fc001c00f801f000ff0
+    1c300e7007e003c00ff01e701810 c030c0f0e7e07f003f000fe001f00030 1c301e301f3019f018f018701830
+    018001803ffe7f7e600340034000 ffffffff 400360037f7e3ffe01c001800080
+    008000c000c000c00180018001800080
+""")
+
+# Full-height fancy set for 16-row signs, ASCII 0x20-0x7E (rasterized from DejaVu Serif Bold)
+FONT_FULL_FANCY = _font(2, """
+    00000000000000000000 0c3e1dfe0804 003e001c0000003c003c
+    03201f300ff003fc033c1f3007f0037c03340030 0cf010f811c87ffe11880f980f30
+    003c007c004218460c7c031800c000600f981f861080 07800fc01c7c187c18e619c20b860f0c0e001f4018c0
+    003e001c 03c00ff01ff8300c4002 4002300c1ffc0ff807e0 00480068003000fe003000680048
+    01800180018001801ff80ff80180018001800080 60003c001c00 01000380038003800100 08001c000c00
+    38001f0003e0007c000e 03f00ffc0ffc1806100218060ffc0ff803f0 100810041ffe1ffe1ffe10001000
+    1c0c1c041e021f021d861cfc1c7c1e38 0c0c18041042104218e61ffc0fbc0718
+    038002c00230120c1ffe1ffe1ffe12000200 0c7c186e102e102e186e0fee0fce0780
+    03f00ff80ffc1844102218620fe60fcc0300 001e000e080e0e0e038e00ee003e000e
+    07000fbc0ffc18fe104210461ffc0fbc0718 00700cfc19fc1186110219860ffc07fc03f0 1ce01ce0
+    60003ce01ce0 018001c003c0034002600660062004300c30 026002600260026002600260026002600260
+    0c300430062006600260034003c001c00180 000c08021d820cc600fc007c0038
+    07c01ff03018238847c44c64482440044fc44fe40808 18001e0003800170011c017e03fc1ff01f801e001800
+    10061ffe1ffe1ffe1046104618440cfc0ffc0fb80700 03f007f80ffc0c0c18061002100218040c04061c
+    10061ffe1ffe1ffe1006100408040c0c0ffc07f803f0 10061ffe1ffe1ffe18461846184618e6180e0c0c
+    10061ffe1ffe1ffe10460046004600e6000e000c 03f007f80ffc0c0c18061002100210820f840f9c0f98
+    10061ffe1ffe1ffe10460040004010461ffe1ffe1ffe 10061ffe1ffe1ffe1006 8000c0067ffe7ffe3ffe0006
+    10061ffe1ffe1ffe10c601e003f007980f0e1c061806 10061ffe1ffe1ffe18061800180018001c00
+    10061ffe100e007e01fc07e00780030000c00030180c 10061ffe181e003c007800f003e007c00f001e061ffe
+    03f007f80ffc0c0c18061002100218040ffc0ffc07f8 10061ffe1ffe1ffe1086008600c400fc007c0038
+    03f007f80ffc0c0c18061002300278046ffc6ffc07f8 10061ffe1ffe1ffe1086008603c40ffc1f7c1c381800
+    0e7808fc10e410e210c211c20fc40f9c0300 000e0006000610061ffe1ffe1ffe100600060006000c
+    000601fe0ffe0ffe1c0618001000100008000c0603fe 0006001e00fe03fe0fe01f800e0003800060001e0006
+    0006003e01fe0ffe1fc00f0001c00038003e03fc0ff8 1006180e1c1e037e01fe03e01fe01f1e1e0e18061000
+    0006000e001e107e1ffe1fe01fc01060001e0006 180c1e061f061f861be619f6187e183e180e0c04
+    3ffe7ffe7ffe4002 001e00f807c03e003000 40027ffe7ffe7ffe 002000100018000c000e000c001800100020
+    8000800080008000800080008000 00030006 06000f601f20191009300fe01fe01fc01000
+    00021ffe1ffe0ffe0820182018600fe00fe00380 07800fe00fe018201010100008200460
+    03800fe00fe01870182008220ffe1ffe1ffe 07c00fe01fe01930113011e009e005c0
+    00201ff81ffc1ffe102200220006 4fc0cfe09fe098308820ffe07fe03fe00020
+    00021ffe1ffe1ffe0020002018701fe01fe01000 1fe41fee1fe41000 8020ffe4ffee7fe4
+    00021ffe1ffe1ffe110003801fe01e201c201800 00021ffe1ffe1ffe1000
+    10201fe01fe01fe0002000201ff01fe01fc000200020 10201fe01fe01fe0002000201ff01fe01fc01000
+    07800fe00fe01820101018200fe00fe00780 8020ffe0ffe0ffe0882018301fe00fe00fc0
+    03800fe00fe0187018208820ffe0ffe0ffe08020 00201fe01fe01fe01020002000300060
+    0de019e011a013901f000f200e60 00200ffc1ffc1ffc10200820 002007e00fe01fe0180008000fe01fe01fe01000
+    0020006003e00fe01f000c00030000e00020 002001e00fe01fa00e00038000e007e01f800e0003a00060
+    10201c6003e003e01f801ee01c601820 0020c06081e08fe07f001c00030000e00020
+    1c601e201f2013e011e010e01c20 018001803ffc7ffe7e7e40024002 fffefffe 400240027e7e7ffe3ffc0180
+    0180008000c0008001800180018001800080
+""")
+
+FONTS = {5: FONT_5HIGH, 7: FONT_7HIGH, 10: FONT_10HIGH, 16: FONT_FULL}
+FANCY_FONTS = {16: FONT_FULL_FANCY}
+
+# Charset code -> (height in rows or None for full sign height, horizontal scale, shadow, fancy)
+CHARSETS = {
+    "1": (5, 1, False, False), "2": (5, 1, False, False), "3": (7, 1, False, False),
+    "4": (7, 1, False, False), "5": (7, 1, False, True), "6": (10, 1, False, False),
+    "7": (7, 1, True, False), "8": (None, 1, False, True), "9": (None, 1, False, False),
+    ":": (7, 1, True, True), ";": (5, 2, False, False), "<": (7, 2, False, False),
+    "=": (7, 2, False, True), ">": (5, 2, False, False),
+    "W": (5, 1, False, False), "X": (7, 1, False, False), "Y": (10, 1, False, False),
+    "Z": (None, 1, False, False),
+}
+DEFAULT_CHARSET = "3"
+
+
+def font_for(height, fancy):
+    """Table for a set height: the tallest table that fits (full height on a 7-row sign is 7 high)."""
+    fitting = [h for h in FONTS if h <= height] or [min(FONTS)]
+    rows = max(fitting)
+    if fancy and rows in FANCY_FONTS:
+        return rows, FANCY_FONTS[rows]
+    return rows, FONTS[rows]
+
+
+_glyph_cache = {}
+
+
+def glyph(ch, charset, sign_height):
+    """Glyph rows (lists of booleans) for a character in a charset."""
+    key = (ch, charset, sign_height)
+    if key not in _glyph_cache:
+        height, xscale, shadow, fancy = CHARSETS.get(charset, CHARSETS[DEFAULT_CHARSET])
+        rows, table = font_for(sign_height if height is None else min(height, sign_height), fancy)
+        code = ord(ch)
+        if code < 0x20 or code > 0x7E:
+            code = ord("?")
+        columns = [c for c in table[code - 0x20] for _ in range(xscale)]
+        bitmap = [[bool(c >> y & 1) for c in columns] for y in range(rows)]
+        if shadow:
+            width = len(columns) + 1
+            shaded = [[False] * width for _ in range(rows)]
+            for y in range(rows):
+                for x in range(len(columns)):
+                    if bitmap[y][x] or (x and y and bitmap[y - 1][x - 1]):
+                        shaded[y][x] = True
+                if y and bitmap[y - 1][-1]:
+                    shaded[y][width - 1] = True
+            bitmap = shaded
+        _glyph_cache[key] = bitmap
+    return _glyph_cache[key]
+
+
+# ---------------------------------------------------------------------------
+# Protocol parsing
+# ---------------------------------------------------------------------------
+
+def parse_commands(data):
+    """Split a byte stream into (command, label, payload) tuples."""
+    commands = []
+    i, n = 0, len(data)
+    while i < n:
+        if data[i] != SOH:
+            i += 1
+            continue
+        i += 4  # SOH, type, address(2)
+        while i < n and data[i] == STX:
+            i += 1
+            start = i
+            while i < n and data[i] not in (ETX, EOT, SOH):
+                i += 1
+            body = data[start:i]
+            if len(body) >= 2:
+                commands.append((body[0], body[1], body[2:]))
+            if i < n and data[i] == ETX:
+                i += 1
+        if i < n and data[i] == EOT:
+            i += 1
+    return commands
+
+
+class Page:
+    """One screenful of content: lines of (char, color, charset) cells."""
+
+    def __init__(self, position, mode, special):
+        self.position = position
+        self.mode = mode
+        self.special = special
+        self.speed = 5
+        self.lines = [[]]
+
+    def is_blank(self):
+        return all(ch == " " for line in self.lines for ch, _, _ in line)
+
+
+def build_pages(contents, strings):
+    """Interpret text file contents into pages."""
+    pages = []
+    page = None
+    color = "C"
+    charset = DEFAULT_CHARSET
+    i, n = 0, len(contents)
+
+    def new_page(position, mode, special):
+        p = Page(position, mode, special)
+        pages.append(p)
+        return p
+
+    while i < n:
+        b = contents[i]
+        if b == ESC:
+            position = chr(contents[i + 1]) if i + 1 < n else '"'
+            mode = chr(contents[i + 2]) if i + 2 < n else "a"
+            i += 3
+            special = None
+            if mode == "n" and i < n:
+                special = chr(contents[i])
+                i += 1
+            page = new_page(position, mode, special)
+            continue
+        if page is None:
+            page = new_page("0", "a", None)   # No mode field: sign defaults to fill/rotate
+
+        if b == FC_SELECTCHARSET and i + 1 < n:
+            charset = chr(contents[i + 1])
+            i += 2
+        elif b == FC_SELECTCHARCOLOR and i + 1 < n:
+            color = chr(contents[i + 1])
+            i += 2
+        elif b in SPEED_CODES:
+            page.speed = SPEED_CODES[b]
+            i += 1
+        elif b == FC_NEWLINE:
+            page.lines.append([])
+            i += 1
+        elif b == FC_NEWPAGE:
+            page = new_page(page.position, page.mode, page.special)
+            i += 1
+        elif b == FC_CALLSTRING and i + 1 < n:
+            for ch in strings.get(contents[i + 1], b""):
+                page.lines[-1].append((chr(ch), color, charset))
+            i += 2
+        elif b == FC_CALLTIME:
+            for ch in "12:00":
+                page.lines[-1].append((ch, color, charset))
+            i += 1
+        elif b in (FC_CALLDATE, 0x05, 0x06, 0x07, 0x08, 0x1E):
+            i += 2   # One argument byte (date format, double high, descenders, flash, ...)
+        elif b == 0x1D:
+            i += 3   # Character attribute + on/off
+        elif b >= 0x20:
+            page.lines[-1].append((chr(b), color, charset))
+            i += 1
+        else:
+            i += 1
+    return pages
+
+
+class SignState:
+    """Text/string files held by the sign."""
+
+    def __init__(self):
+        self.files = {}
+        self.strings = {}
+
+    def apply(self, data):
+        for cmd, label, payload in parse_commands(data):
+            if cmd == CC_WTEXT:
+                if label == PRIORITY_LABEL and not payload:
+                    self.files.pop(PRIORITY_LABEL, None)   # Cancel priority file
+                else:
+                    self.files[label] = bytes(payload)
+            elif cmd == CC_WSTRING:
+                self.strings[label] = bytes(payload)
+
+    def pages(self):
+        """Pages currently in rotation (priority file overrides the run sequence)."""
+        if PRIORITY_LABEL in self.files:
+            return build_pages(self.files[PRIORITY_LABEL], self.strings)
+        pages = []
+        for label in sorted(self.files):
+            pages += [p for p in build_pages(self.files[label], self.strings) if not p.is_blank()]
+        return pages
+
+
+# ---------------------------------------------------------------------------
+# Rendering
+# ---------------------------------------------------------------------------
+
+def cell_color(color, index, column):
+    if color in COLORS:
+        return COLORS[color]
+    if color == "9":
+        return RAINBOW[(column // 2) % len(RAINBOW)]
+    if color in ("A", "B"):
+        return RAINBOW[index % len(RAINBOW)]
+    return AUTO_CYCLE[index % len(AUTO_CYCLE)]
+
+
+def render_block(page, sign_height):
+    """Render a page's lines into a sparse pixel block: (width, height, {(x, y): rgb})."""
+    pixels = {}
+    y0 = 0
+    width = 0
+    for line in page.lines:
+        x = 0
+        line_height = 0
+        for index, (ch, color, charset) in enumerate(line):
+            rows = glyph(ch, charset, sign_height)
+            rgb = cell_color(color, index, x)
+            for gy, row in enumerate(rows):
+                for gx, on in enumerate(row):
+                    if on:
+                        pixels[(x + gx, y0 + gy)] = cell_color(color, index, x + gx) if color == "9" else rgb
+            x += len(rows[0]) + 1
+            line_height = max(line_height, len(rows))
+        width = max(width, x - 1 if x else 0)
+        y0 += line_height + 1
+    return width, max(0, y0 - 1), pixels
+
+
+def page_duration(page, block_width, width):
+    if page.mode in ("a", "t"):
+        return (width + block_width) / SPEED_CPS[page.speed]
+    return TRANSITION_S + HOLD_S
+
+
+def compose(page, t, width, height):
+    """Pixels of one page at page-local time t."""
+    bw, bh, pixels = render_block(page, height)
+    if page.position == '"':
+        y_base = 0
+    elif page.position == "&":
+        y_base = max(0, height - bh)
+    else:
+        y_base = max(0, (height - bh) // 2)
+    x_base = (width - bw) // 2 if bw <= width else 0
+
+    dx, dy = 0, 0
+    progress = min(1.0, t / TRANSITION_S)
+    visible = None   # Optional predicate on display coordinates
+
+    mode = page.mode
+    if mode in ("a", "t"):
+        x_base = width - int(t * SPEED_CPS[page.speed]) % (width + bw + 1)
+    elif mode == "c":
+        if int(t / FLASH_PERIOD_S) % 2:
+            return {}
+    elif mode in ("m", "e"):
+        dy = int((1 - progress) * height)
+    elif mode == "f":
+        dy = -int((1 - progress) * height)
+    elif mode == "g":
+        dx = int((1 - progress) * width)
+    elif mode == "h":
+        dx = -int((1 - progress) * width)
+    elif mode == "i":
+        visible = lambda x, y: y >= height - progress * height
+    elif mode == "j":
+        visible = lambda x, y: y < progress * height
+    elif mode == "k":
+        visible = lambda x, y: x >= width - progress * width
+    elif mode == "l":
+        visible = lambda x, y: x < progress * width
+    elif mode in ("p", "r"):
+        visible = lambda x, y: abs(x - width / 2.0) <= progress * width / 2.0
+    elif mode in ("q", "s"):
+        visible = lambda x, y: abs(x - width / 2.0) >= (1 - progress) * width / 2.0 or progress >= 1.0
+
+    out = {}
+    for (px, py), rgb in pixels.items():
+        x, y = x_base + px + dx, y_base + py + dy
+        if 0 <= x < width and 0 <= y < height and (visible is None or visible(x, y)):
+            out[(x, y)] = rgb
+    return out
+
+
+def render_state(state, t, width, height):
+    """Full display (row-major list of rgb) for a sign state at virtual time t."""
+    lit = {}
+    pages = state.pages()
+    if pages:
+        blocks = [render_block(p, height)[0] for p in pages]
+        durations = [page_duration(p, bw, width) for p, bw in zip(pages, blocks)]
+        local = t % sum(durations)
+        for page, duration in zip(pages, durations):
+            if local < duration:
+                lit = compose(page, local, width, height)
+                break
+            local -= duration
+    return [[lit.get((x, y), OFF) for x in range(width)] for y in range(height)]
+
+
+def to_png(display, scale=4):
+    """Encode a display as an 8-bit RGB PNG (each LED a scale x scale dot)."""
+    height = len(display)
+    width = len(display[0])
+    raw = bytearray()
+    for row in display:
+        line = bytearray()
+        for rgb in row:
+            line += bytes(rgb) * (scale - 1) + bytes(BACKGROUND)
+        blank = bytes(BACKGROUND) * (width * scale)
+        for sy in range(scale):
+            raw.append(0)
+            raw += line if sy < scale - 1 else blank
+
+    def chunk(kind, body):
+        return (struct.pack(">I", len(body)) + kind + body +
+                struct.pack(">I", zlib.crc32(kind + body) & 0xFFFFFFFF))
+
+    header = struct.pack(">IIBBBBB", width * scale, height * scale, 8, 2, 0, 0, 0)
+    return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) +
+            chunk(b"IDAT", zlib.compress(bytes(raw), 9)) + chunk(b"IEND", b""))
+
+
+def png_pixels(png):
+    """Decode a PNG written by to_png() into (width, height, rgb bytes), or None."""
+    if not png.startswith(b"\x89PNG\r\n\x1a\n"):
+        return None
+    pos, idat, width, height = 8, b"", 0, 0
+    while pos < len(png):
+        length, kind = struct.unpack(">I4s", png[pos:pos + 8])
+        body = png[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, ctype = struct.unpack(">IIBB", body[:10])
+            if depth != 8 or ctype != 2:
+                return None
+        elif kind == b"IDAT":
+            idat += body
+        pos += 12 + length
+    raw = zlib.decompress(idat)
+    stride = width * 3 + 1
+    if any(raw[y * stride] != 0 for y in range(height)):
+        return None   # Filtered rows: not one of ours
+    return width, height, b"".join(raw[y * stride + 1:(y + 1) * stride] for y in range(height))
+
+
+def diff_png(golden, actual):
+    """Return (differing pixel count, highlight PNG) or (None, None) if not comparable."""
+    a, b = png_pixels(golden), png_pixels(actual)
+    if not a or not b or a[:2] != b[:2]:
+        return None, None
+    width, height = a[0], a[1]
+    changed = 0
+    display = []
+    for y in range(height):
+        row = []
+        for x in range(width):
+            i = (y * width + x) * 3
+            same = a[2][i:i + 3] == b[2][i:i + 3]
+            changed += 0 if same else 1
+            row.append(tuple(b[2][i:i + 3]) if same else (255, 0, 255))
+        display.append(row)
+    return changed, to_png(display, scale=1)
+
+
+def to_ansi(display):
+    """Render a display with half-block characters (two LED rows per text row)."""
+    lines = []
+    for y in range(0, len(display), 2):
+        top = display[y]
+        bottom = display[y + 1] if y + 1 < len(display) else [BACKGROUND] * len(top)
+        line = ""
+        for t, b in zip(top, bottom):
+            line += "\x1b[38;2;%d;%d;%dm\x1b[48;2;%d;%d;%dm▀" % (t + b)
+        lines.append(line + "\x1b[0m")
+    return "\n".join(lines)
+
+
+# ---------------------------------------------------------------------------
+# Cases: firmware captures (goldens) and playlist previews
+# ---------------------------------------------------------------------------
+
+def case_name(index, payload):
+    """Name of a capture case: level_category for an alert, else its position."""
+    try:
+        alert = json.loads(payload.decode("utf-8"))
+        return "%03d_%s_%s" % (index, alert["level"], alert["category"])
+    except (ValueError, KeyError, TypeError):
+        return "%03d_message" % index
+
+
+def capture_cases(path, offsets):
+    """Yield (name, [(frame_time, bytes)], [times]) per inbound message of a firmware capture.
+
+    Frames are timed from the message's arrival and belong to the message
+    before them; frames sent before the first message (boot, clear) are
+    skipped. Each case is rendered on its own blank sign.
+    """
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    import capture_replay as cr
+
+    session = cr.load_session(path, -1)
+    cases = []
+    pending, pending_ms = b"", 0
+    for kind, time_ms, body in session["records"]:
+        if kind == "M":
+            topic, _, payload = body.partition(b"\0")
+            cases.append([case_name(len(cases), payload), time_ms, []])
+        elif kind == "F":
+            if not pending:
+                pending_ms = time_ms
+            pending += body
+            if pending[-1] == EOT:
+                if cases:
+                    cases[-1][2].append(((pending_ms - cases[-1][1]) / 1000.0, pending))
+                pending = b""
+    for name, _, frames in cases:
+        yield name, frames, offsets
+
+
+def frame_text(label, contents, color="C", position='"', mode="t", special="0"):
+    """Same bytes as BETABRITE::WriteTextFile / EncodeTextFile (playlist preview only)."""
+    out = bytearray(b"\x00" * 5 + bytes([SOH, SIGN_TYPE_ALL]) + b"00" + bytes([STX, CC_WTEXT, ord(label)]))
+    out += bytes([ESC, ord(position), ord(mode)])
+    if mode == "n":
+        out.append(ord(special))
+    if color != "C":
+        out += bytes([FC_SELECTCHARCOLOR, ord(color)])
+    out += contents
+    out.append(EOT)
+    return bytes(out)
+
+
+def frame_cancel():
+    """Same bytes as BETABRITE::CancelPriorityTextFile (playlist preview only)."""
+    return b"\x00" * 5 + bytes([SOH, SIGN_TYPE_ALL]) + b"00" + bytes([STX, CC_WTEXT, PRIORITY_LABEL, EOT])
+
+
+def playlist_cases(path):
+    """Yield (name, [(frame_time, bytes)], [times]) for every step of a playlist script or .lspl."""
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    import playlist_compiler as pc
+
+    if path.endswith(".lspl"):
+        with open(path, "rb") as f:
+            _, steps = pc.decode(f.read())
+    else:
+        with open(path, "r") as f:
+            steps, _ = pc.parse_script(f.readlines())
+
+    for index, (kind, color, position, mode, special, text, duration) in enumerate(steps):
+        # Mirrors PlaylistPlayer::encodeNext()
+        frame = frame_cancel()
+        if kind == pc.KIND_SHOW:
+            frame += frame_text("0", bytes(text), color, position, mode, special)
+        end = max(0.0, duration / 1000.0 - 0.05)
+        yield "playlist_%03d" % index, [(0.0, frame)], sorted({min(0.25, end), min(1.0, end)})
+
+
+def case_shots(frames, times):
+    """Yield (t, state, local t) per render time: frames sent by t applied, clock from the last one."""
+    for t in times:
+        state = SignState()
+        last = 0.0
+        for at, data in frames:
+            if at <= t:
+                state.apply(data)
+                last = at
+        yield t, state, t - last
+
+
+def run_cases(cases, args):
+    """Render every case, writing images and/or comparing against goldens."""
+    failures = 0
+    written = 0
+    for name, frames, times in cases:
+        for t, state, local in case_shots(frames, times):
+            image_name = "%s_t%04d.png" % (name, int(round(t * 1000)))
+            display = render_state(state, local, args.width, args.height)
+            png = to_png(display, args.scale)
+            if args.out:
+                with open(os.path.join(args.out, image_name), "wb") as f:
+                    f.write(png)
+                written += 1
+            if args.golden:
+                golden_path = os.path.join(args.golden, image_name)
+                if args.update:
+                    with open(golden_path, "wb") as f:
+                        f.write(png)
+                    written += 1
+                    continue
+                if not os.path.exists(golden_path):
+                    print("MISSING  %s" % image_name)
+                    failures += 1
+                    continue
+                with open(golden_path, "rb") as f:
+                    golden = f.read()
+                if golden != png:
+                    changed, highlight = diff_png(golden, png)
+                    failures += 1
+                    if changed is None:
+                        print("DIFF     %s (size or format changed)" % image_name)
+                    else:
+                        print("DIFF     %s (%d pixels)" % (image_name, changed))
+                        with open(os.path.join(args.golden, image_name[:-4] + ".diff.png"), "wb") as f:
+                            f.write(highlight)
+            if args.ansi:
+                print("%s  t=%.2fs" % (name, t))
+                print(to_ansi(display))
+    if written:
+        print("Wrote %d images" % written)
+    if args.golden and not args.update:
+        print("%s: %d differences" % ("FAIL" if failures else "OK", failures))
+    return 1 if failures else 0
+
+
+def parse_times(args):
+    if args.at:
+        return [float(t) for t in args.at.split(",")]
+    steps = max(1, int(args.duration * args.fps))
+    return [i / float(args.fps) for i in range(steps)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Render BetaBrite protocol traffic to images")
+    parser.add_argument("--geometry", default="%dx%d" % (DEFAULT_WIDTH, DEFAULT_HEIGHT),
+                        help="sign size in LEDs, WIDTHxHEIGHT (default %(default)s)")
+    parser.add_argument("--scale", type=int, default=4, help="PNG pixels per LED (default 4)")
+    sub = parser.add_subparsers(dest="command")
+
+    p = sub.add_parser("render", help="render a captured byte stream")
+    p.add_argument("input", help="raw capture file (or hex text with --hex)")
+    p.add_argument("--hex", action="store_true", help="input is whitespace-separated hex bytes")
+    p.add_argument("--at", help="comma-separated virtual times in seconds")
+    p.add_argument("--fps", type=float, default=4.0, help="frames per second with --duration")
+    p.add_argument("--duration", type=float, default=2.0, help="seconds to render (default 2)")
+    p.add_argument("--png", metavar="PREFIX", help="write PREFIX_NNN.png per frame")
+
+    p = sub.add_parser("capture", help="render each message of a firmware capture (golden gate)")
+    p.add_argument("input", help="capture file or serial log with CAPTURE lines")
+    p.add_argument("--at", default="0.25,1,3,4.5",
+                   help="seconds after each message to render (default %(default)s)")
+    p.add_argument("--golden", help="directory of golden PNGs to compare against")
+    p.add_argument("--update", action="store_true", help="rewrite goldens instead of comparing")
+    p.add_argument("--out", help="directory for rendered PNGs")
+    p.add_argument("--ansi", action="store_true", help="also print frames to the terminal")
+
+    p = sub.add_parser("playlist", help="preview every step of a playlist")
+    p.add_argument("playlist", nargs="?", default="tools/playlists/demo.playlist",
+                   help="playlist script or compiled .lspl")
+    p.add_argument("--out", help="directory for rendered PNGs")
+    p.add_argument("--ansi", action="store_true", help="also print frames to the terminal")
+
+    args = parser.parse_args()
+    try:
+        args.width, args.height = (int(v) for v in args.geometry.lower().split("x"))
+    except ValueError:
+        parser.error("--geometry must look like 80x16")
+
+    if args.command == "render":
+        if args.hex:
+            with open(args.input, "r") as f:
+                data = bytes.fromhex(" ".join(f.read().split()))
+        else:
+            with open(args.input, "rb") as f:
+                data = f.read()
+        state = SignState()
+        state.apply(data)
+        for index, t in enumerate(parse_times(args)):
+            display = render_state(state, t, args.width, args.height)
+            if args.png:
+                with open("%s_%03d.png" % (args.png, index), "wb") as f:
+                    f.write(to_png(display, args.scale))
+            else:
+                print("t=%.2fs" % t)
+                print(to_ansi(display))
+        return 0
+
+    if args.command in ("capture", "playlist"):
+        if args.command == "capture":
+            cases = capture_cases(args.input, [float(t) for t in args.at.split(",")])
+        else:
+            args.golden = None
+            cases = playlist_cases(args.playlist)
+        for directory in (args.out, args.golden):
+            if directory:
+                os.makedirs(directory, exist_ok=True)
+        if not args.out and not args.golden:
+            args.ansi = True
+        return run_cases(cases, args)
+
+    parser.print_help()
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())